@@ -99,6 +99,30 @@ function(gnc_add_test _TARGET _SOURCE_FILES TEST_INCLUDE_VAR_NAME TEST_LIBS_VAR_
   add_dependencies(check ${_TARGET})
 endfunction()
 
+# Benchmarks only report timings, which depend on the machine, so they
+# aren't ctest tests: "make benchmark" builds and runs them, one at a time
+# so that they don't compete for the processors.
+function(gnc_add_benchmark _TARGET _SOURCE_FILES TEST_INCLUDE_VAR_NAME TEST_LIBS_VAR_NAME)
+  set(TEST_INCLUDE_DIRS ${${TEST_INCLUDE_VAR_NAME}})
+  set(TEST_LIBS ${${TEST_LIBS_VAR_NAME}})
+  set_source_files_properties (${_SOURCE_FILES} PROPERTIES OBJECT_DEPENDS ${CONFIG_H})
+  add_executable(${_TARGET} EXCLUDE_FROM_ALL ${_SOURCE_FILES})
+  target_link_libraries(${_TARGET} ${TEST_LIBS})
+  target_include_directories(${_TARGET} PRIVATE ${TEST_INCLUDE_DIRS})
+  add_custom_target(run-${_TARGET}
+    COMMAND ${CMAKE_COMMAND} -E env GNC_UNINSTALLED=YES GNC_BUILDDIR=${CMAKE_BINARY_DIR} ${ARGN}
+      ${CMAKE_BINARY_DIR}/bin/${_TARGET}
+    DEPENDS ${_TARGET}
+    USES_TERMINAL
+  )
+  get_property(_previous GLOBAL PROPERTY GNC_LAST_BENCHMARK)
+  if (_previous)
+    add_dependencies(run-${_TARGET} ${_previous})
+  endif()
+  set_property(GLOBAL PROPERTY GNC_LAST_BENCHMARK run-${_TARGET})
+  add_dependencies(benchmark run-${_TARGET})
+endfunction()
+
 function(gnc_add_test_with_guile _TARGET _SOURCE_FILES TEST_INCLUDE_VAR_NAME TEST_LIBS_VAR_NAME)
   get_guile_env()
   gnc_add_test(${_TARGET} "${_SOURCE_FILES}" "${TEST_INCLUDE_VAR_NAME}" "${TEST_LIBS_VAR_NAME}"
@@ -1367,6 +1367,42 @@ gnc_file_do_export(GtkWindow *parent, const char * filename)
 }
 
 static gboolean been_here_before = FALSE;
+static guint background_save_source = 0;
+
+/* Polled while the backend writes a save out in the background. Once it
+ * is over, collect the outcome and tell the user if it failed, or
+ * announce the save if it didn't. */
+static gboolean
+gnc_file_finish_background_save (gpointer user_data)
+{
+    QofBackendError io_err;
+    QofSession *session;
+
+    if (!gnc_current_session_exist ())
+    {
+        background_save_source = 0;
+        return FALSE;
+    }
+
+    session = gnc_get_current_session ();
+    if (qof_session_save_in_progress (session))
+        return TRUE;
+
+    background_save_source = 0;
+    qof_session_wait_for_save (session);
+    io_err = qof_session_pop_error (session);
+    if (ERR_BACKEND_NO_ERR != io_err)
+    {
+        show_session_error (gnc_ui_get_main_window (NULL), io_err,
+                            qof_session_get_url (session),
+                            GNC_FILE_DIALOG_SAVE);
+        return FALSE;
+    }
+
+    gnc_add_history (session);
+    gnc_hook_run(HOOK_BOOK_SAVED, session);
+    return FALSE;
+}
 
 void
 gnc_file_save (GtkWindow *parent)
@@ -1428,6 +1464,18 @@ gnc_file_save (GtkWindow *parent)
     }
 
     xaccReopenLog();
+
+    /* The book isn't saved until the background write is over, so leave
+     * the history and HOOK_BOOK_SAVED to gnc_file_finish_background_save. */
+    if (qof_session_save_in_progress (session))
+    {
+        if (!background_save_source)
+            background_save_source =
+                g_timeout_add (250, gnc_file_finish_background_save, NULL);
+        LEAVE ("saving in the background");
+        return;
+    }
+
     gnc_add_history (session);
     gnc_hook_run(HOOK_BOOK_SAVED, session);
     LEAVE (" ");
@@ -1490,7 +1490,6 @@ gnc_tree_model_price_do_deletions (gpointer price_db)
 
             /* Remove the path. */
             gnc_tree_model_price_row_delete(data->model, data->path);
-            gnc_pricedb_nth_price_reset_cache (price_db);
 
             gtk_tree_path_free(data->path);
             g_free(data);
@@ -1616,7 +1615,6 @@ gnc_tree_model_price_event_handler (QofInstance *entity,
     case QOF_EVENT_ADD:
         /* Tell the filters/views where the new price was added. */
         DEBUG("add %s", name);
-        gnc_pricedb_nth_price_reset_cache (priv->price_db);
         gnc_tree_model_price_row_add (model, &iter);
         break;
 
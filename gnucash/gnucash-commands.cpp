@@ -111,6 +111,7 @@ scm_add_quotes(void *data, [[maybe_unused]] int argc, [[maybe_unused]] char **ar
     auto scm_result = scm_call_2(add_quotes, SCM_BOOL_F, scm_book);
 
     qof_session_save(session, NULL);
+    qof_session_wait_for_save(session);
     if (qof_session_get_error(session) != ERR_BACKEND_NO_ERR)
         scm_cleanup_and_exit_with_failure (session);
 
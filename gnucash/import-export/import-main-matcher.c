@@ -540,6 +540,7 @@ on_matcher_ok_clicked (GtkButton *button, GNCImportMainMatcher *info)
     gboolean append_text = gtk_toggle_button_get_active ((GtkToggleButton*) info->append_text);
     gboolean first_tran = TRUE;
     gpointer user_data = info->user_data;
+    QofBook *book = gnc_get_current_book ();
 
     g_assert (info);
 
@@ -556,6 +557,9 @@ on_matcher_ok_clicked (GtkButton *button, GNCImportMainMatcher *info)
     /* Don't run any queries and/or split sorts while processing the matcher
     results. */
     gnc_suspend_gui_refresh ();
+    /* Likewise put off sorting the accounts' splits and computing their
+       balances until everything has been entered. */
+    gnc_book_begin_bulk_load (book);
     do
     {
         gtk_tree_model_get (model, &iter,
@@ -591,6 +595,7 @@ on_matcher_ok_clicked (GtkButton *button, GNCImportMainMatcher *info)
     while (gtk_tree_model_iter_next (model, &iter));
 
     gnc_gen_trans_list_delete (info);
+    gnc_book_end_bulk_load (book);
 
     /* Allow GUI refresh again. */
     gnc_resume_gui_refresh ();
@@ -59,6 +59,7 @@ struct gnc_ledger_display
     GncGUID leader;
 
     Query* query;
+    QofLiveQuery* live_query;
 
     GNCLedgerDisplayType ld_type;
 
@@ -101,6 +102,8 @@ static void gnc_ledger_display_make_query (GNCLedgerDisplay* ld,
                                            gint limit,
                                            SplitRegisterType type);
 
+static GList* gnc_ledger_display_run_query (GNCLedgerDisplay* ld);
+
 /** Implementations *************************************************/
 
 Account*
@@ -637,12 +640,11 @@ refresh_handler (GHashTable* changes, gpointer user_data)
     if (!ld->reg->is_template && (ld->reg->type == SEARCH_LEDGER || ld->ld_type == LD_GL))
         exclude_template_accounts (ld->query, ld->excluded_template_acc_hash);
 
-    /* Its not clear if we should re-run the query, or if we should
-     * just use qof_query_last_run().  Its possible that the dates
-     * changed, requiring a full new query.  Similar considerations
-     * needed for multi-user mode.
+    /* The live query has already followed the edits that led here, and
+     * only runs the whole query again if its terms have changed.
+     * Changes made by other users in multi-user mode are not seen.
      */
-    splits = qof_query_run (ld->query);
+    splits = gnc_ledger_display_run_query (ld);
 
     gnc_ledger_display_set_watches (ld, splits);
 
@@ -671,6 +673,8 @@ close_handler (gpointer user_data)
     if (ld->excluded_template_acc_hash)
         g_hash_table_destroy (ld->excluded_template_acc_hash);
 
+    qof_live_query_destroy (ld->live_query);
+    ld->live_query = NULL;
     qof_query_destroy (ld->query);
     ld->query = NULL;
 
@@ -733,6 +737,23 @@ gnc_ledger_display_make_query (GNCLedgerDisplay* ld,
                               QOF_GUID_MATCH_ANY, QOF_QUERY_AND);
 
     g_list_free (accounts);
+
+    if (ld->live_query)
+        qof_live_query_set_query (ld->live_query, ld->query);
+}
+
+/* Return the query's current results, following the book's changes
+ * through a live query rather than running it afresh every time. */
+static GList*
+gnc_ledger_display_run_query (GNCLedgerDisplay* ld)
+{
+    if (!ld->query)
+        return NULL;
+
+    if (!ld->live_query)
+        ld->live_query = qof_live_query_new (ld->query, NULL, NULL);
+
+    return qof_live_query_get_results (ld->live_query);
 }
 
 /* Opens up a ledger window for an arbitrary query. */
@@ -836,6 +857,7 @@ gnc_ledger_display_internal (Account* lead_account, Query* q,
 
     ld->leader = *xaccAccountGetGUID (lead_account);
     ld->query = NULL;
+    ld->live_query = NULL;
     ld->ld_type = ld_type;
     ld->loading = FALSE;
     ld->destroy = NULL;
@@ -867,7 +889,7 @@ gnc_ledger_display_internal (Account* lead_account, Query* q,
 
     gnc_split_register_set_data (ld->reg, ld, gnc_ledger_display_parent);
 
-    splits = qof_query_run (ld->query);
+    splits = gnc_ledger_display_run_query (ld);
 
     gnc_ledger_display_set_watches (ld, splits);
 
@@ -886,6 +908,9 @@ gnc_ledger_display_set_query (GNCLedgerDisplay* ledger_display, Query* q)
 
     qof_query_destroy (ledger_display->query);
     ledger_display->query = qof_query_copy (q);
+    if (ledger_display->live_query)
+        qof_live_query_set_query (ledger_display->live_query,
+                                  ledger_display->query);
 }
 
 GNCLedgerDisplay*
@@ -939,7 +964,7 @@ gnc_ledger_display_refresh (GNCLedgerDisplay* ld)
     if (!ld->reg->is_template && (ld->reg->type == SEARCH_LEDGER || ld->ld_type == LD_GL))
         exclude_template_accounts (ld->query, ld->excluded_template_acc_hash);
 
-    gnc_ledger_display_refresh_internal (ld, qof_query_run (ld->query));
+    gnc_ledger_display_refresh_internal (ld, gnc_ledger_display_run_query (ld));
     LEAVE (" ");
 }
 
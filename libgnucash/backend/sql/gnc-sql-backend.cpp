@@ -285,6 +285,7 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
     ENTER ("sql_be=%p, book=%p", this, book);
 
     m_loading = TRUE;
+    gnc_book_begin_bulk_load (book);
 
     if (loadType == LOAD_TYPE_INITIAL_LOAD)
     {
@@ -332,6 +333,7 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
         obe->load_all (this);
     }
 
+    gnc_book_end_bulk_load (book);
     m_loading = FALSE;
     std::for_each(m_postload_commodities.begin(), m_postload_commodities.end(),
                  [](gnc_commodity* comm) {
@@ -40,6 +40,7 @@ extern "C"
 #include "sixtp-utils.h"
 #include "sixtp-dom-parsers.h"
 #include "sixtp-dom-generators.h"
+#include "gnc-xml-writer.hpp"
 
 #include "gnc-xml.h"
 #include "io-gncxml-gen.h"
@@ -166,6 +167,69 @@ gnc_account_dom_tree_create (Account* act,
     return ret;
 }
 
+void
+gnc_account_xml_write (GncXmlWriter& writer, Account* act,
+                       gboolean exporting, gboolean allow_incompat)
+{
+    ENTER ("(account=%p)", act);
+
+    writer.start_element (gnc_account_string);
+    writer.attribute ("version", account_version_string);
+
+    writer.text_element (act_name_string, xaccAccountGetName (act));
+    writer.guid_element (act_id_string, xaccAccountGetGUID (act));
+    writer.text_element (act_type_string,
+                         xaccAccountTypeEnumAsString (xaccAccountGetType (act)));
+
+    auto acct_commodity = xaccAccountGetCommodity (act);
+    if (acct_commodity != NULL)
+    {
+        writer.commodity_ref_element (act_commodity_string, acct_commodity);
+        writer.int_element (act_commodity_scu_string,
+                            xaccAccountGetCommoditySCUi (act));
+
+        if (xaccAccountGetNonStdSCU (act))
+        {
+            writer.start_element (act_non_standard_scu_string);
+            writer.end_element ();
+        }
+    }
+
+    auto str = xaccAccountGetCode (act);
+    if (str && strlen (str) > 0)
+        writer.text_element (act_code_string, str);
+
+    str = xaccAccountGetDescription (act);
+    if (str && strlen (str) > 0)
+        writer.text_element (act_description_string, str);
+
+    writer.slots_element (act_slots_string, QOF_INSTANCE (act));
+
+    auto parent = gnc_account_get_parent (act);
+    if (parent)
+    {
+        if (!gnc_account_is_root (parent) || allow_incompat)
+            writer.guid_element (act_parent_string, xaccAccountGetGUID (parent));
+    }
+
+    auto lots = xaccAccountGetLotList (act);
+    PINFO ("lot list=%p", lots);
+    if (lots && !exporting)
+    {
+        writer.start_element (act_lots_string);
+
+        lots = g_list_sort (lots, qof_instance_guid_compare);
+        for (auto n = lots; n; n = n->next)
+            gnc_lot_xml_write (writer, static_cast<GNCLot*> (n->data));
+
+        writer.end_element ();
+    }
+    g_list_free (lots);
+
+    writer.end_element ();
+    LEAVE ("");
+}
+
 /***********************************************************************/
 
 struct account_pdata
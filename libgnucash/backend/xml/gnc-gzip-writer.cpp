@@ -0,0 +1,245 @@
+/********************************************************************
+ * gnc-gzip-writer.cpp: compress a gzip file on worker threads      *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ ********************************************************************/
+#include <glib.h>
+
+extern "C"
+{
+#include <config.h>
+
+#include <errno.h>
+#include <zlib.h>
+}
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "gnc-gzip-writer.hpp"
+
+/* How much data is deflated at a time, and how much of what comes
+ * before a block primes its compressor; 32K is all deflate can refer
+ * back to. */
+#define GZ_BLOCK_SIZE (128 * 1024)
+#define GZ_DICT_SIZE (32 * 1024)
+
+/* Deflates one block as a piece of a raw deflate stream.  Only the last
+ * block finishes the stream; the others end with a sync flush, so the
+ * next block can follow on from a byte boundary. */
+static std::string
+deflate_block (const std::string& data, const std::string& dict, int level,
+               bool last)
+{
+    z_stream strm {};
+    if (deflateInit2 (&strm, level, Z_DEFLATED, -MAX_WBITS, 8,
+                      Z_DEFAULT_STRATEGY) != Z_OK)
+        throw std::runtime_error ("deflateInit2 failed");
+
+    if (!dict.empty ())
+        deflateSetDictionary (&strm,
+                              reinterpret_cast<const Bytef*> (dict.data ()),
+                              dict.size ());
+
+    std::string deflated;
+    /* Room for the sync flush's empty stored block as well. */
+    deflated.resize (deflateBound (&strm, data.size ()) + 16);
+    strm.next_in = reinterpret_cast<Bytef*> (const_cast<char*> (data.data ()));
+    strm.avail_in = data.size ();
+
+    size_t have = 0;
+    while (true)
+    {
+        if (have == deflated.size ())
+            deflated.resize (deflated.size () * 2);
+        strm.next_out = reinterpret_cast<Bytef*> (&deflated[have]);
+        strm.avail_out = deflated.size () - have;
+
+        auto ret = deflate (&strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+        have = deflated.size () - strm.avail_out;
+        if (ret == Z_STREAM_ERROR)
+        {
+            deflateEnd (&strm);
+            throw std::runtime_error ("deflate failed");
+        }
+        if (last ? ret == Z_STREAM_END : strm.avail_out != 0)
+            break;
+    }
+    deflateEnd (&strm);
+
+    deflated.resize (have);
+    return deflated;
+}
+
+GncGzipWriter::GncGzipWriter (FILE* out, int level, guint n_workers) :
+    m_out {out}, m_level {level}, m_crc {crc32 (0L, Z_NULL, 0)}
+{
+    n_workers = std::max (n_workers, 1u);
+    /* Enough to keep every worker busy while the oldest block is
+     * written, without holding the whole file in memory. */
+    m_max_pending = 2 * n_workers;
+    m_block.reserve (GZ_BLOCK_SIZE);
+
+    /* No name and no time stamp.  XFL marks the best or fastest levels
+     * the way deflate does in its own gzip header, but the OS byte is
+     * 0xff (unknown) rather than the build's OS_CODE, so the header
+     * isn't byte for byte the one gzopen() writes.  deflate takes
+     * Z_DEFAULT_COMPRESSION to be level 6. */
+    auto xfl_level = level == Z_DEFAULT_COMPRESSION ? 6 : level;
+    const unsigned char header[] =
+    {
+        0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0,
+        static_cast<unsigned char> (xfl_level == 9 ? 2 :
+                                    xfl_level < 2 ? 4 : 0),
+        0xff
+    };
+    write_bytes (header, sizeof (header));
+
+    for (guint i = 0; i < n_workers; i++)
+        m_threads.emplace_back (&GncGzipWriter::work, this);
+}
+
+GncGzipWriter::~GncGzipWriter ()
+{
+    {
+        std::lock_guard<std::mutex> lock {m_mutex};
+        m_stop = true;
+    }
+    m_cond.notify_all ();
+    for (auto& thread : m_threads)
+        thread.join ();
+}
+
+void
+GncGzipWriter::work ()
+{
+    while (true)
+    {
+        BlockTask job;
+        {
+            std::unique_lock<std::mutex> lock {m_mutex};
+            m_cond.wait (lock, [this] { return m_stop || !m_jobs.empty (); });
+            if (m_stop)
+                return;
+            job = std::move (m_jobs.front ());
+            m_jobs.pop_front ();
+        }
+        job ();
+    }
+}
+
+void
+GncGzipWriter::write_bytes (const void* data, size_t len)
+{
+    if (m_ok && fwrite (data, 1, len, m_out) != len)
+    {
+        g_warning ("Could not write the compressed file. The error is '%s' (errno %d)",
+                   g_strerror (errno), errno);
+        m_ok = FALSE;
+    }
+}
+
+void
+GncGzipWriter::submit (bool last)
+{
+    auto dict = std::move (m_dict);
+    if (!last)
+        m_dict.assign (m_block, m_block.size () - GZ_DICT_SIZE, GZ_DICT_SIZE);
+
+    BlockTask job {[data = std::move (m_block), dict = std::move (dict),
+                    level = m_level, last]
+    {
+        auto crc = crc32 (crc32 (0L, Z_NULL, 0),
+                          reinterpret_cast<const Bytef*> (data.data ()),
+                          data.size ());
+        return Block {deflate_block (data, dict, level, last), crc, data.size ()};
+    }};
+    m_block.clear ();
+    m_block.reserve (GZ_BLOCK_SIZE);
+
+    m_results.push_back (job.get_future ());
+    {
+        std::lock_guard<std::mutex> lock {m_mutex};
+        m_jobs.push_back (std::move (job));
+    }
+    m_cond.notify_one ();
+}
+
+void
+GncGzipWriter::write_next_block ()
+{
+    auto result = std::move (m_results.front ());
+    m_results.pop_front ();
+
+    try
+    {
+        auto block = result.get ();
+        write_bytes (block.deflated.data (), block.deflated.size ());
+        m_crc = crc32_combine (m_crc, block.crc, block.len);
+        m_size += block.len;
+    }
+    catch (const std::exception& err)
+    {
+        g_warning ("Could not compress the file: %s", err.what ());
+        m_ok = FALSE;
+    }
+}
+
+gboolean
+GncGzipWriter::write (const char* data, size_t len)
+{
+    g_return_val_if_fail (!m_finished, FALSE);
+
+    while (len && m_ok)
+    {
+        auto n_copy = std::min (len, GZ_BLOCK_SIZE - m_block.size ());
+        m_block.append (data, n_copy);
+        data += n_copy;
+        len -= n_copy;
+
+        if (m_block.size () == GZ_BLOCK_SIZE)
+        {
+            submit (false);
+            while (m_results.size () > m_max_pending)
+                write_next_block ();
+        }
+    }
+    return m_ok;
+}
+
+gboolean
+GncGzipWriter::finish ()
+{
+    g_return_val_if_fail (!m_finished, FALSE);
+    m_finished = true;
+
+    submit (true);
+    while (!m_results.empty ())
+        write_next_block ();
+
+    /* The CRC and length of the data, least significant byte first. */
+    unsigned char trailer[8];
+    for (int i = 0; i < 4; i++)
+    {
+        trailer[i] = (m_crc >> (8 * i)) & 0xff;
+        trailer[i + 4] = (m_size >> (8 * i)) & 0xff;
+    }
+    write_bytes (trailer, sizeof (trailer));
+    return m_ok;
+}
@@ -0,0 +1,103 @@
+/********************************************************************
+ * gnc-gzip-writer.hpp: compress a gzip file on worker threads      *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ ********************************************************************/
+
+#ifndef GNC_GZIP_WRITER_HPP
+#define GNC_GZIP_WRITER_HPP
+
+extern "C"
+{
+#include <glib.h>
+#include <stdio.h>
+}
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** Writes a gzip file, deflating it on worker threads.
+ *
+ * The data is cut into blocks which are deflated independently, each
+ * primed with the 32K of data before it so little is lost to the
+ * splitting.  Every block but the last ends with a sync flush, which
+ * leaves it on a byte boundary, so the compressed blocks written one
+ * after the other make up a single ordinary deflate stream.  The file
+ * is one gzip member with one CRC, readable by gzread() and gunzip like
+ * any other.
+ */
+class GncGzipWriter
+{
+public:
+    /** @param out The file to write to; it is not closed.
+     *  @param level The zlib compression level, 0 to 9, or -1 for
+     *  zlib's default.
+     *  @param n_workers The number of compressing threads, at least 1. */
+    GncGzipWriter (FILE* out, int level, guint n_workers);
+    GncGzipWriter (const GncGzipWriter&) = delete;
+    GncGzipWriter& operator= (const GncGzipWriter&) = delete;
+    ~GncGzipWriter ();
+
+    /** Adds data to the file.
+     *  @return FALSE if compressing or writing failed, now or earlier. */
+    gboolean write (const char* data, size_t len);
+    /** Compresses what is left and writes the gzip trailer.  Nothing
+     * may be written afterwards.
+     *  @return FALSE if compressing or writing failed. */
+    gboolean finish ();
+
+private:
+    struct Block
+    {
+        std::string deflated;
+        gulong crc;
+        size_t len;
+    };
+    using BlockTask = std::packaged_task<Block ()>;
+
+    void submit (bool last);
+    void write_next_block ();
+    void write_bytes (const void* data, size_t len);
+    void work ();
+
+    FILE* m_out;
+    int m_level;
+    gboolean m_ok = TRUE;
+    bool m_finished = false;
+
+    std::string m_block;
+    std::string m_dict;
+    gulong m_crc;
+    guint64 m_size = 0;
+    size_t m_max_pending;
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<BlockTask> m_jobs;
+    bool m_stop = false;
+    std::deque<std::future<Block>> m_results;
+};
+
+#endif /* GNC_GZIP_WRITER_HPP */
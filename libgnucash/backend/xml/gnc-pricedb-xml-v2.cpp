@@ -35,6 +35,8 @@ extern "C"
 #include "sixtp-parsers.h"
 #include "sixtp-dom-parsers.h"
 #include "sixtp-dom-generators.h"
+#include "sixtp-stream-parsers.hpp"
+#include "gnc-xml-writer.hpp"
 #include "io-gncxml-gen.h"
 #include "io-gncxml-v2.h"
 
@@ -77,71 +79,146 @@ static QofLogModule log_module = GNC_MOD_IO;
 
 /****************************************************************************/
 /* <price>
-
-  restores a price.  Does so via a walk of the XML tree in memory.
+  restores a price.  Does so straight from the SAX events, without
+  building a DOM tree for it; each child element is collected by a
+  SixtpStreamField and applied when it ends.
   Returns a GNCPrice * in result.
-
   Right now, a price is legitimate even if all of it's fields are not
   set.  We may need to change that later, but at the moment.
-
 */
 
+struct price_stream_pdata
+{
+    QofBook* book;
+    GNCPrice* price = nullptr;
+    SixtpStreamField field;
+    int depth = 0;
+    gboolean has_children = FALSE;
+    gboolean ok = TRUE;
+};
+
 static gboolean
-price_parse_xml_sub_node (GNCPrice* p, xmlNodePtr sub_node, QofBook* book)
+price_parse_xml_field (GNCPrice* p, const SixtpStreamField& field,
+                       QofBook* book)
 {
-    if (!p || !sub_node) return FALSE;
+    const std::string& tag = field.tag ();
 
-    gnc_price_begin_edit (p);
-    if (g_strcmp0 ("price:id", (char*)sub_node->name) == 0)
+    if (tag == "price:id")
     {
-        GncGUID* c = dom_tree_to_guid (sub_node);
+        GncGUID* c = field.to_guid ();
         if (!c) return FALSE;
+        gnc_price_begin_edit (p);
         gnc_price_set_guid (p, c);
+        gnc_price_commit_edit (p);
         guid_free (c);
     }
-    else if (g_strcmp0 ("price:commodity", (char*)sub_node->name) == 0)
+    else if (tag == "price:commodity")
     {
-        gnc_commodity* c = dom_tree_to_commodity_ref (sub_node, book);
+        gnc_commodity* c = field.to_commodity_ref (book);
         if (!c) return FALSE;
+        gnc_price_begin_edit (p);
         gnc_price_set_commodity (p, c);
+        gnc_price_commit_edit (p);
     }
-    else if (g_strcmp0 ("price:currency", (char*)sub_node->name) == 0)
+    else if (tag == "price:currency")
     {
-        gnc_commodity* c = dom_tree_to_commodity_ref (sub_node, book);
+        gnc_commodity* c = field.to_commodity_ref (book);
         if (!c) return FALSE;
+        gnc_price_begin_edit (p);
         gnc_price_set_currency (p, c);
+        gnc_price_commit_edit (p);
     }
-    else if (g_strcmp0 ("price:time", (char*)sub_node->name) == 0)
+    else if (tag == "price:time")
     {
-        time64 time = dom_tree_to_time64 (sub_node);
-        if (!dom_tree_valid_time64 (time, sub_node->name)) time = 0;
+        time64 time = field.to_time64 ();
+        if (!dom_tree_valid_time64 (time, field.name ())) time = 0;
+        gnc_price_begin_edit (p);
         gnc_price_set_time64 (p, time);
+        gnc_price_commit_edit (p);
     }
-    else if (g_strcmp0 ("price:source", (char*)sub_node->name) == 0)
+    else if (tag == "price:source")
     {
-        char* text = dom_tree_to_text (sub_node);
+        char* text = field.to_text ();
         if (!text) return FALSE;
+        gnc_price_begin_edit (p);
         gnc_price_set_source_string (p, text);
+        gnc_price_commit_edit (p);
         g_free (text);
     }
-    else if (g_strcmp0 ("price:type", (char*)sub_node->name) == 0)
+    else if (tag == "price:type")
     {
-        char* text = dom_tree_to_text (sub_node);
+        char* text = field.to_text ();
         if (!text) return FALSE;
+        gnc_price_begin_edit (p);
         gnc_price_set_typestr (p, text);
+        gnc_price_commit_edit (p);
         g_free (text);
     }
-    else if (g_strcmp0 ("price:value", (char*)sub_node->name) == 0)
+    else if (tag == "price:value")
     {
-        gnc_numeric* value = dom_tree_to_gnc_numeric (sub_node);
+        gnc_numeric* value = field.to_gnc_numeric ();
         if (!value) return FALSE;
+        gnc_price_begin_edit (p);
         gnc_price_set_value (p, *value);
+        gnc_price_commit_edit (p);
         g_free (value);
     }
-    gnc_price_commit_edit (p);
     return TRUE;
 }
 
+static gboolean
+price_parse_xml_start_handler (GSList* sibling_data, gpointer parent_data,
+                               gpointer global_data,
+                               gpointer* data_for_children, gpointer* result,
+                               const gchar* tag, gchar** attrs)
+{
+    struct price_stream_pdata* pdata;
+
+    *result = NULL;
+
+    if (!parent_data)
+    {
+        gxpf_data* gdata = static_cast<decltype (gdata)> (global_data);
+        pdata = new price_stream_pdata;
+        pdata->book = static_cast<QofBook*> (gdata->bookdata);
+        *data_for_children = pdata;
+        return TRUE;
+    }
+
+    pdata = static_cast<decltype (pdata)> (parent_data);
+    *data_for_children = pdata;
+    pdata->has_children = TRUE;
+
+    if (++pdata->depth == 1)
+        pdata->field.start (tag, attrs);
+    else
+        pdata->field.element_start (tag, attrs);
+    return TRUE;
+}
+
+static gboolean
+price_parse_xml_chars_handler (GSList* sibling_data, gpointer parent_data,
+                               gpointer global_data, gpointer* result,
+                               const char* text, int length)
+{
+    auto pdata = static_cast<struct price_stream_pdata*> (parent_data);
+
+    if (length <= 0) return TRUE;
+
+    pdata->has_children = TRUE;
+    if (pdata->depth > 0)
+        pdata->field.chars (text, length);
+    return TRUE;
+}
+
+static void
+price_stream_pdata_free (struct price_stream_pdata* pdata)
+{
+    if (pdata->price)
+        gnc_price_unref (pdata->price);
+    delete pdata;
+}
+
 static gboolean
 price_parse_xml_end_handler (gpointer data_for_children,
                              GSList* data_from_children,
@@ -151,79 +228,63 @@ price_parse_xml_end_handler (gpointer data_for_children,
                              gpointer* result,
                              const gchar* tag)
 {
-    gboolean ok = TRUE;
-    xmlNodePtr price_xml = (xmlNodePtr) data_for_children;
-    xmlNodePtr child;
-    GNCPrice* p = NULL;
-    gxpf_data* gdata = static_cast<decltype (gdata)> (global_data);
-    QofBook* book = static_cast<decltype (book)> (gdata->bookdata);
+    auto pdata = static_cast<struct price_stream_pdata*> (data_for_children);
 
-    /* we haven't been handed the *top* level node yet... */
-    if (parent_data) return TRUE;
-
-    *result = NULL;
-
-    if (!price_xml) return FALSE;
-    if (price_xml->next)
-    {
-        ok = FALSE;
-        goto cleanup_and_exit;
-    }
-    if (price_xml->prev)
-    {
-        ok = FALSE;
-        goto cleanup_and_exit;
-    }
-    if (!price_xml->xmlChildrenNode)
-    {
-        ok = FALSE;
-        goto cleanup_and_exit;
-    }
-
-    p = gnc_price_create (book);
-    if (!p)
+    if (parent_data)
     {
-        ok = FALSE;
-        goto cleanup_and_exit;
-    }
+        if (pdata->depth-- > 1)
+        {
+            pdata->field.element_end ();
+            return TRUE;
+        }
 
-    for (child = price_xml->xmlChildrenNode; child; child = child->next)
-    {
-        switch (child->type)
+        /* Once a field fails the rest of the price is ignored. */
+        if (pdata->ok)
         {
-        case XML_COMMENT_NODE:
-        case XML_TEXT_NODE:
-            break;
-        case XML_ELEMENT_NODE:
-            if (!price_parse_xml_sub_node (p, child, book))
-            {
-                ok = FALSE;
-                goto cleanup_and_exit;
-            }
-            break;
-        default:
-            PERR ("Unknown node type (%d) while parsing gnc-price xml.", child->type);
-            child = NULL;
-            ok = FALSE;
-            goto cleanup_and_exit;
-            break;
+            if (!pdata->price)
+                pdata->price = gnc_price_create (pdata->book);
+            if (!pdata->price ||
+                !price_parse_xml_field (pdata->price, pdata->field,
+                                        pdata->book))
+                pdata->ok = FALSE;
         }
+        pdata->field.clear ();
+        return TRUE;
     }
 
-cleanup_and_exit:
+    *result = NULL;
+
+    if (pdata->ok && pdata->has_children && !pdata->price)
+        pdata->price = gnc_price_create (pdata->book);
+
+    gboolean ok = pdata->ok && pdata->has_children && pdata->price;
     if (ok)
     {
-        *result = p;
-    }
-    else
-    {
-        *result = NULL;
-        gnc_price_unref (p);
+        *result = pdata->price;
+        pdata->price = nullptr;
     }
-    xmlFreeNode (price_xml);
+    price_stream_pdata_free (pdata);
     return ok;
 }
 
+static void
+price_parse_xml_fail_handler (gpointer data_for_children,
+                              GSList* data_from_children,
+                              GSList* sibling_data,
+                              gpointer parent_data,
+                              gpointer global_data,
+                              gpointer* result,
+                              const gchar* tag)
+{
+    auto pdata = static_cast<struct price_stream_pdata*> (data_for_children);
+
+    /* Only the <price> frame owns the parse data. */
+    if (parent_data || !pdata)
+        return;
+
+    price_stream_pdata_free (pdata);
+}
+
 static void
 cleanup_gnc_price (sixtp_child_result* result)
 {
@@ -233,9 +294,12 @@ cleanup_gnc_price (sixtp_child_result* result)
 static sixtp*
 gnc_price_parser_new (void)
 {
-    return sixtp_dom_parser_new (price_parse_xml_end_handler,
-                                 cleanup_gnc_price,
-                                 cleanup_gnc_price);
+    return sixtp_stream_parser_new (price_parse_xml_start_handler,
+                                    price_parse_xml_chars_handler,
+                                    price_parse_xml_end_handler,
+                                    price_parse_xml_fail_handler,
+                                    cleanup_gnc_price,
+                                    cleanup_gnc_price);
 }
 
 
@@ -513,3 +577,66 @@ gnc_pricedb_dom_tree_create (GNCPriceDB* db)
 {
     return gnc_pricedb_to_dom_tree (BAD_CAST "gnc:pricedb", db);
 }
+
+/* Whether gnc_price_to_dom_tree makes a tree for the price. */
+static gboolean
+price_xml_writable (GNCPrice* price)
+{
+    auto commodity = gnc_price_get_commodity (price);
+    auto currency = gnc_price_get_currency (price);
+
+    return commodity && currency &&
+           gnc_commodity_get_namespace (commodity) &&
+           gnc_commodity_get_mnemonic (commodity) &&
+           gnc_commodity_get_namespace (currency) &&
+           gnc_commodity_get_mnemonic (currency) &&
+           gnc_price_get_time64 (price) != INT64_MAX;
+}
+
+static gboolean
+add_xml_price (GNCPrice* p, gpointer data)
+{
+    auto prices = static_cast<std::vector<GNCPrice*>*> (data);
+
+    if (!p)
+        return TRUE;
+    if (!price_xml_writable (p))
+        return FALSE;
+    prices->push_back (p);
+    return TRUE;
+}
+
+std::vector<GNCPrice*>
+gnc_pricedb_xml_prices (GNCPriceDB* db)
+{
+    std::vector<GNCPrice*> prices;
+
+    if (!gnc_pricedb_foreach_price (db, add_xml_price, &prices, TRUE))
+        prices.clear ();
+    return prices;
+}
+
+void
+gnc_price_xml_write (GncXmlWriter& writer, GNCPrice* price)
+{
+    writer.start_element ("price");
+
+    writer.guid_element ("price:id", gnc_price_get_guid (price));
+    writer.commodity_ref_element ("price:commodity",
+                                  gnc_price_get_commodity (price));
+    writer.commodity_ref_element ("price:currency",
+                                  gnc_price_get_currency (price));
+    writer.time64_element ("price:time", gnc_price_get_time64 (price));
+
+    auto sourcestr = gnc_price_get_source_string (price);
+    if (sourcestr && (strlen (sourcestr) != 0))
+        writer.text_element ("price:source", sourcestr);
+
+    auto typestr = gnc_price_get_typestr (price);
+    if (typestr && (strlen (typestr) != 0))
+        writer.text_element ("price:type", typestr);
+
+    writer.gnc_numeric_element ("price:value", gnc_price_get_value (price));
+
+    writer.end_element ();
+}
@@ -23,6 +23,9 @@
  *******************************************************************/
 #include <glib.h>
 
+#include <memory>
+#include <vector>
+
 extern "C"
 {
 #include <config.h>
@@ -42,6 +45,8 @@ extern "C"
 #include "sixtp-utils.h"
 #include "sixtp-dom-parsers.h"
 #include "sixtp-dom-generators.h"
+#include "sixtp-stream-parsers.hpp"
+#include "gnc-xml-writer.hpp"
 
 #include "gnc-xml.h"
 
@@ -194,6 +199,73 @@ gnc_transaction_dom_tree_create (Transaction* trn)
     return ret;
 }
 
+static void
+split_xml_write (GncXmlWriter& writer, const gchar* tag, Split* spl)
+{
+    writer.start_element (tag);
+
+    writer.guid_element ("split:id", xaccSplitGetGUID (spl));
+
+    auto memo = xaccSplitGetMemo (spl);
+    if (memo && *memo)
+        writer.text_child ("split:memo", memo);
+
+    auto action = xaccSplitGetAction (spl);
+    if (action && *action)
+        writer.text_child ("split:action", action);
+
+    char reconciled[2] = {xaccSplitGetReconcile (spl), '\0'};
+    writer.text_child ("split:reconciled-state", reconciled);
+
+    auto reconcile_date = xaccSplitGetDateReconciled (spl);
+    if (reconcile_date)
+        writer.time64_element ("split:reconcile-date", reconcile_date);
+
+    writer.gnc_numeric_element ("split:value", xaccSplitGetValue (spl));
+    writer.gnc_numeric_element ("split:quantity", xaccSplitGetAmount (spl));
+
+    writer.guid_element ("split:account",
+                         xaccAccountGetGUID (xaccSplitGetAccount (spl)));
+
+    auto lot = xaccSplitGetLot (spl);
+    if (lot)
+        writer.guid_element ("split:lot", gnc_lot_get_guid (lot));
+
+    writer.slots_element ("split:slots", QOF_INSTANCE (spl));
+
+    writer.end_element ();
+}
+
+void
+gnc_transaction_xml_write (GncXmlWriter& writer, Transaction* trn)
+{
+    writer.start_element ("gnc:transaction");
+    writer.attribute ("version", transaction_version_string);
+
+    writer.guid_element ("trn:id", xaccTransGetGUID (trn));
+    writer.commodity_ref_element ("trn:currency", xaccTransGetCurrency (trn));
+
+    auto num = xaccTransGetNum (trn);
+    if (num && *num)
+        writer.text_child ("trn:num", num);
+
+    writer.time64_element ("trn:date-posted", xaccTransRetDatePosted (trn));
+    writer.time64_element ("trn:date-entered", xaccTransRetDateEntered (trn));
+
+    auto description = xaccTransGetDescription (trn);
+    if (description)
+        writer.text_child ("trn:description", description);
+
+    writer.slots_element ("trn:slots", QOF_INSTANCE (trn));
+
+    writer.start_element ("trn:splits");
+    for (auto n = xaccTransGetSplitList (trn); n; n = n->next)
+        split_xml_write (writer, "trn:split", static_cast<Split*> (n->data));
+    writer.end_element ();
+
+    writer.end_element ();
+}
+
 /***********************************************************************/
 
 struct split_pdata
@@ -297,26 +369,45 @@ spl_quantity_handler (xmlNodePtr node, gpointer data)
 
 gboolean gnc_transaction_xml_v2_testing = FALSE;
 
-static gboolean
-spl_account_handler (xmlNodePtr node, gpointer data)
+static void
+spl_set_account (Split* spl, QofBook* book, const GncGUID* id)
 {
-    struct split_pdata* pdata = static_cast<decltype (pdata)> (data);
-    GncGUID* id = dom_tree_to_guid (node);
-    Account* account;
-
-    g_return_val_if_fail (id, FALSE);
-
-    account = xaccAccountLookup (id, pdata->book);
+    Account* account = xaccAccountLookup (id, book);
     if (!account && gnc_transaction_xml_v2_testing &&
         !guid_equal (id, guid_null ()))
     {
-        account = xaccMallocAccount (pdata->book);
+        account = xaccMallocAccount (book);
         xaccAccountSetGUID (account, id);
         xaccAccountSetCommoditySCU (account,
-                                    xaccSplitGetAmount (pdata->split).denom);
+                                    xaccSplitGetAmount (spl).denom);
     }
 
-    xaccAccountInsertSplit (account, pdata->split);
+    xaccAccountInsertSplit (account, spl);
+}
+
+static void
+spl_set_lot (Split* spl, QofBook* book, const GncGUID* id)
+{
+    GNCLot* lot = gnc_lot_lookup (id, book);
+    if (!lot && gnc_transaction_xml_v2_testing &&
+        !guid_equal (id, guid_null ()))
+    {
+        lot = gnc_lot_new (book);
+        gnc_lot_set_guid (lot, *id);
+    }
+
+    gnc_lot_add_split (lot, spl);
+}
+
+static gboolean
+spl_account_handler (xmlNodePtr node, gpointer data)
+{
+    struct split_pdata* pdata = static_cast<decltype (pdata)> (data);
+    GncGUID* id = dom_tree_to_guid (node);
+
+    g_return_val_if_fail (id, FALSE);
+
+    spl_set_account (pdata->split, pdata->book, id);
 
     guid_free (id);
 
@@ -328,19 +419,10 @@ spl_lot_handler (xmlNodePtr node, gpointer data)
 {
     struct split_pdata* pdata = static_cast<decltype (pdata)> (data);
     GncGUID* id = dom_tree_to_guid (node);
-    GNCLot* lot;
 
     g_return_val_if_fail (id, FALSE);
 
-    lot = gnc_lot_lookup (id, pdata->book);
-    if (!lot && gnc_transaction_xml_v2_testing &&
-        !guid_equal (id, guid_null ()))
-    {
-        lot = gnc_lot_new (pdata->book);
-        gnc_lot_set_guid (lot, *id);
-    }
-
-    gnc_lot_add_split (lot, pdata->split);
+    spl_set_lot (pdata->split, pdata->book, id);
 
     guid_free (id);
 
@@ -574,66 +656,750 @@ struct dom_tree_handler trn_dom_handlers[] =
     { NULL, NULL, 0, 0 },
 };
 
-static gboolean
-gnc_transaction_end_handler (gpointer data_for_children,
-                             GSList* data_from_children, GSList* sibling_data,
-                             gpointer parent_data, gpointer global_data,
-                             gpointer* result, const gchar* tag)
+Transaction*
+dom_tree_to_transaction (xmlNodePtr node, QofBook* book)
 {
-    Transaction* trn = NULL;
-    xmlNodePtr tree = (xmlNodePtr)data_for_children;
-    gxpf_data* gdata = (gxpf_data*)global_data;
+    Transaction* trn;
+    gboolean successful;
+    struct trans_pdata pdata;
 
-    if (parent_data)
+    g_return_val_if_fail (node, NULL);
+    g_return_val_if_fail (book, NULL);
+
+    trn = xaccMallocTransaction (book);
+    g_return_val_if_fail (trn, NULL);
+    xaccTransBeginEdit (trn);
+
+    pdata.trans = trn;
+    pdata.book = book;
+
+    successful = dom_tree_generic_parse (node, trn_dom_handlers, &pdata);
+
+    xaccTransCommitEdit (trn);
+
+    if (!successful)
     {
-        return TRUE;
+        xmlElemDump (stdout, NULL, node);
+        xaccTransBeginEdit (trn);
+        xaccTransDestroy (trn);
+        xaccTransCommitEdit (trn);
+        trn = NULL;
     }
 
-    /* OK.  For some messed up reason this is getting called again with a
-       NULL tag.  So we ignore those cases */
-    if (!tag)
+    return trn;
+}
+
+/***********************************************************************/
+/* <gnc:transaction> is read straight from the SAX events: transactions
+ * make up most of a book and building a DOM tree for each of them just
+ * to walk it once is what dominated loading.  Each field element is
+ * collected by a SixtpStreamField and converted the way the DOM handlers
+ * above convert it, in document order; only the slots are still built
+ * into a (small) tree for dom_tree_create_instance_slots.  Unknown and
+ * missing required elements fail the split or transaction as in
+ * dom_tree_generic_parse; so does a field that doesn't convert, and a
+ * split that fails, or anything but a <trn:split> in <trn:splits>, fails
+ * its transaction.
+ *
+ * This happens in two steps so that the XML side can be done on other
+ * threads, see io-gncxml-v2-parallel.cpp: a TrnDecoder turns the events
+ * into a TrnRecord, doing every conversion that doesn't need the book,
+ * and trn_record_apply then makes the transaction and its splits.
+ */
+
+enum class TrnStreamKind
+{
+    TEXT,
+    GUID,
+    TIME64,
+    NUMERIC,
+    COMMODITY,
+    TREE,
+    SPLITS,
+};
+
+struct TrnStreamValue;
+
+struct trn_apply_data
+{
+    QofBook* book;
+    Transaction* trn;
+    Split* spl;
+};
+
+typedef gboolean (*trn_stream_apply_fn) (const TrnStreamValue& value,
+                                         struct trn_apply_data* pdata);
+
+struct trn_stream_handler
+{
+    const char* tag;
+    TrnStreamKind kind;
+    trn_stream_apply_fn apply;
+    gboolean required;
+};
+
+/* One field, converted as far as that can be done without the book. */
+struct TrnStreamValue
+{
+    const trn_stream_handler* handler = nullptr;
+    /* FALSE where the dom_tree_to_* converter gives NULL. */
+    gboolean ok = FALSE;
+    /* The text, or the commodity namespace. */
+    std::string text;
+    /* The commodity mnemonic. */
+    std::string id;
+    GncGUID guid;
+    gboolean guid_parsed = FALSE;
+    time64 time = 0;
+    gnc_numeric num;
+    xmlNodePtr tree = nullptr;
+    /* The splits read from a <trn:splits>; ok is FALSE there if it held
+     * something other than <trn:split>s. */
+    size_t first_split = 0;
+    size_t n_splits = 0;
+};
+
+struct SplitRecord
+{
+    std::vector<TrnStreamValue> values;
+    /* Unhandled tags, reported when the record is applied. */
+    std::vector<std::string> unknown;
+    guint gotten = 0;
+};
+
+struct TrnRecord
+{
+    TrnRecord () = default;
+    TrnRecord (const TrnRecord&) = delete;
+    TrnRecord& operator= (const TrnRecord&) = delete;
+    ~TrnRecord ()
     {
-        return TRUE;
+        for (auto& value : values)
+            if (value.tree) xmlFreeNode (value.tree);
+        for (auto& split : splits)
+            for (auto& value : split.values)
+                if (value.tree) xmlFreeNode (value.tree);
     }
 
-    g_return_val_if_fail (tree, FALSE);
+    std::vector<TrnStreamValue> values;
+    std::vector<SplitRecord> splits;
+    std::vector<std::string> unknown;
+    guint gotten = 0;
+    /* FALSE if the element was cut short. */
+    gboolean complete = TRUE;
+};
+
+static GncGUID
+stream_value_guid (const TrnStreamValue& value)
+{
+    GncGUID guid = value.guid;
+    if (!value.guid_parsed)
+        guid_replace (&guid);
+    return guid;
+}
+
+static gboolean
+stream_set_spl_string (const TrnStreamValue& value, Split* spl,
+                       void (*func) (Split* spl, const char* txt))
+{
+    g_return_val_if_fail (value.ok, FALSE);
+    func (spl, value.text.c_str ());
+    return TRUE;
+}
+
+static gboolean
+stream_set_spl_gnc_num (const TrnStreamValue& value, Split* spl,
+                        void (*func) (Split* spl, gnc_numeric gn))
+{
+    g_return_val_if_fail (value.ok, FALSE);
+    func (spl, value.num);
+    return TRUE;
+}
+
+static gboolean
+spl_stream_id_handler (const TrnStreamValue& value,
+                       struct trn_apply_data* pdata)
+{
+    g_return_val_if_fail (value.ok, FALSE);
+
+    auto guid = stream_value_guid (value);
+    xaccSplitSetGUID (pdata->spl, &guid);
+    return TRUE;
+}
+
+static gboolean
+spl_stream_memo_handler (const TrnStreamValue& value,
+                         struct trn_apply_data* pdata)
+{
+    return stream_set_spl_string (value, pdata->spl, xaccSplitSetMemo);
+}
+
+static gboolean
+spl_stream_action_handler (const TrnStreamValue& value,
+                           struct trn_apply_data* pdata)
+{
+    return stream_set_spl_string (value, pdata->spl, xaccSplitSetAction);
+}
+
+static gboolean
+spl_stream_reconciled_state_handler (const TrnStreamValue& value,
+                                     struct trn_apply_data* pdata)
+{
+    g_return_val_if_fail (value.ok, FALSE);
+
+    xaccSplitSetReconcile (pdata->spl, value.text.c_str ()[0]);
+    return TRUE;
+}
+
+static gboolean
+spl_stream_reconcile_date_handler (const TrnStreamValue& value,
+                                   struct trn_apply_data* pdata)
+{
+    time64 time = value.time;
+    if (!dom_tree_valid_time64 (time, BAD_CAST value.handler->tag)) time = 0;
+    xaccSplitSetDateReconciledSecs (pdata->spl, time);
+    return TRUE;
+}
+
+static gboolean
+spl_stream_value_handler (const TrnStreamValue& value,
+                          struct trn_apply_data* pdata)
+{
+    return stream_set_spl_gnc_num (value, pdata->spl, xaccSplitSetValue);
+}
+
+static gboolean
+spl_stream_quantity_handler (const TrnStreamValue& value,
+                             struct trn_apply_data* pdata)
+{
+    return stream_set_spl_gnc_num (value, pdata->spl, xaccSplitSetAmount);
+}
+
+static gboolean
+spl_stream_account_handler (const TrnStreamValue& value,
+                            struct trn_apply_data* pdata)
+{
+    g_return_val_if_fail (value.ok, FALSE);
+
+    auto guid = stream_value_guid (value);
+    spl_set_account (pdata->spl, pdata->book, &guid);
+    return TRUE;
+}
+
+static gboolean
+spl_stream_lot_handler (const TrnStreamValue& value,
+                        struct trn_apply_data* pdata)
+{
+    g_return_val_if_fail (value.ok, FALSE);
+
+    auto guid = stream_value_guid (value);
+    spl_set_lot (pdata->spl, pdata->book, &guid);
+    return TRUE;
+}
+
+static gboolean
+spl_stream_slots_handler (const TrnStreamValue& value,
+                          struct trn_apply_data* pdata)
+{
+    gboolean successful;
+
+    successful = dom_tree_create_instance_slots (value.tree,
+                                                 QOF_INSTANCE (pdata->spl));
+    g_return_val_if_fail (successful, FALSE);
+
+    return TRUE;
+}
+
+static const trn_stream_handler spl_stream_handlers[] =
+{
+    { "split:id", TrnStreamKind::GUID, spl_stream_id_handler, 1 },
+    { "split:memo", TrnStreamKind::TEXT, spl_stream_memo_handler, 0 },
+    { "split:action", TrnStreamKind::TEXT, spl_stream_action_handler, 0 },
+    { "split:reconciled-state", TrnStreamKind::TEXT,
+      spl_stream_reconciled_state_handler, 1 },
+    { "split:reconcile-date", TrnStreamKind::TIME64,
+      spl_stream_reconcile_date_handler, 0 },
+    { "split:value", TrnStreamKind::NUMERIC, spl_stream_value_handler, 1 },
+    { "split:quantity", TrnStreamKind::NUMERIC, spl_stream_quantity_handler, 1 },
+    { "split:account", TrnStreamKind::GUID, spl_stream_account_handler, 1 },
+    { "split:lot", TrnStreamKind::GUID, spl_stream_lot_handler, 0 },
+    { "split:slots", TrnStreamKind::TREE, spl_stream_slots_handler, 0 },
+    { NULL, TrnStreamKind::TEXT, NULL, 0 },
+};
+
+static gboolean
+stream_set_tran_string (const TrnStreamValue& value, Transaction* trn,
+                        void (*func) (Transaction* trn, const char* txt))
+{
+    g_return_val_if_fail (value.ok, FALSE);
+    func (trn, value.text.c_str ());
+    return TRUE;
+}
 
-    trn = dom_tree_to_transaction (tree,
-                                   static_cast<QofBook*> (gdata->bookdata));
-    if (trn != NULL)
+static gboolean
+stream_set_tran_time64 (const TrnStreamValue& value, Transaction* trn,
+                        void (*func) (Transaction*, time64))
+{
+    time64 time = value.time;
+    if (!dom_tree_valid_time64 (time, BAD_CAST value.handler->tag)) time = 0;
+    func (trn, time);
+    return TRUE;
+}
+
+static gboolean
+trn_stream_id_handler (const TrnStreamValue& value,
+                       struct trn_apply_data* pdata)
+{
+    g_return_val_if_fail (value.ok, FALSE);
+
+    auto guid = stream_value_guid (value);
+    xaccTransSetGUID (pdata->trn, &guid);
+    return TRUE;
+}
+
+static gboolean
+trn_stream_currency_handler (const TrnStreamValue& value,
+                             struct trn_apply_data* pdata)
+{
+    gnc_commodity* ref = NULL;
+
+    if (value.ok)
     {
-        gdata->cb (tag, gdata->parsedata, trn);
+        gchar* space = g_strdup (value.text.c_str ());
+        gchar* id = g_strdup (value.id.c_str ());
+        ref = gnc_xml_commodity_ref_lookup (pdata->book, space, id);
+        g_free (space);
+        g_free (id);
     }
+    xaccTransSetCurrency (pdata->trn, ref);
+    return TRUE;
+}
 
-    xmlFreeNode (tree);
+static gboolean
+trn_stream_num_handler (const TrnStreamValue& value,
+                        struct trn_apply_data* pdata)
+{
+    return stream_set_tran_string (value, pdata->trn, xaccTransSetNum);
+}
 
-    return trn != NULL;
+static gboolean
+trn_stream_date_posted_handler (const TrnStreamValue& value,
+                                struct trn_apply_data* pdata)
+{
+    return stream_set_tran_time64 (value, pdata->trn,
+                                   xaccTransSetDatePostedSecs);
 }
 
-Transaction*
-dom_tree_to_transaction (xmlNodePtr node, QofBook* book)
+static gboolean
+trn_stream_date_entered_handler (const TrnStreamValue& value,
+                                 struct trn_apply_data* pdata)
+{
+    return stream_set_tran_time64 (value, pdata->trn,
+                                   xaccTransSetDateEnteredSecs);
+}
+
+static gboolean
+trn_stream_description_handler (const TrnStreamValue& value,
+                                struct trn_apply_data* pdata)
+{
+    return stream_set_tran_string (value, pdata->trn,
+                                   xaccTransSetDescription);
+}
+
+static gboolean
+trn_stream_slots_handler (const TrnStreamValue& value,
+                          struct trn_apply_data* pdata)
 {
-    Transaction* trn;
     gboolean successful;
-    struct trans_pdata pdata;
 
-    g_return_val_if_fail (node, NULL);
-    g_return_val_if_fail (book, NULL);
+    successful = dom_tree_create_instance_slots (value.tree,
+                                                 QOF_INSTANCE (pdata->trn));
+    g_return_val_if_fail (successful, FALSE);
+
+    return TRUE;
+}
+
+static const trn_stream_handler trn_stream_handlers[] =
+{
+    { "trn:id", TrnStreamKind::GUID, trn_stream_id_handler, 1 },
+    { "trn:currency", TrnStreamKind::COMMODITY, trn_stream_currency_handler, 0},
+    { "trn:num", TrnStreamKind::TEXT, trn_stream_num_handler, 0 },
+    { "trn:date-posted", TrnStreamKind::TIME64,
+      trn_stream_date_posted_handler, 1 },
+    { "trn:date-entered", TrnStreamKind::TIME64,
+      trn_stream_date_entered_handler, 1 },
+    { "trn:description", TrnStreamKind::TEXT,
+      trn_stream_description_handler, 0 },
+    { "trn:slots", TrnStreamKind::TREE, trn_stream_slots_handler, 0 },
+    /* Not a field: its splits are read as they come. */
+    { "trn:splits", TrnStreamKind::SPLITS, NULL, 1 },
+    { NULL, TrnStreamKind::TEXT, NULL, 0 },
+};
+
+static inline guint
+trn_stream_handler_bit (const trn_stream_handler* handlers,
+                        const trn_stream_handler* handler)
+{
+    return 1u << (handler - handlers);
+}
+
+static gboolean
+trn_stream_all_gotten_p (const trn_stream_handler* handlers, guint gotten,
+                         gboolean report)
+{
+    gboolean ret = TRUE;
+    for (guint bit = 1; handlers->tag != NULL; handlers++, bit <<= 1)
+    {
+        if (handlers->required && !(gotten & bit))
+        {
+            if (report)
+                PERR ("Not defined and it should be: %s", handlers->tag);
+            ret = FALSE;
+        }
+    }
+    if (!ret && report)
+        PERR ("didn't find all of the expected tags in the input");
+    return ret;
+}
+
+static gboolean
+trn_stream_record_ok (const trn_stream_handler* handlers,
+                      const std::vector<std::string>& unknown, guint gotten,
+                      gboolean report)
+{
+    if (report)
+    {
+        for (auto& tag : unknown)
+        {
+            PERR ("Unhandled tag: %s", tag.c_str ());
+            PERR ("gnc_xml_set_data failed");
+        }
+    }
+    /* Check for missing tags even if there were unknown ones, so that
+     * all of the problems get reported. */
+    gboolean gotten_ok = trn_stream_all_gotten_p (handlers, gotten, report);
+    return unknown.empty () && gotten_ok;
+}
+
+/* Converts the parts of a field that don't need the book, which makes
+ * it safe to run on any thread. */
+static void
+trn_stream_convert (SixtpStreamField& field, TrnStreamValue& value)
+{
+    gchar* text;
+    gnc_numeric* num;
+
+    switch (value.handler->kind)
+    {
+    case TrnStreamKind::TEXT:
+        text = field.to_text ();
+        value.ok = text != NULL;
+        if (text) value.text = text;
+        g_free (text);
+        break;
+    case TrnStreamKind::GUID:
+        value.ok = field.to_guid (&value.guid, &value.guid_parsed);
+        break;
+    case TrnStreamKind::TIME64:
+        value.time = field.to_time64 ();
+        value.ok = TRUE;
+        break;
+    case TrnStreamKind::NUMERIC:
+        num = field.to_gnc_numeric ();
+        value.ok = num != NULL;
+        if (num) value.num = *num;
+        g_free (num);
+        break;
+    case TrnStreamKind::COMMODITY:
+        value.ok = field.to_commodity_strings (value.text, value.id);
+        break;
+    case TrnStreamKind::TREE:
+        value.tree = field.release_tree ();
+        value.ok = TRUE;
+        break;
+    case TrnStreamKind::SPLITS:
+        break;
+    }
+}
+
+enum class TrnStreamLevel
+{
+    TRANSACTION,
+    TRN_FIELD,
+    SPLITS,
+    SPLIT,
+    SPLIT_FIELD,
+    FIELD_CHILD,
+    SKIP,
+};
+
+/* Builds a TrnRecord from the SAX events inside one <gnc:transaction>.
+ * It doesn't touch the engine, so any number of them can run at once. */
+class TrnDecoder
+{
+public:
+    TrnDecoder () : m_record (new TrnRecord)
+    {
+        m_levels.push_back (TrnStreamLevel::TRANSACTION);
+    }
+
+    void start (const gchar* tag, gchar** attrs);
+    void chars (const gchar* text, int length);
+    void end ();
+    /* At </gnc:transaction>: hands over the record. */
+    TrnRecord* finish ();
+
+private:
+    TrnStreamLevel start_field (const trn_stream_handler* handlers,
+                                const gchar* tag, gchar** attrs,
+                                std::vector<std::string>& unknown,
+                                TrnStreamLevel field_level);
+    void end_split ();
+
+    std::vector<TrnStreamLevel> m_levels;
+    SixtpStreamField m_field;
+    TrnStreamValue m_value;
+    std::unique_ptr<TrnRecord> m_record;
+    SplitRecord m_split;
+    /* The value of the <trn:splits> being read. */
+    size_t m_splits_value = 0;
+    /* trn_splits_handler stops at the first element that isn't a good
+     * <trn:split>. */
+    gboolean m_splits_done = FALSE;
+};
+
+TrnStreamLevel
+TrnDecoder::start_field (const trn_stream_handler* handlers, const gchar* tag,
+                         gchar** attrs, std::vector<std::string>& unknown,
+                         TrnStreamLevel field_level)
+{
+    /* Stray text nodes are skipped by name in dom_tree_generic_parse. */
+    if (g_strcmp0 (tag, "text") == 0)
+        return TrnStreamLevel::SKIP;
+
+    auto handler = handlers;
+    while (handler->tag && g_strcmp0 (tag, handler->tag) != 0)
+        handler++;
+    if (!handler->tag)
+    {
+        unknown.push_back (tag ? tag : "(null)");
+        return TrnStreamLevel::SKIP;
+    }
+
+    m_value = TrnStreamValue ();
+    m_value.handler = handler;
+
+    if (handler->kind == TrnStreamKind::SPLITS)
+    {
+        m_record->gotten |= trn_stream_handler_bit (handlers, handler);
+        m_value.first_split = m_record->splits.size ();
+        m_value.ok = TRUE;
+        m_splits_value = m_record->values.size ();
+        m_record->values.push_back (m_value);
+        m_splits_done = FALSE;
+        return TrnStreamLevel::SPLITS;
+    }
+
+    m_field.start (tag, attrs, handler->kind == TrnStreamKind::TREE);
+    return field_level;
+}
+
+void
+TrnDecoder::end_split ()
+{
+    gboolean ok = trn_stream_record_ok (spl_stream_handlers, m_split.unknown,
+                                        m_split.gotten, FALSE);
+    m_record->splits.push_back (std::move (m_split));
+    m_record->values[m_splits_value].n_splits++;
+    m_split = SplitRecord ();
+    if (!ok)
+        m_splits_done = TRUE;
+}
+
+void
+TrnDecoder::start (const gchar* tag, gchar** attrs)
+{
+    TrnStreamLevel level;
+
+    switch (m_levels.back ())
+    {
+    case TrnStreamLevel::TRANSACTION:
+        level = start_field (trn_stream_handlers, tag, attrs,
+                             m_record->unknown, TrnStreamLevel::TRN_FIELD);
+        break;
+    case TrnStreamLevel::SPLITS:
+        if (m_splits_done || g_strcmp0 (tag, "text") == 0)
+        {
+            level = TrnStreamLevel::SKIP;
+        }
+        else if (g_strcmp0 (tag, "trn:split") != 0)
+        {
+            m_record->values[m_splits_value].ok = FALSE;
+            m_splits_done = TRUE;
+            level = TrnStreamLevel::SKIP;
+        }
+        else
+        {
+            level = TrnStreamLevel::SPLIT;
+        }
+        break;
+    case TrnStreamLevel::SPLIT:
+        level = start_field (spl_stream_handlers, tag, attrs, m_split.unknown,
+                             TrnStreamLevel::SPLIT_FIELD);
+        break;
+    case TrnStreamLevel::TRN_FIELD:
+    case TrnStreamLevel::SPLIT_FIELD:
+    case TrnStreamLevel::FIELD_CHILD:
+        m_field.element_start (tag, attrs);
+        level = TrnStreamLevel::FIELD_CHILD;
+        break;
+    default:
+        level = TrnStreamLevel::SKIP;
+        break;
+    }
+
+    m_levels.push_back (level);
+}
+
+void
+TrnDecoder::chars (const gchar* text, int length)
+{
+    switch (m_levels.back ())
+    {
+    case TrnStreamLevel::TRN_FIELD:
+    case TrnStreamLevel::SPLIT_FIELD:
+    case TrnStreamLevel::FIELD_CHILD:
+        m_field.chars (text, length);
+        break;
+    default:
+        break;
+    }
+}
+
+void
+TrnDecoder::end ()
+{
+    /* The transaction's own end is finish(). */
+    if (m_levels.size () <= 1)
+        return;
+
+    auto level = m_levels.back ();
+    m_levels.pop_back ();
+
+    switch (level)
+    {
+    case TrnStreamLevel::TRN_FIELD:
+        trn_stream_convert (m_field, m_value);
+        m_record->gotten |= trn_stream_handler_bit (trn_stream_handlers,
+                                                    m_value.handler);
+        m_record->values.push_back (std::move (m_value));
+        m_field.clear ();
+        break;
+    case TrnStreamLevel::SPLIT_FIELD:
+        trn_stream_convert (m_field, m_value);
+        m_split.gotten |= trn_stream_handler_bit (spl_stream_handlers,
+                                                  m_value.handler);
+        m_split.values.push_back (std::move (m_value));
+        m_field.clear ();
+        break;
+    case TrnStreamLevel::FIELD_CHILD:
+        m_field.element_end ();
+        break;
+    case TrnStreamLevel::SPLIT:
+        end_split ();
+        break;
+    default:
+        break;
+    }
+    m_value.tree = nullptr;
+}
+
+TrnRecord*
+TrnDecoder::finish ()
+{
+    /* Only a badly nested file gets here with elements still open. */
+    if (m_levels.size () > 1)
+        m_record->complete = FALSE;
+    m_field.clear ();
+    for (auto& value : m_split.values)
+        if (value.tree) xmlFreeNode (value.tree);
+    m_split = SplitRecord ();
+    return m_record.release ();
+}
+
+static Split*
+split_record_apply (const SplitRecord& record, QofBook* book,
+                    Transaction* trn)
+{
+    if (!trn_stream_record_ok (spl_stream_handlers, record.unknown,
+                               record.gotten, TRUE))
+        return NULL;
+
+    struct trn_apply_data pdata = { book, trn, xaccMallocSplit (book) };
+    gboolean successful = TRUE;
+    for (auto& value : record.values)
+        successful = value.handler->apply (value, &pdata) && successful;
+    if (!successful)
+    {
+        xaccSplitDestroy (pdata.spl);
+        return NULL;
+    }
+    return pdata.spl;
+}
+
+/* Makes the transaction; NULL if the record fails the checks of
+ * dom_tree_generic_parse. */
+static Transaction*
+trn_record_apply (const TrnRecord& record, QofBook* book)
+{
+    struct trn_apply_data pdata = { book, xaccMallocTransaction (book), NULL };
+    Transaction* trn = pdata.trn;
+    gboolean applied = TRUE;
 
-    trn = xaccMallocTransaction (book);
-    g_return_val_if_fail (trn, NULL);
     xaccTransBeginEdit (trn);
+    for (auto& value : record.values)
+    {
+        if (value.handler->kind != TrnStreamKind::SPLITS)
+        {
+            applied = value.handler->apply (value, &pdata) && applied;
+            continue;
+        }
 
-    pdata.trans = trn;
-    pdata.book = book;
+        /* trn_splits_handler won't take a <trn:splits> without any, or
+         * with anything but good <trn:split>s in it. */
+        if (value.n_splits == 0)
+        {
+            PERR ("no splits in trn:splits");
+            applied = FALSE;
+        }
+        if (!value.ok)
+        {
+            PERR ("unexpected element in trn:splits");
+            applied = FALSE;
+        }
+        for (size_t i = 0; i < value.n_splits; i++)
+        {
+            auto spl = split_record_apply (record.splits[value.first_split + i],
+                                           book, trn);
+            if (!spl)
+            {
+                PERR ("failed to parse split");
+                applied = FALSE;
+                break;
+            }
+            xaccTransAppendSplit (trn, spl);
+        }
+    }
 
-    successful = dom_tree_generic_parse (node, trn_dom_handlers, &pdata);
+    gboolean successful = record.complete && applied &&
+        trn_stream_record_ok (trn_stream_handlers, record.unknown,
+                              record.gotten, TRUE);
 
     xaccTransCommitEdit (trn);
 
     if (!successful)
     {
-        xmlElemDump (stdout, NULL, node);
+        PERR ("failed to parse transaction");
         xaccTransBeginEdit (trn);
         xaccTransDestroy (trn);
         xaccTransCommitEdit (trn);
@@ -643,8 +1409,224 @@ dom_tree_to_transaction (xmlNodePtr node, QofBook* book)
     return trn;
 }
 
+static gboolean
+trn_stream_start_handler (GSList* sibling_data, gpointer parent_data,
+                          gpointer global_data, gpointer* data_for_children,
+                          gpointer* result, const gchar* tag, gchar** attrs)
+{
+    *result = NULL;
+
+    /* The frame sixtp makes for a top-level parser has no tag. */
+    if (!tag)
+    {
+        *data_for_children = NULL;
+        return TRUE;
+    }
+
+    if (!parent_data)
+    {
+        *data_for_children = new TrnDecoder;
+        return TRUE;
+    }
+
+    auto decoder = static_cast<TrnDecoder*> (parent_data);
+    decoder->start (tag, attrs);
+    *data_for_children = decoder;
+    return TRUE;
+}
+
+static gboolean
+trn_stream_chars_handler (GSList* sibling_data, gpointer parent_data,
+                          gpointer global_data, gpointer* result,
+                          const char* text, int length)
+{
+    if (parent_data && length > 0)
+        static_cast<TrnDecoder*> (parent_data)->chars (text, length);
+    return TRUE;
+}
+
+static gboolean
+trn_stream_end_handler (gpointer data_for_children,
+                        GSList* data_from_children, GSList* sibling_data,
+                        gpointer parent_data, gpointer global_data,
+                        gpointer* result, const gchar* tag)
+{
+    auto decoder = static_cast<TrnDecoder*> (data_for_children);
+
+    /* OK.  For some messed up reason this is getting called again with a
+       NULL tag.  So we ignore those cases */
+    if (!tag || !decoder)
+        return TRUE;
+
+    if (parent_data)
+    {
+        decoder->end ();
+        return TRUE;
+    }
+
+    gxpf_data* gdata = (gxpf_data*)global_data;
+    std::unique_ptr<TrnRecord> record (decoder->finish ());
+    delete decoder;
+
+    auto trn = trn_record_apply (*record, static_cast<QofBook*> (gdata->bookdata));
+    if (!trn)
+        return FALSE;
+
+    gdata->cb (tag, gdata->parsedata, trn);
+    return TRUE;
+}
+
+static void
+trn_stream_fail_handler (gpointer data_for_children,
+                         GSList* data_from_children, GSList* sibling_data,
+                         gpointer parent_data, gpointer global_data,
+                         gpointer* result, const gchar* tag)
+{
+    /* Only the <gnc:transaction> frame owns the decoder. */
+    if (parent_data || !data_for_children)
+        return;
+
+    auto decoder = static_cast<TrnDecoder*> (data_for_children);
+    delete decoder->finish ();
+    delete decoder;
+}
+
 sixtp*
 gnc_transaction_sixtp_parser_create (void)
 {
-    return sixtp_dom_parser_new (gnc_transaction_end_handler, NULL, NULL);
+    return sixtp_stream_parser_new (trn_stream_start_handler,
+                                    trn_stream_chars_handler,
+                                    trn_stream_end_handler,
+                                    trn_stream_fail_handler,
+                                    NULL, NULL);
+}
+
+/***********************************************************************/
+/* Decoding a batch of transactions on another thread. */
+
+struct GncXmlTrnBatch
+{
+    std::vector<std::unique_ptr<TrnRecord>> records;
+    gboolean ok = TRUE;
+};
+
+struct trn_batch_decode_data
+{
+    GncXmlTrnBatch* batch;
+    TrnDecoder* decoder;
+    int depth;
+};
+
+static void
+trn_batch_start_element (void* user_data, const xmlChar* name,
+                         const xmlChar** attrs)
+{
+    auto data = static_cast<trn_batch_decode_data*> (user_data);
+    auto tag = reinterpret_cast<const gchar*> (name);
+
+    switch (data->depth++)
+    {
+    case 0:
+        /* the wrapping element */
+        break;
+    case 1:
+        if (g_strcmp0 (tag, GNC_TRANSACTION_TAG) == 0)
+            data->decoder = new TrnDecoder;
+        else
+            data->batch->ok = FALSE;
+        break;
+    default:
+        if (data->decoder)
+            data->decoder->start (tag, (gchar**)attrs);
+        break;
+    }
+}
+
+static void
+trn_batch_characters (void* user_data, const xmlChar* text, int len)
+{
+    auto data = static_cast<trn_batch_decode_data*> (user_data);
+    if (data->decoder && data->depth > 1 && len > 0)
+        data->decoder->chars (reinterpret_cast<const gchar*> (text), len);
+}
+
+static void
+trn_batch_end_element (void* user_data, const xmlChar* name)
+{
+    auto data = static_cast<trn_batch_decode_data*> (user_data);
+
+    if (--data->depth > 1)
+    {
+        if (data->decoder)
+            data->decoder->end ();
+    }
+    else if (data->depth == 1 && data->decoder)
+    {
+        data->batch->records.emplace_back (data->decoder->finish ());
+        delete data->decoder;
+        data->decoder = NULL;
+    }
+}
+
+static xmlEntityPtr
+trn_batch_get_entity (void* user_data, const xmlChar* name)
+{
+    return xmlGetPredefinedEntity (name);
+}
+
+GncXmlTrnBatch*
+gnc_transaction_xml_decode_batch (const char* xml, int len)
+{
+    xmlSAXHandler handler;
+    trn_batch_decode_data data;
+
+    memset (&handler, 0, sizeof (handler));
+    handler.startElement = trn_batch_start_element;
+    handler.endElement = trn_batch_end_element;
+    handler.characters = trn_batch_characters;
+    handler.getEntity = trn_batch_get_entity;
+
+    data.batch = new GncXmlTrnBatch;
+    data.decoder = NULL;
+    data.depth = 0;
+
+    if (xmlSAXUserParseMemory (&handler, &data, xml, len) != 0)
+        data.batch->ok = FALSE;
+
+    if (data.decoder)
+    {
+        delete data.decoder->finish ();
+        delete data.decoder;
+        data.batch->ok = FALSE;
+    }
+    return data.batch;
+}
+
+gboolean
+gnc_transaction_xml_apply_batch (GncXmlTrnBatch* batch, gxpf_data* gdata)
+{
+    g_return_val_if_fail (batch && gdata, FALSE);
+
+    auto book = static_cast<QofBook*> (gdata->bookdata);
+    gboolean ok = batch->ok;
+
+    /* Like the serial parse, carry on past a bad transaction; the load
+     * fails all the same. */
+    for (auto& record : batch->records)
+    {
+        auto trn = trn_record_apply (*record, book);
+        if (trn)
+            gdata->cb (GNC_TRANSACTION_TAG, gdata->parsedata, trn);
+        else
+            ok = FALSE;
+    }
+    if (!batch->ok)
+        PERR ("failed to parse a batch of transactions");
+    return ok;
+}
+
+void
+gnc_transaction_xml_batch_free (GncXmlTrnBatch* batch)
+{
+    delete batch;
 }
@@ -157,6 +157,9 @@ GncXmlBackend::session_begin(QofSession* session, const char* new_uri,
 void
 GncXmlBackend::session_end()
 {
+    /* Nothing may be removed from under a save still being written. */
+    wait_for_save ();
+
     if (m_book && qof_book_is_readonly (m_book))
     {
         set_error(ERR_BACKEND_READONLY);
@@ -314,6 +317,14 @@ GncXmlBackend::sync(QofBook* book)
         return;
     }
 
+    finish_previous_save ();
+
+    if (gnc_prefs_get_file_save_in_background ())
+    {
+        save_in_background ();
+        return;
+    }
+
     write_to_file (true);
     remove_old_files();
 }
@@ -349,56 +360,46 @@ GncXmlBackend::export_coa(QofBook* book)
     fclose(out);
 }
 
+/* Picks the name of the file to write and backs up the data file. */
 bool
-GncXmlBackend::write_to_file (bool make_backup)
+GncXmlBackend::prepare_save (bool make_backup, std::string& tmp_name,
+                             SaveStatus& status)
 {
-    QofBackendError be_err;
-
-    ENTER (" book=%p file=%s", m_book, m_fullpath.c_str());
-
-    if (m_book && qof_book_is_readonly (m_book))
-    {
-        /* Are we read-only? Don't continue in this case. */
-        set_error(ERR_BACKEND_READONLY);
-        LEAVE ("");
-        return FALSE;
-    }
-
-    /* If the book is 'clean', recently saved, then don't save again. */
-    /* XXX this is currently broken due to faulty 'Save As' logic. */
-    /* if (FALSE == qof_book_session_not_saved (book)) return FALSE; */
-
-
-    auto tmp_name = g_new (char, strlen (m_fullpath.c_str()) + 12);
-    strcpy (tmp_name, m_fullpath.c_str());
-    strcat (tmp_name, ".tmp-XXXXXX");
+    tmp_name = m_fullpath + ".tmp-XXXXXX";
 
     /* Clang static analyzer flags this as a security risk, which is
      * theoretically true, but we can't use mkstemp because we need to
      * open the file ourselves because of compression. None of the alternatives
      * is any more secure.
      */
-    if (!mktemp (tmp_name))
+    if (!mktemp (&tmp_name[0]))
     {
-        g_free (tmp_name);
-        set_error(ERR_BACKEND_MISC);
-        set_message("Failed to make temp file");
-        LEAVE ("");
-        return FALSE;
+        status.set_error(ERR_BACKEND_MISC);
+        status.set_message("Failed to make temp file");
+        return false;
     }
 
     if (make_backup)
     {
         if (!backup_file ())
         {
-            g_free (tmp_name);
-            LEAVE ("");
-            return FALSE;
+            status.set_error(ERR_FILEIO_BACKUP_ERROR);
+            return false;
         }
     }
+    return true;
+}
+
+/* Puts the newly written tmp_name in place of the data file, or cleans
+ * up after it if writing it failed. Doesn't touch the book, so that it
+ * can finish a save in the background. */
+bool
+GncXmlBackend::install_file (const std::string& tmp_name, bool written,
+                             SaveStatus& status)
+{
+    QofBackendError be_err;
 
-    if (gnc_book_write_to_xml_file_v2 (m_book, tmp_name,
-                                       gnc_prefs_get_file_save_compressed ()))
+    if (written)
     {
         /* Record the file's permissions before g_unlinking it */
         GStatBuf statbuf;
@@ -406,10 +407,10 @@ GncXmlBackend::write_to_file (bool make_backup)
         if (rc == 0)
         {
             /* We must never chmod the file /dev/null */
-            g_assert (g_strcmp0 (tmp_name, "/dev/null") != 0);
+            g_assert (tmp_name != "/dev/null");
 
             /* Use the permissions from the original data file */
-            if (g_chmod (tmp_name, statbuf.st_mode) != 0)
+            if (g_chmod (tmp_name.c_str(), statbuf.st_mode) != 0)
             {
                 /* set_error(ERR_BACKEND_PERM); */
                 /* set_message("Failed to chmod filename %s", tmp_name ); */
@@ -419,73 +420,58 @@ GncXmlBackend::write_to_file (bool make_backup)
                    error here which implies that the saving itself
                    failed. Instead, we simply ignore this. */
                 PWARN ("unable to chmod filename %s: %s",
-                       tmp_name ? tmp_name : "(null)",
+                       tmp_name.c_str(),
                        g_strerror (errno) ? g_strerror (errno) : "");
 #if VFAT_DOESNT_SUCK  /* chmod always fails on vfat/samba fs */
-                /* g_free(tmp_name); */
                 /* return FALSE; */
 #endif
             }
 #ifdef HAVE_CHOWN
             /* Don't try to change the owner. Only root can do
                that. */
-            if (chown (tmp_name, -1, statbuf.st_gid) != 0)
+            if (chown (tmp_name.c_str(), -1, statbuf.st_gid) != 0)
             {
                 /* set_error(ERR_BACKEND_PERM); */
                 /* set_message("Failed to chown filename %s", tmp_name ); */
                 /* A failed chown doesn't mean that the saving itself
                 failed. So don't abort with an error here! */
                 PWARN ("unable to chown filename %s: %s",
-                       tmp_name ? tmp_name : "(null)",
+                       tmp_name.c_str(),
                        strerror (errno) ? strerror (errno) : "");
 #if VFAT_DOESNT_SUCK /* chown always fails on vfat fs */
-                /* g_free(tmp_name);
-                return FALSE; */
+                /* return FALSE; */
 #endif
             }
 #endif
         }
         if (g_unlink (m_fullpath.c_str()) != 0 && errno != ENOENT)
         {
-            set_error(ERR_BACKEND_READONLY);
+            status.set_error(ERR_BACKEND_READONLY);
             PWARN ("unable to unlink filename %s: %s",
                    m_fullpath.empty() ? "(null)" : m_fullpath.c_str(),
                    g_strerror (errno) ? g_strerror (errno) : "");
-            g_free (tmp_name);
-            LEAVE ("");
             return FALSE;
         }
         if (!link_or_make_backup (tmp_name, m_fullpath))
         {
-            set_error(ERR_FILEIO_BACKUP_ERROR);
+            status.set_error(ERR_FILEIO_BACKUP_ERROR);
             std::string msg{"Failed to make backup file "};
-            set_message(msg + (m_fullpath.empty() ? "NULL" : m_fullpath));
-            g_free (tmp_name);
-            LEAVE ("");
+            status.set_message(msg + (m_fullpath.empty() ? "NULL" : m_fullpath));
             return FALSE;
         }
-        if (g_unlink (tmp_name) != 0)
+        if (g_unlink (tmp_name.c_str()) != 0)
         {
-            set_error(ERR_BACKEND_PERM);
+            status.set_error(ERR_BACKEND_PERM);
             PWARN ("unable to unlink temp filename %s: %s",
-                   tmp_name ? tmp_name : "(null)",
+                   tmp_name.c_str(),
                    g_strerror (errno) ? g_strerror (errno) : "");
-            g_free (tmp_name);
-            LEAVE ("");
             return FALSE;
         }
-        g_free (tmp_name);
-
-        /* Since we successfully saved the book,
-         * we should mark it clean. */
-        qof_book_mark_session_saved (m_book);
-        LEAVE (" successful save of book=%p to file=%s", m_book,
-               m_fullpath.c_str());
         return TRUE;
     }
     else
     {
-        if (g_unlink (tmp_name) != 0)
+        if (g_unlink (tmp_name.c_str()) != 0)
         {
             switch (errno)
             {
@@ -500,28 +486,164 @@ GncXmlBackend::write_to_file (bool make_backup)
                 be_err = ERR_BACKEND_MISC;
                 break;
             }
-            set_error(be_err);
+            status.set_error(be_err);
             PWARN ("unable to unlink temp_filename %s: %s",
-                   tmp_name ? tmp_name : "(null)",
+                   tmp_name.c_str(),
                    g_strerror (errno) ? g_strerror (errno) : "");
             /* already in an error just flow on through */
         }
         else
         {
             /* Use a generic write error code */
-            set_error(ERR_FILEIO_WRITE_ERROR);
+            status.set_error(ERR_FILEIO_WRITE_ERROR);
             std::string msg{"Unable to write to temp file "};
-            set_message(msg + (tmp_name ? tmp_name : "NULL"));
+            status.set_message(msg + tmp_name);
         }
-        g_free (tmp_name);
+        return FALSE;
+    }
+}
+
+void
+GncXmlBackend::report_save_status (SaveStatus& status)
+{
+    if (status.err == ERR_BACKEND_NO_ERR)
+        return;
+    set_error(status.err);
+    if (!status.message.empty())
+        set_message(std::move(status.message));
+}
+
+bool
+GncXmlBackend::write_to_file (bool make_backup)
+{
+    ENTER (" book=%p file=%s", m_book, m_fullpath.c_str());
+
+    if (m_book && qof_book_is_readonly (m_book))
+    {
+        /* Are we read-only? Don't continue in this case. */
+        set_error(ERR_BACKEND_READONLY);
+        LEAVE ("");
+        return FALSE;
+    }
+
+    /* If the book is 'clean', recently saved, then don't save again. */
+    /* XXX this is currently broken due to faulty 'Save As' logic. */
+    /* if (FALSE == qof_book_session_not_saved (book)) return FALSE; */
+
+    SaveStatus status;
+    std::string tmp_name;
+    if (!prepare_save (make_backup, tmp_name, status))
+    {
+        report_save_status (status);
         LEAVE ("");
         return FALSE;
     }
-    g_free (tmp_name);
-    LEAVE ("");
+
+    gnc_xml_set_compression_level (gnc_prefs_get_file_compression_level ());
+    auto written = gnc_book_write_to_xml_file_v2 (m_book, tmp_name.c_str(),
+                                                  gnc_prefs_get_file_save_compressed ());
+    if (!install_file (tmp_name, written, status))
+    {
+        report_save_status (status);
+        LEAVE ("");
+        return FALSE;
+    }
+
+    /* Since we successfully saved the book,
+     * we should mark it clean. */
+    qof_book_mark_session_saved (m_book);
+    LEAVE (" successful save of book=%p to file=%s", m_book,
+           m_fullpath.c_str());
     return TRUE;
 }
 
+/* Saves the book without waiting for it to be compressed and written.
+ * The book is written into memory on this thread, which is the
+ * consistent snapshot of it; another thread backs up the data file,
+ * writes the snapshot out and puts it in place, while the caller goes
+ * on editing the book. */
+void
+GncXmlBackend::save_in_background ()
+{
+    ENTER (" book=%p file=%s", m_book, m_fullpath.c_str());
+
+    std::string xml;
+    if (!gnc_book_write_to_xml_string_v2 (m_book, xml))
+    {
+        set_error(ERR_FILEIO_WRITE_ERROR);
+        set_message("Unable to write the book");
+        LEAVE ("");
+        return;
+    }
+
+    /* Changes made from here on aren't in the snapshot and make the book
+     * dirty again. */
+    qof_book_mark_session_saved (m_book);
+
+    gnc_xml_set_compression_level (gnc_prefs_get_file_compression_level ());
+    auto compress = gnc_prefs_get_file_save_compressed ();
+    m_save_done = false;
+    m_save_thread = std::thread {[this, xml = std::move (xml), compress]
+    {
+        SaveStatus status;
+        std::string tmp_name;
+        if (prepare_save (true, tmp_name, status))
+        {
+            auto written = gnc_xml_write_string_to_file_v2 (xml, tmp_name.c_str(),
+                                                            compress);
+            install_file (tmp_name, written, status);
+        }
+        remove_old_files ();
+        m_save_status = std::move (status);
+        m_save_done = true;
+    }};
+    LEAVE (" writing book=%p to file=%s", m_book, m_fullpath.c_str());
+}
+
+void
+GncXmlBackend::finish_background_save ()
+{
+    m_save_thread.join ();
+    if (m_save_status.err != ERR_BACKEND_NO_ERR)
+    {
+        /* The snapshot never made it to the data file. */
+        PWARN ("saving %s in the background failed: %d",
+               m_fullpath.c_str(), m_save_status.err);
+        if (m_book)
+            qof_book_mark_session_dirty (m_book);
+        report_save_status (m_save_status);
+    }
+    m_save_status = SaveStatus{};
+}
+
+/* Only one save may write the data file and its backups at a time. If
+ * the one before failed, the save about to start writes the same
+ * changes and more, so it takes that one's place and the old error is
+ * only logged. */
+void
+GncXmlBackend::finish_previous_save ()
+{
+    if (!m_save_thread.joinable ())
+        return;
+    finish_background_save ();
+    if (check_error ())
+        PWARN ("the previous save of %s failed with error %d, saving again",
+               m_fullpath.c_str(), get_error ());
+}
+
+bool
+GncXmlBackend::save_in_progress () const
+{
+    return m_save_thread.joinable () && !m_save_done;
+}
+
+void
+GncXmlBackend::wait_for_save ()
+{
+    if (m_save_thread.joinable ())
+        finish_background_save ();
+}
+
 static bool
 copy_file (const std::string& orig, const std::string& bkup)
 {
@@ -611,7 +733,6 @@ GncXmlBackend::link_or_make_backup (const std::string& orig,
 
         if (!copy_success)
         {
-            set_error(ERR_FILEIO_BACKUP_ERROR);
             PWARN ("unable to make file backup from %s to %s: %s",
                    orig.c_str(), bkup.c_str(), g_strerror (errno) ? g_strerror (errno) : "");
             return false;
@@ -23,7 +23,9 @@ extern "C"
 #include <qof.h>
 }
 
+#include <atomic>
 #include <string>
+#include <thread>
 #include <qof-backend.hpp>
 
 class GncXmlBackend : public QofBackend
@@ -42,17 +44,36 @@ public:
     /* The XML backend isn't able to do anything with individual instances. */
     void export_coa(QofBook*) override;
     void sync(QofBook* book) override;
-    void safe_sync(QofBook* book) override { sync(book); } // XML sync is inherently safe.
+    /* XML sync is inherently safe, once it is done. */
+    void safe_sync(QofBook* book) override { sync(book); wait_for_save(); }
     void commit(QofInstance* instance) override;
+    bool save_in_progress() const override;
+    void wait_for_save() override;
     const char * get_filename() { return m_fullpath.c_str(); }
     QofBook* get_book() { return m_book; }
 
 private:
+    /* The outcome of a save, kept apart from the backend's own error so
+     * that a save in the background can't race the session for it. */
+    struct SaveStatus
+    {
+        QofBackendError err = ERR_BACKEND_NO_ERR;
+        std::string message;
+        void set_error(QofBackendError e) { if (err == ERR_BACKEND_NO_ERR) err = e; }
+        void set_message(std::string&& msg) { message = std::move(msg); }
+    };
+
     bool save_may_clobber_data();
     void get_file_lock(SessionOpenMode);
     bool link_or_make_backup(const std::string& orig, const std::string& bkup);
     bool backup_file();
+    bool prepare_save(bool make_backup, std::string& tmp_name, SaveStatus& status);
+    bool install_file(const std::string& tmp_name, bool written, SaveStatus& status);
+    void report_save_status(SaveStatus& status);
     bool write_to_file(bool make_backup);
+    void save_in_background();
+    void finish_background_save();
+    void finish_previous_save();
     void remove_old_files();
     void write_accounts(QofBook* book);
     bool check_path(const char* fullpath, bool create);
@@ -63,5 +84,10 @@ private:
     int m_lockfd = -1;
 
     QofBook* m_book = nullptr;  /* The primary, main open book */
+
+    /* A save being written out by save_in_background(). */
+    std::thread m_save_thread;
+    std::atomic<bool> m_save_done{false};
+    SaveStatus m_save_status;
 };
 #endif // __GNC_XML_BACKEND_HPP__
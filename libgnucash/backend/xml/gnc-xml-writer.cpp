@@ -0,0 +1,542 @@
+/********************************************************************
+ * gnc-xml-writer.cpp: write XML without building a tree first      *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ ********************************************************************/
+#include <glib.h>
+
+extern "C"
+{
+#include <config.h>
+
+#include <string.h>
+
+#include <gnc-date.h>
+}
+
+#include <algorithm>
+
+#include "gnc-xml-helper.h"
+#include "gnc-xml-writer.hpp"
+#include "sixtp-dom-generators.h"
+
+#include <kvp-frame.hpp>
+#include <gnc-datetime.hpp>
+
+static QofLogModule log_module = GNC_MOD_IO;
+
+/* The buffer is written out once it grows past this. */
+#define WRITER_FLUSH_SIZE (64 * 1024)
+
+/* libxml's xmlsave.c stops indenting at 60 spaces. */
+#define MAX_INDENT_LEVEL 30
+
+GncXmlWriter::GncXmlWriter (FILE* out, int level) :
+    m_out {out}, m_level {level}
+{
+    m_buf.reserve (WRITER_FLUSH_SIZE + 4096);
+}
+
+GncXmlWriter::~GncXmlWriter ()
+{
+    flush ();
+}
+
+gboolean
+GncXmlWriter::flush ()
+{
+    if (!m_buf.empty ())
+    {
+        if (fwrite (m_buf.data (), 1, m_buf.size (), m_out) != m_buf.size ())
+            m_ok = false;
+        m_buf.clear ();
+    }
+    if (ferror (m_out))
+        m_ok = false;
+    return m_ok;
+}
+
+void
+GncXmlWriter::indent (int level)
+{
+    m_buf.append (2 * std::min (level, MAX_INDENT_LEVEL), ' ');
+}
+
+/* Closes the start tag of the element that gets a child.  Like
+ * xmlNodeDumpOutput(), an element with text in it has its children
+ * written on one line; that includes any element nested in it. */
+void
+GncXmlWriter::child_added (bool is_text)
+{
+    if (m_stack.empty ())
+        return;
+
+    auto& parent = m_stack.back ();
+    if (parent.open)
+    {
+        parent.open = false;
+        parent.format = parent.format && !is_text;
+        m_buf += '>';
+        if (parent.format)
+            m_buf += '\n';
+    }
+    else if (is_text && parent.format)
+    {
+        PWARN ("Text after child elements in <%s> is laid out differently "
+               "than xmlElemDump would", parent.tag);
+    }
+    parent.has_children = true;
+}
+
+void
+GncXmlWriter::start_element (const char* tag)
+{
+    child_added (false);
+
+    Element elem {tag, m_level, true, false, true};
+    if (!m_stack.empty ())
+    {
+        auto& parent = m_stack.back ();
+        elem.level = parent.level + 1;
+        elem.format = parent.format;
+        if (parent.format)
+            indent (elem.level);
+    }
+
+    m_buf += '<';
+    m_buf += tag;
+    m_stack.push_back (elem);
+}
+
+void
+GncXmlWriter::end_element ()
+{
+    g_return_if_fail (!m_stack.empty ());
+
+    auto elem = m_stack.back ();
+    m_stack.pop_back ();
+
+    if (elem.open)
+    {
+        m_buf += "/>";
+    }
+    else
+    {
+        if (elem.format)
+            indent (elem.level);
+        m_buf += "</";
+        m_buf += elem.tag;
+        m_buf += '>';
+    }
+
+    if (!m_stack.empty () && m_stack.back ().format)
+        m_buf += '\n';
+
+    if (m_buf.size () >= WRITER_FLUSH_SIZE)
+        flush ();
+}
+
+void
+GncXmlWriter::attribute (const char* name, const char* value)
+{
+    g_return_if_fail (!m_stack.empty () && m_stack.back ().open);
+
+    m_buf += ' ';
+    m_buf += name;
+    m_buf += "=\"";
+    write_attribute_value (value);
+    m_buf += '"';
+}
+
+void
+GncXmlWriter::text (const char* str)
+{
+    if (!str || !*str)
+        return;
+    child_added (true);
+    write_text (str);
+}
+
+void
+GncXmlWriter::text_child (const char* tag, const char* str)
+{
+    start_element (tag);
+    if (str)
+    {
+        child_added (true);
+        write_text (str);
+    }
+    end_element ();
+}
+
+void
+GncXmlWriter::raw (const char* str)
+{
+    m_buf += str;
+    if (m_buf.size () >= WRITER_FLUSH_SIZE)
+        flush ();
+}
+
+/* Escapes text as xmlNodeDumpOutput() does, after cleaning it up as
+ * checked_char_cast() does. */
+void
+GncXmlWriter::write_text (const char* str)
+{
+    gchar* cleaned = nullptr;
+    if (!g_utf8_validate (str, -1, nullptr))
+    {
+        cleaned = g_strdup (str);
+        checked_char_cast (cleaned);
+        str = cleaned;
+    }
+
+    auto run = str;
+    for (auto p = str; *p; ++p)
+    {
+        const char* escaped;
+        switch (*p)
+        {
+        case '<':
+            escaped = "&lt;";
+            break;
+        case '>':
+            escaped = "&gt;";
+            break;
+        case '&':
+            escaped = "&amp;";
+            break;
+        case '\r':
+            escaped = "&#13;";
+            break;
+        case '\t':
+        case '\n':
+            continue;
+        default:
+            if (*p > 0 && *p < 0x20)
+                escaped = "?";
+            else
+                continue;
+            break;
+        }
+        m_buf.append (run, p - run);
+        m_buf += escaped;
+        run = p + 1;
+    }
+    m_buf += run;
+
+    g_free (cleaned);
+}
+
+/* Escapes an attribute value as xmlNodeDumpOutput() does when the node
+ * has no document: besides the markup characters, whitespace other
+ * than blanks and all non-ASCII characters become character
+ * references. */
+void
+GncXmlWriter::write_attribute_value (const char* str)
+{
+    char ref[16];
+
+    for (auto p = reinterpret_cast<const guchar*> (str); *p;)
+    {
+        switch (*p)
+        {
+        case '\n':
+            m_buf += "&#10;";
+            break;
+        case '\r':
+            m_buf += "&#13;";
+            break;
+        case '\t':
+            m_buf += "&#9;";
+            break;
+        case '"':
+            m_buf += "&quot;";
+            break;
+        case '<':
+            m_buf += "&lt;";
+            break;
+        case '>':
+            m_buf += "&gt;";
+            break;
+        case '&':
+            m_buf += "&amp;";
+            break;
+        default:
+            if (*p < 0x80)
+            {
+                m_buf += static_cast<char> (*p);
+                break;
+            }
+            else
+            {
+                auto ch = g_utf8_get_char_validated (
+                              reinterpret_cast<const gchar*> (p), -1);
+                if (ch == static_cast<gunichar> (-1) ||
+                    ch == static_cast<gunichar> (-2))
+                {
+                    ch = *p;
+                    ++p;
+                }
+                else
+                {
+                    p = reinterpret_cast<const guchar*> (
+                            g_utf8_next_char (reinterpret_cast<const gchar*> (p)));
+                }
+                snprintf (ref, sizeof (ref), "&#x%X;", ch);
+                m_buf += ref;
+                continue;
+            }
+        }
+        ++p;
+    }
+}
+
+/* The generators */
+
+void
+GncXmlWriter::text_element (const char* tag, const char* str)
+{
+    g_return_if_fail (tag);
+    g_return_if_fail (str);
+
+    start_element (tag);
+    text (str);
+    end_element ();
+}
+
+void
+GncXmlWriter::int_element (const char* tag, gint64 val)
+{
+    char num[32];
+
+    snprintf (num, sizeof (num), "%" G_GINT64_FORMAT, val);
+    text_element (tag, num);
+}
+
+void
+GncXmlWriter::guid_element (const char* tag, const GncGUID* gid)
+{
+    char guid_str[GUID_ENCODING_LENGTH + 1];
+
+    if (!guid_to_string_buff (gid, guid_str))
+    {
+        PERR ("guid_to_string_buff failed\n");
+        return;
+    }
+
+    start_element (tag);
+    attribute ("type", "guid");
+    text (guid_str);
+    end_element ();
+}
+
+void
+GncXmlWriter::commodity_ref_element (const char* tag, const gnc_commodity* c)
+{
+    g_return_if_fail (c);
+
+    auto name_space = gnc_commodity_get_namespace (c);
+    auto mnemonic = gnc_commodity_get_mnemonic (c);
+    if (!name_space || !mnemonic)
+        return;
+
+    start_element (tag);
+    text_child ("cmdty:space", name_space);
+    text_child ("cmdty:id", mnemonic);
+    end_element ();
+}
+
+void
+GncXmlWriter::time64_element (const char* tag, time64 time)
+{
+    g_return_if_fail (time != INT64_MAX);
+
+    auto date_str = GncDateTime (time).format_iso8601 ();
+    if (date_str.empty ())
+        return;
+    date_str += " +0000"; //Tack on a UTC offset to mollify GnuCash for Android
+
+    start_element (tag);
+    text_child ("ts:date", date_str.c_str ());
+    end_element ();
+}
+
+void
+GncXmlWriter::gdate_element (const char* tag, const GDate* date)
+{
+    char date_str[512];
+
+    g_return_if_fail (date);
+    g_date_strftime (date_str, sizeof (date_str), "%Y-%m-%d", date);
+
+    start_element (tag);
+    text_child ("gdate", date_str);
+    end_element ();
+}
+
+void
+GncXmlWriter::gnc_numeric_element (const char* tag, gnc_numeric num)
+{
+    gchar* numstr = gnc_numeric_to_string (num);
+    g_return_if_fail (numstr);
+
+    start_element (tag);
+    text (numstr);
+    end_element ();
+
+    g_free (numstr);
+}
+
+void
+GncXmlWriter::kvp_value (const char* tag, KvpValue* val)
+{
+    switch (val->get_type ())
+    {
+    case KvpValue::Type::INT64:
+    {
+        char num[32];
+        snprintf (num, sizeof (num), "%" G_GINT64_FORMAT,
+                  val->get<int64_t> ());
+        start_element (tag);
+        attribute ("type", "integer");
+        text (num);
+        end_element ();
+        break;
+    }
+    case KvpValue::Type::DOUBLE:
+    {
+        auto num = double_to_string (val->get<double> ());
+        start_element (tag);
+        attribute ("type", "double");
+        text (num);
+        end_element ();
+        g_free (num);
+        break;
+    }
+    case KvpValue::Type::NUMERIC:
+    {
+        auto num = gnc_numeric_to_string (val->get<gnc_numeric> ());
+        start_element (tag);
+        attribute ("type", "numeric");
+        text (num);
+        end_element ();
+        g_free (num);
+        break;
+    }
+    case KvpValue::Type::STRING:
+    {
+        auto str = val->get<const char*> ();
+        start_element (tag);
+        attribute ("type", "string");
+        if (str)
+        {
+            child_added (true);
+            write_text (str);
+        }
+        end_element ();
+        break;
+    }
+    case KvpValue::Type::GUID:
+    {
+        gchar guidstr[GUID_ENCODING_LENGTH + 1];
+        guid_to_string_buff (val->get<GncGUID*> (), guidstr);
+        start_element (tag);
+        attribute ("type", "guid");
+        text (guidstr);
+        end_element ();
+        break;
+    }
+    /* Note: The type attribute must remain 'timespec' to maintain
+     * compatibility.
+     */
+    case KvpValue::Type::TIME64:
+    {
+        auto t = val->get<Time64> ();
+        g_return_if_fail (t.t != INT64_MAX);
+        auto date_str = GncDateTime (t.t).format_iso8601 ();
+        if (date_str.empty ())
+            return;
+        date_str += " +0000";
+        start_element (tag);
+        attribute ("type", "timespec");
+        text_child ("ts:date", date_str.c_str ());
+        end_element ();
+        break;
+    }
+    case KvpValue::Type::GDATE:
+    {
+        char date_str[512];
+        auto d = val->get<GDate> ();
+        g_date_strftime (date_str, sizeof (date_str), "%Y-%m-%d", &d);
+        start_element (tag);
+        attribute ("type", "gdate");
+        text_child ("gdate", date_str);
+        end_element ();
+        break;
+    }
+    case KvpValue::Type::GLIST:
+        start_element (tag);
+        attribute ("type", "list");
+        for (auto cursor = val->get<GList*> (); cursor; cursor = cursor->next)
+            kvp_value ("slot:value", static_cast<KvpValue*> (cursor->data));
+        end_element ();
+        break;
+    case KvpValue::Type::FRAME:
+    {
+        start_element (tag);
+        attribute ("type", "frame");
+        auto frame = val->get<KvpFrame*> ();
+        if (frame)
+            frame->for_each_slot_temp ([this] (const char* key, KvpValue* value)
+            {
+                kvp_slot (key, value);
+            });
+        end_element ();
+        break;
+    }
+    default:
+        start_element (tag);
+        end_element ();
+        break;
+    }
+}
+
+void
+GncXmlWriter::kvp_slot (const char* key, KvpValue* value)
+{
+    start_element ("slot");
+    text_child ("slot:key", key);
+    kvp_value ("slot:value", value);
+    end_element ();
+}
+
+void
+GncXmlWriter::slots_element (const char* tag, const QofInstance* inst)
+{
+    KvpFrame* frame = qof_instance_get_slots (inst);
+    if (!frame || frame->empty ())
+        return;
+
+    start_element (tag);
+    frame->for_each_slot_temp ([this] (const char* key, KvpValue* value)
+    {
+        kvp_slot (key, value);
+    });
+    end_element ();
+}
@@ -0,0 +1,115 @@
+/********************************************************************
+ * gnc-xml-writer.hpp: write XML without building a tree first      *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ ********************************************************************/
+
+#ifndef GNC_XML_WRITER_HPP
+#define GNC_XML_WRITER_HPP
+
+extern "C"
+{
+#include <glib.h>
+#include <stdio.h>
+
+#include "gnc-commodity.h"
+#include "qof.h"
+}
+
+#include <string>
+#include <vector>
+
+/** Writes XML to a file as it is produced, laid out byte for byte the
+ * way xmlElemDump() lays out the equivalent tree: elements holding only
+ * elements get each child on its own line, indented two spaces a
+ * level, and elements holding text are written on one line.  The
+ * element functions below produce what the matching *_to_dom_tree
+ * generator in sixtp-dom-generators.h would, so an object can be saved
+ * without building, dumping and freeing a tree for it.
+ *
+ * Output is buffered; call flush() when done, or before writing to the
+ * file by other means.  Tags and attribute names must stay valid until
+ * their element is ended.
+ */
+class GncXmlWriter
+{
+public:
+    /** @param out The file to write to.
+     *  @param level The indentation level of the first element, as
+     *  passed to xmlNodeDumpOutput(). */
+    explicit GncXmlWriter (FILE* out, int level = 0);
+    GncXmlWriter (const GncXmlWriter&) = delete;
+    GncXmlWriter& operator= (const GncXmlWriter&) = delete;
+    ~GncXmlWriter ();
+
+    void start_element (const char* tag);
+    void attribute (const char* name, const char* value);
+    /** Adds text to the element, as xmlNodeAddContent() does; an empty
+     * string adds nothing. */
+    void text (const char* str);
+    void end_element ();
+    /** An element holding str, as xmlNewTextChild() makes it; an empty
+     * string gives <tag></tag> rather than <tag/>. */
+    void text_child (const char* tag, const char* str);
+    /** Writes str as it is, between top-level elements. */
+    void raw (const char* str);
+
+    /** Writes out the buffer.
+     *  @return FALSE if writing to the file failed, now or earlier. */
+    gboolean flush ();
+    /** Sets the level of the next top-level element. */
+    void set_level (int level) { m_level = level; }
+
+    /* The sixtp-dom-generators.h counterparts. */
+    void text_element (const char* tag, const char* str);
+    void int_element (const char* tag, gint64 val);
+    void guid_element (const char* tag, const GncGUID* gid);
+    void commodity_ref_element (const char* tag, const gnc_commodity* c);
+    void time64_element (const char* tag, time64 time);
+    void gdate_element (const char* tag, const GDate* date);
+    void gnc_numeric_element (const char* tag, gnc_numeric num);
+    void slots_element (const char* tag, const QofInstance* inst);
+
+private:
+    struct Element
+    {
+        const char* tag;
+        int level;
+        /* The start tag still lacks its '>'. */
+        bool open;
+        bool has_children;
+        /* Whether the children go on lines of their own. */
+        bool format;
+    };
+
+    void child_added (bool is_text);
+    void indent (int level);
+    void write_text (const char* str);
+    void write_attribute_value (const char* str);
+    void kvp_value (const char* tag, KvpValue* val);
+    void kvp_slot (const char* key, KvpValue* val);
+
+    FILE* m_out;
+    int m_level;
+    std::string m_buf;
+    std::vector<Element> m_stack;
+    bool m_ok = true;
+};
+
+#endif /* GNC_XML_WRITER_HPP */
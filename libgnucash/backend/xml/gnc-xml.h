@@ -35,10 +35,21 @@ extern "C"
 
 #include "gnc-xml-helper.h"
 #include "sixtp.h"
+#include "io-gncxml-gen.h"
+
+#include <vector>
+
+#define GNC_TRANSACTION_TAG "gnc:transaction"
+
+/* The *_xml_write functions write what xmlElemDump would for the tree
+ * the matching *_dom_tree_create function makes; see gnc-xml-writer.hpp. */
+class GncXmlWriter;
 
 xmlNodePtr gnc_account_dom_tree_create (Account* act, gboolean exporting,
                                         gboolean allow_incompat);
 sixtp* gnc_account_sixtp_parser_create (void);
+void gnc_account_xml_write (GncXmlWriter& writer, Account* act,
+                            gboolean exporting, gboolean allow_incompat);
 
 xmlNodePtr gnc_book_dom_tree_create (QofBook* book);
 sixtp* gnc_book_sixtp_parser_create (void);
@@ -52,9 +63,14 @@ sixtp* gnc_freqSpec_sixtp_parser_create (void);
 
 xmlNodePtr gnc_lot_dom_tree_create (GNCLot*);
 sixtp* gnc_lot_sixtp_parser_create (void);
+void gnc_lot_xml_write (GncXmlWriter& writer, GNCLot* lot);
 
 xmlNodePtr gnc_pricedb_dom_tree_create (GNCPriceDB* db);
 sixtp* gnc_pricedb_sixtp_parser_create (void);
+/* The prices gnc_pricedb_dom_tree_create puts in its tree, in order, or
+ * none if it makes no tree. */
+std::vector<GNCPrice*> gnc_pricedb_xml_prices (GNCPriceDB* db);
+void gnc_price_xml_write (GncXmlWriter& writer, GNCPrice* price);
 
 xmlNodePtr gnc_schedXaction_dom_tree_create (SchedXaction* sx);
 sixtp* gnc_schedXaction_sixtp_parser_create (void);
@@ -63,8 +79,19 @@ xmlNodePtr gnc_budget_dom_tree_create (GncBudget* bgt);
 sixtp* gnc_budget_sixtp_parser_create (void);
 
 xmlNodePtr gnc_transaction_dom_tree_create (Transaction* txn);
+void gnc_transaction_xml_write (GncXmlWriter& writer, Transaction* txn);
 sixtp* gnc_transaction_sixtp_parser_create (void);
 
+/* Transactions can be decoded away from the book, on any thread, and
+ * added to it later: xml holds <gnc:transaction> elements inside one
+ * wrapping element.  Applying the batch hands each transaction to
+ * gdata->cb as the transaction parser does. */
+typedef struct GncXmlTrnBatch GncXmlTrnBatch;
+GncXmlTrnBatch* gnc_transaction_xml_decode_batch (const char* xml, int len);
+gboolean gnc_transaction_xml_apply_batch (GncXmlTrnBatch* batch,
+                                          gxpf_data* gdata);
+void gnc_transaction_xml_batch_free (GncXmlTrnBatch* batch);
+
 sixtp* gnc_template_transaction_sixtp_parser_create (void);
 
 #endif /* GNC_XML_H */
@@ -51,4 +51,9 @@ gnc_xml_parse_fd (sixtp* top_parser, FILE* fd,
                   gxpf_callback callback, gpointer parsedata,
                   gpointer bookdata);
 
+gboolean
+gnc_xml_parse_io (sixtp* top_parser, xmlInputReadCallback read_cb,
+                  void* read_context, gxpf_callback callback,
+                  gpointer parsedata, gpointer bookdata);
+
 #endif /* IO_GNCXML_GEN_H */
@@ -0,0 +1,505 @@
+/********************************************************************
+ * io-gncxml-v2-parallel.cpp: decode transactions on worker threads *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ ********************************************************************/
+#include <glib.h>
+
+extern "C"
+{
+#include <config.h>
+
+#include <errno.h>
+#include <string.h>
+
+#include <gnc-engine.h>
+}
+
+#include <algorithm>
+
+#include "io-gncxml-v2-parallel.hpp"
+
+static QofLogModule log_module = GNC_MOD_IO;
+
+/* How much of the file is read at a time and how many transactions a
+ * worker decodes at a time.  A batch is a few hundred kilobytes of
+ * XML, enough to make handing it over cheap. */
+#define READ_CHUNK_SIZE (64 * 1024)
+#define TRN_BATCH_SIZE 256
+
+static const char trn_start_tag[] = "<" GNC_TRANSACTION_TAG;
+static const char trn_end_tag[] = "</" GNC_TRANSACTION_TAG;
+static const char batch_open_tag[] = "<" GNC_TRANSACTION_BATCH_TAG ">";
+static const char batch_close_tag[] = "</" GNC_TRANSACTION_BATCH_TAG ">";
+static const char batch_ref_tag[] = "<" GNC_TRANSACTION_BATCH_TAG "/>";
+
+#define LITERAL_LEN(s) (sizeof (s) - 1)
+
+GncXmlParallelLoad::GncXmlParallelLoad (FILE* file, guint n_workers) :
+    m_file {file}
+{
+    /* libxml has to set itself up before threads share it. */
+    xmlInitParser ();
+    n_workers = std::max (n_workers, 1u);
+    for (guint i = 0; i < n_workers; i++)
+        m_threads.emplace_back (&GncXmlParallelLoad::work, this);
+}
+
+GncXmlParallelLoad::~GncXmlParallelLoad ()
+{
+    {
+        std::lock_guard<std::mutex> lock {m_mutex};
+        m_stop = true;
+    }
+    m_cond.notify_all ();
+    for (auto& thread : m_threads)
+        thread.join ();
+
+    /* A failed parse leaves batches behind.  Dropping the jobs that
+     * never ran breaks their promises. */
+    m_jobs.clear ();
+    for (auto& result : m_results)
+    {
+        try
+        {
+            gnc_transaction_xml_batch_free (result.get ());
+        }
+        catch (...)
+        {
+        }
+    }
+}
+
+void
+GncXmlParallelLoad::work ()
+{
+    while (true)
+    {
+        BatchTask job;
+        {
+            std::unique_lock<std::mutex> lock {m_mutex};
+            m_cond.wait (lock, [this] { return m_stop || !m_jobs.empty (); });
+            if (m_stop)
+                return;
+            job = std::move (m_jobs.front ());
+            m_jobs.pop_front ();
+        }
+        job ();
+    }
+}
+
+void
+GncXmlParallelLoad::submit (std::string&& xml)
+{
+    BatchTask job {[xml = std::move (xml)]
+    {
+        return gnc_transaction_xml_decode_batch (xml.data (), xml.size ());
+    }};
+    m_results.push_back (job.get_future ());
+    {
+        std::lock_guard<std::mutex> lock {m_mutex};
+        m_jobs.push_back (std::move (job));
+    }
+    m_cond.notify_one ();
+}
+
+gboolean
+GncXmlParallelLoad::apply_next_batch (gxpf_data* gdata)
+{
+    if (m_results.empty ())
+    {
+        PERR ("No transactions to go with <%s/>", GNC_TRANSACTION_BATCH_TAG);
+        return FALSE;
+    }
+
+    auto result = std::move (m_results.front ());
+    m_results.pop_front ();
+
+    GncXmlTrnBatch* batch;
+    try
+    {
+        batch = result.get ();
+    }
+    catch (const std::exception& err)
+    {
+        PERR ("Decoding a batch of transactions failed: %s", err.what ());
+        return FALSE;
+    }
+
+    auto ok = gnc_transaction_xml_apply_batch (batch, gdata);
+    gnc_transaction_xml_batch_free (batch);
+    return ok;
+}
+
+/* Splitting the file */
+
+void
+GncXmlParallelLoad::emit (size_t from, size_t to)
+{
+    if (to > from)
+        m_out.append (m_in, from, to - from);
+}
+
+void
+GncXmlParallelLoad::flush_batch ()
+{
+    if (!m_batch_count)
+        return;
+
+    m_batch.append (batch_close_tag);
+    submit (std::move (m_batch));
+    m_batch.clear ();
+    m_batch_count = 0;
+    m_out.append (batch_ref_tag);
+}
+
+void
+GncXmlParallelLoad::fall_back ()
+{
+    DEBUG ("Decoding the rest of the file serially");
+    flush_batch ();
+    m_passthrough = true;
+}
+
+bool
+GncXmlParallelLoad::is_transaction_start (size_t pos) const
+{
+    if (m_in.compare (pos, LITERAL_LEN (trn_start_tag), trn_start_tag) != 0)
+        return false;
+    auto next = pos + LITERAL_LEN (trn_start_tag);
+    return next < m_in.size () &&
+           (g_ascii_isspace (m_in[next]) || m_in[next] == '>' ||
+            m_in[next] == '/');
+}
+
+/* The position just past the '>' closing the tag at pos, or npos if
+ * it isn't all there yet. */
+size_t
+GncXmlParallelLoad::tag_end (size_t pos) const
+{
+    char quote = 0;
+    for (auto i = pos + 1; i < m_in.size (); i++)
+    {
+        auto c = m_in[i];
+        if (quote)
+        {
+            if (c == quote)
+                quote = 0;
+        }
+        else if (c == '"' || c == '\'')
+            quote = c;
+        else if (c == '>')
+            return i + 1;
+    }
+    return std::string::npos;
+}
+
+/* Checks the encoding in an <?xml ...?> declaration. */
+bool
+GncXmlParallelLoad::encoding_ok (size_t pos, size_t end) const
+{
+    std::string decl {m_in, pos, end - pos};
+    if (decl.compare (0, 6, "<?xml ") != 0)
+        return true;
+
+    auto enc = decl.find ("encoding");
+    if (enc == std::string::npos)
+        return true;
+    auto open = decl.find_first_of ("\"'", enc);
+    if (open == std::string::npos)
+        return false;
+    auto close = decl.find (decl[open], open + 1);
+    if (close == std::string::npos)
+        return false;
+
+    auto name = decl.substr (open + 1, close - open - 1);
+    return g_ascii_strcasecmp (name.c_str (), "utf-8") == 0 ||
+           g_ascii_strcasecmp (name.c_str (), "utf8") == 0;
+}
+
+/* Deals with the markup at m_pos.  Returns false if it needs more
+ * input to do so. */
+bool
+GncXmlParallelLoad::scan_markup ()
+{
+    auto find_end = [this] (const char* end, size_t from)
+    {
+        auto found = m_in.find (end, from);
+        return found == std::string::npos ? found : found + strlen (end);
+    };
+
+    /* Enough to tell all the kinds of markup apart. */
+    if (m_in.size () - m_pos < LITERAL_LEN ("<![CDATA["))
+        return false;
+
+    size_t end;
+    if (m_in.compare (m_pos, 4, "<!--") == 0)
+        end = find_end ("-->", m_pos + 4);
+    else if (m_in.compare (m_pos, 9, "<![CDATA[") == 0)
+        end = find_end ("]]>", m_pos + 9);
+    else if (m_in[m_pos + 1] == '!')
+    {
+        /* A DOCTYPE can declare entities which only libxml knows. */
+        fall_back ();
+        return true;
+    }
+    else if (m_in[m_pos + 1] == '?')
+    {
+        end = find_end ("?>", m_pos + 2);
+        if (end != std::string::npos && !encoding_ok (m_pos, end))
+        {
+            fall_back ();
+            return true;
+        }
+    }
+    else if (m_in[m_pos + 1] == '/')
+    {
+        end = tag_end (m_pos);
+        if (end != std::string::npos)
+        {
+            flush_batch ();
+            m_depth--;
+        }
+    }
+    else
+    {
+        end = tag_end (m_pos);
+        if (end == std::string::npos)
+            return false;
+
+        auto empty = m_in[end - 2] == '/';
+        /* Transactions are children of <gnc-v2> or of a <gnc:book>;
+         * deeper ones are template transactions, left to their own
+         * parser. */
+        if (!empty && (m_depth == 1 || m_depth == 2) &&
+            is_transaction_start (m_pos))
+        {
+            m_in_trn = true;
+            m_trn_start = m_pos;
+            m_trn_search = end;
+            m_pos = end;
+            return true;
+        }
+
+        flush_batch ();
+        if (!empty)
+            m_depth++;
+    }
+
+    if (end == std::string::npos)
+        return false;
+
+    emit (m_pos, end);
+    m_pos = end;
+    return true;
+}
+
+/* Looks for the end of the transaction started at m_trn_start and adds
+ * the transaction to the batch.  Returns false if it needs more input
+ * to do so. */
+bool
+GncXmlParallelLoad::scan_transaction ()
+{
+    auto end = m_in.find (trn_end_tag, m_trn_search);
+    if (end == std::string::npos)
+    {
+        /* Don't look through the same bytes again next time. */
+        if (m_in.size () > m_trn_search + LITERAL_LEN (trn_end_tag))
+            m_trn_search = m_in.size () - LITERAL_LEN (trn_end_tag);
+        return false;
+    }
+    m_trn_search = end;
+
+    auto gt = m_in.find ('>', end);
+    if (gt == std::string::npos)
+        return false;
+    gt++;
+
+    auto is_end_tag = std::all_of (m_in.begin () + end + LITERAL_LEN (trn_end_tag),
+                                   m_in.begin () + gt - 1,
+                                   [] (char c) { return g_ascii_isspace (c); });
+
+    /* Nested transactions, comments, CDATA sections and processing
+     * instructions are left to libxml. */
+    auto body = m_trn_start + LITERAL_LEN (trn_start_tag);
+    if (!is_end_tag ||
+        m_in.find (trn_start_tag, body) < end ||
+        m_in.find ("<!", body) < end ||
+        m_in.find ("<?", body) < end)
+    {
+        m_in_trn = false;
+        m_pos = m_trn_start;
+        fall_back ();
+        return true;
+    }
+
+    if (!m_batch_count)
+        m_batch.append (batch_open_tag);
+    m_batch.append (m_in, m_trn_start, gt - m_trn_start);
+    m_batch_count++;
+    m_in_trn = false;
+    m_pos = gt;
+
+    if (m_batch_count >= TRN_BATCH_SIZE)
+        flush_batch ();
+    return true;
+}
+
+/* Works through the input read so far. */
+void
+GncXmlParallelLoad::scan ()
+{
+    if (!m_started)
+    {
+        if (m_in.size () < 4 && !m_eof)
+            return;
+        m_started = true;
+        /* The splitter only understands ASCII compatible encodings. */
+        if (m_in.size () >= 2 &&
+            ((m_in[0] == '\xfe' && m_in[1] == '\xff') ||
+             (m_in[0] == '\xff' && m_in[1] == '\xfe') ||
+             m_in[0] == '\0' || m_in[1] == '\0'))
+            m_passthrough = true;
+    }
+
+    while (m_pos < m_in.size ())
+    {
+        if (m_passthrough)
+        {
+            emit (m_pos, m_in.size ());
+            m_pos = m_in.size ();
+            return;
+        }
+
+        if (m_in_trn)
+        {
+            if (!scan_transaction ())
+                return;
+            continue;
+        }
+
+        auto lt = m_in.find ('<', m_pos);
+        if (lt == std::string::npos)
+            lt = m_in.size ();
+        emit (m_pos, lt);
+        m_pos = lt;
+        if (m_pos < m_in.size () && !scan_markup ())
+            return;
+    }
+}
+
+void
+GncXmlParallelLoad::read_more ()
+{
+    /* Drop what has been dealt with, keeping any transaction whose end
+     * hasn't turned up yet. */
+    auto keep = m_in_trn ? m_trn_start : m_pos;
+    if (keep > 0)
+    {
+        m_in.erase (0, keep);
+        m_pos -= keep;
+        if (m_in_trn)
+        {
+            m_trn_start -= keep;
+            m_trn_search -= keep;
+        }
+    }
+
+    auto old_size = m_in.size ();
+    m_in.resize (old_size + READ_CHUNK_SIZE);
+    auto n_read = fread (&m_in[old_size], 1, READ_CHUNK_SIZE, m_file);
+    m_in.resize (old_size + n_read);
+
+    if (n_read == 0)
+    {
+        if (ferror (m_file))
+            PWARN ("Error reading the file: %s", g_strerror (errno));
+        m_eof = true;
+    }
+}
+
+void
+GncXmlParallelLoad::fill ()
+{
+    m_out.clear ();
+    m_out_pos = 0;
+
+    while (m_out.empty () && !m_done)
+    {
+        scan ();
+        if (!m_out.empty ())
+            break;
+
+        if (m_eof)
+        {
+            /* Whatever is left is incomplete; libxml will say so. */
+            if (m_in_trn)
+            {
+                m_in_trn = false;
+                m_pos = m_trn_start;
+            }
+            flush_batch ();
+            emit (m_pos, m_in.size ());
+            m_pos = m_in.size ();
+            m_done = true;
+            break;
+        }
+
+        read_more ();
+    }
+}
+
+int
+GncXmlParallelLoad::read (void* context, char* buffer, int len)
+{
+    auto load = static_cast<GncXmlParallelLoad*> (context);
+
+    if (load->m_out_pos >= load->m_out.size ())
+        load->fill ();
+
+    auto n_copy = std::min (static_cast<size_t> (len),
+                            load->m_out.size () - load->m_out_pos);
+    memcpy (buffer, load->m_out.data () + load->m_out_pos, n_copy);
+    load->m_out_pos += n_copy;
+    return n_copy;
+}
+
+/* The batch placeholder's parser */
+
+static gboolean
+trn_batch_end_handler (gpointer data_for_children,
+                       GSList* data_from_children, GSList* sibling_data,
+                       gpointer parent_data, gpointer global_data,
+                       gpointer* result, const gchar* tag)
+{
+    auto gdata = static_cast<gxpf_data*> (global_data);
+    auto gd = static_cast<sixtp_gdv2*> (gdata->parsedata);
+    auto load = static_cast<GncXmlParallelLoad*> (gd->parallel_load);
+
+    g_return_val_if_fail (load, FALSE);
+    return load->apply_next_batch (gdata);
+}
+
+sixtp*
+GncXmlParallelLoad::batch_parser_create ()
+{
+    return sixtp_set_any (sixtp_new (), FALSE,
+                          SIXTP_END_HANDLER_ID, trn_batch_end_handler,
+                          SIXTP_NO_MORE_HANDLERS);
+}
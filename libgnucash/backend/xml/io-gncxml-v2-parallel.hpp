@@ -0,0 +1,125 @@
+/********************************************************************
+ * io-gncxml-v2-parallel.hpp: decode transactions on worker threads *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ ********************************************************************/
+
+#ifndef IO_GNCXML_V2_PARALLEL_HPP
+#define IO_GNCXML_V2_PARALLEL_HPP
+
+extern "C"
+{
+#include <glib.h>
+#include <stdio.h>
+}
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gnc-xml.h"
+#include "sixtp.h"
+
+/** The element that stands in for a batch of transactions in the
+ * document libxml sees. */
+#define GNC_TRANSACTION_BATCH_TAG "gnc:transaction-batch"
+
+/** Reads an XML v2 file for libxml, cutting the top-level
+ * <gnc:transaction> elements out of it as it goes.  The transactions
+ * are gathered into batches which worker threads decode with
+ * gnc_transaction_xml_decode_batch(); each batch is replaced by an
+ * empty <gnc:transaction-batch/> element, whose parser (see
+ * batch_parser_create()) waits for the batch and applies it to the book
+ * on the parsing thread.  Batches are applied in the order they were
+ * cut, so the book ends up the same as with the serial parser.
+ *
+ * Anything the splitter can't see through, a DOCTYPE, an encoding
+ * other than UTF-8 or a comment, CDATA section or processing
+ * instruction inside a transaction, makes it pass the rest of the file
+ * to libxml untouched.
+ */
+class GncXmlParallelLoad
+{
+public:
+    /** @param file The file to read; it is not closed.
+     *  @param n_workers The number of decoding threads, at least 1. */
+    GncXmlParallelLoad (FILE* file, guint n_workers);
+    GncXmlParallelLoad (const GncXmlParallelLoad&) = delete;
+    GncXmlParallelLoad& operator= (const GncXmlParallelLoad&) = delete;
+    ~GncXmlParallelLoad ();
+
+    /** An xmlInputReadCallback; the context is the GncXmlParallelLoad. */
+    static int read (void* context, char* buffer, int len);
+    /** The parser for GNC_TRANSACTION_BATCH_TAG.  It finds the loader
+     * through the parallel_load member of the sixtp_gdv2. */
+    static sixtp* batch_parser_create ();
+
+    /** Wait for the oldest outstanding batch and apply it. */
+    gboolean apply_next_batch (gxpf_data* gdata);
+
+private:
+    using BatchTask = std::packaged_task<GncXmlTrnBatch* ()>;
+
+    void fill ();
+    void read_more ();
+    void scan ();
+    bool scan_markup ();
+    bool scan_transaction ();
+    bool is_transaction_start (size_t pos) const;
+    bool encoding_ok (size_t pos, size_t end) const;
+    size_t tag_end (size_t pos) const;
+    void emit (size_t from, size_t to);
+    void fall_back ();
+    void flush_batch ();
+    void submit (std::string&& xml);
+    void work ();
+
+    FILE* m_file;
+    std::string m_in;
+    size_t m_pos = 0;
+    bool m_eof = false;
+    bool m_done = false;
+    bool m_started = false;
+    bool m_passthrough = false;
+    int m_depth = 0;
+
+    /* The transaction being cut out, from its start tag on. */
+    bool m_in_trn = false;
+    size_t m_trn_start = 0;
+    size_t m_trn_search = 0;
+
+    std::string m_batch;
+    guint m_batch_count = 0;
+
+    std::string m_out;
+    size_t m_out_pos = 0;
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<BatchTask> m_jobs;
+    bool m_stop = false;
+    std::deque<std::future<GncXmlTrnBatch*>> m_results;
+};
+
+#endif /* IO_GNCXML_V2_PARALLEL_HPP */
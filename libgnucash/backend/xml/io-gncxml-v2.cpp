@@ -67,6 +67,9 @@ extern "C"
 #endif
 }
 
+#include <algorithm>
+#include <thread>
+
 #include "gnc-xml-backend.hpp"
 #include "sixtp-parsers.h"
 #include "sixtp-utils.h"
@@ -75,6 +78,9 @@ extern "C"
 #include "sixtp-dom-parsers.h"
 #include "io-gncxml-v2.h"
 #include "io-gncxml-gen.h"
+#include "io-gncxml-v2-parallel.hpp"
+#include "gnc-xml-writer.hpp"
+#include "gnc-gzip-writer.hpp"
 
 /* Do not treat -Wstrict-aliasing warnings as errors because of problems of the
  * G_LOCK* macros as declared by glib.  See
@@ -96,6 +102,8 @@ typedef struct
     gchar* filename;
     gchar* perms;
     gboolean write;
+    gint level;
+    guint n_workers;
 } gz_thread_params_t;
 
 /* Callback structure */
@@ -107,6 +115,7 @@ struct file_backend
     const char*     tag;
     sixtp*          parser;
     FILE*           out;
+    GncXmlWriter*   writer;
     QofBook*        book;
 };
 
@@ -416,10 +425,18 @@ gnc_counter_end_handler (gpointer data_for_children,
     else if (g_strcmp0 (type, "transaction") == 0)
     {
         sixdata->counter.transactions_total = val;
+        /* Size the collections up front rather than growing them while
+         * loading. Every transaction has at least two splits. */
+        qof_collection_reserve (qof_book_get_collection (sixdata->book,
+                                                         GNC_ID_TRANS), val);
+        qof_collection_reserve (qof_book_get_collection (sixdata->book,
+                                                         GNC_ID_SPLIT), 2 * val);
     }
     else if (g_strcmp0 (type, "account") == 0)
     {
         sixdata->counter.accounts_total = val;
+        qof_collection_reserve (qof_book_get_collection (sixdata->book,
+                                                         GNC_ID_ACCOUNT), val);
     }
     else if (g_strcmp0 (type, "book") == 0)
     {
@@ -692,6 +709,46 @@ gnc_sixtp_gdv2_new (
     return gd;
 }
 
+static guint load_workers = 0;
+
+void
+gnc_xml_set_load_workers (guint n_workers)
+{
+    load_workers = n_workers;
+}
+
+guint
+gnc_xml_get_load_workers (void)
+{
+    return load_workers;
+}
+
+static guint
+load_worker_count (void)
+{
+    if (load_workers)
+        return load_workers;
+    return std::max (std::thread::hardware_concurrency (), 1u);
+}
+
+/* Parse a file, decoding its transactions on other threads if there are
+ * any to spare. */
+static gboolean
+parse_xml_file (sixtp* top_parser, FILE* file, sixtp_gdv2* gd,
+                QofBook* book)
+{
+    auto n_workers = load_worker_count ();
+    if (n_workers <= 1)
+        return gnc_xml_parse_fd (top_parser, file, generic_callback, gd, book);
+
+    GncXmlParallelLoad load {file, n_workers - 1};
+    gd->parallel_load = &load;
+    auto retval = gnc_xml_parse_io (top_parser, GncXmlParallelLoad::read,
+                                    &load, generic_callback, gd, book);
+    gd->parallel_load = NULL;
+    return retval;
+}
+
 static gboolean
 qof_session_load_from_xml_file_v2_full (
     GncXmlBackend* xml_be, QofBook* book,
@@ -743,6 +800,7 @@ qof_session_load_from_xml_file_v2_full (
             TRANSACTION_TAG, gnc_transaction_sixtp_parser_create (),
             SCHEDXACTION_TAG, gnc_schedXaction_sixtp_parser_create (),
             TEMPLATE_TRANSACTION_TAG, gnc_template_transaction_sixtp_parser_create (),
+            GNC_TRANSACTION_BATCH_TAG, GncXmlParallelLoad::batch_parser_create (),
             NULL, NULL))
     {
         goto bail;
@@ -760,6 +818,7 @@ qof_session_load_from_xml_file_v2_full (
             TRANSACTION_TAG, gnc_transaction_sixtp_parser_create (),
             SCHEDXACTION_TAG, gnc_schedXaction_sixtp_parser_create (),
             TEMPLATE_TRANSACTION_TAG, gnc_template_transaction_sixtp_parser_create (),
+            GNC_TRANSACTION_BATCH_TAG, GncXmlParallelLoad::batch_parser_create (),
             NULL, NULL))
     {
         goto bail;
@@ -775,6 +834,8 @@ qof_session_load_from_xml_file_v2_full (
     /* stop logging while we load */
     xaccLogDisable ();
     xaccDisableDataScrubbing ();
+    /* sort and balance each account once, after all of its splits are in */
+    gnc_book_begin_bulk_load (book);
 
     if (push_handler)
     {
@@ -806,14 +867,15 @@ qof_session_load_from_xml_file_v2_full (
         }
         else
         {
-            retval = gnc_xml_parse_fd (top_parser, file,
-                                       generic_callback, gd, book);
+            retval = parse_xml_file (top_parser, file, gd, book);
             fclose (file);
             if (thread)
                 g_thread_join (thread) != nullptr;
         }
     }
 
+    gnc_book_end_bulk_load (book);
+
     if (!retval)
     {
         sixtp_destroy (top_parser);
@@ -1103,56 +1165,36 @@ write_commodities (FILE* out, QofBook* book, sixtp_gdv2* gd)
 static gboolean
 write_pricedb (FILE* out, QofBook* book, sixtp_gdv2* gd)
 {
-    xmlNodePtr node;
-    xmlNodePtr parent;
-    xmlOutputBufferPtr outbuf;
+    auto prices = gnc_pricedb_xml_prices (gnc_pricedb_get_db (book));
 
-    parent = gnc_pricedb_dom_tree_create (gnc_pricedb_get_db (book));
-
-    if (!parent)
+    if (prices.empty ())
     {
         return TRUE;
     }
 
-    /* Write out the parent pricedb tag then loop to write out each price.
-       We do it this way instead of just calling xmlElemDump so that we can
-       increment the progress bar as we go. */
+    /* Write out the parent pricedb tag then loop to write out each price
+       so that we can increment the progress bar as we go. */
 
-    if (fprintf (out, "<%s version=\"%s\">\n", parent->name,
-                 xmlGetProp (parent, BAD_CAST "version")) < 0)
+    if (fprintf (out, "<%s version=\"1\">\n", PRICEDB_TAG) < 0)
         return FALSE;
 
-    /* We create our own output buffer so we can call xmlNodeDumpOutput to get
-       the indentation correct. */
-    outbuf = xmlOutputBufferCreateFile (out, NULL);
-    if (outbuf == NULL)
-    {
-        xmlFreeNode (parent);
-        return FALSE;
-    }
-
-    for (node = parent->children; node; node = node->next)
+    /* The prices are one level down; their first line is indented by
+       hand as the writer doesn't indent a top-level element. */
+    GncXmlWriter writer {out, 1};
+    for (auto price : prices)
     {
-        /* Write two spaces since xmlNodeDumpOutput doesn't indent the first line */
-        xmlOutputBufferWrite (outbuf, 2, "  ");
-        xmlNodeDumpOutput (outbuf, NULL, node, 1, 1, NULL);
-        /* It also doesn't terminate the last line */
-        xmlOutputBufferWrite (outbuf, 1, "\n");
-        if (ferror (out))
+        writer.raw ("  ");
+        gnc_price_xml_write (writer, price);
+        writer.raw ("\n");
+        if (!writer.flush ())
             break;
         gd->counter.prices_loaded += 1;
         sixtp_run_callback (gd, "prices");
     }
 
-    xmlOutputBufferClose (outbuf);
-
-    if (ferror (out) || fprintf (out, "</%s>\n", parent->name) < 0)
-    {
-        xmlFreeNode (parent);
+    if (!writer.flush () || fprintf (out, "</%s>\n", PRICEDB_TAG) < 0)
         return FALSE;
-    }
 
-    xmlFreeNode (parent);
     return TRUE;
 }
 
@@ -1160,14 +1202,11 @@ static int
 xml_add_trn_data (Transaction* t, gpointer data)
 {
     struct file_backend* be_data = static_cast<decltype (be_data)> (data);
-    xmlNodePtr node;
 
-    node = gnc_transaction_dom_tree_create (t);
+    gnc_transaction_xml_write (*be_data->writer, t);
+    be_data->writer->raw ("\n");
 
-    xmlElemDump (be_data->out, NULL, node);
-    xmlFreeNode (node);
-
-    if (ferror (be_data->out) || fprintf (be_data->out, "\n") < 0)
+    if (!be_data->writer->flush ())
         return -1;
 
     be_data->gd->counter.transactions_loaded++;
@@ -1179,9 +1218,11 @@ static gboolean
 write_transactions (FILE* out, QofBook* book, sixtp_gdv2* gd)
 {
     struct file_backend be_data;
+    GncXmlWriter writer {out};
 
     be_data.out = out;
     be_data.gd = gd;
+    be_data.writer = &writer;
     return 0 ==
            xaccAccountTreeForEachTransaction (gnc_book_get_root_account (book),
                                               xml_add_trn_data,
@@ -1194,8 +1235,11 @@ write_template_transaction_data (FILE* out, QofBook* book, sixtp_gdv2* gd)
     Account* ra;
     struct file_backend be_data;
 
+    GncXmlWriter writer {out};
+
     be_data.out = out;
     be_data.gd = gd;
+    be_data.writer = &writer;
 
     ra = gnc_book_get_template_root (book);
     if (gnc_account_n_descendants (ra) > 0)
@@ -1386,6 +1430,42 @@ gnc_book_write_accounts_to_xml_filehandle_v2 (QofBackend* qof_be, QofBook* book,
     return success;
 }
 
+static gint compression_level = Z_DEFAULT_COMPRESSION;
+static guint save_workers = 0;
+
+void
+gnc_xml_set_compression_level (gint level)
+{
+    g_return_if_fail (level >= Z_DEFAULT_COMPRESSION && level <= Z_BEST_COMPRESSION);
+    compression_level = level;
+}
+
+gint
+gnc_xml_get_compression_level (void)
+{
+    return compression_level;
+}
+
+void
+gnc_xml_set_save_workers (guint n_workers)
+{
+    save_workers = n_workers;
+}
+
+guint
+gnc_xml_get_save_workers (void)
+{
+    return save_workers;
+}
+
+static guint
+save_worker_count (void)
+{
+    if (save_workers)
+        return save_workers;
+    return std::max (std::thread::hardware_concurrency (), 1u);
+}
+
 static inline gzFile
 do_gzopen (const char* filename, const char* perms)
 {
@@ -1416,6 +1496,9 @@ do_gzopen (const char* filename, const char* perms)
 }
 
 constexpr uint32_t BUFLEN{4096};
+/* The parallel writer reads the pipe in bigger pieces, as it hands
+ * blocks of 128K to its workers. */
+constexpr uint32_t GZ_PIPE_BUFLEN{64 * 1024};
 
 static inline bool
 gz_thread_write (gzFile file, gz_thread_params_t* params)
@@ -1451,6 +1534,59 @@ gz_thread_write (gzFile file, gz_thread_params_t* params)
     return success;
 }
 
+/* Compresses what comes down the pipe on params->n_workers threads. */
+static bool
+gz_thread_write_parallel (gz_thread_params_t* params)
+{
+    bool success = true;
+    std::vector<gchar> buffer (GZ_PIPE_BUFLEN);
+
+    auto file = g_fopen (params->filename, "wb");
+    if (!file)
+    {
+        g_warning ("Could not open the compressed file '%s'. The error is '%s' (errno %d)",
+                   params->filename, g_strerror (errno), errno);
+        return false;
+    }
+
+    {
+        GncGzipWriter gz {file, params->level, params->n_workers};
+        while (success)
+        {
+            auto bytes = read (params->fd, buffer.data (), buffer.size ());
+            if (bytes > 0)
+            {
+                if (!gz.write (buffer.data (), bytes))
+                {
+                    g_warning ("Could not write the compressed file '%s'",
+                               params->filename);
+                    success = false;
+                }
+            }
+            else if (bytes == 0)
+            {
+                break;
+            }
+            else
+            {
+                g_warning ("Could not read from pipe. The error is '%s' (errno %d)",
+                           g_strerror (errno) ? g_strerror (errno) : "", errno);
+                success = false;
+            }
+        }
+        if (success && !gz.finish ())
+            success = false;
+    }
+
+    if (fclose (file) != 0)
+    {
+        g_warning ("Could not close the compressed file '%s'. The error is '%s' (errno %d)",
+                   params->filename, g_strerror (errno), errno);
+        success = false;
+    }
+    return success;
+}
+
 #if COMPILER(MSVC)
 #define WRITE_FN _write
 #else
@@ -1498,8 +1634,22 @@ gz_thread_func (gz_thread_params_t* params)
 {
     gint gzval;
     bool success = true;
+    gzFile file = nullptr;
+    gchar* perms = nullptr;
 
-    auto file = do_gzopen (params->filename, params->perms);
+    if (params->write && params->n_workers > 1)
+    {
+        success = gz_thread_write_parallel (params);
+        goto cleanup_gz_thread_func;
+    }
+
+    /* gzopen takes the compression level as a digit after the mode. */
+    if (params->write && params->level != Z_DEFAULT_COMPRESSION)
+        perms = g_strdup_printf ("%s%d", params->perms, params->level);
+    else
+        perms = g_strdup (params->perms);
+    file = do_gzopen (params->filename, perms);
+    g_free (perms);
 
     if (!file)
     {
@@ -1533,6 +1683,34 @@ cleanup_gz_thread_func:
     return GINT_TO_POINTER (success);
 }
 
+static bool
+make_pipe (int filedes[2])
+{
+#ifdef G_OS_WIN32
+    if (_pipe (filedes, 4096, _O_BINARY) < 0)
+    {
+#else
+    /* Set CLOEXEC on the pipe FDs so that if the user runs a
+     * report while saving WebKit's fork won't get an open copy
+     * and keep the pipe from closing. See
+     * https://bugs.gnucash.org/show_bug.cgi?id=798250. Win32
+     * doesn't fork nor does it support CLOEXEC.
+     */
+    if (pipe (filedes) < 0 ||
+        fcntl(filedes[0], F_SETFD, FD_CLOEXEC) == -1 ||
+        fcntl(filedes[1], F_SETFD, FD_CLOEXEC) == -1)
+    {
+#endif
+        if (filedes[0])
+        {
+            close(filedes[0]);
+            close(filedes[1]);
+        }
+        return false;
+    }
+    return true;
+}
+
 static std::pair<FILE*, GThread*>
 try_gz_open (const char* filename, const char* perms, gboolean compress,
              gboolean write)
@@ -1547,28 +1725,9 @@ try_gz_open (const char* filename, const char* perms, gboolean compress,
     {
         int filedes[2]{};
 
-#ifdef G_OS_WIN32
-        if (_pipe (filedes, 4096, _O_BINARY) < 0)
+        if (!make_pipe (filedes))
         {
-#else
-        /* Set CLOEXEC on the pipe FDs so that if the user runs a
-         * report while saving WebKit's fork won't get an open copy
-         * and keep the pipe from closing. See
-         * https://bugs.gnucash.org/show_bug.cgi?id=798250. Win32
-         * doesn't fork nor does it support CLOEXEC.
-         */
-        if (pipe (filedes) < 0 ||
-            fcntl(filedes[0], F_SETFD, FD_CLOEXEC) == -1 ||
-	    fcntl(filedes[1], F_SETFD, FD_CLOEXEC) == -1)
-        {
-#endif
             g_warning ("Pipe setup failed with errno %d. Opening uncompressed file.", errno);
-            if (filedes[0])
-            {
-                close(filedes[0]);
-                close(filedes[1]);
-            }
-
             return std::pair<FILE*, GThread*>(g_fopen (filename, perms),
                                               nullptr);
         }
@@ -1578,6 +1737,8 @@ try_gz_open (const char* filename, const char* perms, gboolean compress,
         params->filename = g_strdup (filename);
         params->perms = g_strdup (perms);
         params->write = write;
+        params->level = compression_level;
+        params->n_workers = write ? save_worker_count () : 1;
 
         auto thread = g_thread_new ("xml_thread", (GThreadFunc) gz_thread_func,
                                     params);
@@ -1629,6 +1790,75 @@ gnc_book_write_to_xml_file_v2 (QofBook* book, const char* filename,
     return success;
 }
 
+gboolean
+gnc_book_write_to_xml_string_v2 (QofBook* book, std::string& xml)
+{
+    int filedes[2]{};
+
+    xml.clear ();
+    if (!make_pipe (filedes))
+    {
+        g_warning ("Pipe setup failed with errno %d.", errno);
+        return FALSE;
+    }
+
+    /* Drain the pipe as it fills, so the book is written at the speed
+     * of memory. */
+    std::thread reader {[fd = filedes[0], &xml]
+    {
+        std::vector<gchar> buffer (GZ_PIPE_BUFLEN);
+        ssize_t bytes;
+        while ((bytes = read (fd, buffer.data (), buffer.size ())) != 0)
+        {
+            if (bytes > 0)
+                xml.append (buffer.data (), bytes);
+            else if (errno != EINTR)
+                break;
+        }
+        close (fd);
+    }};
+
+    gboolean success = FALSE;
+    auto out = fdopen (filedes[1], "w");
+    if (out)
+    {
+        success = gnc_book_write_to_xml_filehandle_v2 (book, out);
+        success = (fclose (out) == 0) && success;
+    }
+    else
+        close (filedes[1]);
+
+    reader.join ();
+    return success;
+}
+
+gboolean
+gnc_xml_write_string_to_file_v2 (const std::string& xml,
+                                 const char* filename, gboolean compress)
+{
+    auto file = g_fopen (filename, "wb");
+    if (!file)
+    {
+        g_warning ("Could not open the file '%s'. The error is '%s' (errno %d)",
+                   filename, g_strerror (errno), errno);
+        return FALSE;
+    }
+
+    gboolean success;
+    if (compress)
+    {
+        GncGzipWriter gz {file, compression_level, save_worker_count ()};
+        success = gz.write (xml.data (), xml.size ()) && gz.finish ();
+    }
+    else
+        success = fwrite (xml.data (), 1, xml.size (), file) == xml.size ();
+
+    success = (fclose (file) == 0) && success;
+    if (!success)
+        g_warning ("Could not write the file '%s'", filename);
+    return success;
+}
+
 /*
  * Have to pass in the backend as this routine needs the temporary
  * backend for file export, not the real backend which could be
@@ -41,6 +41,7 @@ extern "C"
 }
 #include "gnc-backend-xml.h"
 #include "sixtp.h"
+#include <string>
 #include <vector>
 
 class GncXmlBackend;
@@ -88,11 +89,59 @@ typedef struct
 gboolean qof_session_load_from_xml_file_v2 (GncXmlBackend*, QofBook*,
                                             QofBookFileType);
 
+/** Set how many threads qof_session_load_from_xml_file_v2() uses to
+ *  read a file: one parses it while the others decode its transactions.
+ *  0, the default, uses one thread per processor; 1 does all the work
+ *  on the calling thread.
+ *
+ *  @param n_workers The number of threads to use. */
+void gnc_xml_set_load_workers (guint n_workers);
+
+/** Get the number of threads qof_session_load_from_xml_file_v2() uses.
+ *
+ *  @return The value set with gnc_xml_set_load_workers(). */
+guint gnc_xml_get_load_workers (void);
+
+/** Set the zlib compression level gnc_book_write_to_xml_file_v2() uses
+ *  for compressed files.
+ *
+ *  @param level 0 (no compression) to 9 (smallest file), or -1, the
+ *  default, for zlib's own default. */
+void gnc_xml_set_compression_level (gint level);
+
+/** Get the compression level for compressed files.
+ *
+ *  @return The value set with gnc_xml_set_compression_level(). */
+gint gnc_xml_get_compression_level (void);
+
+/** Set how many threads gnc_book_write_to_xml_file_v2() compresses a
+ *  file on.  With more than one the file is deflated in independent
+ *  blocks; it is still an ordinary gzip file.  0, the default, uses one
+ *  thread per processor.
+ *
+ *  @param n_workers The number of threads to use. */
+void gnc_xml_set_save_workers (guint n_workers);
+
+/** Get the number of threads compressed files are written with.
+ *
+ *  @return The value set with gnc_xml_set_save_workers(). */
+guint gnc_xml_get_save_workers (void);
+
 /* write all book info to a file */
 gboolean gnc_book_write_to_xml_filehandle_v2 (QofBook* book, FILE* fh);
 gboolean gnc_book_write_to_xml_file_v2 (QofBook* book, const char* filename,
                                         gboolean compress);
 
+/** Write all book info into a string, as it would be written to a file
+ *  by gnc_book_write_to_xml_filehandle_v2(). */
+gboolean gnc_book_write_to_xml_string_v2 (QofBook* book, std::string& xml);
+/** Write a string made by gnc_book_write_to_xml_string_v2() to a file,
+ *  compressing it with the settings gnc_book_write_to_xml_file_v2() uses.
+ *  It doesn't touch the book, so it may run on any thread. */
+gboolean gnc_xml_write_string_to_file_v2 (const std::string& xml,
+                                          const char* filename,
+                                          gboolean compress);
+
 /** write just the commodities and accounts to a file */
 gboolean gnc_book_write_accounts_to_xml_filehandle_v2 (QofBackend* be,
                                                        QofBook* book, FILE* fh);
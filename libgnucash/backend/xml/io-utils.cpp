@@ -33,24 +33,19 @@ extern "C"
 #include "gnc-xml.h"
 #include "io-utils.h"
 #include "sixtp.h"
+#include "gnc-xml-writer.hpp"
 
 static gboolean
-write_one_account (FILE* out,
+write_one_account (GncXmlWriter& writer,
                    Account* account,
                    sixtp_gdv2* gd,
                    gboolean allow_incompat)
 {
-    xmlNodePtr accnode;
-
-    accnode =
-        gnc_account_dom_tree_create (account, gd && gd->exporting, allow_incompat);
-
-    xmlElemDump (out, NULL, accnode);
-    xmlFreeNode (accnode);
-
     g_return_val_if_fail(gd, FALSE);
 
-    if (ferror (out) || fprintf (out, "\n") < 0)
+    gnc_account_xml_write (writer, account, gd->exporting, allow_incompat);
+    writer.raw ("\n");
+    if (!writer.flush ())
         return FALSE;
 
     gd->counter.accounts_loaded++;
@@ -64,15 +59,16 @@ write_account_tree (FILE* out, Account* root, sixtp_gdv2* gd)
     GList* descendants, *node;
     gboolean allow_incompat = TRUE;
     gboolean success = TRUE;
+    GncXmlWriter writer {out};
 
     if (allow_incompat)
-        if (!write_one_account (out, root, gd, allow_incompat))
+        if (!write_one_account (writer, root, gd, allow_incompat))
             return FALSE;
 
     descendants = gnc_account_get_descendants (root);
     for (node = descendants; node; node = g_list_next (node))
     {
-        if (!write_one_account (out, static_cast<Account*> (node->data),
+        if (!write_one_account (writer, static_cast<Account*> (node->data),
                                 gd, allow_incompat))
         {
             success = FALSE;
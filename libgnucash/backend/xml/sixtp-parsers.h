@@ -35,4 +35,18 @@ sixtp* sixtp_dom_parser_new (sixtp_end_handler ender,
                              sixtp_result_handler cleanup_result_by_default_func,
                              sixtp_result_handler cleanup_result_on_fail_func);
 
+/* Create a parser that gets the SAX events of the entire sub-tree
+   without building a DOM tree: it is its own child parser, so every
+   handler is called for the top-level element and for all of its
+   descendants.  The handlers can tell the top-level element by its
+   NULL parent_data, as long as they hand on a non-NULL
+   data_for_children.
+*/
+sixtp* sixtp_stream_parser_new (sixtp_start_handler starter,
+                                sixtp_characters_handler chars,
+                                sixtp_end_handler ender,
+                                sixtp_fail_handler failer,
+                                sixtp_result_handler cleanup_result_by_default_func,
+                                sixtp_result_handler cleanup_result_on_fail_func);
+
 #endif /* _SIXTP_PARSERS_H_ */
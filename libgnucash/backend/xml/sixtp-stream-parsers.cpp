@@ -0,0 +1,327 @@
+/********************************************************************
+ * sixtp-stream-parsers.cpp: convert XML elements from SAX events   *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ ********************************************************************/
+#include <glib.h>
+
+extern "C"
+{
+#include <config.h>
+
+#include <string.h>
+
+#include <gnc-engine.h>
+}
+
+#include "sixtp.h"
+#include "sixtp-parsers.h"
+#include "sixtp-stream-parsers.hpp"
+
+static QofLogModule log_module = GNC_MOD_IO;
+
+static void
+set_tree_props (xmlNodePtr node, gchar** attrs)
+{
+    if (!attrs) return;
+    for (gchar** atptr = attrs; *atptr; atptr += 2)
+        xmlSetProp (node, checked_char_cast (atptr[0]),
+                    checked_char_cast (atptr[1]));
+}
+
+void
+SixtpStreamField::clear ()
+{
+    if (m_tree)
+        xmlFreeNode (m_tree);
+    m_tree = m_tree_current = nullptr;
+    m_tag.clear ();
+    m_has_attr = false;
+    m_attr_name.clear ();
+    m_attr_value.clear ();
+    m_text.clear ();
+    m_lead_text.clear ();
+    m_has_children = m_has_elements = false;
+    m_depth = 0;
+    m_date = m_space = m_id = Child ();
+    m_child = nullptr;
+}
+
+xmlNodePtr
+SixtpStreamField::release_tree ()
+{
+    auto tree = m_tree;
+    m_tree = m_tree_current = nullptr;
+    return tree;
+}
+
+void
+SixtpStreamField::start (const gchar* tag, gchar** attrs, bool build_tree)
+{
+    clear ();
+    m_tag = tag;
+    if (attrs && attrs[0])
+    {
+        m_has_attr = true;
+        m_attr_name = attrs[0];
+        m_attr_value = attrs[1] ? attrs[1] : "";
+    }
+    if (build_tree)
+    {
+        m_tree = m_tree_current = xmlNewNode (NULL, BAD_CAST tag);
+        set_tree_props (m_tree, attrs);
+    }
+}
+
+void
+SixtpStreamField::element_start (const gchar* tag, gchar** attrs)
+{
+    if (m_tree)
+    {
+        m_tree_current = xmlNewChild (m_tree_current, NULL, BAD_CAST tag, NULL);
+        set_tree_props (m_tree_current, attrs);
+    }
+
+    if (++m_depth == 1)
+    {
+        m_has_children = m_has_elements = true;
+        if (g_strcmp0 (tag, "ts:date") == 0)
+            m_child = &m_date;
+        else if (g_strcmp0 (tag, "cmdty:space") == 0)
+            m_child = &m_space;
+        else if (g_strcmp0 (tag, "cmdty:id") == 0)
+            m_child = &m_id;
+        else
+            m_child = nullptr;
+
+        /* A repeated child makes the conversion fail, so there is no
+         * point in collecting its text. */
+        if (m_child && ++m_child->count > 1)
+            m_child = nullptr;
+    }
+    else if (m_depth == 2 && m_child)
+    {
+        m_child->has_children = true;
+    }
+}
+
+void
+SixtpStreamField::element_end ()
+{
+    if (m_tree && m_tree_current != m_tree)
+        m_tree_current = m_tree_current->parent;
+    if (m_depth == 1)
+        m_child = nullptr;
+    if (m_depth > 0)
+        --m_depth;
+}
+
+void
+SixtpStreamField::chars (const gchar* text, int length)
+{
+    if (length <= 0) return;
+
+    if (m_tree)
+        xmlNodeAddContentLen (m_tree_current, BAD_CAST text, length);
+
+    if (m_depth == 0)
+    {
+        m_has_children = true;
+        m_text.append (text, length);
+        if (!m_has_elements)
+            m_lead_text.append (text, length);
+    }
+    else if (m_depth == 1 && m_child)
+    {
+        m_child->has_children = true;
+        m_child->text.append (text, length);
+    }
+}
+
+gchar*
+SixtpStreamField::to_text () const
+{
+    if (!m_has_children)
+        return g_strdup ("");
+    if (m_text.empty ())
+        return NULL;
+    return g_strdup (m_text.c_str ());
+}
+
+gboolean
+SixtpStreamField::to_guid (GncGUID* guid, gboolean* parsed) const
+{
+    if (!m_has_attr)
+        return FALSE;
+
+    if (m_attr_name != "type")
+    {
+        PERR ("Unknown attribute for id tag: %s", m_attr_name.c_str ());
+        return FALSE;
+    }
+
+    if (m_attr_value != "guid" && m_attr_value != "new")
+    {
+        PERR ("Unknown type %s for attribute type for tag %s",
+              m_attr_value.c_str (), m_attr_name.c_str ());
+        return FALSE;
+    }
+
+    *parsed = string_to_guid (m_lead_text.empty () ? NULL :
+                              m_lead_text.c_str (), guid);
+    return TRUE;
+}
+
+GncGUID*
+SixtpStreamField::to_guid () const
+{
+    GncGUID guid;
+    gboolean parsed;
+
+    if (!to_guid (&guid, &parsed))
+        return NULL;
+
+    auto gid = guid_new ();
+    if (parsed)
+        *gid = guid;
+    return gid;
+}
+
+time64
+SixtpStreamField::to_time64 () const
+{
+    if (m_date.count == 0)
+    {
+        PERR ("no ts:date node found.");
+        return INT64_MAX;
+    }
+    if (m_date.count > 1 || !m_date.text_ok ())
+        return INT64_MAX;
+    return gnc_iso8601_to_time64_gmt (m_date.text.c_str ());
+}
+
+gnc_numeric*
+SixtpStreamField::to_gnc_numeric () const
+{
+    gchar* content = to_text ();
+    if (!content)
+        return NULL;
+
+    gnc_numeric* ret = g_new (gnc_numeric, 1);
+    if (!string_to_gnc_numeric (content, ret))
+        *ret = gnc_numeric_zero ();
+    g_free (content);
+    return ret;
+}
+
+gboolean
+SixtpStreamField::to_commodity_strings (std::string& space,
+                                        std::string& id) const
+{
+    if (!m_has_children ||
+        m_space.count != 1 || !m_space.text_ok () ||
+        m_id.count != 1 || !m_id.text_ok ())
+    {
+        PERR ("Bad commodity reference in %s", m_tag.c_str ());
+        return FALSE;
+    }
+
+    space = m_space.text;
+    id = m_id.text;
+    return TRUE;
+}
+
+gnc_commodity*
+SixtpStreamField::to_commodity_ref (QofBook* book) const
+{
+    std::string space_str, id_str;
+
+    if (!to_commodity_strings (space_str, id_str))
+        return NULL;
+
+    gchar* space = g_strdup (space_str.c_str ());
+    gchar* id = g_strdup (id_str.c_str ());
+    auto ret = gnc_xml_commodity_ref_lookup (book, space, id);
+    g_free (space);
+    g_free (id);
+    return ret;
+}
+
+gnc_commodity*
+gnc_xml_commodity_ref_lookup (QofBook* book, gchar* space, gchar* id)
+{
+    gnc_commodity_table* table = gnc_commodity_table_get_table (book);
+    g_return_val_if_fail (table != NULL, NULL);
+
+    g_strstrip (space);
+    g_strstrip (id);
+
+    /* gnc_commodity_new only allows the template commodity itself in the
+     * template namespace. */
+    const gchar* name_space = space;
+    if (g_strcmp0 (name_space, GNC_COMMODITY_NS_TEMPLATE) == 0 &&
+        g_strcmp0 (id, "template") != 0)
+        name_space = "User";
+
+    /* Referring to a namespace creates it, as it did when the reference
+     * was made into a commodity. */
+    gnc_commodity_table_add_namespace (table, name_space, book);
+    auto ret = gnc_commodity_table_lookup (table, name_space, id);
+    if (!ret)
+        PERR ("Unknown commodity %s:%s", name_space, id);
+    return ret;
+}
+
+sixtp*
+sixtp_stream_parser_new (sixtp_start_handler starter,
+                         sixtp_characters_handler chars,
+                         sixtp_end_handler ender,
+                         sixtp_fail_handler failer,
+                         sixtp_result_handler cleanup_result_by_default_func,
+                         sixtp_result_handler cleanup_result_on_fail_func)
+{
+    sixtp* top_level;
+
+    g_return_val_if_fail (starter && ender, NULL);
+
+    if (! (top_level =
+               sixtp_set_any (sixtp_new (), FALSE,
+                              SIXTP_START_HANDLER_ID, starter,
+                              SIXTP_CHARACTERS_HANDLER_ID, chars,
+                              SIXTP_END_HANDLER_ID, ender,
+                              SIXTP_FAIL_HANDLER_ID, failer,
+                              SIXTP_NO_MORE_HANDLERS)))
+    {
+        return NULL;
+    }
+
+    if (cleanup_result_by_default_func)
+        sixtp_set_cleanup_result (top_level, cleanup_result_by_default_func);
+
+    if (cleanup_result_on_fail_func)
+        sixtp_set_result_fail (top_level, cleanup_result_on_fail_func);
+
+    if (!sixtp_add_sub_parser (top_level, SIXTP_MAGIC_CATCHER, top_level))
+    {
+        sixtp_destroy (top_level);
+        return NULL;
+    }
+
+    return top_level;
+}
@@ -0,0 +1,124 @@
+/********************************************************************
+ * sixtp-stream-parsers.hpp: convert XML elements from SAX events   *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ ********************************************************************/
+
+#ifndef SIXTP_STREAM_PARSERS_HPP
+#define SIXTP_STREAM_PARSERS_HPP
+
+extern "C"
+{
+#include <glib.h>
+
+#include "gnc-commodity.h"
+#include "qof.h"
+}
+
+#include <string>
+
+#include "gnc-xml-helper.h"
+
+/** Collects one field element, e.g. <split:value> or <trn:date-posted>,
+ * while its SAX events go by and converts it the same way the matching
+ * dom_tree_to_* function converts the element's DOM tree.  Only the
+ * parts those converters look at are kept: the first attribute, the
+ * element's own text and the text of <ts:date>, <cmdty:space> and
+ * <cmdty:id> children.  Fields which need the whole subtree, i.e. slots,
+ * are started with build_tree and can then be handed to the DOM code
+ * through tree().
+ *
+ * Call start() for the field's own start tag, then element_start(),
+ * element_end() and chars() for everything inside it.
+ */
+class SixtpStreamField
+{
+public:
+    SixtpStreamField () = default;
+    SixtpStreamField (const SixtpStreamField&) = delete;
+    SixtpStreamField& operator= (const SixtpStreamField&) = delete;
+    ~SixtpStreamField () { clear (); }
+
+    void start (const gchar* tag, gchar** attrs, bool build_tree = false);
+    void element_start (const gchar* tag, gchar** attrs);
+    void element_end ();
+    void chars (const gchar* text, int length);
+    /** Frees the tree, if any, and forgets the field. */
+    void clear ();
+
+    const std::string& tag () const { return m_tag; }
+    const xmlChar* name () const { return BAD_CAST m_tag.c_str (); }
+    bool has_children () const { return m_has_children; }
+    xmlNodePtr tree () const { return m_tree; }
+    /** Hands the tree over to the caller. */
+    xmlNodePtr release_tree ();
+
+    /* These follow dom_tree_to_text, dom_tree_to_guid, ..., including
+     * their return conventions. */
+    gchar* to_text () const;
+    GncGUID* to_guid () const;
+    time64 to_time64 () const;
+    gnc_numeric* to_gnc_numeric () const;
+    gnc_commodity* to_commodity_ref (QofBook* book) const;
+
+    /* The parts of to_guid and to_commodity_ref that don't touch the
+     * engine, so that fields can be converted away from the main thread.
+     * Both return FALSE where the full conversion gives NULL.  A GUID
+     * that doesn't parse leaves *parsed FALSE; to_guid then makes up a
+     * new one. */
+    gboolean to_guid (GncGUID* guid, gboolean* parsed) const;
+    gboolean to_commodity_strings (std::string& space, std::string& id) const;
+
+private:
+    struct Child
+    {
+        int count = 0;
+        bool has_children = false;
+        std::string text;
+        /* dom_tree_to_text gives NULL for a child with only elements. */
+        bool text_ok () const { return !has_children || !text.empty (); }
+    };
+
+    std::string m_tag;
+    bool m_has_attr = false;
+    std::string m_attr_name;
+    std::string m_attr_value;
+    std::string m_text;
+    /* The text ahead of the first child element, which is what
+     * dom_tree_to_guid reads. */
+    std::string m_lead_text;
+    bool m_has_children = false;
+    bool m_has_elements = false;
+    int m_depth = 0;
+    Child m_date;
+    Child m_space;
+    Child m_id;
+    Child* m_child = nullptr;
+    xmlNodePtr m_tree = nullptr;
+    xmlNodePtr m_tree_current = nullptr;
+};
+
+/** Look up the commodity that a <cmdty:space>/<cmdty:id> pair refers to
+ * without creating a throwaway gnc_commodity for it, as
+ * dom_tree_to_commodity_ref does.  The space and id are stripped in
+ * place. */
+gnc_commodity* gnc_xml_commodity_ref_lookup (QofBook* book, gchar* space,
+                                             gchar* id);
+
+#endif /* SIXTP_STREAM_PARSERS_HPP */
@@ -798,6 +798,24 @@ sixtp_parse_fd (sixtp* sixtp,
     return ret;
 }
 
+gboolean
+sixtp_parse_io (sixtp* sixtp,
+                xmlInputReadCallback read_cb,
+                void* read_context,
+                gpointer data_for_top_level,
+                gpointer global_data,
+                gpointer* parse_result)
+{
+    gboolean ret;
+    xmlParserCtxtPtr context = xmlCreateIOParserCtxt (NULL, NULL,
+                                                      read_cb, NULL /*no close */,
+                                                      read_context,
+                                                      XML_CHAR_ENCODING_NONE);
+    ret = sixtp_parse_file_common (sixtp, context, data_for_top_level,
+                                   global_data, parse_result);
+    return ret;
+}
+
 gboolean
 sixtp_parse_buffer (sixtp* sixtp,
                     char* bufp,
@@ -71,6 +71,8 @@ struct sixtp_gdv2
     countCallbackFn countCallback;
     QofBePercentageFunc gui_display_fn;
     gboolean exporting;
+    /* The GncXmlParallelLoad feeding the parser, if any. */
+    gpointer parallel_load;
 };
 typedef struct _sixtp_child_result sixtp_child_result;
 
@@ -227,6 +229,9 @@ gboolean sixtp_parse_file (sixtp* sixtp, const char* filename,
 gboolean sixtp_parse_fd (sixtp* sixtp, FILE* fd,
                          gpointer data_for_top_level, gpointer global_data,
                          gpointer* parse_result);
+gboolean sixtp_parse_io (sixtp* sixtp, xmlInputReadCallback read_cb,
+                         void* read_context, gpointer data_for_top_level,
+                         gpointer global_data, gpointer* parse_result);
 gboolean sixtp_parse_buffer (sixtp* sixtp, char* bufp, int bufsz,
                              gpointer data_for_top_level, gpointer global_data,
                              gpointer* parse_result);
@@ -0,0 +1,110 @@
+/********************************************************************
+ * bench-xml-save-compressed.cpp: Time saving compressed XML files. *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+/* Saves a generated book compressed on one thread and on several at a
+ * few compression levels and reports how fast each save is.
+ */
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+extern "C"
+{
+#include <config.h>
+#include <zlib.h>
+#include "qof.h"
+#include "cashobjects.h"
+#include "TransLog.h"
+}
+
+#include "io-gncxml-v2.h"
+#include "test-file-stuff.h"
+
+#define NUM_ACCOUNTS 50
+#define NUM_TRANSACTIONS 20000
+#define NUM_WORKERS 4
+
+using Clock = std::chrono::steady_clock;
+
+static void
+run_benchmark (void)
+{
+    auto book = qof_book_new ();
+    g_list_free (make_book (book, NUM_ACCOUNTS, NUM_TRANSACTIONS));
+
+    auto filename = g_build_filename (g_get_tmp_dir (),
+                                      "bench-xml-save-compressed.gnucash", NULL);
+    auto old_level = gnc_xml_get_compression_level ();
+    auto old_workers = gnc_xml_get_save_workers ();
+    std::string serial_text;
+
+    for (auto level : {Z_DEFAULT_COMPRESSION, 1, 9})
+    {
+        gnc_xml_set_compression_level (level);
+        for (auto n_workers : {1u, (guint)NUM_WORKERS})
+        {
+            gnc_xml_set_save_workers (n_workers);
+            auto start = Clock::now ();
+            auto ok = gnc_book_write_to_xml_file_v2 (book, filename, TRUE);
+            std::chrono::duration<double> time = Clock::now () - start;
+
+            GStatBuf statbuf;
+            std::string text;
+            ok = ok && g_stat (filename, &statbuf) == 0 &&
+                 read_gzip (filename, text);
+            if (n_workers == 1)
+                serial_text = text;
+            if (!ok || text != serial_text)
+                printf ("Level %2d, %u threads: the file didn't read back\n",
+                        level, n_workers);
+            else
+                printf ("Level %2d, %u thread%s: %.1f MB in %.0f ms, %.1f MB/s,"
+                        " %.1f MB on disk\n", level, n_workers,
+                        n_workers == 1 ? ", gzwrite" : "s",
+                        text.size () / 1e6, time.count () * 1000,
+                        text.size () / 1e6 / time.count (),
+                        statbuf.st_size / 1e6);
+        }
+    }
+
+    gnc_xml_set_compression_level (old_level);
+    gnc_xml_set_save_workers (old_workers);
+    g_unlink (filename);
+    g_free (filename);
+    qof_book_destroy (book);
+}
+
+int
+main (int argc, char** argv)
+{
+    qof_init ();
+    if (cashobjects_register ())
+    {
+        xaccLogDisable ();
+        run_benchmark ();
+    }
+    qof_close ();
+    return 0;
+}
@@ -0,0 +1,198 @@
+/********************************************************************
+ * bench-xml-save-speed.cpp: Time writing transactions as XML.      *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+/* Writes the transactions of a generated book once through
+ * gnc_transaction_dom_tree_create and xmlElemDump and once through
+ * gnc_transaction_xml_write, and reports the time each takes and how
+ * many allocations libxml makes.
+ */
+#include <glib.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+extern "C"
+{
+#include <config.h>
+#include "qof.h"
+#include "cashobjects.h"
+#include "Transaction.h"
+#include "TransLog.h"
+}
+
+#include "gnc-xml-helper.h"
+#include "gnc-xml.h"
+#include "gnc-xml-writer.hpp"
+#include "test-file-stuff.h"
+#include "test-stuff.h"
+
+#define NUM_ACCOUNTS 50
+#define NUM_TRANSACTIONS 20000
+
+using Clock = std::chrono::steady_clock;
+
+/* libxml allocation counts, through xmlMemSetup. */
+static guint64 n_allocs = 0;
+static gint64 n_live = 0;
+static gint64 peak_live = 0;
+
+static void
+count_alloc (void)
+{
+    n_allocs++;
+    if (++n_live > peak_live)
+        peak_live = n_live;
+}
+
+static void*
+counting_malloc (size_t size)
+{
+    count_alloc ();
+    return malloc (size);
+}
+
+static void*
+counting_realloc (void* mem, size_t size)
+{
+    n_allocs++;
+    if (!mem)
+        count_alloc ();
+    return realloc (mem, size);
+}
+
+static char*
+counting_strdup (const char* str)
+{
+    count_alloc ();
+    return strdup (str);
+}
+
+static void
+counting_free (void* mem)
+{
+    if (mem)
+        n_live--;
+    free (mem);
+}
+
+static void
+reset_counts (void)
+{
+    n_allocs = 0;
+    n_live = 0;
+    peak_live = 0;
+}
+
+static gchar*
+read_back (FILE* file)
+{
+    GString* contents = g_string_new (NULL);
+    char buf[4096];
+    size_t len;
+
+    fflush (file);
+    rewind (file);
+    while ((len = fread (buf, 1, sizeof (buf), file)) > 0)
+        g_string_append_len (contents, buf, len);
+    return g_string_free (contents, FALSE);
+}
+
+static void
+run_test (void)
+{
+    auto book = qof_book_new ();
+    auto transactions = make_book (book, NUM_ACCOUNTS, NUM_TRANSACTIONS);
+
+    FILE* dom_file = tmpfile ();
+    reset_counts ();
+    auto start = Clock::now ();
+    for (auto node = transactions; node; node = node->next)
+    {
+        auto tree = gnc_transaction_dom_tree_create (
+                        static_cast<Transaction*> (node->data));
+        xmlElemDump (dom_file, NULL, tree);
+        xmlFreeNode (tree);
+        fprintf (dom_file, "\n");
+    }
+    fflush (dom_file);
+    std::chrono::duration<double, std::milli> dom_time = Clock::now () - start;
+    auto dom_allocs = n_allocs;
+    auto dom_peak = peak_live;
+
+    FILE* writer_file = tmpfile ();
+    reset_counts ();
+    start = Clock::now ();
+    {
+        GncXmlWriter writer {writer_file};
+        for (auto node = transactions; node; node = node->next)
+        {
+            gnc_transaction_xml_write (writer,
+                                       static_cast<Transaction*> (node->data));
+            writer.raw ("\n");
+        }
+        writer.flush ();
+    }
+    fflush (writer_file);
+    std::chrono::duration<double, std::milli> writer_time = Clock::now () - start;
+    auto writer_allocs = n_allocs;
+    auto writer_peak = peak_live;
+
+    auto dom_text = read_back (dom_file);
+    auto writer_text = read_back (writer_file);
+    do_test (g_strcmp0 (dom_text, writer_text) == 0,
+             "GncXmlWriter output matches xmlElemDump");
+
+    printf ("%d transactions, %zu bytes:\n"
+            "  DOM tree + xmlElemDump: %.1f ms, %" G_GUINT64_FORMAT
+            " libxml allocations, at most %" G_GINT64_FORMAT " live\n"
+            "  GncXmlWriter:           %.1f ms, %" G_GUINT64_FORMAT
+            " libxml allocations, at most %" G_GINT64_FORMAT " live\n",
+            NUM_TRANSACTIONS, strlen (writer_text),
+            dom_time.count (), dom_allocs, dom_peak,
+            writer_time.count (), writer_allocs, writer_peak);
+
+    g_free (dom_text);
+    g_free (writer_text);
+    fclose (dom_file);
+    fclose (writer_file);
+    g_list_free (transactions);
+    qof_book_destroy (book);
+}
+
+int
+main (int argc, char** argv)
+{
+    /* Before libxml allocates anything. */
+    xmlMemSetup (counting_free, counting_malloc, counting_realloc,
+                 counting_strdup);
+    qof_init ();
+    if (cashobjects_register ())
+    {
+        xaccLogDisable ();
+        run_test ();
+        print_test_results ();
+    }
+    qof_close ();
+    return get_rv ();
+}
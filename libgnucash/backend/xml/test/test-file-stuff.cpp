@@ -34,8 +34,11 @@ extern "C"
 #include <dirent.h>
 #include <fcntl.h>
 #include <string.h>
+#include <zlib.h>
 
 #include "gnc-engine.h"
+#include "Account.h"
+#include "Transaction.h"
 #include "test-stuff.h"
 }
 
@@ -106,6 +109,46 @@ write_dom_node_to_file (xmlNodePtr node, int fd)
     fclose (out);
 }
 
+static gchar*
+read_back (FILE* file)
+{
+    GString* contents = g_string_new (NULL);
+    char buf[4096];
+    size_t len;
+
+    rewind (file);
+    while ((len = fread (buf, 1, sizeof (buf), file)) > 0)
+        g_string_append_len (contents, buf, len);
+    fclose (file);
+    return g_string_free (contents, FALSE);
+}
+
+gboolean
+writer_matches_dom_node (xmlNodePtr node,
+                         const std::function<void (GncXmlWriter&)>& write)
+{
+    FILE* dom_file = tmpfile ();
+    FILE* writer_file = tmpfile ();
+    gboolean ret;
+
+    xmlElemDump (dom_file, NULL, node);
+    {
+        GncXmlWriter writer {writer_file};
+        write (writer);
+        writer.flush ();
+    }
+
+    gchar* dom_text = read_back (dom_file);
+    gchar* writer_text = read_back (writer_file);
+    ret = g_strcmp0 (dom_text, writer_text) == 0;
+    if (!ret)
+        printf ("xmlElemDump wrote\n%s\nGncXmlWriter wrote\n%s\n",
+                dom_text, writer_text);
+    g_free (dom_text);
+    g_free (writer_text);
+    return ret;
+}
+
 gboolean
 print_dom_tree (gpointer data_for_children, GSList* data_from_children,
                 GSList* sibling_data, gpointer parent_data,
@@ -396,3 +439,81 @@ test_files_in_dir (int argc, char** argv, gxpf_callback cb,
 
     sixtp_destroy (top_parser);
 }
+
+GList*
+make_book (QofBook* book, int n_accounts, int n_transactions)
+{
+    auto comm = gnc_commodity_new (book, "US Dollar", "CURRENCY", "USD",
+                                   "840", 100);
+    comm = gnc_commodity_table_insert (gnc_commodity_table_get_table (book),
+                                       comm);
+    auto root = gnc_book_get_root_account (book);
+    auto accounts = g_new (Account*, n_accounts);
+    GList* transactions = NULL;
+
+    for (int i = 0; i < n_accounts; i++)
+    {
+        auto name = g_strdup_printf ("Account %d", i);
+        accounts[i] = xaccMallocAccount (book);
+        xaccAccountBeginEdit (accounts[i]);
+        xaccAccountSetName (accounts[i], name);
+        xaccAccountSetCommodity (accounts[i], comm);
+        gnc_account_append_child (root, accounts[i]);
+        xaccAccountCommitEdit (accounts[i]);
+        g_free (name);
+    }
+
+    for (int i = 0; i < n_transactions; i++)
+    {
+        auto trans = xaccMallocTransaction (book);
+        auto amount = gnc_numeric_create ((i * 7919) % 1000000 + 1, 100);
+        auto description = g_strdup_printf ("Payment %d to Smith & Sons <%d>",
+                                            i, i % 97);
+        auto num = g_strdup_printf ("%d", i);
+
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, comm);
+        xaccTransSetDatePostedSecsNormalized (trans, 86400 * (i + 1));
+        xaccTransSetDateEnteredSecs (trans, 86400 * (i + 1) + 3600);
+        xaccTransSetDescription (trans, description);
+        xaccTransSetNum (trans, num);
+        if (i % 10 == 0)
+            xaccTransSetNotes (trans, "Checked against the statement");
+
+        for (int j = 0; j < 2; j++)
+        {
+            auto split = xaccMallocSplit (book);
+            xaccSplitSetParent (split, trans);
+            xaccSplitSetAccount (split, accounts[(i + j * 7) % n_accounts]);
+            xaccSplitSetAmount (split, j ? gnc_numeric_neg (amount) : amount);
+            xaccSplitSetValue (split, j ? gnc_numeric_neg (amount) : amount);
+            if (i % 3 == 0)
+                xaccSplitSetMemo (split, "Monthly");
+            if (i % 2)
+                xaccSplitSetReconcile (split, CREC);
+        }
+        xaccTransCommitEdit (trans);
+
+        transactions = g_list_prepend (transactions, trans);
+        g_free (description);
+        g_free (num);
+    }
+
+    g_free (accounts);
+    return g_list_reverse (transactions);
+}
+
+bool
+read_gzip (const char* filename, std::string& contents)
+{
+    auto file = gzopen (filename, "rb");
+    if (!file)
+        return false;
+
+    char buf[65536];
+    int len;
+    contents.clear ();
+    while ((len = gzread (file, buf, sizeof (buf))) > 0)
+        contents.append (buf, len);
+    return gzclose (file) == Z_OK && len == 0;
+}
@@ -34,6 +34,10 @@ extern "C"
 #include <gnc-xml-helper.h>
 #include <io-gncxml-gen.h>
 #include <sixtp.h>
+#include <gnc-xml-writer.hpp>
+
+#include <functional>
+#include <string>
 
 #ifndef __KVP_FRAME
 typedef struct KvpFrameImpl KvpFrame;
@@ -41,6 +45,9 @@ typedef struct KvpFrameImpl KvpFrame;
 #endif
 
 void write_dom_node_to_file (xmlNodePtr node, int fd);
+/* Whether write writes what xmlElemDump writes for node. */
+gboolean writer_matches_dom_node (xmlNodePtr node,
+                                  const std::function<void (GncXmlWriter&)>& write);
 
 int files_compare (const gchar* f1, const gchar* f2);
 
@@ -65,4 +72,11 @@ void
 test_files_in_dir (int argc, char** argv, gxpf_callback cb,
                    sixtp* parser, const char* parser_tag,
                    QofBook* book);
+
+/* Fills book with n_accounts accounts under the root and n_transactions
+ * two split transactions between them, the same every time. Returns
+ * the transactions in the order they were made; free the list. */
+GList* make_book (QofBook* book, int n_accounts, int n_transactions);
+/* Reads a gzip file back whole. */
+bool read_gzip (const char* filename, std::string& contents);
 #endif
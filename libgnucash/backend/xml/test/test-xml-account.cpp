@@ -272,6 +272,12 @@ test_account (int i, Account* test_act)
         success ("account_xml");
     }
 
+    do_test (writer_matches_dom_node (test_node,
+                                      [test_act] (GncXmlWriter& writer)
+    {
+        gnc_account_xml_write (writer, test_act, FALSE, TRUE);
+    }), "gnc_account_xml_write matches the DOM tree");
+
     filename1 = g_strdup_printf ("test_file_XXXXXX");
 
     fd = g_mkstemp (filename1);
@@ -0,0 +1,164 @@
+/********************************************************************
+ * test-xml-background-save.cpp: Test saving XML in the background. *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+/* Saves a book in the background, changes it while the save is being
+ * written and checks that the file holds the book as it was when the
+ * save started.
+ */
+#include <glib.h>
+#include <glib/gstdio.h>
+
+extern "C"
+{
+#include <config.h>
+#include <cashobjects.h>
+#include <TransLog.h>
+#include <gnc-engine.h>
+#include <gnc-prefs.h>
+}
+
+#include <test-stuff.h>
+
+#define GNC_LIB_NAME "gncmod-backend-xml"
+#define GNC_LIB_REL_PATH "xml"
+
+static void
+add_accounts (QofBook* book, int n_accounts)
+{
+    auto root = gnc_book_get_root_account (book);
+    auto n_existing = gnc_account_n_descendants (root);
+
+    for (int i = 0; i < n_accounts; i++)
+    {
+        auto name = g_strdup_printf ("Account %d", n_existing + i);
+        auto account = xaccMallocAccount (book);
+        xaccAccountBeginEdit (account);
+        xaccAccountSetName (account, name);
+        gnc_account_append_child (root, account);
+        xaccAccountCommitEdit (account);
+        g_free (name);
+    }
+}
+
+static int
+saved_account_count (const char* filename)
+{
+    auto book = qof_book_new ();
+    auto session = qof_session_new (book);
+    int n_accounts = -1;
+
+    qof_session_begin (session, filename, SESSION_READ_ONLY);
+    if (qof_session_pop_error (session) == ERR_BACKEND_NO_ERR)
+    {
+        qof_session_load (session, NULL);
+        if (qof_session_pop_error (session) == ERR_BACKEND_NO_ERR)
+            n_accounts = gnc_account_n_descendants (gnc_book_get_root_account (book));
+    }
+    qof_session_destroy (session);
+    return n_accounts;
+}
+
+static void
+remove_dir (const char* dirname)
+{
+    auto dir = g_dir_open (dirname, 0, NULL);
+    if (!dir)
+        return;
+
+    const char* entry;
+    while ((entry = g_dir_read_name (dir)) != NULL)
+    {
+        auto name = g_build_filename (dirname, entry, NULL);
+        g_unlink (name);
+        g_free (name);
+    }
+    g_dir_close (dir);
+    g_rmdir (dirname);
+}
+
+static void
+test_background_save (gboolean compress)
+{
+    auto dirname = g_dir_make_tmp ("test-xml-background-save-XXXXXX", NULL);
+    auto filename = g_build_filename (dirname, "book.gnucash", NULL);
+    auto book = qof_book_new ();
+    auto session = qof_session_new (book);
+
+    gnc_prefs_set_file_save_compressed (compress);
+    qof_session_begin (session, filename, SESSION_NEW_OVERWRITE);
+    do_test (qof_session_pop_error (session) == ERR_BACKEND_NO_ERR,
+             "Begin the session");
+
+    add_accounts (book, 10);
+    qof_session_save (session, NULL);
+    do_test (qof_session_get_error (session) == ERR_BACKEND_NO_ERR,
+             "Start saving in the background");
+    do_test (!qof_book_session_not_saved (book),
+             "The book is clean once the save has started");
+
+    /* Not in the file being written. */
+    add_accounts (book, 5);
+    do_test (qof_book_session_not_saved (book),
+             "Changes during the save make the book dirty");
+
+    qof_session_wait_for_save (session);
+    do_test (qof_session_get_error (session) == ERR_BACKEND_NO_ERR,
+             "The background save succeeds");
+    do_test (!qof_session_save_in_progress (session),
+             "The save is over after waiting for it");
+    do_test (saved_account_count (filename) == 10,
+             "The file holds the book as it was when the save started");
+
+    qof_session_save (session, NULL);
+    while (qof_session_save_in_progress (session))
+        g_usleep (1000);
+    do_test (qof_session_get_error (session) == ERR_BACKEND_NO_ERR,
+             "The second background save succeeds");
+    do_test (saved_account_count (filename) == 15,
+             "The second save has the later changes");
+
+    qof_session_end (session);
+    qof_session_destroy (session);
+    remove_dir (dirname);
+    g_free (filename);
+    g_free (dirname);
+}
+
+int
+main (int argc, char** argv)
+{
+    g_setenv ("GNC_UNINSTALLED", "1", TRUE);
+    qof_init ();
+    cashobjects_register ();
+    do_test (qof_load_backend_library (GNC_LIB_REL_PATH, GNC_LIB_NAME),
+             " loading gnc-backend-xml GModule failed");
+    xaccLogDisable ();
+
+    gnc_prefs_set_file_save_in_background (TRUE);
+    test_background_save (TRUE);
+    test_background_save (FALSE);
+    gnc_prefs_set_file_save_in_background (FALSE);
+
+    print_test_results ();
+    qof_close ();
+    return get_rv ();
+}
@@ -0,0 +1,196 @@
+/********************************************************************
+ * test-xml-parallel-load.cpp: Test loading XML on several threads. *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+/* Loads each of the test files on one thread and on several, and checks
+ * that the books come out the same.  Then does the same for copies of a
+ * file changed in each of the ways that make the parallel loader hand
+ * the rest of the file to libxml.
+ */
+#include <glib.h>
+#include <glib/gstdio.h>
+
+extern "C"
+{
+#include <config.h>
+#include <string.h>
+#include <cashobjects.h>
+#include <TransLog.h>
+#include <gnc-engine.h>
+}
+
+#include <string>
+
+#include "../io-gncxml-v2.h"
+#include <test-stuff.h>
+
+#define GNC_LIB_NAME "gncmod-backend-xml"
+#define GNC_LIB_REL_PATH "xml"
+
+#define PARALLEL_WORKERS 4
+
+static QofSession*
+load_file (const char* filename, guint n_workers)
+{
+    auto session = qof_session_new (qof_book_new ());
+
+    gnc_xml_set_load_workers (n_workers);
+    qof_session_begin (session, filename, SESSION_READ_ONLY);
+    if (qof_session_pop_error (session) == ERR_BACKEND_NO_ERR)
+        qof_session_load (session, NULL);
+    return session;
+}
+
+static void
+test_same_load (const char* filename, const char* what)
+{
+    auto serial = load_file (filename, 1);
+    auto parallel = load_file (filename, PARALLEL_WORKERS);
+    auto serial_book = qof_session_get_book (serial);
+    auto parallel_book = qof_session_get_book (parallel);
+
+    do_test_args (qof_session_get_error (serial) == ERR_BACKEND_NO_ERR &&
+                  qof_session_get_error (parallel) == ERR_BACKEND_NO_ERR,
+                  "load on one thread and on several", __FILE__, __LINE__,
+                  "%s: [%s]", what, filename);
+    do_test_args (qof_collection_count (qof_book_get_collection (serial_book,
+                                                                 GNC_ID_TRANS)) ==
+                  qof_collection_count (qof_book_get_collection (parallel_book,
+                                                                 GNC_ID_TRANS)),
+                  "same number of transactions", __FILE__, __LINE__,
+                  "%s: [%s]", what, filename);
+    do_test_args (xaccAccountEqual (gnc_book_get_root_account (serial_book),
+                                    gnc_book_get_root_account (parallel_book),
+                                    TRUE),
+                  "same accounts and splits", __FILE__, __LINE__,
+                  "%s: [%s]", what, filename);
+
+    qof_session_destroy (parallel);
+    qof_session_destroy (serial);
+}
+
+/* Inserts text just after the start tag of the file's last transaction,
+ * so that the batches before it have already been cut. */
+static void
+insert_in_last_transaction (std::string& xml, const char* text)
+{
+    auto start = xml.rfind ("<gnc:transaction ");
+    g_assert (start != std::string::npos);
+    xml.insert (xml.find ('>', start) + 1, text);
+}
+
+static void
+test_fallbacks (const char* location, const char* dirname)
+{
+    auto orig_name = g_build_filename (location, "ms-money.gml2", NULL);
+    gchar* contents = NULL;
+    if (!g_file_get_contents (orig_name, &contents, NULL, NULL))
+    {
+        failure ("unable to read ms-money.gml2");
+        g_free (orig_name);
+        return;
+    }
+    const std::string orig {contents};
+    g_free (contents);
+    g_free (orig_name);
+
+    auto decl_end = orig.find ("?>") + 2;
+    struct
+    {
+        const char* name;
+        std::string xml;
+    } cases[] =
+    {
+        {"doctype", orig},
+        {"encoding", orig},
+        {"comment", orig},
+        {"cdata", orig},
+        {"pi", orig},
+    };
+    cases[0].xml.insert (decl_end, "\n<!DOCTYPE gnc-v2>");
+    auto enc = cases[1].xml.find ("utf-8");
+    cases[1].xml.replace (enc, strlen ("utf-8"), "ISO-8859-1");
+    insert_in_last_transaction (cases[2].xml, "<!-- a comment -->");
+    insert_in_last_transaction (cases[3].xml, "<![CDATA[ ]]>");
+    insert_in_last_transaction (cases[4].xml, "<?gnc-test an instruction?>");
+
+    for (auto& test_case : cases)
+    {
+        auto name = g_strdup_printf ("%s.gml2", test_case.name);
+        auto filename = g_build_filename (dirname, name, NULL);
+        g_file_set_contents (filename, test_case.xml.c_str (),
+                             test_case.xml.size (), NULL);
+        test_same_load (filename, test_case.name);
+        g_unlink (filename);
+        g_free (filename);
+        g_free (name);
+    }
+}
+
+int
+main (int argc, char** argv)
+{
+    g_setenv ("GNC_UNINSTALLED", "1", TRUE);
+    const char* location = g_getenv ("GNC_TEST_FILES");
+    int files_tested = 0;
+
+    qof_init ();
+    cashobjects_register ();
+    do_test (qof_load_backend_library (GNC_LIB_REL_PATH, GNC_LIB_NAME),
+             " loading gnc-backend-xml GModule failed");
+    xaccLogDisable ();
+
+    if (!location)
+        location = "test-files/xml2";
+
+    auto old_workers = gnc_xml_get_load_workers ();
+    auto xml2_dir = g_dir_open (location, 0, NULL);
+    if (!xml2_dir)
+    {
+        failure ("unable to open xml2 directory");
+    }
+    else
+    {
+        const gchar* entry;
+        while ((entry = g_dir_read_name (xml2_dir)) != NULL)
+        {
+            if (!g_str_has_suffix (entry, ".gml2"))
+                continue;
+            auto filename = g_build_filename (location, entry, NULL);
+            test_same_load (filename, "as it is");
+            files_tested++;
+            g_free (filename);
+        }
+        g_dir_close (xml2_dir);
+    }
+    if (files_tested == 0)
+        failure ("handled 0 files in test-xml-parallel-load");
+
+    auto dirname = g_dir_make_tmp ("test-xml-parallel-load-XXXXXX", NULL);
+    test_fallbacks (location, dirname);
+    g_rmdir (dirname);
+    g_free (dirname);
+
+    gnc_xml_set_load_workers (old_workers);
+    print_test_results ();
+    qof_close ();
+    return get_rv ();
+}
@@ -87,6 +87,15 @@ test_db (GNCPriceDB* db)
     if (!db)
         return;
 
+    do_test (writer_matches_dom_node (test_node, [db] (GncXmlWriter& writer)
+    {
+        writer.start_element ("gnc:pricedb");
+        writer.attribute ("version", "1");
+        for (auto price : gnc_pricedb_xml_prices (db))
+            gnc_price_xml_write (writer, price);
+        writer.end_element ();
+    }), "gnc_price_xml_write matches the DOM tree");
+
     filename1 = g_strdup_printf ("test_file_XXXXXX");
 
     fd = g_mkstemp (filename1);
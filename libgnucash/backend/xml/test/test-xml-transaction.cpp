@@ -29,6 +29,7 @@ extern "C"
 #include <config.h>
 
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <sys/types.h>
@@ -442,6 +443,12 @@ test_transaction (void)
             success_args ("transaction_xml", __FILE__, __LINE__, "%d", i);
         }
 
+        do_test (writer_matches_dom_node (test_node,
+                                          [ran_trn] (GncXmlWriter& writer)
+        {
+            gnc_transaction_xml_write (writer, ran_trn);
+        }), "gnc_transaction_xml_write matches the DOM tree");
+
         filename1 = g_strdup_printf ("test_file_XXXXXX");
 
         fd = g_mkstemp (filename1);
@@ -504,6 +511,82 @@ test_transaction (void)
     }
 }
 
+static gboolean
+test_no_transaction (const char* tag, gpointer globaldata, gpointer data)
+{
+    failure_args ((const char*)globaldata, __FILE__, __LINE__,
+                  "a transaction was made");
+    really_get_rid_of_transaction ((Transaction*)data);
+    return TRUE;
+}
+
+#define TEST_SPLIT_ID "<split:id type=\"guid\">5c0ac7bd6e5a4e0f8f5b0e9b2c1d3e4f</split:id>\n"
+#define TEST_SPLIT_STATE "<split:reconciled-state>n</split:reconciled-state>\n"
+#define TEST_SPLIT_QUANTITY "<split:quantity>100/100</split:quantity>\n"
+#define TEST_SPLIT_ACCOUNT "<split:account type=\"guid\">9a8b7c6d5e4f40318293a4b5c6d7e8f9</split:account>\n"
+
+/* Parses a transaction whose <trn:splits> holds splits, and checks that
+ * it's rejected, as the DOM parser's trn_splits_handler and
+ * dom_tree_to_split did. */
+static void
+test_rejected_transaction (const char* splits, const char* what)
+{
+    gchar* xml = g_strconcat (
+        "<gnc:transaction version=\"2.0.0\">\n"
+        "  <trn:id type=\"guid\">3fd1bd0d3b1a4c6c9a9c54ac3d8d7e3a</trn:id>\n"
+        "  <trn:date-posted>\n"
+        "    <ts:date>2020-01-01 10:59:00 +0000</ts:date>\n"
+        "  </trn:date-posted>\n"
+        "  <trn:date-entered>\n"
+        "    <ts:date>2020-01-01 10:59:00 +0000</ts:date>\n"
+        "  </trn:date-entered>\n"
+        "  <trn:splits>\n",
+        splits,
+        "  </trn:splits>\n"
+        "</gnc:transaction>\n", NULL);
+    gchar* filename = g_strdup ("test_file_XXXXXX");
+    int fd = g_mkstemp (filename);
+
+    if (write (fd, xml, strlen (xml)) != (ssize_t)strlen (xml))
+        failure_args (what, __FILE__, __LINE__, "unable to write the file");
+    close (fd);
+
+    do_test_args (!gnc_xml_parse_file (gnc_transaction_sixtp_parser_create (),
+                                       filename, test_no_transaction,
+                                       (gpointer)what, book),
+                  "damaged transaction is rejected", __FILE__, __LINE__,
+                  "%s", what);
+
+    g_unlink (filename);
+    g_free (filename);
+    g_free (xml);
+}
+
+static void
+test_damaged_transactions (void)
+{
+    test_rejected_transaction ("", "empty trn:splits");
+    test_rejected_transaction (
+        "<trn:split>\n" TEST_SPLIT_ID TEST_SPLIT_STATE
+        "<split:value>not a number</split:value>\n"
+        TEST_SPLIT_QUANTITY TEST_SPLIT_ACCOUNT
+        "</trn:split>\n",
+        "bad split:value");
+    test_rejected_transaction (
+        "<trn:split>\n" TEST_SPLIT_ID TEST_SPLIT_STATE
+        "<split:value>100/100</split:value>\n"
+        TEST_SPLIT_QUANTITY
+        "</trn:split>\n",
+        "split without split:account");
+    test_rejected_transaction (
+        "<trn:split>\n" TEST_SPLIT_ID TEST_SPLIT_STATE
+        "<split:value>100/100</split:value>\n"
+        TEST_SPLIT_QUANTITY TEST_SPLIT_ACCOUNT
+        "</trn:split>\n"
+        "<trn:stray>text</trn:stray>\n",
+        "foreign element in trn:splits");
+}
+
 static gboolean
 test_real_transaction (const char* tag, gpointer global_data, gpointer data)
 {
@@ -537,6 +620,7 @@ main (int argc, char** argv)
     else
     {
         test_transaction ();
+        test_damaged_transactions ();
     }
 
     print_test_results ();
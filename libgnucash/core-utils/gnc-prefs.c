@@ -32,6 +32,8 @@ static gchar *namespace_regexp    = NULL;
 static gboolean is_debugging      = FALSE;
 static gboolean extras_enabled    = FALSE;
 static gboolean use_compression   = TRUE; // This is also the default in the prefs backend
+static gint compression_level     = 6;    // This is also the default in the prefs backend
+static gboolean save_in_background = FALSE; // This is also the default in the prefs backend
 static gint file_retention_policy = 1;    // 1 = "days", the default in the prefs backend
 static gint file_retention_days   = 30;   // This is also the default in the prefs backend
 
@@ -95,6 +97,30 @@ gnc_prefs_set_file_save_compressed(gboolean compressed)
     use_compression = compressed;
 }
 
+gint
+gnc_prefs_get_file_compression_level(void)
+{
+    return compression_level;
+}
+
+void
+gnc_prefs_set_file_compression_level(gint level)
+{
+    compression_level = level;
+}
+
+gboolean
+gnc_prefs_get_file_save_in_background(void)
+{
+    return save_in_background;
+}
+
+void
+gnc_prefs_set_file_save_in_background(gboolean background)
+{
+    save_in_background = background;
+}
+
 gint
 gnc_prefs_get_file_retention_policy(void)
 {
@@ -44,11 +44,18 @@ extern "C" {
 #include "gnc-lot.h"
 #include "gnc-pricedb.h"
 #include "qofinstance-p.h"
+#include "qofquery-p.h"
+#include "qofquerycore-p.h"
 #include "gnc-features.h"
 #include "guid.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <numeric>
 #include <map>
+#include <new>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
 
 static QofLogModule log_module = GNC_MOD_ACCOUNT;
@@ -327,6 +334,7 @@ gnc_account_init(Account* acc)
     priv->starting_cleared_balance = gnc_numeric_zero();
     priv->starting_reconciled_balance = gnc_numeric_zero();
     priv->balance_dirty = FALSE;
+    priv->balance_dirty_from = SIZE_MAX;
 
     priv->last_num = (char*) is_unset;
     priv->tax_us_code = (char*) is_unset;
@@ -338,8 +346,15 @@ gnc_account_init(Account* acc)
     priv->equity_type = TriState::Unset;
     priv->sort_reversed = TriState::Unset;
 
-    priv->splits = NULL;
+    /* GObject zero-fills the private data, it doesn't construct it. */
+    new (&priv->splits) SplitsVec ();
+    priv->splits_list = NULL;
+    priv->splits_list_stale = FALSE;
+    new (&priv->splits_list_spare) std::vector<GList*> ();
     priv->sort_dirty = FALSE;
+    new (&priv->reconciled_index) ReconciledIndex ();
+    priv->reconciled_index_valid = FALSE;
+    priv->imap_bayes_index = nullptr;
 }
 
 static void
@@ -348,9 +363,22 @@ gnc_account_dispose (GObject *acctp)
     G_OBJECT_CLASS(gnc_account_parent_class)->dispose(acctp);
 }
 
+static void imap_bayes_index_clear (AccountPrivate *priv);
+
 static void
 gnc_account_finalize(GObject* acctp)
 {
+    AccountPrivate *priv = GET_PRIVATE(acctp);
+
+    g_list_free (priv->splits_list);
+    priv->splits_list = NULL;
+    std::for_each (priv->splits_list_spare.begin(),
+                   priv->splits_list_spare.end(), g_list_free_1);
+    priv->splits_list_spare.~vector ();
+    priv->splits.~SplitsVec ();
+    priv->reconciled_index.~ReconciledIndex ();
+    imap_bayes_index_clear (priv);
+
     G_OBJECT_CLASS(gnc_account_parent_class)->finalize(acctp);
 }
 
@@ -1370,24 +1398,23 @@ xaccFreeAccount (Account *acc)
     /* NB there shouldn't be any splits by now ... they should
      * have been all been freed by CommitEdit().  We can remove this
      * check once we know the warning isn't occurring any more. */
-    if (priv->splits)
+    if (!priv->splits.empty())
     {
-        GList *slist;
         PERR (" instead of calling xaccFreeAccount(), please call\n"
               " xaccAccountBeginEdit(); xaccAccountDestroy();\n");
 
         qof_instance_reset_editlevel(acc);
 
-        slist = g_list_copy(priv->splits);
-        for (lp = slist; lp; lp = lp->next)
+        /* Destroying a split removes it from priv->splits, so work on a
+         * copy. Going backwards makes each removal an erase at the end. */
+        auto slist{priv->splits};
+        std::for_each (slist.rbegin(), slist.rend(), [acc](Split *s)
         {
-            Split *s = (Split *) lp->data;
             g_assert(xaccSplitGetAccount(s) == acc);
             xaccSplitDestroy (s);
-        }
-        g_list_free(slist);
-/* Nothing here (or in xaccAccountCommitEdit) NULLs priv->splits, so this asserts every time.
-        g_assert(priv->splits == NULL);
+        });
+/* Nothing here (or in xaccAccountCommitEdit) clears priv->splits, so this asserts every time.
+        g_assert(priv->splits.empty());
 */
     }
 
@@ -1435,6 +1462,7 @@ xaccFreeAccount (Account *acc)
     priv->commodity = NULL;
 
     priv->balance_dirty = FALSE;
+    priv->balance_dirty_from = SIZE_MAX;
     priv->sort_dirty = FALSE;
 
     /* qof_instance_release (&acc->inst); */
@@ -1500,7 +1528,7 @@ xaccAccountCommitEdit (Account *acc)
     priv = GET_PRIVATE(acc);
     if (qof_instance_get_destroying(acc))
     {
-        GList *lp, *slist;
+        GList *lp;
         QofCollection *col;
 
         qof_instance_increase_editlevel(acc);
@@ -1517,18 +1545,17 @@ xaccAccountCommitEdit (Account *acc)
            themselves will be destroyed by the transaction code */
         if (!qof_book_shutting_down(book))
         {
-            slist = g_list_copy(priv->splits);
-            for (lp = slist; lp; lp = lp->next)
-            {
-                Split *s = static_cast<Split *>(lp->data);
-                xaccSplitDestroy (s);
-            }
-            g_list_free(slist);
+            /* Each split destroyed modifies its transaction and this
+               account; deliver those once each. */
+            auto slist{priv->splits};
+            qof_event_begin_batch ();
+            std::for_each (slist.rbegin(), slist.rend(), xaccSplitDestroy);
+            qof_event_end_batch ();
         }
         else
         {
-            g_list_free(priv->splits);
-            priv->splits = NULL;
+            priv->splits.clear();
+            priv->splits_list_stale = TRUE;
         }
 
         /* It turns out there's a case where this assertion does not hold:
@@ -1536,7 +1563,7 @@ xaccAccountCommitEdit (Account *acc)
            deleting all the splits in it.  The splits will just get
            recreated and put right back into the same account!
 
-           g_assert(priv->splits == NULL || qof_book_shutting_down(acc->inst.book));
+           g_assert(priv->splits.empty() || qof_book_shutting_down(acc->inst.book));
         */
 
         if (!qof_book_shutting_down(book))
@@ -1839,36 +1866,27 @@ xaccAccountEqual(const Account *aa, const Account *ab, gboolean check_guids)
     /* no parent; always compare downwards. */
 
     {
-        GList *la = priv_aa->splits;
-        GList *lb = priv_ab->splits;
+        const auto& la = priv_aa->splits;
+        const auto& lb = priv_ab->splits;
 
-        if ((la && !lb) || (!la && lb))
+        if (la.empty() != lb.empty())
         {
             PWARN ("only one has splits");
             return FALSE;
         }
 
-        if (la && lb)
+        if (la.size() != lb.size())
         {
-            /* presume that the splits are in the same order */
-            while (la && lb)
-            {
-                Split *sa = (Split *) la->data;
-                Split *sb = (Split *) lb->data;
-
-                if (!xaccSplitEqual(sa, sb, check_guids, TRUE, FALSE))
-                {
-                    PWARN ("splits differ");
-                    return(FALSE);
-                }
-
-                la = la->next;
-                lb = lb->next;
-            }
+            PWARN ("number of splits differs");
+            return(FALSE);
+        }
 
-            if ((la != NULL) || (lb != NULL))
+        /* presume that the splits are in the same order */
+        for (size_t i = 0; i < la.size(); ++i)
+        {
+            if (!xaccSplitEqual(la[i], lb[i], check_guids, TRUE, FALSE))
             {
-                PWARN ("number of splits differs");
+                PWARN ("splits differ");
                 return(FALSE);
             }
         }
@@ -1885,6 +1903,17 @@ xaccAccountEqual(const Account *aa, const Account *ab, gboolean check_guids)
 
 /********************************************************************\
 \********************************************************************/
+
+/* Record that the cached running balances of the split at pos and of
+ * every split after it are stale. Pass 0 when the whole account needs
+ * recomputing. */
+static void
+account_set_balance_dirty_from (AccountPrivate *priv, size_t pos)
+{
+    priv->balance_dirty = TRUE;
+    priv->balance_dirty_from = std::min (priv->balance_dirty_from, pos);
+}
+
 void
 gnc_account_set_sort_dirty (Account *acc)
 {
@@ -1910,7 +1939,7 @@ gnc_account_set_balance_dirty (Account *acc)
         return;
 
     priv = GET_PRIVATE(acc);
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from (priv, 0);
 }
 
 void gnc_account_set_defer_bal_computation (Account *acc, gboolean defer)
@@ -1939,37 +1968,157 @@ gboolean gnc_account_get_defer_bal_computation (Account *acc)
 /********************************************************************\
 \********************************************************************/
 
+static bool
+split_order_less (const Split *a, const Split *b)
+{
+    return xaccSplitOrder (a, b) < 0;
+}
+
+/* Bring the GList returned by xaccAccountGetSplitList back in step
+ * with priv->splits. Callers walk that list while adding and removing
+ * splits, so its nodes are re-pointed rather than freed: a caller
+ * holding a node from before the change never follows a freed one.
+ * Nodes left over when the account has shrunk are parked in
+ * splits_list_spare, pointing at the last split and ending the walk
+ * there, and reused when it grows again. */
+static void
+account_splits_list_update (AccountPrivate *priv)
+{
+    GList *node = priv->splits_list, *last = NULL;
+    for (auto s : priv->splits)
+    {
+        if (!node)
+        {
+            if (priv->splits_list_spare.empty())
+                node = g_list_alloc ();
+            else
+            {
+                node = priv->splits_list_spare.back();
+                priv->splits_list_spare.pop_back();
+            }
+            node->next = NULL;
+            node->prev = last;
+            if (last)
+                last->next = node;
+            else
+                priv->splits_list = node;
+        }
+        node->data = s;
+        last = node;
+        node = node->next;
+    }
+
+    if (last)
+        last->next = NULL;
+    else
+        priv->splits_list = NULL;
+    while (node)
+    {
+        auto next = node->next;
+        node->data = last ? last->data : NULL;
+        node->prev = node->next = NULL;
+        priv->splits_list_spare.push_back (node);
+        node = next;
+    }
+    priv->splits_list_stale = FALSE;
+}
+
+/* Find s in priv->splits. While the vector is sorted a binary search
+ * usually finds it; if the split's sort keys changed since it was
+ * inserted fall back to a linear scan. */
+static SplitsVec::iterator
+account_find_split (AccountPrivate *priv, Split *s)
+{
+    auto& splits = priv->splits;
+    if (!priv->sort_dirty)
+    {
+        auto it = std::lower_bound (splits.begin(), splits.end(), s,
+                                    split_order_less);
+        if (it != splits.end() && *it == s)
+            return it;
+    }
+    return std::find (splits.begin(), splits.end(), s);
+}
+
+void
+gnc_account_set_balance_dirty_from (Account *acc, Split *split)
+{
+    AccountPrivate *priv;
+
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+
+    if (qof_instance_get_destroying(acc))
+        return;
+
+    priv = GET_PRIVATE(acc);
+    /* During a bulk load everything gets recomputed at the end anyway;
+     * don't go looking for the split in the unsorted vector. */
+    if (qof_book_is_bulk_loading (qof_instance_get_book (acc)))
+    {
+        account_set_balance_dirty_from (priv, 0);
+        return;
+    }
+    /* A split that isn't in the account yet doesn't contribute to any
+     * running balance; gnc_account_insert_split will mark its position
+     * when it arrives. */
+    if (split->list_acc != acc)
+    {
+        account_set_balance_dirty_from (priv, priv->splits.size());
+        return;
+    }
+    auto pos = account_find_split (priv, split) - priv->splits.begin();
+    account_set_balance_dirty_from (priv, pos);
+}
+
+void
+gnc_account_set_reconciled_index_dirty (Account *acc)
+{
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+
+    GET_PRIVATE(acc)->reconciled_index_valid = FALSE;
+}
+
 gboolean
 gnc_account_insert_split (Account *acc, Split *s)
 {
     AccountPrivate *priv;
-    GList *node;
+    size_t pos;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
     g_return_val_if_fail(GNC_IS_SPLIT(s), FALSE);
 
     priv = GET_PRIVATE(acc);
-    node = g_list_find(priv->splits, s);
-    if (node)
+    /* A split is only ever in one account's vector. xaccSplitCommitEdit
+     * takes a moved split out of its old account first; anyone calling
+     * this directly may not have. */
+    if (s->list_acc == acc)
         return FALSE;
+    if (s->list_acc)
+        gnc_account_remove_split (s->list_acc, s);
+    s->list_acc = acc;
 
-    if (qof_instance_get_editlevel(acc) == 0)
+    if (qof_instance_get_editlevel(acc) == 0 && !priv->sort_dirty &&
+        !qof_book_is_bulk_loading (qof_instance_get_book (acc)))
     {
-        priv->splits = g_list_insert_sorted(priv->splits, s,
-                                            (GCompareFunc)xaccSplitOrder);
+        auto it = std::upper_bound (priv->splits.begin(), priv->splits.end(),
+                                    s, split_order_less);
+        pos = it - priv->splits.begin();
+        priv->splits.insert (it, s);
     }
     else
     {
-        priv->splits = g_list_prepend(priv->splits, s);
+        pos = priv->splits.size();
+        priv->splits.push_back (s);
         priv->sort_dirty = TRUE;
     }
+    priv->splits_list_stale = TRUE;
 
     //FIXME: find better event
     qof_event_gen (&acc->inst, QOF_EVENT_MODIFY, NULL);
     /* Also send an event based on the account */
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_ADDED, s);
 
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from (priv, pos);
 //  DRH: Should the below be added? It is present in the delete path.
 //  xaccAccountRecomputeBalance(acc);
     return TRUE;
@@ -1979,23 +2128,25 @@ gboolean
 gnc_account_remove_split (Account *acc, Split *s)
 {
     AccountPrivate *priv;
-    GList *node;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
     g_return_val_if_fail(GNC_IS_SPLIT(s), FALSE);
 
     priv = GET_PRIVATE(acc);
-    node = g_list_find(priv->splits, s);
-    if (NULL == node)
+    if (s->list_acc != acc)
         return FALSE;
+    s->list_acc = NULL;
 
-    priv->splits = g_list_delete_link(priv->splits, node);
+    auto it = account_find_split (priv, s);
+    size_t pos = it - priv->splits.begin();
+    priv->splits.erase (it);
+    priv->splits_list_stale = TRUE;
     //FIXME: find better event type
     qof_event_gen(&acc->inst, QOF_EVENT_MODIFY, NULL);
     // And send the account-based event, too
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_REMOVED, s);
 
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from (priv, pos);
     xaccAccountRecomputeBalance(acc);
     return TRUE;
 }
@@ -2010,9 +2161,28 @@ xaccAccountSortSplits (Account *acc, gboolean force)
     priv = GET_PRIVATE(acc);
     if (!priv->sort_dirty || (!force && qof_instance_get_editlevel(acc) > 0))
         return;
-    priv->splits = g_list_sort(priv->splits, (GCompareFunc)xaccSplitOrder);
+    if (!force && qof_book_is_bulk_loading (qof_instance_get_book (acc)))
+        return;
+
+    /* Usually only a few splits are out of place, most often new ones
+     * at the end: sort the part after the sorted prefix and merge it
+     * in. Nothing before the merge point moves, so the running
+     * balances there stay good. */
+    auto& splits = priv->splits;
+    auto unsorted = std::is_sorted_until (splits.begin(), splits.end(),
+                                          split_order_less);
+    auto first_moved = splits.end();
+    if (unsorted != splits.end())
+    {
+        std::stable_sort (unsorted, splits.end(), split_order_less);
+        first_moved = std::upper_bound (splits.begin(), unsorted, *unsorted,
+                                        split_order_less);
+        std::inplace_merge (splits.begin(), unsorted, splits.end(),
+                            split_order_less);
+        priv->splits_list_stale = TRUE;
+    }
     priv->sort_dirty = FALSE;
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from (priv, first_moved - splits.begin());
 }
 
 static void
@@ -2026,6 +2196,92 @@ xaccAccountBringUpToDate(Account *acc)
     xaccAccountRecomputeBalance(acc);
 }
 
+static guint bulk_load_workers = 0;
+
+void
+gnc_book_set_bulk_load_workers (guint n_workers)
+{
+    bulk_load_workers = n_workers;
+}
+
+guint
+gnc_book_get_bulk_load_workers (void)
+{
+    return bulk_load_workers;
+}
+
+void
+gnc_book_begin_bulk_load (QofBook *book)
+{
+    g_return_if_fail (QOF_IS_BOOK (book));
+    qof_book_begin_bulk_load (book);
+}
+
+static void
+collect_bulk_loaded_account (QofInstance *inst, gpointer data)
+{
+    auto accounts = static_cast<std::vector<Account*>*>(data);
+    auto acc = GNC_ACCOUNT (inst);
+    /* Accounts still open for editing are brought up to date when they
+     * are committed. */
+    if (qof_instance_get_editlevel (acc) > 0)
+        return;
+    accounts->push_back (acc);
+}
+
+/* Sorting and balancing an account writes only to the account and its
+ * own splits, so accounts can be done concurrently. The transactions
+ * are shared between accounts and must only be read; the one thing the
+ * sort and the balance walk would write is the closing-transaction flag
+ * that xaccTransGetIsClosingTxn caches on first use, and the book's
+ * num-source option cache read by xaccSplitOrder, so fill both in
+ * before the workers start. */
+static void
+accounts_bring_up_to_date (QofBook *book, std::vector<Account*>& accounts,
+                           guint n_workers)
+{
+    if (n_workers == 0)
+        n_workers = std::max (1u, std::thread::hardware_concurrency ());
+    n_workers = std::min<size_t> (n_workers, accounts.size ());
+    if (n_workers <= 1)
+    {
+        std::for_each (accounts.begin (), accounts.end (),
+                       xaccAccountBringUpToDate);
+        return;
+    }
+
+    qof_book_use_split_action_for_num_field (book);
+    for (auto acc : accounts)
+        for (auto s : GET_PRIVATE (acc)->splits)
+            xaccTransGetIsClosingTxn (xaccSplitGetParent (s));
+
+    std::atomic<size_t> next {0};
+    auto worker = [&accounts, &next] ()
+    {
+        for (auto i = next++; i < accounts.size (); i = next++)
+            xaccAccountBringUpToDate (accounts[i]);
+    };
+    std::vector<std::thread> threads;
+    for (guint i = 1; i < n_workers; ++i)
+        threads.emplace_back (worker);
+    worker ();
+    for (auto& thread : threads)
+        thread.join ();
+}
+
+void
+gnc_book_end_bulk_load (QofBook *book)
+{
+    std::vector<Account*> accounts;
+
+    g_return_if_fail (QOF_IS_BOOK (book));
+    if (!qof_book_end_bulk_load (book))
+        return;
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_ACCOUNT),
+                            collect_bulk_loaded_account, &accounts);
+    accounts_bring_up_to_date (book, accounts, bulk_load_workers);
+}
+
 /********************************************************************\
 \********************************************************************/
 
@@ -2210,7 +2466,7 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
 
     /* optimizations */
     from_priv = GET_PRIVATE(accfrom);
-    if (!from_priv->splits || accfrom == accto)
+    if (from_priv->splits.empty() || accfrom == accto)
         return;
 
     /* check for book mix-up */
@@ -2220,7 +2476,8 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
     xaccAccountBeginEdit(accfrom);
     xaccAccountBeginEdit(accto);
     /* Begin editing both accounts and all transactions in accfrom. */
-    g_list_foreach(from_priv->splits, (GFunc)xaccPreSplitMove, NULL);
+    std::for_each (from_priv->splits.begin(), from_priv->splits.end(),
+                   [](Split *s){ xaccPreSplitMove (s, nullptr); });
 
     /* Concatenate accfrom's lists of splits and lots to accto's lists. */
     //to_priv->splits = g_list_concat(to_priv->splits, from_priv->splits);
@@ -2236,11 +2493,15 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
      * Change each split's account back pointer to accto.
      * Convert each split's amount to accto's commodity.
      * Commit to editing each transaction.
+     * Each move removes the split from accfrom, so walk a copy; going
+     * backwards keeps every removal at the end of the vector.
      */
-    g_list_foreach(from_priv->splits, (GFunc)xaccPostSplitMove, (gpointer)accto);
+    auto splits{from_priv->splits};
+    std::for_each (splits.rbegin(), splits.rend(),
+                   [accto](Split *s){ xaccPostSplitMove (s, accto); });
 
     /* Finally empty accfrom. */
-    g_assert(from_priv->splits == NULL);
+    g_assert(from_priv->splits.empty());
     g_assert(from_priv->lots == NULL);
     xaccAccountCommitEdit(accfrom);
     xaccAccountCommitEdit(accto);
@@ -2285,7 +2546,6 @@ xaccAccountRecomputeBalance (Account * acc)
     gnc_numeric  noclosing_balance;
     gnc_numeric  cleared_balance;
     gnc_numeric  reconciled_balance;
-    GList *lp;
 
     if (NULL == acc) return;
 
@@ -2294,17 +2554,33 @@ xaccAccountRecomputeBalance (Account * acc)
     if (!priv->balance_dirty || priv->defer_bal_computation) return;
     if (qof_instance_get_destroying(acc)) return;
     if (qof_book_shutting_down(qof_instance_get_book(acc))) return;
+    if (qof_book_is_bulk_loading(qof_instance_get_book(acc))) return;
 
-    balance            = priv->starting_balance;
-    noclosing_balance  = priv->starting_noclosing_balance;
-    cleared_balance    = priv->starting_cleared_balance;
-    reconciled_balance = priv->starting_reconciled_balance;
+    /* Splits before balance_dirty_from still hold correct running
+     * balances, so pick up from the last of them. */
+    auto first = std::min (priv->balance_dirty_from, priv->splits.size());
+    if (first == 0)
+    {
+        balance            = priv->starting_balance;
+        noclosing_balance  = priv->starting_noclosing_balance;
+        cleared_balance    = priv->starting_cleared_balance;
+        reconciled_balance = priv->starting_reconciled_balance;
+    }
+    else
+    {
+        Split *prev = priv->splits[first - 1];
+        balance            = prev->balance;
+        noclosing_balance  = prev->noclosing_balance;
+        cleared_balance    = prev->cleared_balance;
+        reconciled_balance = prev->reconciled_balance;
+    }
 
-    PINFO ("acct=%s starting baln=%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT,
-           priv->accountName, balance.num, balance.denom);
-    for (lp = priv->splits; lp; lp = lp->next)
+    PINFO ("acct=%s starting at split %zu of %zu, baln=%" G_GINT64_FORMAT
+           "/%" G_GINT64_FORMAT, priv->accountName, first,
+           priv->splits.size(), balance.num, balance.denom);
+    for (auto it = priv->splits.begin() + first; it != priv->splits.end(); ++it)
     {
-        Split *split = (Split *) lp->data;
+        Split *split = *it;
         gnc_numeric amt = xaccSplitGetAmount (split);
 
         balance = gnc_numeric_add_fixed(balance, amt);
@@ -2336,6 +2612,8 @@ xaccAccountRecomputeBalance (Account * acc)
     priv->cleared_balance = cleared_balance;
     priv->reconciled_balance = reconciled_balance;
     priv->balance_dirty = FALSE;
+    priv->balance_dirty_from = SIZE_MAX;
+    priv->reconciled_index_valid = FALSE;
 }
 
 /********************************************************************\
@@ -2438,7 +2716,8 @@ xaccAccountSetType (Account *acc, GNCAccountType tip)
 
     xaccAccountBeginEdit(acc);
     priv->type = tip;
-    priv->balance_dirty = TRUE; /* new type may affect balance computation */
+    /* new type may affect balance computation */
+    account_set_balance_dirty_from (priv, 0);
     mark_account(acc);
     xaccAccountCommitEdit(acc);
 }
@@ -2562,6 +2841,51 @@ get_kvp_string_tag (const Account *acc, const char *tag)
     return get_kvp_string_path (acc, {tag});
 }
 
+/* The slots behind the account properties that are read most, as
+ * compiled paths. */
+static const KvpPath color_path {"color"};
+static const KvpPath filter_path {"filter"};
+static const KvpPath sort_order_path {"sort-order"};
+static const KvpPath sort_reversed_path {"sort-reversed"};
+static const KvpPath notes_path {"notes"};
+static const KvpPath tax_us_code_path {"tax-US/code"};
+static const KvpPath tax_us_pns_path {"tax-US/payer-name-source"};
+static const KvpPath equity_type_path {"equity-type"};
+static const KvpPath last_num_path {"last-num"};
+
+static void
+set_kvp_string (Account *acc, KvpPath const & path, const char *value)
+{
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+
+    xaccAccountBeginEdit(acc);
+    if (value)
+    {
+        GValue v = G_VALUE_INIT;
+        g_value_init (&v, G_TYPE_STRING);
+        g_value_set_string (&v, value);
+        qof_instance_set_compiled_path_kvp (QOF_INSTANCE (acc), &v, path);
+        g_value_unset (&v);
+    }
+    else
+    {
+         qof_instance_set_compiled_path_kvp (QOF_INSTANCE (acc), NULL, path);
+    }
+    mark_account (acc);
+    xaccAccountCommitEdit(acc);
+}
+
+static char*
+get_kvp_string (const Account *acc, KvpPath const & path)
+{
+    GValue v = G_VALUE_INIT;
+    if (acc == NULL) return NULL;
+    qof_instance_get_compiled_path_kvp (QOF_INSTANCE (acc), &v, path);
+    auto retval = G_VALUE_HOLDS_STRING (&v) ? g_value_dup_string (&v) : NULL;
+    g_value_unset (&v);
+    return retval;
+}
+
 void
 xaccAccountSetColor (Account *acc, const char *str)
 {
@@ -2569,7 +2893,7 @@ xaccAccountSetColor (Account *acc, const char *str)
     if (priv->color != is_unset)
         g_free (priv->color);
     priv->color = stripdup_or_null (str);
-    set_kvp_string_tag (acc, "color", priv->color);
+    set_kvp_string (acc, color_path, priv->color);
 }
 
 void
@@ -2579,7 +2903,7 @@ xaccAccountSetFilter (Account *acc, const char *str)
     if (priv->filter != is_unset)
         g_free (priv->filter);
     priv->filter = stripdup_or_null (str);
-    set_kvp_string_tag (acc, "filter", priv->filter);
+    set_kvp_string (acc, filter_path, priv->filter);
 }
 
 void
@@ -2589,7 +2913,7 @@ xaccAccountSetSortOrder (Account *acc, const char *str)
     if (priv->sort_order != is_unset)
         g_free (priv->sort_order);
     priv->sort_order = stripdup_or_null (str);
-    set_kvp_string_tag (acc, "sort-order", priv->sort_order);
+    set_kvp_string (acc, sort_order_path, priv->sort_order);
 }
 
 void
@@ -2597,7 +2921,7 @@ xaccAccountSetSortReversed (Account *acc, gboolean sortreversed)
 {
     auto priv = GET_PRIVATE (acc);
     priv->sort_reversed = sortreversed ? TriState::True : TriState::False;
-    set_kvp_string_tag (acc, "sort-reversed", sortreversed ? "true" : NULL);
+    set_kvp_string (acc, sort_reversed_path, sortreversed ? "true" : NULL);
 }
 
 static void
@@ -2625,14 +2949,13 @@ xaccAccountSetNotes (Account *acc, const char *str)
     if (priv->notes != is_unset)
         g_free (priv->notes);
     priv->notes = stripdup_or_null (str);
-    set_kvp_string_tag (acc, "notes", priv->notes);
+    set_kvp_string (acc, notes_path, priv->notes);
 }
 
 void
 xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
 {
     AccountPrivate *priv;
-    GList *lp;
 
     /* errors */
     g_return_if_fail(GNC_IS_ACCOUNT(acc));
@@ -2651,9 +2974,8 @@ xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
     priv->non_standard_scu = FALSE;
 
     /* iterate over splits */
-    for (lp = priv->splits; lp; lp = lp->next)
+    for (auto s : priv->splits)
     {
-        Split *s = (Split *) lp->data;
         Transaction *trans = xaccSplitGetParent (s);
 
         xaccTransBeginEdit (trans);
@@ -2662,7 +2984,7 @@ xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
     }
 
     priv->sort_dirty = TRUE;  /* Not needed. */
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from (priv, 0);
     mark_account (acc);
 
     xaccAccountCommitEdit(acc);
@@ -3372,7 +3694,7 @@ xaccAccountGetColor (const Account *acc)
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
     auto priv = GET_PRIVATE (acc);
     if (priv->color == is_unset)
-        priv->color = get_kvp_string_tag (acc, "color");
+        priv->color = get_kvp_string (acc, color_path);
     return priv->color;
 }
 
@@ -3382,7 +3704,7 @@ xaccAccountGetFilter (const Account *acc)
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), 0);
     auto priv = GET_PRIVATE (acc);
     if (priv->filter == is_unset)
-        priv->filter = get_kvp_string_tag (acc, "filter");
+        priv->filter = get_kvp_string (acc, filter_path);
     return priv->filter;
 }
 
@@ -3392,7 +3714,7 @@ xaccAccountGetSortOrder (const Account *acc)
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), 0);
     auto priv = GET_PRIVATE (acc);
     if (priv->sort_order == is_unset)
-        priv->sort_order = get_kvp_string_tag (acc, "sort-order");
+        priv->sort_order = get_kvp_string (acc, sort_order_path);
     return priv->sort_order;
 }
 
@@ -3404,7 +3726,7 @@ xaccAccountGetSortReversed (const Account *acc)
     auto priv = GET_PRIVATE (acc);
     if (priv->sort_reversed == TriState::Unset)
     {
-        auto sort_reversed = get_kvp_string_tag (acc, "sort-reversed");
+        auto sort_reversed = get_kvp_string (acc, sort_reversed_path);
         priv->sort_reversed = g_strcmp0 (sort_reversed, "true") ?
             TriState::False : TriState::True;
         g_free (sort_reversed);
@@ -3418,7 +3740,7 @@ xaccAccountGetNotes (const Account *acc)
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
     auto priv = GET_PRIVATE (acc);
     if (priv->notes == is_unset)
-        priv->notes = get_kvp_string_tag (acc, "notes");
+        priv->notes = get_kvp_string (acc, notes_path);
     return priv->notes;
 }
 
@@ -3496,7 +3818,7 @@ gnc_account_set_start_balance (Account *acc, const gnc_numeric start_baln)
 
     priv = GET_PRIVATE(acc);
     priv->starting_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from (priv, 0);
 }
 
 void
@@ -3509,7 +3831,7 @@ gnc_account_set_start_cleared_balance (Account *acc,
 
     priv = GET_PRIVATE(acc);
     priv->starting_cleared_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from (priv, 0);
 }
 
 void
@@ -3522,7 +3844,7 @@ gnc_account_set_start_reconciled_balance (Account *acc,
 
     priv = GET_PRIVATE(acc);
     priv->starting_reconciled_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from (priv, 0);
 }
 
 gnc_numeric
@@ -3550,7 +3872,6 @@ gnc_numeric
 xaccAccountGetProjectedMinimumBalance (const Account *acc)
 {
     AccountPrivate *priv;
-    GList *node;
     time64 today;
     gnc_numeric lowest = gnc_numeric_zero ();
     int seen_a_transaction = 0;
@@ -3559,9 +3880,9 @@ xaccAccountGetProjectedMinimumBalance (const Account *acc)
 
     priv = GET_PRIVATE(acc);
     today = gnc_time64_get_today_end();
-    for (node = g_list_last(priv->splits); node; node = node->prev)
+    for (auto it = priv->splits.rbegin(); it != priv->splits.rend(); ++it)
     {
-        Split *split = static_cast<Split*>(node->data);
+        Split *split = *it;
 
         if (!seen_a_transaction)
         {
@@ -3587,12 +3908,6 @@ xaccAccountGetProjectedMinimumBalance (const Account *acc)
 static gnc_numeric
 GetBalanceAsOfDate (Account *acc, time64 date, gboolean ignclosing)
 {
-    /* Ideally this could use xaccAccountForEachSplit, but
-     * it doesn't exist yet and I'm uncertain of exactly how
-     * it would work at this time, since it differs from
-     * xaccAccountForEachTransaction by using gpointer return
-     * values rather than gints.
-     */
     Split *latest = nullptr;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
@@ -3600,15 +3915,18 @@ GetBalanceAsOfDate (Account *acc, time64 date, gboolean ignclosing)
     xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
     xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
 
-    for (GList *lp = GET_PRIVATE(acc)->splits; lp; lp = lp->next)
-    {
-        if (xaccTransGetDate (xaccSplitGetParent ((Split *)lp->data)) >= date)
-            break;
-        latest = (Split *)lp->data;
-    }
-
-    if (!latest)
+    /* xaccSplitOrder sorts on the posted date first, so the sorted split
+     * vector doubles as a date index and each split carries the running
+     * balance up to and including itself. */
+    const auto& splits = GET_PRIVATE(acc)->splits;
+    auto after = std::partition_point (splits.begin(), splits.end(),
+                                       [date](const Split *split)
+                                       {
+                                           return xaccTransGetDate (split->parent) < date;
+                                       });
+    if (after == splits.begin())
         return gnc_numeric_zero();
+    latest = *(after - 1);
 
     if (ignclosing)
         return xaccSplitGetNoclosingBalance (latest);
@@ -3628,20 +3946,70 @@ xaccAccountGetNoclosingBalanceAsOfDate (Account *acc, time64 date)
     return GetBalanceAsOfDate (acc, date, TRUE);
 }
 
+/* Order the reconciled splits by reconcile date and pair each with the
+ * sum of the amounts up to and including it. */
+static void
+build_reconciled_index (AccountPrivate *priv)
+{
+    auto& index = priv->reconciled_index;
+    index.clear();
+    for (auto split : priv->splits)
+    {
+        if (xaccSplitGetReconcile (split) == YREC)
+            index.emplace_back (xaccSplitGetDateReconciled (split),
+                                xaccSplitGetAmount (split));
+    }
+    std::stable_sort (index.begin(), index.end(),
+                      [](const auto& a, const auto& b)
+                      {
+                          return a.first < b.first;
+                      });
+    auto balance = gnc_numeric_zero();
+    for (auto& entry : index)
+    {
+        balance = gnc_numeric_add_fixed (balance, entry.second);
+        entry.second = balance;
+    }
+    priv->reconciled_index_valid = TRUE;
+}
+
 gnc_numeric
 xaccAccountGetReconciledBalanceAsOfDate (Account *acc, time64 date)
 {
     gnc_numeric balance = gnc_numeric_zero();
+    AccountPrivate *priv;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
 
-    for (GList *node = GET_PRIVATE(acc)->splits; node; node = node->next)
+    priv = GET_PRIVATE(acc);
+    xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
+
+    /* The index is only trustworthy while the balances are; if they
+     * couldn't be brought up to date (open edit, deferred computation)
+     * add up the splits directly. */
+    if (priv->balance_dirty)
     {
-        Split *split = (Split*) node->data;
-        if ((xaccSplitGetReconcile (split) == YREC) &&
-            (xaccSplitGetDateReconciled (split) <= date))
-            balance = gnc_numeric_add_fixed (balance, xaccSplitGetAmount (split));
-    };
+        for (auto split : priv->splits)
+        {
+            if ((xaccSplitGetReconcile (split) == YREC) &&
+                (xaccSplitGetDateReconciled (split) <= date))
+                balance = gnc_numeric_add_fixed (balance, xaccSplitGetAmount (split));
+        };
+
+        return balance;
+    }
+
+    if (!priv->reconciled_index_valid)
+        build_reconciled_index (priv);
+
+    const auto& index = priv->reconciled_index;
+    auto after = std::upper_bound (index.begin(), index.end(), date,
+                                   [](time64 d, const auto& entry)
+                                   {
+                                       return d < entry.first;
+                                   });
+    if (after != index.begin())
+        balance = (after - 1)->second;
 
     return balance;
 }
@@ -3992,25 +4360,42 @@ xaccAccountGetNoclosingBalanceChangeForPeriod (Account *acc, time64 t1,
 /********************************************************************\
 \********************************************************************/
 
-/* THIS API NEEDS TO CHANGE.
- *
- * This code exposes the internal structure of the account object to
- * external callers by returning the actual list used by the object.
- * It should instead return a copy of the split list that the caller
- * is required to free.  That change would provide the freedom of
- * allowing the internal organization to change data structures if
- * necessary for whatever reason, while leaving the external API
- * unchanged. */
+/* The account keeps its splits in a vector. For callers of the old
+ * API a GList copy is brought up to date when they ask for it after
+ * the splits have changed. The returned list is still owned by the
+ * account and must not be freed. New code should use
+ * xaccAccountGetSplits() or xaccAccountGetSplitsSize() instead. */
 /* XXX: violates the const'ness by forcing a sort before returning
  * the splitlist */
 SplitList *
 xaccAccountGetSplitList (const Account *acc)
 {
+    AccountPrivate *priv;
+
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
     xaccAccountSortSplits((Account*)acc, FALSE);  // normally a noop
+    priv = GET_PRIVATE(acc);
+    if (priv->splits_list_stale)
+        account_splits_list_update (priv);
+    return priv->splits_list;
+}
+
+const SplitsVec&
+xaccAccountGetSplits (const Account *acc)
+{
+    static const SplitsVec empty;
+    g_return_val_if_fail (GNC_IS_ACCOUNT(acc), empty);
+    xaccAccountSortSplits ((Account*)acc, FALSE);  // normally a noop
     return GET_PRIVATE(acc)->splits;
 }
 
+size_t
+xaccAccountGetSplitsSize (const Account *acc)
+{
+    g_return_val_if_fail (GNC_IS_ACCOUNT(acc), 0);
+    return GET_PRIVATE(acc)->splits.size();
+}
+
 gint64
 xaccAccountCountSplits (const Account *acc, gboolean include_children)
 {
@@ -4018,11 +4403,11 @@ xaccAccountCountSplits (const Account *acc, gboolean include_children)
 
     PWARN ("xaccAccountCountSplits is deprecated and will be removed \
 in GnuCash 5.0. If testing for an empty account, use \
-xaccAccountGetSplitList(account) == NULL instead. To test descendants \
+xaccAccountGetSplitsSize(account) == 0 instead. To test descendants \
 as well, use gnc_account_and_descendants_empty.");
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), 0);
 
-    nr = g_list_length(xaccAccountGetSplitList(acc));
+    nr = xaccAccountGetSplitsSize(acc);
     if (include_children && (gnc_account_n_children(acc) != 0))
     {
         for (i=0; i < gnc_account_n_children(acc); i++)
@@ -4037,7 +4422,7 @@ gboolean gnc_account_and_descendants_empty (Account *acc)
 {
     g_return_val_if_fail (GNC_IS_ACCOUNT (acc), FALSE);
     auto priv = GET_PRIVATE (acc);
-    if (priv->splits != nullptr) return FALSE;
+    if (!priv->splits.empty()) return FALSE;
     for (auto *n = priv->children; n; n = n->next)
     {
 	if (!gnc_account_and_descendants_empty (static_cast<Account*>(n->data)))
@@ -4159,7 +4544,7 @@ xaccAccountGetTaxUSCode (const Account *acc)
 {
     auto priv = GET_PRIVATE (acc);
     if (priv->tax_us_code == is_unset)
-        priv->tax_us_code = get_kvp_string_path (acc, {"tax-US", "code"});
+        priv->tax_us_code = get_kvp_string (acc, tax_us_code_path);
     return priv->tax_us_code;
 }
 
@@ -4170,7 +4555,7 @@ xaccAccountSetTaxUSCode (Account *acc, const char *code)
     if (priv->tax_us_code != is_unset)
         g_free (priv->tax_us_code);
     priv->tax_us_code = g_strdup (code);
-    set_kvp_string_path (acc, {"tax-US", "code"}, priv->tax_us_code);
+    set_kvp_string (acc, tax_us_code_path, priv->tax_us_code);
 }
 
 const char *
@@ -4178,7 +4563,7 @@ xaccAccountGetTaxUSPayerNameSource (const Account *acc)
 {
     auto priv = GET_PRIVATE (acc);
     if (priv->tax_us_pns == is_unset)
-        priv->tax_us_pns = get_kvp_string_path (acc, {"tax-US", "payer-name-source"});
+        priv->tax_us_pns = get_kvp_string (acc, tax_us_pns_path);
     return priv->tax_us_pns;
  }
 
@@ -4189,7 +4574,7 @@ xaccAccountSetTaxUSPayerNameSource (Account *acc, const char *source)
     if (priv->tax_us_pns != is_unset)
         g_free (priv->tax_us_pns);
     priv->tax_us_pns = g_strdup (source);
-    set_kvp_string_path (acc, {"tax-US", "payer-name-source"}, priv->tax_us_pns);
+    set_kvp_string (acc, tax_us_pns_path, priv->tax_us_pns);
 }
 
 gint64
@@ -4290,7 +4675,7 @@ xaccAccountGetIsOpeningBalance (const Account *acc)
     auto priv = GET_PRIVATE(acc);
     if (priv->equity_type == TriState::Unset)
     {
-        auto equity_type = get_kvp_string_tag (acc, "equity-type");
+        auto equity_type = get_kvp_string (acc, equity_type_path);
         priv->equity_type = g_strcmp0 (equity_type, "opening-balance") ?
             TriState::False : TriState::True;
         g_free (equity_type);
@@ -4305,7 +4690,7 @@ xaccAccountSetIsOpeningBalance (Account *acc, gboolean val)
         return;
     auto priv = GET_PRIVATE (acc);
     priv->equity_type = val ? TriState::True : TriState::False;
-    set_kvp_string_tag(acc, "equity-type", val ? "opening-balance" : nullptr);
+    set_kvp_string (acc, equity_type_path, val ? "opening-balance" : nullptr);
 }
 
 GNCPlaceholderType
@@ -4934,7 +5319,7 @@ xaccAccountGetLastNum (const Account *acc)
 {
     auto priv = GET_PRIVATE (acc);
     if (priv->last_num == is_unset)
-        priv->last_num = get_kvp_string_tag (acc, "last-num");
+        priv->last_num = get_kvp_string (acc, last_num_path);
     return priv->last_num;
 }
 
@@ -4948,7 +5333,7 @@ xaccAccountSetLastNum (Account *acc, const char *num)
     if (priv->last_num != is_unset)
         g_free (priv->last_num);
     priv->last_num = g_strdup (num);
-    set_kvp_string_tag (acc, "last-num", priv->last_num);
+    set_kvp_string (acc, last_num_path, priv->last_num);
 }
 
 static Account *
@@ -5142,7 +5527,6 @@ finder_help_function(const Account *acc, const char *description,
                      Split **split, Transaction **trans )
 {
     AccountPrivate *priv;
-    GList *slp;
 
     /* First, make sure we set the data to NULL BEFORE we start */
     if (split) *split = NULL;
@@ -5155,9 +5539,9 @@ finder_help_function(const Account *acc, const char *description,
      * list is in date order, and the most recent matches should be
      * returned!?  */
     priv = GET_PRIVATE(acc);
-    for (slp = g_list_last(priv->splits); slp; slp = slp->prev)
+    for (auto it = priv->splits.rbegin(); it != priv->splits.rend(); ++it)
     {
-        Split *lsplit = static_cast<Split*>(slp->data);
+        Split *lsplit = *it;
         Transaction *ltrans = xaccSplitGetParent(lsplit);
 
         if (g_strcmp0 (description, xaccTransGetDescription (ltrans)) == 0)
@@ -5273,9 +5657,10 @@ gnc_account_merge_children (Account *parent)
             /* recurse to do the children's children */
             gnc_account_merge_children (acc_a);
 
-            /* consolidate transactions */
-            while (priv_b->splits)
-                xaccSplitSetAccount (static_cast <Split*> (priv_b->splits->data), acc_a);
+            /* consolidate transactions, from the back so that each
+             * removal from acc_b is cheap */
+            while (!priv_b->splits.empty())
+                xaccSplitSetAccount (priv_b->splits.back(), acc_a);
 
             /* move back one before removal. next iteration around the loop
              * will get the node after node_b */
@@ -5317,7 +5702,13 @@ xaccAccountBeginStagedTransactionTraversals (const Account *account)
     if (!account)
         return;
     priv = GET_PRIVATE(account);
-    xaccSplitsBeginStagedTransactionTraversals(priv->splits);
+    for (auto s : priv->splits)
+    {
+        Transaction *trans = s->parent;
+
+        if (trans)
+            trans->marker = 0;
+    }
 }
 
 gboolean
@@ -5334,16 +5725,11 @@ xaccTransactionTraverse (Transaction *trans, int stage)
     return FALSE;
 }
 
-static void do_one_split (Split *s, gpointer data)
-{
-    Transaction *trans = s->parent;
-    trans->marker = 0;
-}
-
 static void do_one_account (Account *account, gpointer data)
 {
     AccountPrivate *priv = GET_PRIVATE(account);
-    g_list_foreach(priv->splits, (GFunc)do_one_split, NULL);
+    for (auto s : priv->splits)
+        s->parent->marker = 0;
 }
 
 /* Replacement for xaccGroupBeginStagedTransactionTraversals */
@@ -5364,24 +5750,17 @@ xaccAccountStagedTransactionTraversal (const Account *acc,
                                        void *cb_data)
 {
     AccountPrivate *priv;
-    GList *split_p;
-    GList *next;
     Transaction *trans;
     Split *s;
     int retval;
+    size_t i = 0;
 
     if (!acc) return 0;
 
     priv = GET_PRIVATE(acc);
-    for (split_p = priv->splits; split_p; split_p = next)
+    while (i < priv->splits.size())
     {
-        /* Get the next element in the split list now, just in case some
-         * naughty thunk destroys the one we're using. This reduces, but
-         * does not eliminate, the possibility of undefined results if
-         * a thunk removes splits from this account. */
-        next = g_list_next(split_p);
-
-        s = static_cast <Split*> (split_p->data);
+        s = priv->splits[i];
         trans = s->parent;
         if (trans && (trans->marker < stage))
         {
@@ -5392,6 +5771,12 @@ xaccAccountStagedTransactionTraversal (const Account *acc,
                 if (retval) return retval;
             }
         }
+        /* Some naughty thunks destroy the split we're using. If it is
+         * gone, its successor has moved into slot i. Splits that move
+         * back over i because the thunk removed earlier ones belong to
+         * transactions already marked, so they are skipped. */
+        if (i < priv->splits.size() && priv->splits[i] == s)
+            ++i;
     }
 
     return 0;
@@ -5404,10 +5789,11 @@ gnc_account_tree_staged_transaction_traversal (const Account *acc,
         void *cb_data)
 {
     const AccountPrivate *priv;
-    GList *acc_p, *split_p;
+    GList *acc_p;
     Transaction *trans;
     Split *s;
     int retval;
+    size_t i = 0;
 
     if (!acc) return 0;
 
@@ -5421,9 +5807,9 @@ gnc_account_tree_staged_transaction_traversal (const Account *acc,
     }
 
     /* Now this account */
-    for (split_p = priv->splits; split_p; split_p = g_list_next(split_p))
+    while (i < priv->splits.size())
     {
-        s = static_cast <Split*> (split_p->data);
+        s = priv->splits[i];
         trans = s->parent;
         if (trans && (trans->marker < stage))
         {
@@ -5434,6 +5820,9 @@ gnc_account_tree_staged_transaction_traversal (const Account *acc,
                 if (retval) return retval;
             }
         }
+        /* See xaccAccountStagedTransactionTraversal */
+        if (i < priv->splits.size() && priv->splits[i] == s)
+            ++i;
     }
 
     return 0;
@@ -5588,6 +5977,18 @@ struct TokenAccountsInfo
     int64_t total_count;
 };
 
+/** The account's import-map-bayes slots grouped by token, so that a
+ * lookup costs one hash probe per token instead of a prefix scan of
+ * the account's whole frame. Each token's accounts are kept sorted by
+ * guid, which is the order the frame itself would yield them in.
+ * generation is the account frame's generation the index matches; any
+ * other write to the frame makes the index be built again. */
+struct ImapBayesIndex
+{
+    std::unordered_map<std::string, TokenAccountsInfo> tokens;
+    uint64_t generation;
+};
+
 /** holds an account guid and its corresponding integer probability
   the integer probability is some factor of 10
  */
@@ -5597,15 +5998,74 @@ struct AccountInfo
     int32_t probability;
 };
 
+/* The slot keys look like "import-map-bayes/<token>/<guid>"; the
+ * token itself may contain '/', so split on the guid at the end. */
 static void
-build_token_info(char const * suffix, KvpValue * value, TokenAccountsInfo & tokenInfo)
+build_bayes_index_entry (char const * suffix, KvpValue * value, ImapBayesIndex & index)
 {
-    if (strlen(suffix) == GUID_ENCODING_LENGTH)
+    auto len = strlen (suffix);
+    if (len < GUID_ENCODING_LENGTH + 2 || suffix[0] != '/' ||
+        suffix[len - GUID_ENCODING_LENGTH - 1] != '/')
+        return;
+    std::string token {suffix + 1, len - GUID_ENCODING_LENGTH - 2};
+    auto& info = index.tokens[token];
+    auto count = value->get<int64_t>();
+    info.total_count += count;
+    info.accounts.emplace_back (AccountTokenCount{std::string{suffix + len - GUID_ENCODING_LENGTH}, count});
+}
+
+static void
+imap_bayes_index_clear (AccountPrivate *priv)
+{
+    delete priv->imap_bayes_index;
+    priv->imap_bayes_index = nullptr;
+}
+
+static ImapBayesIndex &
+imap_bayes_index_get (Account *acc)
+{
+    auto priv = GET_PRIVATE (acc);
+    auto generation = qof_instance_get_slots (QOF_INSTANCE (acc))->generation ();
+    if (priv->imap_bayes_index && priv->imap_bayes_index->generation != generation)
+        imap_bayes_index_clear (priv);
+    if (!priv->imap_bayes_index)
+    {
+        priv->imap_bayes_index = new ImapBayesIndex;
+        priv->imap_bayes_index->generation = generation;
+        qof_instance_foreach_slot_prefix (QOF_INSTANCE (acc), IMAP_FRAME_BAYES,
+                                          &build_bayes_index_entry,
+                                          *priv->imap_bayes_index);
+    }
+    return *priv->imap_bayes_index;
+}
+
+/* Keep an already built index in step with change_imap_entry, which
+ * has just made the one write to the frame since it saw generation. */
+static void
+imap_bayes_index_add (Account *acc, uint64_t generation,
+                      std::string const & token, std::string const & guid,
+                      int64_t token_count)
+{
+    auto priv = GET_PRIVATE (acc);
+    if (!priv->imap_bayes_index)
+        return;
+    if (priv->imap_bayes_index->generation != generation)
     {
-        tokenInfo.total_count += value->get<int64_t>();
-        /*By convention, the key ends with the account GUID.*/
-        tokenInfo.accounts.emplace_back(AccountTokenCount{std::string{suffix}, value->get<int64_t>()});
+        imap_bayes_index_clear (priv);
+        return;
     }
+    priv->imap_bayes_index->generation =
+        qof_instance_get_slots (QOF_INSTANCE (acc))->generation ();
+    auto& info = priv->imap_bayes_index->tokens[token];
+    info.total_count += token_count;
+    auto it = std::lower_bound (info.accounts.begin (), info.accounts.end (), guid,
+                                [] (AccountTokenCount const & a, std::string const & g) {
+                                    return a.account_guid < g;
+                                });
+    if (it != info.accounts.end () && it->account_guid == guid)
+        it->token_count += token_count;
+    else
+        info.accounts.insert (it, AccountTokenCount{guid, token_count});
 }
 
 /** We scale the probability values by probability_factor.
@@ -5645,25 +6105,27 @@ static ProbabilityVec
 get_first_pass_probabilities(GncImportMatchMap * imap, GList * tokens)
 {
     ProbabilityVec ret;
+    /* Where each account guid sits in ret. */
+    std::unordered_map<std::string, size_t> positions;
+    auto const & index = imap_bayes_index_get (imap->acc);
     /* find the probability for each account that contains any of the tokens
      * in the input tokens list. */
     for (auto current_token = tokens; current_token; current_token = current_token->next)
     {
-        TokenAccountsInfo tokenInfo{};
-        auto path = std::string{IMAP_FRAME_BAYES "/"} + static_cast <char const *> (current_token->data) + "/";
-        qof_instance_foreach_slot_prefix (QOF_INSTANCE (imap->acc), path, &build_token_info, tokenInfo);
+        auto token_info = index.tokens.find (static_cast <char const *> (current_token->data));
+        if (token_info == index.tokens.end ())
+            continue;
+        auto const & tokenInfo = token_info->second;
         for (auto const & current_account_token : tokenInfo.accounts)
         {
-            auto item = std::find_if(ret.begin(), ret.end(), [&current_account_token]
-                (std::pair<std::string, AccountProbability> const & a) {
-                    return current_account_token.account_guid == a.first;
-                });
-            if (item != ret.end())
+            auto item = positions.find (current_account_token.account_guid);
+            if (item != positions.end ())
             {/* This account is already in the map */
-                item->second.product = ((double)current_account_token.token_count /
-                                      (double)tokenInfo.total_count) * item->second.product;
-                item->second.product_difference = ((double)1 - ((double)current_account_token.token_count /
-                                              (double)tokenInfo.total_count)) * item->second.product_difference;
+                auto& prob = ret[item->second].second;
+                prob.product = ((double)current_account_token.token_count /
+                                      (double)tokenInfo.total_count) * prob.product;
+                prob.product_difference = ((double)1 - ((double)current_account_token.token_count /
+                                              (double)tokenInfo.total_count)) * prob.product_difference;
             }
             else
             {
@@ -5672,6 +6134,7 @@ get_first_pass_probabilities(GncImportMatchMap * imap, GList * tokens)
                 new_probability.product = ((double)current_account_token.token_count /
                                       (double)tokenInfo.total_count);
                 new_probability.product_difference = 1 - (new_probability.product);
+                positions.emplace (current_account_token.account_guid, ret.size ());
                 ret.push_back({current_account_token.account_guid, std::move(new_probability)});
             }
         } /* for all accounts in tokenInfo */
@@ -5871,9 +6334,12 @@ gnc_account_imap_find_account_bayes (GncImportMatchMap *imap, GList *tokens)
 }
 
 static void
-change_imap_entry (GncImportMatchMap *imap, std::string const & path, int64_t token_count)
+change_imap_entry (GncImportMatchMap *imap, std::string const & token,
+                   std::string const & guid, int64_t token_count)
 {
     GValue value = G_VALUE_INIT;
+    auto path = std::string {IMAP_FRAME_BAYES} + '/' + token + '/' + guid;
+    auto added = token_count;
 
     PINFO("Source Account is '%s', Count is '%" G_GINT64_FORMAT "'",
            xaccAccountGetName (imap->acc), token_count);
@@ -5900,7 +6366,9 @@ change_imap_entry (GncImportMatchMap *imap, std::string const & path, int64_t to
     g_value_set_int64 (&value, token_count);
 
     // Add or Update the entry based on guid
+    auto generation = qof_instance_get_slots (QOF_INSTANCE (imap->acc))->generation ();
     qof_instance_set_path_kvp (QOF_INSTANCE (imap->acc), &value, {path});
+    imap_bayes_index_add (imap->acc, generation, token, guid, added);
     gnc_features_set_used (imap->book, GNC_FEATURE_GUID_FLAT_BAYESIAN);
     g_value_unset (&value);
 }
@@ -5945,9 +6413,9 @@ gnc_account_imap_add_account_bayes (GncImportMatchMap *imap,
         /* start off with one token for this account */
         token_count = 1;
         PINFO("adding token '%s'", (char*)current_token->data);
-        auto path = std::string {IMAP_FRAME_BAYES} + '/' + static_cast<char*>(current_token->data) + '/' + guid_string;
         /* change the imap entry for the account */
-        change_imap_entry (imap, path, token_count);
+        change_imap_entry (imap, static_cast<char*>(current_token->data),
+                           guid_string, token_count);
     }
     /* free up the account fullname and guid string */
     qof_instance_set_dirty (QOF_INSTANCE (imap->acc));
@@ -6164,6 +6632,144 @@ static QofObject account_object_def =
     DI(.version_cmp       = ) (int (*)(gpointer, gpointer)) qof_instance_version_cmp,
 };
 
+/* ================================================================ */
+/* Query index for splits */
+
+static gboolean
+query_param_path_is (QofQueryParamList *path, const char *first,
+                     const char *second)
+{
+    return path && path->next && !path->next->next &&
+        !g_strcmp0 (static_cast<const char*>(path->data), first) &&
+        !g_strcmp0 (static_cast<const char*>(path->next->data), second);
+}
+
+/* Serves query branches that limit the split's account to a list of
+ * accounts, as xaccQueryAddAccountMatch does, by walking those
+ * accounts' splits. Posted-date bounds in the same branch narrow the
+ * walk to a range of each account's date-ordered splits. Only
+ * committed splits are seen, as they're the only ones the accounts
+ * know about. */
+static gboolean
+split_account_query_index (QofBook *book, GList *and_terms, GList **covered,
+                           QofInstanceForeachCB cb, gpointer user_data)
+{
+    QofQueryTerm *account_term = nullptr;
+    std::vector<QofQueryTerm*> date_terms;
+    time64 first = INT64_MIN, last = INT64_MAX;
+
+    for (auto node = and_terms; node; node = node->next)
+    {
+        auto qt = static_cast<QofQueryTerm*>(node->data);
+        auto path = qof_query_term_get_param_path (qt);
+        auto pd = qof_query_term_get_pred_data (qt);
+
+        if (qof_query_term_is_inverted (qt))
+            continue;
+        if (!account_term &&
+            query_param_path_is (path, SPLIT_ACCOUNT, QOF_PARAM_GUID) &&
+            !g_strcmp0 (pd->type_name, QOF_TYPE_GUID) &&
+            ((query_guid_t) pd)->options == QOF_GUID_MATCH_ANY)
+        {
+            account_term = qt;
+        }
+        else if (query_param_path_is (path, SPLIT_TRANS, TRANS_DATE_POSTED) &&
+                 !g_strcmp0 (pd->type_name, QOF_TYPE_DATE) &&
+                 ((query_date_t) pd)->options == QOF_DATE_MATCH_NORMAL)
+        {
+            auto date = ((query_date_t) pd)->date;
+            switch (pd->how)
+            {
+            case QOF_COMPARE_LT:
+                if (date == INT64_MIN)
+                    return FALSE;
+                last = std::min (last, date - 1);
+                break;
+            case QOF_COMPARE_LTE:
+                last = std::min (last, date);
+                break;
+            case QOF_COMPARE_GT:
+                if (date == INT64_MAX)
+                    return FALSE;
+                first = std::max (first, date + 1);
+                break;
+            case QOF_COMPARE_GTE:
+                first = std::max (first, date);
+                break;
+            case QOF_COMPARE_EQUAL:
+                first = std::max (first, date);
+                last = std::min (last, date);
+                break;
+            default:
+                continue;
+            }
+            date_terms.push_back (qt);
+        }
+    }
+    if (!account_term)
+        return FALSE;
+
+    if (!book)
+    {
+        *covered = g_list_prepend (*covered, account_term);
+        for (auto qt : date_terms)
+            *covered = g_list_prepend (*covered, qt);
+        return TRUE;
+    }
+
+    auto posted = [] (const Split *s)
+    {
+        return xaccTransRetDatePosted (xaccSplitGetParent (s));
+    };
+    auto pd = (query_guid_t) qof_query_term_get_pred_data (account_term);
+    std::unordered_set<Account*> seen;
+    for (auto node = pd->guids; node; node = node->next)
+    {
+        auto acc = xaccAccountLookup (static_cast<GncGUID*>(node->data), book);
+        if (!acc || !seen.insert (acc).second)
+            continue;
+
+        auto priv = GET_PRIVATE (acc);
+        auto begin = priv->splits.begin (), end = priv->splits.end ();
+        /* The splits are ordered by posted date first. */
+        if (!priv->sort_dirty)
+        {
+            begin = std::lower_bound (begin, end, first,
+                                      [&posted] (const Split *s, time64 t)
+                                      { return posted (s) < t; });
+            end = std::upper_bound (begin, end, last,
+                                    [&posted] (time64 t, const Split *s)
+                                    { return t < posted (s); });
+        }
+        for (auto it = begin; it != end; ++it)
+        {
+            auto s = *it;
+            auto t = posted (s);
+            if (t < first || t > last || xaccSplitGetAccount (s) != acc)
+                continue;
+            cb (QOF_INSTANCE (s), user_data);
+        }
+    }
+    return TRUE;
+}
+
+/* A live split query may read through the account, as an account name
+ * or code term or an account sort does. A full name also changes with
+ * the names of the account's ancestors, so the descendants' splits are
+ * passed on too. */
+static void
+split_account_query_related (QofInstance *changed, QofInstanceForeachCB cb,
+                             gpointer user_data)
+{
+    auto acc = GNC_ACCOUNT (changed);
+    auto accounts = gnc_account_get_descendants (acc);
+    accounts = g_list_prepend (accounts, acc);
+    for (auto node = accounts; node; node = node->next)
+        for (auto s : GET_PRIVATE (GNC_ACCOUNT (node->data))->splits)
+            cb (QOF_INSTANCE (s), user_data);
+    g_list_free (accounts);
+}
+
 gboolean xaccAccountRegister (void)
 {
     static QofParam params[] =
@@ -6269,7 +6875,22 @@ gboolean xaccAccountRegister (void)
         { NULL },
     };
 
+    /* The KVP backed getters cache what they read and the dated balances
+     * walk the splits, so only the plain fields are marked. */
+    static const char* thread_safe_params[] =
+    {
+        ACCOUNT_NAME_, ACCOUNT_CODE_, ACCOUNT_DESCRIPTION_, ACCOUNT_TYPE_,
+        ACCOUNT_BALANCE_, ACCOUNT_CLEARED_, ACCOUNT_RECONCILED_,
+        ACCOUNT_NSCU, ACCOUNT_PARENT, QOF_PARAM_BOOK, QOF_PARAM_GUID,
+        nullptr
+    };
+
     qof_class_register (GNC_ID_ACCOUNT, (QofSortFunc) qof_xaccAccountOrder, params);
+    qof_class_set_thread_safe_parameters (GNC_ID_ACCOUNT, thread_safe_params);
+    qof_query_register_index (GNC_ID_SPLIT, "split-account",
+                              split_account_query_index);
+    qof_query_register_related (GNC_ID_SPLIT, GNC_ID_ACCOUNT,
+                                split_account_query_related);
 
     return qof_object_register (&account_object_def);
 }
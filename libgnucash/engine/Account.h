@@ -378,6 +378,37 @@ void gnc_account_set_sort_dirty (Account *acc);
  *  @param defer New value for the flag. */
 void gnc_account_set_defer_bal_computation (Account *acc, gboolean defer);
 
+/** Start a bulk load into a book. Until the matching
+ *  gnc_book_end_bulk_load() the accounts in the book only collect
+ *  the splits given to them: they don't keep them sorted and don't
+ *  recompute their balances. Backends use this while loading a whole
+ *  book so that the work is done once per account instead of once
+ *  per split. Calls may be nested.
+ *
+ *  @param book The book being loaded. */
+void gnc_book_begin_bulk_load (QofBook *book);
+
+/** Finish a bulk load started with gnc_book_begin_bulk_load(). When
+ *  the outermost bulk load ends the splits of every account in the
+ *  book are sorted and its balances recomputed, several accounts at a
+ *  time; see gnc_book_set_bulk_load_workers().
+ *
+ *  @param book The book being loaded. */
+void gnc_book_end_bulk_load (QofBook *book);
+
+/** Set how many threads gnc_book_end_bulk_load() uses to sort and
+ *  balance the accounts, each of which is done by a single thread.
+ *  0, the default, uses one thread per processor; 1 does all the work
+ *  on the calling thread.
+ *
+ *  @param n_workers The number of threads to use. */
+void gnc_book_set_bulk_load_workers (guint n_workers);
+
+/** Get the number of threads gnc_book_end_bulk_load() uses.
+ *
+ *  @return The value set with gnc_book_set_bulk_load_workers(). */
+guint gnc_book_get_bulk_load_workers (void);
+
 /** Insert the given split from an account.
  *
  *  @param acc The account to which the split should be added.
@@ -1039,21 +1070,29 @@ gboolean xaccAccountIsEquityType(GNCAccountType t);
 
 /** The xaccAccountGetSplitList() routine returns a pointer to a GList of
  *    the splits in the account.
- * @note This GList is the account's internal
- *    data structure: do not delete it when done; treat it as a read-only
- *    structure.  Note that some routines (such as xaccAccountRemoveSplit())
- *    modify this list directly, and could leave you with a corrupted
- *    pointer.
- * @note This should be changed so that the returned value is a copy
- * of the list. No other part of the code should have access to the
- * internal data structure used by this object.
+ * @note This GList is owned by the account: do not delete it when done;
+ *    treat it as a read-only structure.  It is only brought up to date
+ *    when this routine is called, so once splits have been added to,
+ *    removed from or re-sorted in the account (by xaccSplitDestroy(),
+ *    say) a list obtained earlier is out of date: call this again rather
+ *    than keep using it.  Walking an old list doesn't follow freed
+ *    nodes, but may skip or repeat splits.
+ * @note The account's splits are really stored in a vector; C++ code
+ * should use xaccAccountGetSplits() from Account.hpp, which doesn't need
+ * the list.
  */
 SplitList* xaccAccountGetSplitList (const Account *account);
 
+/** The xaccAccountGetSplitsSize() routine returns the number of splits
+ *    in the account. Unlike xaccAccountCountSplits() it is O(1) and
+ *    doesn't look at child accounts.
+ */
+size_t xaccAccountGetSplitsSize (const Account *account);
+
 
 /** The xaccAccountCountSplits() routine returns the number of all
- *    the splits in the account. xaccAccountCountSplits is O(N). if
- *    testing for emptiness, use xaccAccountGetSplitList != NULL.
+ *    the splits in the account. if testing for emptiness, use
+ *    xaccAccountGetSplitsSize() == 0.
 
  * @param acc the account for which to count the splits
  *
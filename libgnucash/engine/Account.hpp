@@ -0,0 +1,53 @@
+/********************************************************************\
+ * Account.hpp -- Account C++ interface                             *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+/** @addtogroup Engine
+    @{ */
+/** @addtogroup Account
+    @{ */
+
+/** @file Account.hpp
+ *  @brief Account public routines (C++ api)
+ */
+
+#ifndef GNC_ACCOUNT_HPP
+#define GNC_ACCOUNT_HPP
+
+#include <vector>
+
+#include "Account.h"
+
+using SplitsVec = std::vector<Split*>;
+
+/** Get the account's splits in xaccSplitOrder order. Unlike
+ *  xaccAccountGetSplitList() this does not materialize a GList; the
+ *  returned vector is the account's own storage and is only valid
+ *  until the account's splits next change.
+ *
+ *  @param acc The account
+ *
+ *  @return A reference to the account's split vector. */
+const SplitsVec& xaccAccountGetSplits (const Account* acc);
+
+#endif /* GNC_ACCOUNT_HPP */
+/** @} */
+/** @} */
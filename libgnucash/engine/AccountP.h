@@ -42,6 +42,16 @@
 #include "Account.h"
 
 #ifdef __cplusplus
+extern "C++" {
+#include <utility>
+#include "Account.hpp"
+
+/* (reconcile date, reconciled balance as of that date) */
+using ReconciledIndex = std::vector<std::pair<time64, gnc_numeric>>;
+
+struct ImapBayesIndex;
+}
+
 extern "C" {
 #endif
 
@@ -63,6 +73,7 @@ typedef enum
 } TriState;
 
 /** \struct Account */
+#ifdef __cplusplus
 typedef struct AccountPrivate
 {
     /* The accountName is an arbitrary string assigned by the user.
@@ -122,10 +133,34 @@ typedef struct AccountPrivate
     gnc_numeric reconciled_balance;
 
     gboolean balance_dirty;     /* balances in splits incorrect */
+    /* Index of the first split whose cached balances are incorrect;
+     * SIZE_MAX while balance_dirty is FALSE. */
+    size_t balance_dirty_from;
 
-    GList *splits;              /* list of split pointers */
+    /* The splits in this account, kept in xaccSplitOrder order unless
+     * sort_dirty is set. Each split's list_acc points back here. */
+    SplitsVec splits;
     gboolean sort_dirty;        /* sort order of splits is bad */
 
+    /* GList copy of splits handed out by xaccAccountGetSplitList.
+     * Only brought up to date with splits when someone asks for it
+     * after splits_list_stale is set. Nodes no longer needed are kept
+     * in splits_list_spare rather than freed; see
+     * account_splits_list_update. */
+    GList *splits_list;
+    gboolean splits_list_stale;
+    std::vector<GList*> splits_list_spare;
+
+    /* The reconciled splits ordered by date_reconciled with running
+     * totals, for xaccAccountGetReconciledBalanceAsOfDate. Built on
+     * demand and invalidated each time the balances are recomputed. */
+    ReconciledIndex reconciled_index;
+    gboolean reconciled_index_valid;
+
+    /* The import-map-bayes slots grouped by token. Built by the first
+     * Bayesian lookup and kept up to date by the import map code. */
+    ImapBayesIndex *imap_bayes_index;
+
     LotList   *lots;		/* list of lot pointers */
     GNCPolicy *policy;		/* Cached pointer to policy method */
 
@@ -145,6 +180,11 @@ typedef struct AccountPrivate
     short mark;
     gboolean defer_bal_computation;
 } AccountPrivate;
+#else
+/* The private data uses C++ containers; C code only ever sees it
+ * through a pointer. */
+typedef struct AccountPrivate AccountPrivate;
+#endif
 
 struct account_s
 {
@@ -159,6 +199,16 @@ void xaccAccountSetGUID (Account *account, const GncGUID *guid);
 /* Register Accounts with the engine */
 gboolean xaccAccountRegister (void);
 
+/* Mark the cached running balances of split and of every split after
+ * it in acc as needing recomputation. Splits before it keep theirs, so
+ * the next xaccAccountRecomputeBalance only walks the tail. */
+void gnc_account_set_balance_dirty_from (Account *acc, Split *split);
+
+/* Drop the index xaccAccountGetReconciledBalanceAsOfDate keeps of the
+ * reconciled splits by reconcile date. Call it when a split's reconcile
+ * date changes, which doesn't otherwise touch the balances. */
+void gnc_account_set_reconciled_index_dirty (Account *acc);
+
 /* Structure for accessing static functions for testing */
 typedef struct
 {
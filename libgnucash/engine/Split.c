@@ -110,6 +110,7 @@ gnc_split_init(Split* split)
     /* fill in some sane defaults */
     split->acc         = NULL;
     split->orig_acc    = NULL;
+    split->list_acc    = NULL;
     split->parent      = NULL;
     split->lot         = NULL;
 
@@ -721,6 +722,7 @@ xaccFreeSplit (Split *split)
     split->lot         = NULL;
     split->acc         = NULL;
     split->orig_acc    = NULL;
+    split->list_acc    = NULL;
     split->split_type  = NULL;
 
     split->date_reconciled = 0;
@@ -735,7 +737,10 @@ void mark_split (Split *s)
 {
     if (s->acc)
     {
-        g_object_set(s->acc, "sort-dirty", TRUE, "balance-dirty", TRUE, NULL);
+        /* Locate the split before flagging the sort order, while a
+         * binary search can still find it. */
+        gnc_account_set_balance_dirty_from (s->acc, s);
+        gnc_account_set_sort_dirty (s->acc);
     }
 
     /* set dirty flag on lot too. */
@@ -1036,7 +1041,8 @@ xaccSplitCommitEdit(Split *s)
 
     if (acc)
     {
-        g_object_set(acc, "sort-dirty", TRUE, "balance-dirty", TRUE, NULL);
+        gnc_account_set_balance_dirty_from (acc, s);
+        gnc_account_set_sort_dirty (acc);
         xaccAccountRecomputeBalance(acc);
     }
 }
@@ -1807,6 +1813,8 @@ xaccSplitSetDateReconciledSecs (Split *split, time64 secs)
     xaccTransBeginEdit (split->parent);
 
     split->date_reconciled = secs;
+    if (split->acc)
+        gnc_account_set_reconciled_index_dirty (split->acc);
     qof_instance_set_dirty(QOF_INSTANCE(split));
     xaccTransCommitEdit(split->parent);
 
@@ -2341,7 +2349,19 @@ gboolean xaccSplitRegister (void)
             { NULL },
         };
 
+    /* Getters that only read the split's fields; queries using the KVP
+     * backed ones stay serial. */
+    static const char* thread_safe_params[] =
+        {
+            SPLIT_DATE_RECONCILED, SPLIT_BALANCE, SPLIT_CLEARED_BALANCE,
+            SPLIT_RECONCILED_BALANCE, SPLIT_MEMO, SPLIT_ACTION,
+            SPLIT_RECONCILE, SPLIT_AMOUNT, SPLIT_SHARE_PRICE, SPLIT_VALUE,
+            SPLIT_LOT, SPLIT_TRANS, SPLIT_ACCOUNT, QOF_PARAM_BOOK,
+            QOF_PARAM_GUID, NULL
+        };
+
     qof_class_register (GNC_ID_SPLIT, (QofSortFunc)xaccSplitOrder, params);
+    qof_class_set_thread_safe_parameters (GNC_ID_SPLIT, thread_safe_params);
     qof_class_register (SPLIT_ACCT_FULLNAME,
                         (QofSortFunc)xaccSplitCompareAccountFullNames, NULL);
     qof_class_register (SPLIT_CORR_ACCT_NAME,
@@ -72,28 +72,19 @@ struct split_s
 {
     QofInstance inst;
 
-    Account *acc;              /* back-pointer to debited/credited account  */
-    Account *orig_acc;
-    GNCLot *lot;               /* back-pointer to debited/credited lot */
+    /* The fields that balance walks, sorting and register loads read
+     * come first, so that they share as few cache lines as possible.
+     * Keep the rarely used ones below the balances. */
 
+    Account *acc;              /* back-pointer to debited/credited account  */
     Transaction *parent;       /* parent of split                           */
-    Transaction *orig_parent;
-
-    /* The memo field is an arbitrary user-assiged value.
-     * It is intended to hold a short (zero to forty character) string
-     * that is displayed by the GUI along with this split.
-     */
-    const char  *memo;
 
-    /* The action field is an arbitrary user-assigned value.
-     * It is meant to be a very short (one to ten character) string that
-     * signifies the "type" of this split, such as e.g. Buy, Sell, Div,
-     * Withdraw, Deposit, ATM, Check, etc. The idea is that this field
-     * can be used to create custom reports or graphs of data.
-     */
-    const char  *action;       /* Buy, Sell, Div, etc.                      */
+    /* 'value' is the quantity of the transaction balancing commodity
+     * (i.e. currency) involved, 'amount' is the amount of the account's
+     * commodity involved. */
+    gnc_numeric  amount;
+    gnc_numeric  value;
 
-    time64 date_reconciled;    /* date split was reconciled                 */
     char   reconciled;         /* The reconciled field                      */
 
     /* gains is a flag used to track the relationship between
@@ -103,20 +94,6 @@ struct split_s
      */
     unsigned char  gains;
 
-    /* 'gains_split' is a convenience pointer used to track down the
-     * other end of a cap-gains transaction pair.  NULL if this split
-     * doesn't involve cap gains.
-     */
-    Split *gains_split;
-
-    /* 'value' is the quantity of the transaction balancing commodity
-     * (i.e. currency) involved, 'amount' is the amount of the account's
-     * commodity involved. */
-    gnc_numeric  value;
-    gnc_numeric  amount;
-
-    const gchar * split_type;
-
     /* -------------------------------------------------------------- */
     /* Below follow some 'temporary' fields */
 
@@ -128,6 +105,43 @@ struct split_s
     gnc_numeric  noclosing_balance;
     gnc_numeric  cleared_balance;
     gnc_numeric  reconciled_balance;
+
+    /* -------------------------------------------------------------- */
+    /* Rarely used fields */
+
+    GNCLot *lot;               /* back-pointer to debited/credited lot */
+
+    /* 'gains_split' is a convenience pointer used to track down the
+     * other end of a cap-gains transaction pair.  NULL if this split
+     * doesn't involve cap gains.
+     */
+    Split *gains_split;
+
+    /* The memo field is an arbitrary user-assiged value.
+     * It is intended to hold a short (zero to forty character) string
+     * that is displayed by the GUI along with this split.
+     */
+    const char  *memo;
+
+    /* The action field is an arbitrary user-assigned value.
+     * It is meant to be a very short (one to ten character) string that
+     * signifies the "type" of this split, such as e.g. Buy, Sell, Div,
+     * Withdraw, Deposit, ATM, Check, etc. The idea is that this field
+     * can be used to create custom reports or graphs of data.
+     */
+    const char  *action;       /* Buy, Sell, Div, etc.                      */
+
+    const gchar * split_type;
+
+    time64 date_reconciled;    /* date split was reconciled                 */
+
+    /* The account and transaction the split had at its last commit. */
+    Account *orig_acc;
+    Transaction *orig_parent;
+
+    /* The account whose split vector holds this split, if any.  Only
+     * gnc_account_insert_split and gnc_account_remove_split set it. */
+    Account *list_acc;
 };
 
 struct _SplitClass
@@ -56,6 +56,8 @@
 #include "SchedXaction.h"
 #include "gncBusiness.h"
 #include <qofinstance-p.h>
+#include "qofquery-p.h"
+#include "qofquerycore-p.h"
 #include "gncInvoice.h"
 #include "gncOwner.h"
 
@@ -3215,6 +3217,64 @@ trans_is_balanced_p (const Transaction *trans)
     return trans ? xaccTransIsBalanced(trans) : FALSE;
 }
 
+/* A change to a transaction can change which of its splits a live split
+ * query matches, or where they sort. */
+static void
+split_trans_query_related (QofInstance *changed, QofInstanceForeachCB cb,
+                           gpointer user_data)
+{
+    Transaction *trans = GNC_TRANSACTION (changed);
+    FOR_EACH_SPLIT (trans, cb (QOF_INSTANCE (s), user_data));
+}
+
+/* Query index for splits: serves query branches that limit the split's
+ * transaction to a list of transactions by walking their splits. */
+static gboolean
+split_trans_query_index (QofBook *book, GList *and_terms, GList **covered,
+                         QofInstanceForeachCB cb, gpointer user_data)
+{
+    QofQueryTerm *trans_term = NULL;
+    query_guid_t pd = NULL;
+    GList *node, *seen = NULL;
+
+    for (node = and_terms; node; node = node->next)
+    {
+        QofQueryTerm *qt = node->data;
+        QofQueryParamList *path = qof_query_term_get_param_path (qt);
+        QofQueryPredData *pdata = qof_query_term_get_pred_data (qt);
+
+        if (qof_query_term_is_inverted (qt) || !path || !path->next ||
+            path->next->next ||
+            g_strcmp0 (path->data, SPLIT_TRANS) ||
+            g_strcmp0 (path->next->data, QOF_PARAM_GUID) ||
+            g_strcmp0 (pdata->type_name, QOF_TYPE_GUID) ||
+            ((query_guid_t) pdata)->options != QOF_GUID_MATCH_ANY)
+            continue;
+        trans_term = qt;
+        pd = (query_guid_t) pdata;
+        break;
+    }
+    if (!trans_term)
+        return FALSE;
+
+    if (!book)
+    {
+        *covered = g_list_prepend (*covered, trans_term);
+        return TRUE;
+    }
+
+    for (node = pd->guids; node; node = node->next)
+    {
+        Transaction *trans = xaccTransLookup (node->data, book);
+        if (!trans || g_list_find (seen, trans))
+            continue;
+        seen = g_list_prepend (seen, trans);
+        FOR_EACH_SPLIT (trans, cb (QOF_INSTANCE (s), user_data));
+    }
+    g_list_free (seen);
+    return TRUE;
+}
+
 gboolean xaccTransRegister (void)
 {
     static QofParam params[] =
@@ -3298,7 +3358,21 @@ gboolean xaccTransRegister (void)
             { NULL },
         };
 
+    /* Notes, the closing flag and the type are cached on first read, so
+     * queries on those stay serial. */
+    static const char* thread_safe_params[] =
+        {
+            TRANS_NUM, TRANS_DESCRIPTION, TRANS_DATE_ENTERED,
+            TRANS_DATE_POSTED, TRANS_SPLITLIST, QOF_PARAM_BOOK,
+            QOF_PARAM_GUID, NULL
+        };
+
     qof_class_register (GNC_ID_TRANS, (QofSortFunc)xaccTransOrder, params);
+    qof_class_set_thread_safe_parameters (GNC_ID_TRANS, thread_safe_params);
+    qof_query_register_index (GNC_ID_SPLIT, "split-trans",
+                              split_trans_query_index);
+    qof_query_register_related (GNC_ID_SPLIT, GNC_ID_TRANS,
+                                split_trans_query_related);
 
     return qof_object_register (&trans_object_def);
 }
@@ -426,10 +426,18 @@ gnc_numeric gnc_numeric_abs(gnc_numeric a);
 /**
  * Shortcut for common case: gnc_numeric_add(a, b, GNC_DENOM_AUTO,
  *                        GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
+ *
+ * When both operands have the same positive denominator, as amounts in
+ * one commodity do, the sum is computed directly in 64 bits; only a
+ * denominator mismatch or an overflow goes through gnc_numeric_add().
  */
 static inline
 gnc_numeric gnc_numeric_add_fixed(gnc_numeric a, gnc_numeric b)
 {
+    if (G_LIKELY(a.denom == b.denom && a.denom > 0) &&
+        !(b.num > 0 && a.num > G_MAXINT64 - b.num) &&
+        !(b.num < 0 && a.num <= G_MININT64 - b.num))
+        return gnc_numeric_create(a.num + b.num, a.denom);
     return gnc_numeric_add(a, b, GNC_DENOM_AUTO,
                            GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
 }
@@ -437,10 +445,17 @@ gnc_numeric gnc_numeric_add_fixed(gnc_numeric a, gnc_numeric b)
 /**
  * Shortcut for most common case: gnc_numeric_sub(a, b, GNC_DENOM_AUTO,
  *                        GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
+ *
+ * Like gnc_numeric_add_fixed() this stays in 64 bits for operands with
+ * the same positive denominator.
  */
 static inline
 gnc_numeric gnc_numeric_sub_fixed(gnc_numeric a, gnc_numeric b)
 {
+    if (G_LIKELY(a.denom == b.denom && a.denom > 0) &&
+        !(b.num < 0 && a.num > G_MAXINT64 + b.num) &&
+        !(b.num > 0 && a.num <= G_MININT64 + b.num))
+        return gnc_numeric_create(a.num - b.num, a.denom);
     return gnc_numeric_sub(a, b, GNC_DENOM_AUTO,
                            GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
 }
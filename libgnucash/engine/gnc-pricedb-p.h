@@ -57,7 +57,13 @@ struct gnc_price_db_s
     QofInstance inst;              /* globally unique object identifier */
     GHashTable *commodity_hash;
     gboolean bulk_update;		 /* TRUE while reading XML file, etc. */
-    gboolean reset_nth_price_cache;
+    /* All prices of nth_price_commodity, for gnc_pricedb_nth_price. */
+    const gnc_commodity *nth_price_commodity;
+    GPtrArray *nth_price_view;
+    /* Rates found by get_nearest_price, see ConversionCacheEntry. */
+    GHashTable *conversion_cache;
+    guint64 conversion_cache_hits;
+    guint64 conversion_cache_misses;
 };
 
 struct _GncPriceDBClass
@@ -40,9 +40,12 @@ static gboolean remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup);
 static GNCPrice *lookup_nearest_in_time(GNCPriceDB *db, const gnc_commodity *c,
                                         const gnc_commodity *currency,
                                         time64 t, gboolean sameday);
+static void pricedb_invalidate_conversions(GNCPriceDB *db, const GNCPrice *p);
+static void pricedb_invalidate_nth_price_view(GNCPriceDB *db,
+                                              const gnc_commodity *c);
 static gboolean
 pricedb_pricelist_traversal(GNCPriceDB *db,
-                            gboolean (*f)(GList *p, gpointer user_data),
+                            gboolean (*f)(GPtrArray *p, gpointer user_data),
                             gpointer user_data);
 
 enum
@@ -576,6 +579,7 @@ gnc_price_set_value(GNCPrice *p, gnc_numeric value)
         p->value = value;
         gnc_price_set_dirty(p);
         gnc_price_commit_edit (p);
+        pricedb_invalidate_conversions (p->db, p);
     }
 }
 
@@ -824,15 +828,284 @@ gnc_price_list_equal(PriceList *prices1, PriceList *prices2)
     return TRUE;
 }
 
+/* ==================================================================== */
+/* price array manipulation functions
+
+   The prices for one commodity/currency pair are kept in a GPtrArray
+   sorted the same way as a PriceList, newest first by
+   compare_prices_by_date, so that insertion and the time-based lookups
+   can bisect it instead of walking a list. The array holds a reference
+   to each of its prices.
+ */
+
+/* Returns the index of the first price in prices that is no newer than
+ * t, or if inclusive is FALSE strictly older than t; prices->len if
+ * there is none. */
+static guint
+price_array_bisect_time (const GPtrArray *prices, time64 t, gboolean inclusive)
+{
+    guint lo = 0, hi = prices->len;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        time64 price_t = gnc_price_get_time64 (g_ptr_array_index (prices, mid));
+        if (price_t > t || (!inclusive && price_t == t))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Returns the index at which p sorts in prices. */
+static guint
+price_array_bisect_price (const GPtrArray *prices, const GNCPrice *p)
+{
+    guint lo = 0, hi = prices->len;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        if (compare_prices_by_date (g_ptr_array_index (prices, mid), p) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static gboolean
+price_array_find (const GPtrArray *prices, const GNCPrice *p, guint *index)
+{
+    guint i = price_array_bisect_price (prices, p);
+
+    if (i < prices->len && g_ptr_array_index (prices, i) == p)
+    {
+        *index = i;
+        return TRUE;
+    }
+    /* The price's sort key changed while it was in the array. */
+    for (i = 0; i < prices->len; i++)
+    {
+        if (g_ptr_array_index (prices, i) == p)
+        {
+            *index = i;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/* All prices in the array have the same commodity and currency and
+ * those on one day are adjacent, so only the neighbours of index need
+ * to be checked for a price with the same day and value as p. */
+static gboolean
+price_array_is_duplicate (const GPtrArray *prices, const GNCPrice *p,
+                          guint index)
+{
+    time64 day = time64CanonicalDayTime (gnc_price_get_time64 (p));
+    gnc_numeric value = gnc_price_get_value (p);
+    guint i;
+
+    for (i = index; i > 0; i--)
+    {
+        GNCPrice *other = g_ptr_array_index (prices, i - 1);
+        if (time64CanonicalDayTime (gnc_price_get_time64 (other)) != day)
+            break;
+        if (gnc_numeric_equal (gnc_price_get_value (other), value))
+            return TRUE;
+    }
+    for (i = index; i < prices->len; i++)
+    {
+        GNCPrice *other = g_ptr_array_index (prices, i);
+        if (time64CanonicalDayTime (gnc_price_get_time64 (other)) != day)
+            break;
+        if (gnc_numeric_equal (gnc_price_get_value (other), value))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/* Same contract as gnc_price_list_insert. */
+static gboolean
+price_array_insert (GPtrArray *prices, GNCPrice *p, gboolean check_dupl)
+{
+    guint index;
+
+    if (!prices || !p) return FALSE;
+    gnc_price_ref (p);
+
+    index = price_array_bisect_price (prices, p);
+    if (check_dupl && price_array_is_duplicate (prices, p, index))
+        return TRUE;
+
+    g_ptr_array_insert (prices, index, p);
+    return TRUE;
+}
+
+/* Same contract as gnc_price_list_remove. */
+static gboolean
+price_array_remove (GPtrArray *prices, GNCPrice *p)
+{
+    guint index;
+
+    if (!prices || !p) return FALSE;
+    if (!price_array_find (prices, p, &index)) return TRUE;
+
+    g_ptr_array_remove_index (prices, index);
+    gnc_price_unref (p);
+    return TRUE;
+}
+
+/* Returns a PriceList of the array's prices in the same order. The
+ * list does not hold references to them. */
+static PriceList *
+price_list_from_array (const GPtrArray *prices)
+{
+    GList *result = NULL;
+    guint i;
+
+    for (i = prices->len; i > 0; i--)
+        result = g_list_prepend (result, g_ptr_array_index (prices, i - 1));
+    return result;
+}
+
+/* Of two prices the one that sorts first in a PriceList, or the one that
+ * isn't NULL. */
+static GNCPrice *
+price_first_of (GNCPrice *a, GNCPrice *b)
+{
+    if (!a) return b;
+    if (!b) return a;
+    return compare_prices_by_date (a, b) <= 0 ? a : b;
+}
+
+/* Of two prices the one that sorts last in a PriceList, or the one that
+ * isn't NULL. */
+static GNCPrice *
+price_last_of (GNCPrice *a, GNCPrice *b)
+{
+    if (!a) return b;
+    if (!b) return a;
+    return compare_prices_by_date (a, b) > 0 ? a : b;
+}
+
+/* ==================================================================== */
+/* conversion rate cache
+
+   Reports ask get_nearest_price for the same rates over and over, and
+   finding an indirect rate means scanning every price series in the
+   database. The rates found are kept per pricedb until a price involving
+   either commodity changes: an indirect rate from A to B is derived only
+   from prices that have A or B on one side, so those are the only entries
+   a price can invalidate. Rates for INT64_MAX ("latest") aren't cached
+   because the indirect lookup then depends on the current time.
+ */
+
+#define CONVERSION_CACHE_MAX_ENTRIES 4096
+
+typedef struct
+{
+    const gnc_commodity *from;
+    const gnc_commodity *to;
+    time64 t;
+    gboolean before;
+    gnc_numeric rate;
+} ConversionCacheEntry;
+
+static guint
+conversion_key_hash (gconstpointer key)
+{
+    const ConversionCacheEntry *entry = key;
+    return g_direct_hash (entry->from) ^ (g_direct_hash (entry->to) * 31) ^
+        g_int64_hash (&entry->t) ^ (guint)entry->before;
+}
+
+static gboolean
+conversion_key_equal (gconstpointer a, gconstpointer b)
+{
+    const ConversionCacheEntry *ea = a, *eb = b;
+    return ea->from == eb->from && ea->to == eb->to && ea->t == eb->t &&
+        ea->before == eb->before;
+}
+
+static ConversionCacheEntry *
+conversion_cache_lookup (GNCPriceDB *db, const gnc_commodity *from,
+                         const gnc_commodity *to, time64 t, gboolean before)
+{
+    ConversionCacheEntry key = {from, to, t, before};
+    ConversionCacheEntry *entry;
+
+    if (!db || !db->conversion_cache || t == INT64_MAX) return NULL;
+    entry = g_hash_table_lookup (db->conversion_cache, &key);
+    if (entry)
+        db->conversion_cache_hits++;
+    else
+        db->conversion_cache_misses++;
+    return entry;
+}
+
+static void
+conversion_cache_insert (GNCPriceDB *db, const gnc_commodity *from,
+                         const gnc_commodity *to, time64 t, gboolean before,
+                         gnc_numeric rate)
+{
+    ConversionCacheEntry *entry;
+
+    if (!db || !db->conversion_cache || t == INT64_MAX) return;
+    /* Crude but cheap bound: a report that walks more dates than this
+     * starts over rather than paying for LRU bookkeeping on every hit. */
+    if (g_hash_table_size (db->conversion_cache) >= CONVERSION_CACHE_MAX_ENTRIES)
+        g_hash_table_remove_all (db->conversion_cache);
+
+    entry = g_new (ConversionCacheEntry, 1);
+    entry->from = from;
+    entry->to = to;
+    entry->t = t;
+    entry->before = before;
+    entry->rate = rate;
+    g_hash_table_replace (db->conversion_cache, entry, NULL);
+}
+
+static gboolean
+conversion_uses_price (gpointer key, gpointer value, gpointer user_data)
+{
+    const ConversionCacheEntry *entry = key;
+    const GNCPrice *p = user_data;
+
+    return entry->from == p->commodity || entry->from == p->currency ||
+        entry->to == p->commodity || entry->to == p->currency;
+}
+
+static void
+pricedb_invalidate_conversions (GNCPriceDB *db, const GNCPrice *p)
+{
+    if (!db || !db->conversion_cache || !p) return;
+    if (g_hash_table_size (db->conversion_cache) == 0) return;
+    g_hash_table_foreach_remove (db->conversion_cache, conversion_uses_price,
+                                 (gpointer)p);
+}
+
+void
+gnc_pricedb_get_conversion_cache_stats (GNCPriceDB *db, guint64 *hits,
+                                        guint64 *misses)
+{
+    if (hits)
+        *hits = db ? db->conversion_cache_hits : 0;
+    if (misses)
+        *misses = db ? db->conversion_cache_misses : 0;
+}
+
 /* ==================================================================== */
 /* GNCPriceDB functions
 
    Structurally a GNCPriceDB contains a hash mapping price commodities
    (of type gnc_commodity*) to hashes mapping price currencies (of
-   type gnc_commodity*) to GNCPrice lists (see gnc-pricedb.h for a
-   description of GNCPrice lists).  The top-level key is the commodity
-   you want the prices for, and the second level key is the commodity
-   that the value is expressed in terms of.
+   type gnc_commodity*) to GPtrArrays of GNCPrices sorted newest first
+   (see above).  The top-level key is the commodity you want the prices
+   for, and the second level key is the commodity that the value is
+   expressed in terms of.
  */
 
 /* GObject Initialization */
@@ -841,7 +1114,6 @@ QOF_GOBJECT_IMPL(gnc_pricedb, GNCPriceDB, QOF_TYPE_INSTANCE);
 static void
 gnc_pricedb_init(GNCPriceDB* pdb)
 {
-    pdb->reset_nth_price_cache = FALSE;
 }
 
 static void
@@ -884,6 +1156,10 @@ gnc_pricedb_create(QofBook * book)
 
     result->commodity_hash = g_hash_table_new(NULL, NULL);
     g_return_val_if_fail (result->commodity_hash, NULL);
+    result->conversion_cache = g_hash_table_new_full (conversion_key_hash,
+                                                      conversion_key_equal,
+                                                      g_free, NULL);
+    result->nth_price_view = g_ptr_array_new ();
     return result;
 }
 
@@ -892,18 +1168,18 @@ destroy_pricedb_currency_hash_data(gpointer key,
                                    gpointer data,
                                    gpointer user_data)
 {
-    GList *price_list = (GList *) data;
-    GList *node;
-    GNCPrice *p;
+    GPtrArray *prices = (GPtrArray *) data;
+    guint i;
 
-    for (node = price_list; node; node = node->next)
+    for (i = 0; i < prices->len; i++)
     {
-        p = node->data;
+        GNCPrice *p = g_ptr_array_index (prices, i);
 
         p->db = NULL;
+        gnc_price_unref (p);
     }
 
-    gnc_price_list_destroy(price_list);
+    g_ptr_array_free (prices, TRUE);
 }
 
 static void
@@ -931,6 +1207,13 @@ gnc_pricedb_destroy(GNCPriceDB *db)
     }
     g_hash_table_destroy (db->commodity_hash);
     db->commodity_hash = NULL;
+    PINFO ("conversion cache: %" G_GUINT64_FORMAT " hits, %" G_GUINT64_FORMAT
+           " misses", db->conversion_cache_hits, db->conversion_cache_misses);
+    g_hash_table_destroy (db->conversion_cache);
+    db->conversion_cache = NULL;
+    g_ptr_array_free (db->nth_price_view, TRUE);
+    db->nth_price_view = NULL;
+    db->nth_price_commodity = NULL;
     /* qof_instance_release (&db->inst); */
     g_object_unref(db);
 }
@@ -1013,7 +1296,7 @@ pricedb_equal_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
 {
     GNCPriceDBEqualData *equal_data = user_data;
     gnc_commodity *currency = key;
-    GList *price_list1 = val;
+    GList *price_list1 = price_list_from_array (val);
     GList *price_list2;
 
     price_list2 = gnc_pricedb_get_prices (equal_data->db2,
@@ -1023,6 +1306,7 @@ pricedb_equal_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
     if (!gnc_price_list_equal (price_list1, price_list2))
         equal_data->equal = FALSE;
 
+    g_list_free (price_list1);
     gnc_price_list_destroy (price_list2);
 }
 
@@ -1072,7 +1356,7 @@ add_price(GNCPriceDB *db, GNCPrice *p)
 {
     /* This function will use p, adding a ref, so treat p as read-only
        if this function succeeds. */
-    GList *price_list;
+    GPtrArray *prices;
     gnc_commodity *commodity;
     gnc_commodity *currency;
     GHashTable *currency_hash;
@@ -1135,21 +1419,21 @@ add_price(GNCPriceDB *db, GNCPrice *p)
         g_hash_table_insert(db->commodity_hash, commodity, currency_hash);
     }
 
-    price_list = g_hash_table_lookup(currency_hash, currency);
-    if (!gnc_price_list_insert(&price_list, p, !db->bulk_update))
+    prices = g_hash_table_lookup(currency_hash, currency);
+    if (!prices)
     {
-        LEAVE ("gnc_price_list_insert failed");
-        return FALSE;
+        prices = g_ptr_array_new ();
+        g_hash_table_insert(currency_hash, currency, prices);
     }
-
-    if (!price_list)
+    if (!price_array_insert(prices, p, !db->bulk_update))
     {
-        LEAVE (" no price list");
+        LEAVE ("price_array_insert failed");
         return FALSE;
     }
 
-    g_hash_table_insert(currency_hash, currency, price_list);
     p->db = db;
+    pricedb_invalidate_conversions (db, p);
+    pricedb_invalidate_nth_price_view (db, commodity);
 
     qof_event_gen (&p->inst, QOF_EVENT_ADD, NULL);
 
@@ -1199,7 +1483,7 @@ gnc_pricedb_add_price(GNCPriceDB *db, GNCPrice *p)
 static gboolean
 remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)
 {
-    GList *price_list;
+    GPtrArray *prices;
     gnc_commodity *commodity;
     gnc_commodity *currency;
     GHashTable *currency_hash;
@@ -1235,24 +1519,23 @@ remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)
     }
 
     qof_event_gen (&p->inst, QOF_EVENT_REMOVE, NULL);
-    price_list = g_hash_table_lookup(currency_hash, currency);
+    pricedb_invalidate_conversions (db, p);
+    prices = g_hash_table_lookup(currency_hash, currency);
     gnc_price_ref(p);
-    if (!gnc_price_list_remove(&price_list, p))
+    if (!price_array_remove(prices, p))
     {
         gnc_price_unref(p);
         LEAVE (" cannot remove price list");
         return FALSE;
     }
+    pricedb_invalidate_nth_price_view (db, commodity);
 
     /* if the price list is empty, then remove this currency from the
        commodity hash */
-    if (price_list)
-    {
-        g_hash_table_insert(currency_hash, currency, price_list);
-    }
-    else
+    if (prices->len == 0)
     {
         g_hash_table_remove(currency_hash, currency);
+        g_ptr_array_free(prices, TRUE);
 
         if (cleanup)
         {
@@ -1360,14 +1643,13 @@ pricedb_remove_foreach_pricelist (gpointer key,
                                   gpointer val,
                                   gpointer user_data)
 {
-    GList *price_list = (GList *) val;
-    GList *node = price_list;
+    GPtrArray *prices = (GPtrArray *) val;
     remove_info *data = (remove_info *) user_data;
 
     ENTER("key %p, value %p, data %p", key, val, user_data);
 
     /* now check each item in the list */
-    g_list_foreach(node, (GFunc)check_one_price_date, data);
+    g_ptr_array_foreach(prices, (GFunc)check_one_price_date, data);
 
     LEAVE(" ");
 }
@@ -1677,30 +1959,33 @@ static void
 hash_values_helper(gpointer key, gpointer value, gpointer data)
 {
     GList ** l = data;
+    GList *price_list = price_list_from_array (value);
     if (*l)
     {
         GList *new_l;
-        new_l = pricedb_price_list_merge(*l, value);
+        new_l = pricedb_price_list_merge(*l, price_list);
         g_list_free (*l);
+        g_list_free (price_list);
         *l = new_l;
     }
     else
-        *l = g_list_copy (value);
+        *l = price_list;
 }
 
 static PriceList *
 price_list_from_hashtable (GHashTable *hash, const gnc_commodity *currency)
 {
-    GList *price_list = NULL, *result = NULL ;
+    GPtrArray *prices = NULL;
+    GList *result = NULL;
     if (currency)
     {
-        price_list = g_hash_table_lookup(hash, currency);
-        if (!price_list)
+        prices = g_hash_table_lookup(hash, currency);
+        if (!prices)
         {
             LEAVE (" no price list");
             return NULL;
         }
-        result = g_list_copy (price_list);
+        result = price_list_from_array (prices);
     }
     else
     {
@@ -1789,24 +2074,64 @@ pricedb_get_prices_internal(GNCPriceDB *db, const gnc_commodity *commodity,
     return forward_list;
 }
 
+static GPtrArray *
+pricedb_get_price_array (GNCPriceDB *db, const gnc_commodity *commodity,
+                         const gnc_commodity *currency)
+{
+    GHashTable *currency_hash = g_hash_table_lookup (db->commodity_hash,
+                                                     commodity);
+    return currency_hash ? g_hash_table_lookup (currency_hash, currency) : NULL;
+}
+
+/* Finds the prices on either side of t among the prices of commodity in
+ * currency and of currency in commodity, without merging them into one
+ * list: *before is the first price in PriceList order that is no newer
+ * than t and *after is the one just ahead of it, the oldest price newer
+ * than t.  Either may be NULL. */
+static void
+pricedb_bracket_time (GNCPriceDB *db, const gnc_commodity *commodity,
+                      const gnc_commodity *currency, time64 t,
+                      GNCPrice **before, GNCPrice **after)
+{
+    GPtrArray *arrays[2];
+    int i;
+
+    arrays[0] = pricedb_get_price_array (db, commodity, currency);
+    arrays[1] = pricedb_get_price_array (db, currency, commodity);
+    *before = *after = NULL;
+    for (i = 0; i < 2; i++)
+    {
+        guint index;
+        if (!arrays[i]) continue;
+        index = price_array_bisect_time (arrays[i], t, TRUE);
+        if (index < arrays[i]->len)
+            *before = price_first_of (*before,
+                                      g_ptr_array_index (arrays[i], index));
+        if (index > 0)
+            *after = price_last_of (*after,
+                                    g_ptr_array_index (arrays[i], index - 1));
+    }
+}
+
 GNCPrice *gnc_pricedb_lookup_latest(GNCPriceDB *db,
                           const gnc_commodity *commodity,
                           const gnc_commodity *currency)
 {
-    GList *price_list;
-    GNCPrice *result;
+    GPtrArray *forward, *reverse;
+    GNCPrice *result = NULL;
 
     if (!db || !commodity || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, commodity, currency);
 
-    price_list = pricedb_get_prices_internal(db, commodity, currency, TRUE);
-    if (!price_list) return NULL;
-    /* This works magically because prices are inserted in date-sorted
-     * order, and the latest date always comes first. So return the
-     * first in the list.  */
-    result = price_list->data;
+    /* The latest price is at the front of its array. */
+    forward = pricedb_get_price_array (db, commodity, currency);
+    reverse = pricedb_get_price_array (db, currency, commodity);
+    if (forward)
+        result = g_ptr_array_index (forward, 0);
+    if (reverse)
+        result = price_first_of (result, g_ptr_array_index (reverse, 0));
+    if (!result) return NULL;
     gnc_price_ref(result);
-    g_list_free (price_list);
     LEAVE("price is %p", result);
     return result;
 }
@@ -1829,54 +2154,49 @@ typedef struct
 */
 
 static gboolean
-price_list_scan_any_currency(GList *price_list, gpointer data)
+price_list_scan_any_currency(GPtrArray *prices, gpointer data)
 {
     UsesCommodity *helper = (UsesCommodity*)data;
-    GList *node = price_list;
+    GNCPrice *price;
     gnc_commodity *com;
     gnc_commodity *cur;
+    guint index;
 
-    if (!price_list)
+    if (!prices || prices->len == 0)
         return TRUE;
 
-    com = gnc_price_get_commodity(node->data);
-    cur = gnc_price_get_currency(node->data);
+    price = g_ptr_array_index(prices, 0);
+    com = gnc_price_get_commodity(price);
+    cur = gnc_price_get_currency(price);
 
     /* if this price list isn't for the commodity we are interested in,
        ignore it. */
     if (com != helper->com && cur != helper->com)
         return TRUE;
 
-    /* The price list is sorted in decreasing order of time.  Find the first
-       price on it that is older than the requested time and add it and the
+    /* The prices are sorted in decreasing order of time.  Find the first
+       price that is older than the requested time and add it and the
        previous price to the result list. */
-    while (node != NULL)
+    index = price_array_bisect_time(prices, helper->t, FALSE);
+    if (index < prices->len)
     {
-        GNCPrice *price = node->data;
-        time64 price_t = gnc_price_get_time64(price);
-        if (price_t < helper->t)
-        {
-            /* If there is a previous price add it to the results. */
-            if (node->prev)
-            {
-                GNCPrice *prev_price = node->prev->data;
-                gnc_price_ref(prev_price);
-                *helper->list = g_list_prepend(*helper->list, prev_price);
-            }
-            /* Add the first price before the desired time */
-            gnc_price_ref(price);
-            *helper->list = g_list_prepend(*helper->list, price);
-            /* No point in looking further, they will all be older */
-            break;
-        }
-        else if (node->next == NULL)
+        /* If there is a previous price add it to the results. */
+        if (index > 0)
         {
-            /* The last price is later than given time, add it */
-            gnc_price_ref(price);
-            *helper->list = g_list_prepend(*helper->list, price);
+            GNCPrice *prev_price = g_ptr_array_index(prices, index - 1);
+            gnc_price_ref(prev_price);
+            *helper->list = g_list_prepend(*helper->list, prev_price);
         }
-        node = node->next;
+        /* Add the first price before the desired time */
+        price = g_ptr_array_index(prices, index);
     }
+    else
+    {
+        /* The last price is later than given time, add it */
+        price = g_ptr_array_index(prices, prices->len - 1);
+    }
+    gnc_price_ref(price);
+    *helper->list = g_list_prepend(*helper->list, price);
 
     return TRUE;
 }
@@ -2071,7 +2391,7 @@ gnc_pricedb_has_prices(GNCPriceDB *db,
                        const gnc_commodity *commodity,
                        const gnc_commodity *currency)
 {
-    GList *price_list;
+    GPtrArray *prices;
     GHashTable *currency_hash;
     gint size;
 
@@ -2086,8 +2406,8 @@ gnc_pricedb_has_prices(GNCPriceDB *db,
 
     if (currency)
     {
-        price_list = g_hash_table_lookup(currency_hash, currency);
-        if (price_list)
+        prices = g_hash_table_lookup(currency_hash, currency);
+        if (prices)
         {
             LEAVE("yes");
             return TRUE;
@@ -2131,9 +2451,9 @@ static void
 price_count_helper(gpointer key, gpointer value, gpointer data)
 {
     int *result = data;
-    GList *price_list = value;
+    GPtrArray *prices = value;
 
-    *result += g_list_length(price_list);
+    *result += prices->len;
 }
 
 int
@@ -2156,30 +2476,25 @@ gnc_pricedb_num_prices(GNCPriceDB *db,
     return result;
 }
 
-/* Helper function for combining the price lists in gnc_pricedb_nth_price. */
 static void
-list_combine (gpointer element, gpointer data)
+nth_price_view_append (gpointer key, gpointer value, gpointer data)
 {
-    GList *list = *(GList**)data;
-    if (list == NULL)
-        *(GList**)data = g_list_copy (element);
-    else
-    {
-        GList *new_list = g_list_concat ((GList *)list, g_list_copy (element));
-        *(GList**)data = new_list;
-    }
+    GPtrArray *view = data;
+    GPtrArray *prices = value;
+    guint i;
+
+    for (i = 0; i < prices->len; i++)
+        g_ptr_array_add (view, g_ptr_array_index (prices, i));
 }
 
 /* This function is used by gnc-tree-model-price.c for iterating through the
  * prices when building or filtering the pricedb dialog's
  * GtkTreeView. gtk-tree-view-price.c sorts the results after it has obtained
- * the values so there's nothing gained by sorting. However, for very large
- * collections of prices in multiple currencies (here commodity is the one being
- * priced and currency the one in which the price is denominated; note that they
- * may both be currencies or not) just concatenating the price lists together
- * can be expensive because the receiving list must be traversed to obtain its
- * end. To avoid that cost n times we cache the commodity and merged price list.
- * Since this is a GUI-driven function there is no concern about concurrency.
+ * the values so there's nothing gained by sorting. The tree model asks for
+ * every n of one commodity in turn, so the db keeps that commodity's prices
+ * (here commodity is the one being priced and currency the one in which the
+ * price is denominated; note that they may both be currencies or not) in
+ * one array until a price of that commodity is added or removed.
  */
 
 GNCPrice *
@@ -2187,51 +2502,46 @@ gnc_pricedb_nth_price (GNCPriceDB *db,
                        const gnc_commodity *c,
                        const int n)
 {
-    static const gnc_commodity *last_c = NULL;
-    static GList *prices = NULL;
-
     GNCPrice *result = NULL;
-    GHashTable *currency_hash;
     g_return_val_if_fail (GNC_IS_COMMODITY (c), NULL);
 
     if (!db || !c || n < 0) return NULL;
     ENTER ("db=%p commodity=%s index=%d", db, gnc_commodity_get_mnemonic(c), n);
 
-    if (last_c && prices && last_c == c && db->reset_nth_price_cache == FALSE)
+    if (db->nth_price_commodity != c)
     {
-        result = g_list_nth_data (prices, n);
-        LEAVE ("price=%p", result);
-        return result;
-    }
+        GHashTable *currency_hash;
 
-    last_c = c;
-
-    if (prices)
-    {
-        g_list_free (prices);
-        prices = NULL;
+        g_ptr_array_set_size (db->nth_price_view, 0);
+        db->nth_price_commodity = c;
+        currency_hash = g_hash_table_lookup (db->commodity_hash, c);
+        if (currency_hash)
+            g_hash_table_foreach (currency_hash, nth_price_view_append,
+                                  db->nth_price_view);
     }
 
-    db->reset_nth_price_cache = FALSE;
-
-    currency_hash = g_hash_table_lookup (db->commodity_hash, c);
-    if (currency_hash)
-    {
-        GList *currencies = g_hash_table_get_values (currency_hash);
-        g_list_foreach (currencies, list_combine, &prices);
-        result = g_list_nth_data (prices, n);
-        g_list_free (currencies);
-    }
+    if ((guint)n < db->nth_price_view->len)
+        result = g_ptr_array_index (db->nth_price_view, n);
 
     LEAVE ("price=%p", result);
     return result;
 }
 
+static void
+pricedb_invalidate_nth_price_view (GNCPriceDB *db, const gnc_commodity *c)
+{
+    if (db->nth_price_commodity && (!c || db->nth_price_commodity == c))
+    {
+        g_ptr_array_set_size (db->nth_price_view, 0);
+        db->nth_price_commodity = NULL;
+    }
+}
+
 void
 gnc_pricedb_nth_price_reset_cache (GNCPriceDB *db)
 {
     if (db)
-        db->reset_nth_price_cache = TRUE;
+        pricedb_invalidate_nth_price_view (db, NULL);
 }
 
 GNCPrice *
@@ -2249,27 +2559,17 @@ gnc_pricedb_lookup_at_time64(GNCPriceDB *db,
                              const gnc_commodity *currency,
                              time64 t)
 {
-    GList *price_list;
-    GList *item = NULL;
+    GNCPrice *p, *newer;
 
     if (!db || !c || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    item = price_list;
-    while (item)
+    pricedb_bracket_time (db, c, currency, t, &p, &newer);
+    if (p && gnc_price_get_time64(p) == t)
     {
-        GNCPrice *p = item->data;
-        time64 price_time = gnc_price_get_time64(p);
-        if (price_time == t)
-        {
-            gnc_price_ref(p);
-            g_list_free (price_list);
-            LEAVE("price is %p", p);
-            return p;
-        }
-        item = item->next;
+        gnc_price_ref(p);
+        LEAVE("price is %p", p);
+        return p;
     }
-    g_list_free (price_list);
     LEAVE (" ");
     return NULL;
 }
@@ -2281,35 +2581,24 @@ lookup_nearest_in_time(GNCPriceDB *db,
                        time64 t,
                        gboolean sameday)
 {
-    GList *price_list;
     GNCPrice *current_price = NULL;
     GNCPrice *next_price = NULL;
     GNCPrice *result = NULL;
-    GList *item = NULL;
 
     if (!db || !c || !currency) return NULL;
     if (t == INT64_MAX) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    if (!price_list) return NULL;
-    item = price_list;
-
-    /* default answer */
-    current_price = item->data;
 
-    /* find the first candidate past the one we want.  Remember that
-       prices are in most-recent-first order. */
-    while (!next_price && item)
+    /* next_price is the first candidate past the one we want and
+       current_price the one before it.  Remember that prices are in
+       most-recent-first order. */
+    pricedb_bracket_time (db, c, currency, t, &next_price, &current_price);
+    if (!current_price)
+        current_price = next_price;
+    if (!current_price)
     {
-        GNCPrice *p = item->data;
-        time64 price_time = gnc_price_get_time64(p);
-        if (price_time <= t)
-        {
-            next_price = item->data;
-            break;
-        }
-        current_price = item->data;
-        item = item->next;
+        LEAVE (" no prices");
+        return NULL;
     }
 
     if (current_price)      /* How can this be null??? */
@@ -2382,7 +2671,6 @@ lookup_nearest_in_time(GNCPriceDB *db,
     }
 
     gnc_price_ref(result);
-    g_list_free (price_list);
     LEAVE (" ");
     return result;
 }
@@ -2403,28 +2691,13 @@ gnc_pricedb_lookup_nearest_before_t64 (GNCPriceDB *db,
                                        const gnc_commodity *currency,
                                        time64 t)
 {
-    GList *price_list;
     GNCPrice *current_price = NULL;
-    /*  GNCPrice *next_price = NULL;
-        GNCPrice *result = NULL;*/
-    GList *item = NULL;
-    time64 price_time;
+    GNCPrice *next_price = NULL;
 
     if (!db || !c || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    if (!price_list) return NULL;
-    item = price_list;
-    do
-    {
-        price_time = gnc_price_get_time64 (item->data);
-        if (price_time <= t)
-            current_price = item->data;
-        item = item->next;
-    }
-    while (price_time > t && item);
+    pricedb_bracket_time (db, c, currency, t, &current_price, &next_price);
     gnc_price_ref(current_price);
-    g_list_free (price_list);
     LEAVE (" ");
     return current_price;
 }
@@ -2589,10 +2862,15 @@ get_nearest_price (GNCPriceDB *pdb,
                    gboolean before)
 {
     gnc_numeric price;
+    ConversionCacheEntry *entry;
 
     if (gnc_commodity_equiv (orig_curr, new_curr))
         return gnc_numeric_create (1, 1);
 
+    entry = conversion_cache_lookup (pdb, orig_curr, new_curr, t, before);
+    if (entry)
+        return entry->rate;
+
     /* Look for a direct price. */
     price = direct_price_conversion (pdb, orig_curr, new_curr, t, before);
 
@@ -2602,7 +2880,9 @@ get_nearest_price (GNCPriceDB *pdb,
     if (gnc_numeric_zero_p (price))
         price = indirect_price_conversion (pdb, orig_curr, new_curr, t, before);
 
-    return gnc_numeric_reduce (price);
+    price = gnc_numeric_reduce (price);
+    conversion_cache_insert (pdb, orig_curr, new_curr, t, before, price);
+    return price;
 }
 
 gnc_numeric
@@ -2704,16 +2984,15 @@ typedef struct
 static void
 pricedb_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
 {
-    GList *price_list = (GList *) val;
-    GList *node = price_list;
+    GPtrArray *prices = (GPtrArray *) val;
     GNCPriceDBForeachData *foreach_data = (GNCPriceDBForeachData *) user_data;
+    guint i;
 
     /* stop traversal when func returns FALSE */
-    while (foreach_data->ok && node)
+    for (i = 0; foreach_data->ok && i < prices->len; i++)
     {
-        GNCPrice *p = (GNCPrice *) node->data;
+        GNCPrice *p = (GNCPrice *) g_ptr_array_index (prices, i);
         foreach_data->ok = foreach_data->func(p, foreach_data->user_data);
-        node = node->next;
     }
 }
 
@@ -2750,18 +3029,18 @@ unstable_price_traversal(GNCPriceDB *db,
 typedef struct
 {
     gboolean ok;
-    gboolean (*func)(GList *p, gpointer user_data);
+    gboolean (*func)(GPtrArray *p, gpointer user_data);
     gpointer user_data;
 } GNCPriceListForeachData;
 
 static void
 pricedb_pricelist_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
 {
-    GList *price_list = (GList *) val;
+    GPtrArray *prices = (GPtrArray *) val;
     GNCPriceListForeachData *foreach_data = (GNCPriceListForeachData *) user_data;
     if (foreach_data->ok)
     {
-        foreach_data->ok = foreach_data->func(price_list, foreach_data->user_data);
+        foreach_data->ok = foreach_data->func(prices, foreach_data->user_data);
     }
 }
 
@@ -2774,7 +3053,7 @@ pricedb_pricelist_foreach_currencies_hash(gpointer key, gpointer val, gpointer u
 
 static gboolean
 pricedb_pricelist_traversal(GNCPriceDB *db,
-                         gboolean (*f)(GList *p, gpointer user_data),
+                         gboolean (*f)(GPtrArray *p, gpointer user_data),
                          gpointer user_data)
 {
     GNCPriceListForeachData foreach_data;
@@ -2846,12 +3125,12 @@ stable_price_traversal(GNCPriceDB *db,
         for (j = price_lists; j; j = j->next)
         {
             HashEntry *pricelist_entry = (HashEntry *) j->data;
-            GList *price_list = (GList *) pricelist_entry->value;
-            GList *node;
+            GPtrArray *prices = (GPtrArray *) pricelist_entry->value;
+            guint k;
 
-            for (node = (GList *) price_list; node; node = node->next)
+            for (k = 0; k < prices->len; k++)
             {
-                GNCPrice *price = (GNCPrice *) node->data;
+                GNCPrice *price = (GNCPrice *) g_ptr_array_index (prices, k);
 
                 /* stop traversal when f returns FALSE */
                 if (FALSE == ok) break;
@@ -3071,15 +3350,14 @@ VoidGNCPriceDBForeachData;
 static void
 void_pricedb_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
 {
-    GList *price_list = (GList *) val;
-    GList *node = price_list;
+    GPtrArray *prices = (GPtrArray *) val;
     VoidGNCPriceDBForeachData *foreach_data = (VoidGNCPriceDBForeachData *) user_data;
+    guint i;
 
-    while (node)
+    for (i = 0; i < prices->len; i++)
     {
-        GNCPrice *p = (GNCPrice *) node->data;
+        GNCPrice *p = (GNCPrice *) g_ptr_array_index (prices, i);
         foreach_data->func(p, foreach_data->user_data);
-        node = node->next;
     }
 }
 
@@ -647,6 +647,18 @@ gnc_pricedb_convert_balance_nearest_before_price_t64 (GNCPriceDB *pdb,
                                                      const gnc_commodity *new_currency,
                                                      time64 t);
 
+/** @brief Report how well the conversion rate cache is doing.
+ *
+ * The gnc_pricedb_get_*_price and gnc_pricedb_convert_balance_* functions
+ * remember the rates they find for a pair of commodities at a given time
+ * until a price involving either commodity is added, removed or changed.
+ * @param db The pricedb
+ * @param hits Set to the number of rates served from the cache
+ * @param misses Set to the number of rates that had to be looked up
+ */
+void gnc_pricedb_get_conversion_cache_stats (GNCPriceDB *db, guint64 *hits,
+                                             guint64 *misses);
+
 typedef gboolean (*GncPriceForeachFunc)(GNCPrice *p, gpointer user_data);
 
 /** @brief Call a GncPriceForeachFunction once for each price in db, until the
@@ -689,6 +701,12 @@ gnc_pricedb_nth_price (GNCPriceDB *db,
                        const gnc_commodity *c,
                        const int n);
 
+/** @brief Drop the index used by gnc_pricedb_nth_price.
+ *
+ * Adding or removing a price already does this for the affected commodity,
+ * so there is no need to call it after changing the db.
+ * @param db The pricedb
+ */
 void gnc_pricedb_nth_price_reset_cache (GNCPriceDB *db);
 
 /* The following two convenience functions are used to test the xml backend */
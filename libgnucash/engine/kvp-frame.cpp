@@ -37,6 +37,7 @@ extern "C"
 #include <typeinfo>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
 #include <vector>
 #include <numeric>
 
@@ -45,18 +46,102 @@ static QofLogModule log_module = "qof.kvp";
 
 static const char delim = '/';
 
+/* Frames up to this size are searched for a cached key by comparing
+ * pointers; bigger ones are bisected. */
+static const size_t flat_scan_max = 8;
+
+KvpPath::KvpPath (std::string const & path)
+{
+    std::string::size_type start = 0, end;
+    while ((end = path.find (delim, start)) != std::string::npos)
+    {
+        m_keys.emplace_back (path, start, end - start);
+        start = end + 1;
+    }
+    m_keys.emplace_back (path, start);
+}
+
+KvpPath::KvpPath (Path keys) : m_keys {std::move (keys)} {}
+
+KvpPath::KvpPath (KvpPath const & rhs) : m_keys {rhs.m_keys} {}
+
+KvpPath::~KvpPath () noexcept
+{
+    auto atoms = m_atoms.load (std::memory_order_acquire);
+    if (atoms)
+        release (atoms);
+    delete atoms;
+}
+
+void
+KvpPath::release (Atoms const * atoms) noexcept
+{
+    /* After the cache is destroyed our strings are already gone. */
+    if (atoms->generation == qof_string_cache_generation ())
+        std::for_each (atoms->atoms.begin (), atoms->atoms.end (),
+                       qof_string_cache_remove);
+}
+
+std::vector<char const *> const &
+KvpPath::atoms () const noexcept
+{
+    auto generation = qof_string_cache_generation ();
+    auto atoms = m_atoms.load (std::memory_order_acquire);
+    if (atoms && atoms->generation == generation)
+        return atoms->atoms;
+
+    std::lock_guard<std::mutex> lock {m_mutex};
+    atoms = m_atoms.load (std::memory_order_acquire);
+    if (atoms && atoms->generation == generation)
+        return atoms->atoms;
+
+    auto fresh = new Atoms {generation, {}};
+    for (auto const & key : m_keys)
+        fresh->atoms.push_back (qof_string_cache_insert (key.c_str ()));
+    m_atoms.store (fresh, std::memory_order_release);
+    if (atoms)
+        m_old_atoms.emplace_back (atoms);
+    return fresh->atoms;
+}
+
+uint64_t
+KvpFrameImpl::next_generation () noexcept
+{
+    static std::atomic<uint64_t> last_generation {0};
+    return last_generation.fetch_add (1, std::memory_order_relaxed) + 1;
+}
+
+static bool
+key_less (KvpFrameImpl::map_type::value_type const & a, char const * key)
+{
+    return std::strcmp (a.first, key) < 0;
+}
+
 KvpFrameImpl::KvpFrameImpl(const KvpFrameImpl & rhs) noexcept
 {
+    m_valuemap.reserve (rhs.m_valuemap.size ());
     std::for_each(rhs.m_valuemap.begin(), rhs.m_valuemap.end(),
         [this](const map_type::value_type & a)
         {
             auto key = qof_string_cache_insert(a.first);
             auto val = new KvpValueImpl(*a.second);
-            this->m_valuemap.insert({key,val});
+            this->m_valuemap.emplace_back(key,val);
         }
     );
 }
 
+void*
+KvpFrameImpl::operator new(std::size_t size)
+{
+    return QofArena::allocate(size, alignof(KvpFrameImpl));
+}
+
+void
+KvpFrameImpl::operator delete(void* ptr) noexcept
+{
+    QofArena::deallocate(ptr);
+}
+
 KvpFrameImpl::~KvpFrameImpl() noexcept
 {
     std::for_each(m_valuemap.begin(), m_valuemap.end(),
@@ -68,13 +153,50 @@ KvpFrameImpl::~KvpFrameImpl() noexcept
     m_valuemap.clear();
 }
 
+KvpFrameImpl::map_type::iterator
+KvpFrameImpl::find (char const * key) noexcept
+{
+    auto spot = std::lower_bound (m_valuemap.begin (), m_valuemap.end (),
+                                  key, key_less);
+    if (spot != m_valuemap.end () && !std::strcmp (spot->first, key))
+        return spot;
+    return m_valuemap.end ();
+}
+
+KvpFrameImpl::map_type::const_iterator
+KvpFrameImpl::find (char const * key) const noexcept
+{
+    return const_cast<KvpFrameImpl*>(this)->find (key);
+}
+
+/* Find a key from the string cache. All of our keys come from there
+ * too, so a small frame only needs its key pointers compared. */
+KvpFrameImpl::map_type::iterator
+KvpFrameImpl::find_atom (char const * atom) noexcept
+{
+    if (m_valuemap.size () > flat_scan_max)
+        return find (atom);
+    return std::find_if (m_valuemap.begin (), m_valuemap.end (),
+                         [atom] (map_type::value_type const & a)
+                         { return a.first == atom; });
+}
+
+/* key must already be in the string cache, and not in the frame. */
+void
+KvpFrameImpl::insert (char const * key, KvpValue * value) noexcept
+{
+    auto spot = std::lower_bound (m_valuemap.begin (), m_valuemap.end (),
+                                  key, key_less);
+    m_valuemap.emplace (spot, key, value);
+}
+
 KvpFrame *
 KvpFrame::get_child_frame_or_nullptr (Path const & path) noexcept
 {
     if (!path.size ())
         return this;
     auto key = path.front ();
-    auto map_iter = m_valuemap.find (key.c_str ());
+    auto map_iter = find (key.c_str ());
     if (map_iter == m_valuemap.end ())
         return nullptr;
     auto child = map_iter->second->get <KvpFrame *> ();
@@ -91,12 +213,12 @@ KvpFrame::get_child_frame_or_create (Path const & path) noexcept
     if (!path.size ())
         return this;
     auto key = path.front ();
-    auto spot = m_valuemap.find (key.c_str ());
+    auto spot = find (key.c_str ());
     if (spot == m_valuemap.end () || spot->second->get_type () != KvpValue::Type::FRAME)
         delete set_impl (key.c_str (), new KvpValue {new KvpFrame});
     Path send;
     std::copy (path.begin () + 1, path.end (), std::back_inserter (send));
-    auto child_val = m_valuemap.at (key.c_str ());
+    auto child_val = find (key.c_str ())->second;
     auto child = child_val->get <KvpFrame *> ();
     return child->get_child_frame_or_create (send);
 }
@@ -106,21 +228,47 @@ KvpValue *
 KvpFrame::set_impl (std::string const & key, KvpValue * value) noexcept
 {
     KvpValue * ret {};
-    auto spot = m_valuemap.find (key.c_str ());
+    auto spot = find (key.c_str ());
     if (spot != m_valuemap.end ())
     {
-        qof_string_cache_remove (spot->first);
         ret = spot->second;
+        if (value)
+        {
+            spot->second = value;
+            return ret;
+        }
+        qof_string_cache_remove (spot->first);
         m_valuemap.erase (spot);
     }
     if (value)
     {
         auto cachedkey = static_cast <char const *> (qof_string_cache_insert (key.c_str ()));
-        m_valuemap.emplace (cachedkey, value);
+        insert (cachedkey, value);
     }
     return ret;
 }
 
+KvpValue *
+KvpFrame::set_atom (char const * atom, KvpValue * value) noexcept
+{
+    KvpValue * ret {};
+    auto spot = find_atom (atom);
+    if (spot != m_valuemap.end ())
+    {
+        ret = spot->second;
+        if (value)
+        {
+            spot->second = value;
+            return ret;
+        }
+        qof_string_cache_remove (spot->first);
+        m_valuemap.erase (spot);
+    }
+    if (value)
+        insert (qof_string_cache_insert (atom), value);
+    return ret;
+}
+
 KvpValue *
 KvpFrameImpl::set (Path path, KvpValue* value) noexcept
 {
@@ -131,6 +279,7 @@ KvpFrameImpl::set (Path path, KvpValue* value) noexcept
     auto target = get_child_frame_or_nullptr (path);
     if (!target)
         return nullptr;
+    m_generation = next_generation ();
     return target->set_impl (key, value);
 }
 
@@ -142,9 +291,54 @@ KvpFrameImpl::set_path (Path path, KvpValue* value) noexcept
     auto target = get_child_frame_or_create (path);
     if (!target)
         return nullptr;
+    m_generation = next_generation ();
     return target->set_impl (key, value);
 }
 
+KvpValue *
+KvpFrameImpl::set_compiled_path (KvpPath const & path, KvpValue* value) noexcept
+{
+    auto const & atoms = path.atoms ();
+    if (atoms.empty ())
+        return nullptr;
+    m_generation = next_generation ();
+    auto target = this;
+    for (auto atom = atoms.begin (); atom + 1 != atoms.end (); ++atom)
+    {
+        auto spot = target->find_atom (*atom);
+        if (spot == target->m_valuemap.end () ||
+            spot->second->get_type () != KvpValue::Type::FRAME)
+        {
+            delete target->set_atom (*atom, new KvpValue {new KvpFrame});
+            spot = target->find_atom (*atom);
+        }
+        target = spot->second->get <KvpFrame *> ();
+    }
+    return target->set_atom (atoms.back (), value);
+}
+
+KvpValue *
+KvpFrameImpl::get_compiled_slot (KvpPath const & path) noexcept
+{
+    auto const & atoms = path.atoms ();
+    if (atoms.empty ())
+        return nullptr;
+    auto target = this;
+    for (auto atom = atoms.begin (); atom + 1 != atoms.end (); ++atom)
+    {
+        auto spot = target->find_atom (*atom);
+        if (spot == target->m_valuemap.end ())
+            return nullptr;
+        target = spot->second->get <KvpFrame *> ();
+        if (!target)
+            return nullptr;
+    }
+    auto spot = target->find_atom (atoms.back ());
+    if (spot != target->m_valuemap.end ())
+        return spot->second;
+    return nullptr;
+}
+
 KvpValue *
 KvpFrameImpl::get_slot (Path path) noexcept
 {
@@ -153,7 +347,7 @@ KvpFrameImpl::get_slot (Path path) noexcept
     auto target = get_child_frame_or_nullptr (path);
     if (!target)
         return nullptr;
-    auto spot = target->m_valuemap.find (key.c_str ());
+    auto spot = target->find (key.c_str ());
     if (spot != target->m_valuemap.end ())
         return spot->second;
     return nullptr;
@@ -222,7 +416,7 @@ int compare(const KvpFrameImpl & one, const KvpFrameImpl & two) noexcept
 {
     for (const auto & a : one.m_valuemap)
     {
-        auto otherspot = two.m_valuemap.find(a.first);
+        auto otherspot = two.find(a.first);
         if (otherspot == two.m_valuemap.end())
         {
             return 1;
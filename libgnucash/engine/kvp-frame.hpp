@@ -85,7 +85,12 @@
 #define GNC_KVP_FRAME_TYPE
 
 #include "kvp-value.hpp"
+#include "qof-arena.hpp"
+#include <atomic>
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <cstring>
@@ -94,6 +99,49 @@
 using Path = std::vector<std::string>;
 using KvpEntry = std::pair <std::vector <std::string>, KvpValue*>;
 
+/**
+ * A path of keys resolved once to their entries in the QOF string cache.
+ * Frames keep their keys in the same cache, so looking a KvpPath up
+ * compares key pointers rather than strings. Make one for each path
+ * that's used often and keep it; making one for a single lookup is no
+ * faster than using the Path.
+ */
+class KvpPath
+{
+public:
+    /** @param path: The keys separated by '/', e.g. "tax-US/code". */
+    explicit KvpPath (std::string const & path);
+    explicit KvpPath (Path keys);
+    KvpPath (KvpPath const &);
+    KvpPath & operator= (KvpPath const &) = delete;
+    ~KvpPath () noexcept;
+
+    /** The keys as strings, for the Path-based functions. */
+    Path const & keys () const noexcept { return m_keys; }
+    /** The cached keys. They're looked up on first use, and again if
+     * the string cache has been destroyed since. Safe to call from
+     * several threads at once. */
+    std::vector<char const *> const & atoms () const noexcept;
+
+private:
+    struct Atoms
+    {
+        unsigned generation;
+        std::vector<char const *> atoms;
+    };
+
+    static void release (Atoms const * atoms) noexcept;
+
+    Path m_keys;
+    /* Read without the lock once it's set; only replaced, under the
+     * lock, when the string cache has been made again. */
+    mutable std::atomic<Atoms *> m_atoms {nullptr};
+    mutable std::mutex m_mutex;
+    /* Replaced atoms, kept until the path goes away in case another
+     * thread is still reading them. */
+    mutable std::vector<std::unique_ptr<Atoms>> m_old_atoms;
+};
+
 /** Implements KvpFrame.
  *  It's a struct because QofInstance needs to use the typename to declare a
  *  KvpFrame* member, and QofInstance's API is C until its children are all
@@ -118,7 +166,10 @@ struct KvpFrameImpl
 		return ret;
 	    }
     };
-    using map_type = std::map<const char *, KvpValue*, cstring_comparer>;
+    /* The children, kept sorted with cstring_comparer. Most frames
+     * hold a handful of slots, so a vector is smaller and quicker to
+     * walk than a tree; the few big ones (import maps) are bisected. */
+    using map_type = std::vector<std::pair<const char *, KvpValue*>>;
 
     public:
     KvpFrameImpl() noexcept {};
@@ -133,6 +184,10 @@ struct KvpFrameImpl
      */
     ~KvpFrameImpl() noexcept;
 
+    /** Frames made while a book is read in come from its arena. */
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr) noexcept;
+
     /**
      * Set the value with the key in the immediate frame, replacing and
      * returning the old value if it exists or nullptr if it doesn't. Takes
@@ -169,6 +224,10 @@ struct KvpFrameImpl
      * @return The old value if there was one or nullptr.
      */
     KvpValue* set_path(Path path, KvpValue* newvalue) noexcept;
+    /**
+     * Same as set_path but for a compiled path.
+     */
+    KvpValue* set_compiled_path(KvpPath const & path, KvpValue* newvalue) noexcept;
     /**
      * Make a string representation of the frame. Mostly useful for debugging.
      * @return A std::string representing the frame and all its children.
@@ -193,6 +252,9 @@ struct KvpFrameImpl
      */
     KvpValue* get_slot(Path keys) noexcept;
 
+    /** Same as get_slot but for a compiled path. */
+    KvpValue* get_compiled_slot(KvpPath const & path) noexcept;
+
     /** The function should be of the form:
      * <anything> func (char const *, KvpValue *, data_type &);
      * Do not pass nullptr as the function.
@@ -224,6 +286,12 @@ struct KvpFrameImpl
      * @return true if the frame contains nothing.
      */
     bool empty() const noexcept { return m_valuemap.empty(); }
+    /** A number that changes each time a slot is set or deleted through
+     * this frame's set functions and that no other frame shares, so a
+     * cache built from the frame can tell when it's out of date.
+     * Changes made directly to a child frame don't change it.
+     */
+    uint64_t generation() const noexcept { return m_generation; }
     friend int compare(const KvpFrameImpl&, const KvpFrameImpl&) noexcept;
 
     map_type::iterator begin() { return m_valuemap.begin(); }
@@ -231,11 +299,19 @@ struct KvpFrameImpl
 
     private:
     map_type m_valuemap;
+    uint64_t m_generation {next_generation ()};
+
+    static uint64_t next_generation () noexcept;
 
     KvpFrame * get_child_frame_or_nullptr (Path const &) noexcept;
     KvpFrame * get_child_frame_or_create (Path const &) noexcept;
     void flatten_kvp_impl(std::vector <std::string>, std::vector <KvpEntry> &) const noexcept;
     KvpValue * set_impl (std::string const &, KvpValue *) noexcept;
+    KvpValue * set_atom (char const *, KvpValue *) noexcept;
+    map_type::iterator find (char const *) noexcept;
+    map_type::const_iterator find (char const *) const noexcept;
+    map_type::iterator find_atom (char const *) noexcept;
+    void insert (char const *, KvpValue *) noexcept;
 };
 
 template<typename func_type, typename data_type>
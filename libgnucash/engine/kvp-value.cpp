@@ -23,6 +23,7 @@
 
 #include "kvp-value.hpp"
 #include "kvp-frame.hpp"
+#include "qof-arena.hpp"
 #include <cmath>
 
 #include <sstream>
@@ -381,6 +382,18 @@ delete_visitor::operator()(KvpFrame * & value)
     delete value;
 }
 
+void*
+KvpValueImpl::operator new(std::size_t size)
+{
+    return QofArena::allocate(size, alignof(KvpValueImpl));
+}
+
+void
+KvpValueImpl::operator delete(void* ptr) noexcept
+{
+    QofArena::deallocate(ptr);
+}
+
 KvpValueImpl::~KvpValueImpl() noexcept
 {
     delete_visitor d;
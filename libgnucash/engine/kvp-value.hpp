@@ -106,6 +106,10 @@ struct KvpValueImpl
      */
     ~KvpValueImpl() noexcept;
 
+    /** Values made while a book is read in come from its arena. */
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr) noexcept;
+
     /**
      * Replaces the frame within this KvpValueImpl.
      *
@@ -0,0 +1,222 @@
+/********************************************************************\
+ * qof-arena.cpp -- memory for objects made together in bulk         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "qof-arena.hpp"
+
+/* Blocks are aligned to their size, so the block an address is in, and
+ * through it the arena that owns the address, can be found from the
+ * address alone. Heap objects don't carry any extra header. */
+static constexpr int block_shift = 20;
+static constexpr std::size_t block_size = std::size_t{1} << block_shift;
+/* Anything bigger comes from the heap rather than waste a block's tail. */
+static constexpr std::size_t max_arena_alloc = block_size / 64;
+
+/* Only the thread doing the load allocates from its arena. */
+static thread_local QofArena* current_arena = nullptr;
+
+/* Which arena owns each block, as an open-addressing table that is
+ * read without a lock. A block's slot is filled in before anything is
+ * allocated from it and emptied only once everything in it has been
+ * freed, so a lookup for an arena address can't race the slot's
+ * changes; a lookup for a heap address just doesn't find it. Emptied
+ * slots are marked rather than cleared so that probes go on past them.
+ * Once the table is half full, arenas make no more blocks and allocate
+ * from the heap. */
+static constexpr std::size_t n_owner_slots = 8192;
+static constexpr std::uintptr_t empty_key = 0;
+static constexpr std::uintptr_t removed_key = ~std::uintptr_t{0};
+
+struct BlockOwner
+{
+    std::atomic<std::uintptr_t> key {empty_key};
+    std::atomic<QofArena*> arena {nullptr};
+};
+
+static BlockOwner block_owners[n_owner_slots];
+static std::atomic<std::size_t> n_blocks {0};
+
+static inline std::uintptr_t
+block_key (const void* ptr)
+{
+    return reinterpret_cast<std::uintptr_t>(ptr) >> block_shift;
+}
+
+static inline std::size_t
+block_slot (std::uintptr_t key)
+{
+    return (key * 0x9e3779b97f4a7c15ull) % n_owner_slots;
+}
+
+static bool
+add_block_owner (const void* block, QofArena* arena)
+{
+    if (n_blocks.fetch_add(1, std::memory_order_acq_rel) >= n_owner_slots / 2)
+    {
+        n_blocks.fetch_sub(1, std::memory_order_acq_rel);
+        return false;
+    }
+    auto key = block_key(block);
+    for (auto i = block_slot(key); ; i = (i + 1) % n_owner_slots)
+    {
+        auto& slot = block_owners[i];
+        auto old_key = slot.key.load(std::memory_order_acquire);
+        if (old_key != empty_key && old_key != removed_key)
+            continue;
+        /* Nothing looks the block's owner up before it has been set. */
+        if (slot.key.compare_exchange_strong(old_key, key,
+                                             std::memory_order_acq_rel))
+        {
+            slot.arena.store(arena, std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+static void
+remove_block_owner (const void* block)
+{
+    auto key = block_key(block);
+    auto i = block_slot(key);
+    for (std::size_t n = 0; n < n_owner_slots; n++, i = (i + 1) % n_owner_slots)
+    {
+        auto& slot = block_owners[i];
+        auto slot_key = slot.key.load(std::memory_order_acquire);
+        if (slot_key == empty_key)
+            return;
+        if (slot_key != key)
+            continue;
+        slot.key.store(removed_key, std::memory_order_release);
+        n_blocks.fetch_sub(1, std::memory_order_acq_rel);
+        return;
+    }
+}
+
+static QofArena*
+find_block_owner (const void* ptr)
+{
+    auto key = block_key(ptr);
+    auto i = block_slot(key);
+    for (std::size_t n = 0; n < n_owner_slots; n++, i = (i + 1) % n_owner_slots)
+    {
+        auto& slot = block_owners[i];
+        auto slot_key = slot.key.load(std::memory_order_acquire);
+        if (slot_key == empty_key)
+            return nullptr;
+        if (slot_key == key)
+            return slot.arena.load(std::memory_order_acquire);
+    }
+    return nullptr;
+}
+
+void*
+QofArena::allocate(std::size_t size, std::size_t align)
+{
+    auto arena = current_arena;
+    if (arena && size <= max_arena_alloc)
+        if (auto ptr = arena->alloc(size, align))
+            return ptr;
+    return ::operator new(size);
+}
+
+void*
+QofArena::alloc(std::size_t size, std::size_t align)
+{
+    auto pad = (align - reinterpret_cast<std::uintptr_t>(m_next) % align) % align;
+    if (static_cast<std::size_t>(m_end - m_next) < pad + size)
+    {
+        auto block = std::aligned_alloc(block_size, block_size);
+        if (!block)
+            throw std::bad_alloc();
+        if (!add_block_owner(block, this))
+        {
+            std::free(block);
+            return nullptr;
+        }
+        m_blocks.push_back(block);
+        m_next = static_cast<char*>(block);
+        m_end = m_next + block_size;
+        pad = 0;
+    }
+    auto ptr = m_next + pad;
+    m_next = ptr + size;
+    m_used += size;
+    m_refs.fetch_add(1, std::memory_order_relaxed);
+    return ptr;
+}
+
+void
+QofArena::deallocate(void* ptr) noexcept
+{
+    if (!ptr)
+        return;
+    if (n_blocks.load(std::memory_order_acquire))
+    {
+        if (auto owner = find_block_owner(ptr))
+        {
+            owner->unref();
+            return;
+        }
+    }
+    ::operator delete(ptr);
+}
+
+void
+QofArena::set_current(QofArena* arena) noexcept
+{
+    current_arena = arena;
+}
+
+void
+QofArena::unset_current(QofArena* arena) noexcept
+{
+    if (current_arena == arena)
+        current_arena = nullptr;
+}
+
+void
+QofArena::release() noexcept
+{
+    unset_current(this);
+    unref();
+}
+
+void
+QofArena::unref() noexcept
+{
+    if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+}
+
+QofArena::~QofArena()
+{
+    for (auto block : m_blocks)
+    {
+        remove_block_owner(block);
+        std::free(block);
+    }
+}
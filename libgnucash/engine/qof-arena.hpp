@@ -0,0 +1,93 @@
+/********************************************************************\
+ * qof-arena.hpp -- memory for objects made together in bulk         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup Object_Private
+    @{ */
+/** @file qof-arena.hpp
+    @brief Arena allocation for objects made during a bulk load.
+
+    A book creates a QofArena for its first bulk load, the one that
+    reads it in, and makes it the current one on the loading thread
+    until the load ends. Classes that define their operator new and
+    delete with QofArena::allocate and QofArena::deallocate, like
+    KvpFrameImpl and KvpValueImpl, are then carved out of a few large
+    blocks instead of being allocated one by one. Other threads, and the
+    loading thread once the load is over, allocate from the heap.
+
+    Freeing an object doesn't make its memory reusable. The blocks go
+    back to the system once the book has released the arena and every
+    object in it has been freed, so an object that outlives its book
+    stays valid. Any thread may free an object; finding out whether it
+    came from an arena takes no lock.
+*/
+
+#ifndef QOF_ARENA_HPP
+#define QOF_ARENA_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+class QofArena
+{
+public:
+    QofArena() = default;
+    QofArena(const QofArena&) = delete;
+    QofArena& operator=(const QofArena&) = delete;
+
+    /** Give up the owner's hold on the arena. It stops being the
+     *  current one and is deleted once nothing allocated from it is
+     *  left. */
+    void release() noexcept;
+
+    /** Allocate from the current arena if there is one, otherwise from
+     *  the heap. */
+    static void* allocate(std::size_t size, std::size_t align);
+
+    /** Free memory from allocate(), wherever it came from. */
+    static void deallocate(void* ptr) noexcept;
+
+    /** Make arena the one allocate() uses on the calling thread. */
+    static void set_current(QofArena* arena) noexcept;
+
+    /** Stop allocating from arena on the calling thread, if it is the
+     *  current one there. */
+    static void unset_current(QofArena* arena) noexcept;
+
+    /** How many bytes have been handed out, freed or not. */
+    std::size_t used() const noexcept { return m_used; }
+
+private:
+    ~QofArena();
+    void* alloc(std::size_t size, std::size_t align);
+    void unref() noexcept;
+
+    /* Only touched by the thread the arena is current on. */
+    std::vector<void*> m_blocks;
+    char* m_next = nullptr;
+    char* m_end = nullptr;
+    std::size_t m_used = 0;
+    /* One for the owner and one for each allocation not yet freed. */
+    std::atomic<std::size_t> m_refs {1};
+};
+
+#endif /* QOF_ARENA_HPP */
+/** @} */
@@ -246,6 +246,14 @@ public:
 /** Perform a sync in a way that prevents data loss on a DBI backend.
  */
     virtual void safe_sync(QofBook *) = 0;
+/** Report whether a sync is still writing its data out in the background.
+ *  This only looks; call wait_for_save() once it returns false to collect
+ *  the save's outcome.
+ */
+    virtual bool save_in_progress() const { return false; }
+/** Wait until a background sync has finished and set any error it met.
+ */
+    virtual void wait_for_save() {}
 /**   Extract the chart of accounts from the current database and create a new
  *   database with it. Implemented only in the XML backend at present.
  */
@@ -37,30 +37,196 @@ extern "C"
 #include "qof.h"
 }
 
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
 /* Uncomment if you need to log anything.
 static QofLogModule log_module = QOF_MOD_UTIL;
 */
 /* =================================================================== */
 /* The QOF string cache                                                */
 /*                                                                     */
-/* The cache is a GHashTable where a copy of the string is the key,    */
-/* and a ref count is the value                                        */
+/* The cache is split into shards by the string's hash, each with its  */
+/* own lock, so that threads loading a book only contend when they     */
+/* happen to hit the same shard. A string is kept in one block with    */
+/* its ref count in front of it; the blocks are carved from a per-     */
+/* shard arena and recycled through free lists by size.                */
 /* =================================================================== */
 
-static GHashTable* qof_string_cache = NULL;
+namespace
+{
+
+struct CacheEntry
+{
+    guint32 refcount;
+    guint32 size;               /* of the whole block */
+    char str[1];
+};
+
+constexpr size_t num_shards = 64;
+constexpr size_t size_quantum = 16;
+/* Strings with bigger blocks than this are allocated one by one. */
+constexpr size_t max_arena_size = 512;
+constexpr size_t arena_block_size = 64 * 1024;
+
+class CacheShard
+{
+public:
+    const char * insert (std::string_view key);
+    void remove (std::string_view key);
+    void add_stats (QofStringCacheStats *stats);
+    ~CacheShard ();
+
+private:
+    CacheEntry * allocate (size_t size);
+    void release (CacheEntry *entry);
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string_view, CacheEntry*> m_entries;
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    char * m_next {nullptr};
+    char * m_end {nullptr};
+    std::vector<CacheEntry*> m_free[max_arena_size / size_quantum];
+    gsize m_bytes {0};
+    gsize m_bytes_saved {0};
+};
+
+struct StringCache
+{
+    CacheShard shards[num_shards];
+};
+
+std::atomic<StringCache*> qof_string_cache {nullptr};
+std::mutex qof_string_cache_mutex;
+std::atomic<unsigned> qof_string_cache_gen {1};
+
+}
+
+CacheEntry *
+CacheShard::allocate (size_t size)
+{
+    size = (size + size_quantum - 1) / size_quantum * size_quantum;
+    if (size > max_arena_size)
+    {
+        auto entry = static_cast<CacheEntry*>(g_malloc (size));
+        entry->size = size;
+        return entry;
+    }
+
+    auto& free_list = m_free[size / size_quantum - 1];
+    CacheEntry *entry;
+    if (!free_list.empty ())
+    {
+        entry = free_list.back ();
+        free_list.pop_back ();
+    }
+    else
+    {
+        if (m_next + size > m_end)
+        {
+            m_blocks.emplace_back (new char[arena_block_size]);
+            m_next = m_blocks.back ().get ();
+            m_end = m_next + arena_block_size;
+        }
+        entry = reinterpret_cast<CacheEntry*>(m_next);
+        m_next += size;
+    }
+    entry->size = size;
+    return entry;
+}
+
+void
+CacheShard::release (CacheEntry *entry)
+{
+    if (entry->size > max_arena_size)
+        g_free (entry);
+    else
+        m_free[entry->size / size_quantum - 1].push_back (entry);
+}
+
+CacheShard::~CacheShard ()
+{
+    for (auto& [key, entry] : m_entries)
+        if (entry->size > max_arena_size)
+            g_free (entry);
+}
+
+const char *
+CacheShard::insert (std::string_view key)
+{
+    std::lock_guard<std::mutex> lock {m_mutex};
+    auto spot = m_entries.find (key);
+    if (spot != m_entries.end ())
+    {
+        ++spot->second->refcount;
+        m_bytes_saved += key.size () + 1;
+        return spot->second->str;
+    }
+
+    auto entry = allocate (offsetof (CacheEntry, str) + key.size () + 1);
+    entry->refcount = 1;
+    key.copy (entry->str, key.size ());
+    entry->str[key.size ()] = '\0';
+    m_entries.emplace (std::string_view {entry->str, key.size ()}, entry);
+    m_bytes += key.size () + 1;
+    return entry->str;
+}
+
+void
+CacheShard::remove (std::string_view key)
+{
+    std::lock_guard<std::mutex> lock {m_mutex};
+    auto spot = m_entries.find (key);
+    if (spot == m_entries.end ())
+        return;
+
+    auto entry = spot->second;
+    if (--entry->refcount > 0)
+    {
+        m_bytes_saved -= key.size () + 1;
+        return;
+    }
+    m_entries.erase (spot);
+    m_bytes -= key.size () + 1;
+    release (entry);
+}
 
-static GHashTable*
+void
+CacheShard::add_stats (QofStringCacheStats *stats)
+{
+    std::lock_guard<std::mutex> lock {m_mutex};
+    stats->unique_strings += m_entries.size ();
+    stats->bytes += m_bytes;
+    stats->bytes_saved += m_bytes_saved;
+}
+
+static StringCache*
 qof_get_string_cache(void)
 {
-    if (!qof_string_cache)
+    auto cache = qof_string_cache.load (std::memory_order_acquire);
+    if (cache)
+        return cache;
+
+    std::lock_guard<std::mutex> lock {qof_string_cache_mutex};
+    cache = qof_string_cache.load (std::memory_order_relaxed);
+    if (!cache)
     {
-        qof_string_cache = g_hash_table_new_full(
-                               g_str_hash,               /* hash_func          */
-                               g_str_equal,              /* key_equal_func     */
-                               g_free,                   /* key_destroy_func   */
-                               g_free);                  /* value_destroy_func */
+        cache = new StringCache;
+        qof_string_cache.store (cache, std::memory_order_release);
     }
-    return qof_string_cache;
+    return cache;
+}
+
+static CacheShard&
+qof_string_cache_shard (std::string_view key)
+{
+    auto hash = std::hash<std::string_view>{} (key);
+    return qof_get_string_cache ()->shards[hash % num_shards];
 }
 
 void
@@ -69,14 +235,23 @@ qof_string_cache_init(void)
     (void)qof_get_string_cache();
 }
 
+/* Not safe against other threads still using the cache. */
 void
 qof_string_cache_destroy (void)
 {
-    if (qof_string_cache)
+    std::lock_guard<std::mutex> lock {qof_string_cache_mutex};
+    auto cache = qof_string_cache.exchange (nullptr);
+    if (cache)
     {
-        g_hash_table_destroy(qof_string_cache);
+        delete cache;
+        ++qof_string_cache_gen;
     }
-    qof_string_cache = NULL;
+}
+
+unsigned
+qof_string_cache_generation (void)
+{
+    return qof_string_cache_gen;
 }
 
 /* If the key exists in the cache, check the refcount.  If 1, just
@@ -86,21 +261,8 @@ qof_string_cache_remove(const char * key)
 {
     if (key && key[0] != 0)
     {
-        GHashTable* cache = qof_get_string_cache();
-        gpointer value;
-        gpointer cache_key;
-        if (g_hash_table_lookup_extended(cache, key, &cache_key, &value))
-        {
-            guint* refcount = (guint*)value;
-            if (*refcount == 1)
-            {
-                g_hash_table_remove(cache, key);
-            }
-            else
-            {
-                --(*refcount);
-            }
-        }
+        std::string_view view {key};
+        qof_string_cache_shard (view).remove (view);
     }
 }
 
@@ -115,28 +277,25 @@ qof_string_cache_insert(const char * key)
         {
             return "";
         }
-
-        GHashTable* cache = qof_get_string_cache();
-        gpointer value;
-        gpointer cache_key;
-        if (g_hash_table_lookup_extended(cache, key, &cache_key, &value))
-        {
-            guint* refcount = (guint*)value;
-            ++(*refcount);
-            return static_cast <char *> (cache_key);
-        }
-        else
-        {
-            gpointer new_key = g_strdup(static_cast<const char*>(key));
-            guint* refcount = static_cast<unsigned int*>(g_malloc(sizeof(guint)));
-            *refcount = 1;
-            g_hash_table_insert(cache, new_key, refcount);
-            return static_cast <char *> (new_key);
-        }
+        std::string_view view {key};
+        return qof_string_cache_shard (view).insert (view);
     }
     return NULL;
 }
 
+void
+qof_string_cache_get_stats (QofStringCacheStats *stats)
+{
+    g_return_if_fail (stats);
+
+    memset (stats, 0, sizeof (*stats));
+    auto cache = qof_string_cache.load (std::memory_order_acquire);
+    if (!cache)
+        return;
+    for (auto& shard : cache->shards)
+        shard.add_stats (stats);
+}
+
 const char *
 qof_string_cache_replace(char const * dst, char const * src)
 {
@@ -66,7 +66,9 @@ extern "C"
  * Note that all the work is done when inserting or removing.  Once
  * cached the strings are just plain C strings.
  *
- * The string cache is demand-created on first use.
+ * The string cache is demand-created on first use. Inserting and
+ * removing strings is safe from several threads at once; initializing
+ * and destroying the cache is not.
  *
  **/
 
@@ -76,6 +78,24 @@ void qof_string_cache_init(void);
 /** Destroy the qof_string_cache */
 void qof_string_cache_destroy(void);
 
+/** A number that changes whenever the cache is destroyed. Anything
+ *  holding cached strings past a qof_string_cache_destroy() can check
+ *  it to find that its strings are gone and must not be removed.
+ */
+unsigned qof_string_cache_generation(void);
+
+/** How much the cache holds and how much it saves. */
+typedef struct
+{
+    gsize unique_strings;       /**< Strings in the cache */
+    gsize bytes;                /**< Their size, terminators included */
+    gsize bytes_saved;          /**< What the extra references would
+                                     have cost as separate copies */
+} QofStringCacheStats;
+
+/** Fill in stats with the cache's current figures. */
+void qof_string_cache_get_stats(QofStringCacheStats *stats);
+
 /** You can use this function as a destroy notifier for a GHashTable
    that uses common strings as keys (or values, for that matter.)
 */
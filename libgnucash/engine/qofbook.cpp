@@ -58,6 +58,7 @@ extern "C"
 #include "qofobject-p.h"
 #include "qofbookslots.h"
 #include "kvp-frame.hpp"
+#include "qof-arena.hpp"
 // For GNC_ID_ROOT_ACCOUNT:
 #include "AccountP.h"
 
@@ -435,6 +436,11 @@ qof_book_destroy (QofBook *book)
 
     qof_object_book_end (book);
 
+    /* Whatever is left in the arena keeps it alive until it's freed. */
+    if (book->arena)
+        static_cast<QofArena*>(book->arena)->release ();
+    book->arena = NULL;
+
     g_hash_table_destroy (book->data_table_finalizers);
     book->data_table_finalizers = NULL;
     g_hash_table_destroy (book->data_tables);
@@ -536,9 +542,58 @@ qof_book_shutting_down (const QofBook *book)
     return book->shutting_down;
 }
 
+gboolean
+qof_book_is_bulk_loading (const QofBook *book)
+{
+    if (!book) return FALSE;
+    return book->bulk_load_level > 0;
+}
+
 /* ====================================================================== */
 /* setters */
 
+static gboolean use_bulk_load_arena = TRUE;
+
+void
+qof_book_set_use_bulk_load_arena (gboolean use_arena)
+{
+    use_bulk_load_arena = use_arena;
+}
+
+gboolean
+qof_book_get_use_bulk_load_arena (void)
+{
+    return use_bulk_load_arena;
+}
+
+void
+qof_book_begin_bulk_load (QofBook *book)
+{
+    if (!book) return;
+    /* Only the load that reads the book in, which starts with the book
+     * empty, gets an arena. The memory of objects freed later isn't
+     * reused, so giving one to every import would grow the book for as
+     * long as it's open. */
+    if (book->bulk_load_level++ == 0 && use_bulk_load_arena &&
+        !book->arena && qof_book_empty (book))
+    {
+        book->arena = new QofArena;
+        QofArena::set_current (static_cast<QofArena*>(book->arena));
+    }
+}
+
+gboolean
+qof_book_end_bulk_load (QofBook *book)
+{
+    if (!book) return FALSE;
+    g_return_val_if_fail (book->bulk_load_level > 0, FALSE);
+    if (--book->bulk_load_level > 0)
+        return FALSE;
+    if (book->arena)
+        QofArena::unset_current (static_cast<QofArena*>(book->arena));
+    return TRUE;
+}
+
 void
 qof_book_set_backend (QofBook *book, QofBackend *be)
 {
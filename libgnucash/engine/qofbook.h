@@ -162,6 +162,13 @@ struct _QofBook
     gint cached_num_days_autoreadonly;
     /* Whether the above cached value is valid. */
     gboolean cached_num_days_autoreadonly_isvalid;
+
+    /* Nesting depth of qof_book_begin_bulk_load() calls. */
+    gint bulk_load_level;
+
+    /* The QofArena that KVP data made during the first bulk load comes
+     * from. */
+    gpointer arena;
 };
 
 struct _QofBookClass
@@ -314,6 +321,31 @@ gboolean qof_book_use_split_action_for_num_field (const QofBook *book);
 /** Is the book shutting down? */
 gboolean qof_book_shutting_down (const QofBook *book);
 
+/** Mark the start and end of a bulk load into the book. While a bulk
+ * load is in progress objects may postpone work that only has to be
+ * done once the load is complete. Calls nest; qof_book_end_bulk_load()
+ * returns TRUE when the outermost bulk load has ended. The engine
+ * wraps these in gnc_book_begin_bulk_load() and gnc_book_end_bulk_load(),
+ * which is what backends should call. */
+void qof_book_begin_bulk_load (QofBook *book);
+gboolean qof_book_end_bulk_load (QofBook *book);
+
+/** Is a bulk load into the book in progress? */
+gboolean qof_book_is_bulk_loading (const QofBook *book);
+
+/** Set whether the KVP frames and values made on the loading thread
+ * during the bulk load that reads a book in, into the empty book, are
+ * allocated from an arena owned by the book. On by default. The
+ * arena's memory isn't reused when objects in it are freed; it goes
+ * back to the system once the book is destroyed and everything in the
+ * arena has been freed. Later bulk loads, such as imports, allocate
+ * from the heap as usual. */
+void qof_book_set_use_bulk_load_arena (gboolean use_arena);
+
+/** Whether bulk loads allocate from an arena; see
+ * qof_book_set_use_bulk_load_arena(). */
+gboolean qof_book_get_use_bulk_load_arena (void);
+
 /** qof_book_not_saved() returns the value of the session_dirty flag,
  * set when changes to any object in the book are committed
  * (qof_backend->commit_edit has been called) and the backend hasn't
@@ -31,6 +31,7 @@ static QofLogModule log_module = QOF_MOD_CLASS;
 
 static GHashTable *classTable = NULL;
 static GHashTable *sortTable = NULL;
+static GHashTable *threadSafeParams = NULL;
 static gboolean initialized = FALSE;
 
 static gboolean clear_table (gpointer key, gpointer value, gpointer user_data)
@@ -58,6 +59,7 @@ qof_class_init(void)
 
     classTable = g_hash_table_new (g_str_hash, g_str_equal);
     sortTable = g_hash_table_new (g_str_hash, g_str_equal);
+    threadSafeParams = g_hash_table_new (g_direct_hash, g_direct_equal);
 }
 
 void
@@ -69,6 +71,7 @@ qof_class_shutdown (void)
     g_hash_table_foreach_remove (classTable, clear_table, NULL);
     g_hash_table_destroy (classTable);
     g_hash_table_destroy (sortTable);
+    g_hash_table_destroy (threadSafeParams);
 }
 
 QofSortFunc
@@ -152,6 +155,32 @@ qof_class_get_parameter (QofIdTypeConst obj_name,
     return static_cast<QofParam*>(g_hash_table_lookup (ht, parameter));
 }
 
+void
+qof_class_set_thread_safe_parameters (QofIdTypeConst obj_name,
+                                      const char **parameters)
+{
+    g_return_if_fail (obj_name);
+    g_return_if_fail (parameters);
+
+    for (auto name = parameters; *name; name++)
+    {
+        auto prm = qof_class_get_parameter (obj_name, *name);
+        if (!prm)
+        {
+            PWARN ("no parameter %s on %s", *name, obj_name);
+            continue;
+        }
+        g_hash_table_add (threadSafeParams, (gpointer)prm);
+    }
+}
+
+gboolean
+qof_class_parameter_is_thread_safe (const QofParam *param)
+{
+    if (!param || !check_init()) return FALSE;
+    return g_hash_table_contains (threadSafeParams, param);
+}
+
 QofAccessFunc
 qof_class_get_parameter_getter (QofIdTypeConst obj_name,
                                 const char *parameter)
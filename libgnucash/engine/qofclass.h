@@ -251,6 +251,19 @@ QofAccessFunc qof_class_get_parameter_getter (QofIdTypeConst obj_name,
 QofSetterFunc qof_class_get_parameter_setter (QofIdTypeConst obj_name,
         const char *parameter);
 
+/** Mark the listed parameters of an object as safe to get from
+ *  several threads at once: their getters only read the object and
+ *  don't fill in any cache on it or its book.  The list ends with a
+ *  NULL, and the parameters must already be registered.
+ */
+void qof_class_set_thread_safe_parameters (QofIdTypeConst obj_name,
+        const char **parameters);
+
+/** Return true if the parameter was marked thread safe with
+ *  qof_class_set_thread_safe_parameters().
+ */
+gboolean qof_class_parameter_is_thread_safe (const QofParam *param);
+
 /** Type definition for the class callback function. */
 typedef void (*QofClassForeachCB) (QofIdTypeConst, gpointer);
 
@@ -34,9 +34,22 @@ typedef struct
     gpointer user_data;
 
     gint handler_id;
+
+    QofEventBatchHandler batch_handler;
+    QofIdType entity_type;      /* NULL for all types */
 } HandlerInfo;
 
 /* generates an event even when events are suspended! */
 void qof_event_force (QofInstance *entity, QofEventId event_id, gpointer event_data);
 
+/* whether qof_event_gen is dropping events right now */
+gboolean qof_event_is_suspended (void);
+
+/* changes each time events are suspended, so that a handler following
+ * the events can tell it may have missed some */
+guint qof_event_get_suspend_serial (void);
+
+/* drops any events queued for an entity that is going away */
+void qof_event_forget_entity (QofInstance *entity);
+
 #endif
@@ -28,13 +28,27 @@
 #include "qof.h"
 #include "qofevent-p.h"
 
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
 /* Static Variables ************************************************/
 static guint   suspend_counter   = 0;
+static guint   suspend_serial    = 0;
 static gint    next_handler_id   = 1;
 static guint   handler_run_level = 0;
 static guint   pending_deletes   = 0;
 static GList   *handlers  =   NULL;
 
+/* The events queued by the current batch, in the order they were first
+ * generated, and for each entity where its events are in the queue.
+ * Dropped events are left in the queue with a NULL entity. */
+static guint   batch_level       = 0;
+static std::vector<QofEventBatchEntry> batch_events;
+static std::unordered_map<QofInstance*, std::vector<size_t>> batch_entities;
+
+static QofEventStats event_stats;
+
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = QOF_MOD_ENGINE;
 
@@ -69,16 +83,20 @@ find_next_handler_id(void)
     return handler_id;
 }
 
-gint
-qof_event_register_handler (QofEventHandler handler, gpointer user_data)
+static gint
+register_handler_internal (QofIdType entity_type, QofEventHandler handler,
+                           QofEventBatchHandler batch_handler,
+                           gpointer user_data)
 {
     HandlerInfo *hi;
     gint handler_id;
 
-    ENTER ("(handler=%p, data=%p)", handler, user_data);
+    ENTER ("(type=%s, handler=%p, batch_handler=%p, data=%p)",
+           entity_type ? entity_type : "(all)", handler, batch_handler,
+           user_data);
 
     /* sanity check */
-    if (!handler)
+    if (!handler && !batch_handler)
     {
         PERR ("no handler specified");
         return 0;
@@ -91,14 +109,61 @@ qof_event_register_handler (QofEventHandler handler, gpointer user_data)
     hi = g_new0 (HandlerInfo, 1);
 
     hi->handler = handler;
+    hi->batch_handler = batch_handler;
     hi->user_data = user_data;
     hi->handler_id = handler_id;
+    if (entity_type)
+        hi->entity_type = static_cast<QofIdType>(CACHE_INSERT (entity_type));
 
     handlers = g_list_prepend (handlers, hi);
-    LEAVE ("(handler=%p, data=%p) handler_id=%d", handler, user_data, handler_id);
+    LEAVE ("handler_id=%d", handler_id);
     return handler_id;
 }
 
+gint
+qof_event_register_handler (QofEventHandler handler, gpointer user_data)
+{
+    return register_handler_internal (NULL, handler, NULL, user_data);
+}
+
+gint
+qof_event_register_typed_handler (QofIdType entity_type,
+                                  QofEventHandler handler, gpointer user_data)
+{
+    return register_handler_internal (entity_type, handler, NULL, user_data);
+}
+
+gint
+qof_event_register_batch_handler (QofIdType entity_type,
+                                  QofEventBatchHandler handler,
+                                  gpointer user_data)
+{
+    return register_handler_internal (entity_type, NULL, handler, user_data);
+}
+
+static void
+handler_info_free (HandlerInfo *hi)
+{
+    if (hi->entity_type)
+        CACHE_REMOVE (hi->entity_type);
+    g_free (hi);
+}
+
+static inline gboolean
+handler_is_live (const HandlerInfo *hi)
+{
+    return hi->handler || hi->batch_handler;
+}
+
+/* The entity types are all from the string cache, so usually the same
+ * type means the same pointer. */
+static inline gboolean
+handler_wants (const HandlerInfo *hi, const QofInstance *entity)
+{
+    return !hi->entity_type || hi->entity_type == entity->e_type ||
+        g_strcmp0 (hi->entity_type, entity->e_type) == 0;
+}
+
 void
 qof_event_unregister_handler (gint handler_id)
 {
@@ -117,18 +182,20 @@ qof_event_unregister_handler (gint handler_id)
            of a generated event, such as QOF_EVENT_DESTROY.  In that case,
            we're in the middle of walking the GList and it is wrong to
            modify the list. So, instead, we just NULL the handler. */
-        if (hi->handler)
+        if (handler_is_live (hi))
             LEAVE ("(handler_id=%d) handler=%p data=%p", handler_id,
-                   hi->handler, hi->user_data);
+                   hi->handler ? (gpointer)hi->handler : (gpointer)hi->batch_handler,
+                   hi->user_data);
 
         /* safety -- clear the handler in case we're running events now */
         hi->handler = NULL;
+        hi->batch_handler = NULL;
 
         if (handler_run_level == 0)
         {
             handlers = g_list_remove_link (handlers, node);
             g_list_free_1 (node);
-            g_free (hi);
+            handler_info_free (hi);
         }
         else
         {
@@ -144,7 +211,8 @@ qof_event_unregister_handler (gint handler_id)
 void
 qof_event_suspend (void)
 {
-    suspend_counter++;
+    if (suspend_counter++ == 0)
+        suspend_serial++;
 
     if (suspend_counter == 0)
     {
@@ -164,23 +232,27 @@ qof_event_resume (void)
     suspend_counter--;
 }
 
+gboolean
+qof_event_is_suspended (void)
+{
+    return suspend_counter != 0;
+}
+
+guint
+qof_event_get_suspend_serial (void)
+{
+    return suspend_serial;
+}
+
+/* Pass events to every handler that wants them. Batch handlers get
+ * them together, the others one at a time. */
 static void
-qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
-                             gpointer event_data)
+qof_event_deliver (const QofEventBatchEntry *events, size_t n_events,
+                   gpointer event_data)
 {
     GList *node;
     GList *next_node = NULL;
-
-    g_return_if_fail(entity);
-
-    switch (event_id)
-    {
-    case QOF_EVENT_NONE:
-    {
-        /* if none, don't log, just return. */
-        return;
-    }
-    }
+    std::vector<QofEventBatchEntry> wanted;
 
     handler_run_level++;
     for (node = handlers; node; node = next_node)
@@ -188,11 +260,39 @@ qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
         HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
 
         next_node = node->next;
-        if (hi->handler)
+        if (hi->batch_handler)
+        {
+            const QofEventBatchEntry *these = events;
+            size_t n_these = n_events;
+            if (hi->entity_type)
+            {
+                wanted.clear ();
+                std::copy_if (events, events + n_events,
+                              std::back_inserter (wanted),
+                              [hi](const QofEventBatchEntry& ev)
+                              { return handler_wants (hi, ev.entity); });
+                these = wanted.data ();
+                n_these = wanted.size ();
+            }
+            if (!n_these)
+                continue;
+            PINFO("id=%d hi=%p batch han=%p n=%zu", hi->handler_id, hi,
+                  hi->batch_handler, n_these);
+            event_stats.delivered += n_these;
+            hi->batch_handler (these, n_these, hi->user_data);
+            continue;
+        }
+
+        /* Check the handler each time, an event may unregister it. */
+        for (size_t i = 0; i < n_events && hi->handler; i++)
         {
+            if (!handler_wants (hi, events[i].entity))
+                continue;
             PINFO("id=%d hi=%p han=%p data=%p", hi->handler_id, hi,
                   hi->handler, event_data);
-            hi->handler (entity, event_id, hi->user_data, event_data);
+            event_stats.delivered++;
+            hi->handler (events[i].entity, events[i].event_id, hi->user_data,
+                         event_data);
         }
     }
     handler_run_level--;
@@ -206,18 +306,139 @@ qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
         {
             HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
             next_node = node->next;
-            if (hi->handler == NULL)
+            if (!handler_is_live (hi))
             {
                 /* remove this node from the list, then free this node */
                 handlers = g_list_remove_link (handlers, node);
                 g_list_free_1 (node);
-                g_free (hi);
+                handler_info_free (hi);
             }
         }
         pending_deletes = 0;
     }
 }
 
+/* Take the entity's events out of the batch, in order. */
+static std::vector<QofEventBatchEntry>
+batch_take_entity (QofInstance *entity)
+{
+    std::vector<QofEventBatchEntry> events;
+    auto iter = batch_entities.find (entity);
+    if (iter == batch_entities.end ())
+        return events;
+    for (auto index : iter->second)
+    {
+        events.push_back (batch_events[index]);
+        batch_events[index].entity = NULL;
+    }
+    batch_entities.erase (iter);
+    return events;
+}
+
+static void
+batch_queue (QofInstance *entity, QofEventId event_id)
+{
+    auto& indices = batch_entities[entity];
+    for (auto index : indices)
+    {
+        if (batch_events[index].event_id == event_id)
+        {
+            event_stats.coalesced++;
+            return;
+        }
+    }
+    indices.push_back (batch_events.size ());
+    batch_events.push_back ({entity, event_id});
+}
+
+static void
+qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
+                             gpointer event_data)
+{
+    g_return_if_fail(entity);
+
+    switch (event_id)
+    {
+    case QOF_EVENT_NONE:
+    {
+        /* if none, don't log, just return. */
+        return;
+    }
+    }
+
+    event_stats.generated++;
+
+    if (batch_level)
+    {
+        /* event_data is often on the caller's stack and a destroyed
+         * entity is about to be freed, so those events go now. Send the
+         * entity's queued events first so it sees its events in order. */
+        if (!event_data && event_id != QOF_EVENT_DESTROY)
+        {
+            batch_queue (entity, event_id);
+            return;
+        }
+        auto queued = batch_take_entity (entity);
+        if (!queued.empty ())
+            qof_event_deliver (queued.data (), queued.size (), NULL);
+    }
+
+    QofEventBatchEntry event {entity, event_id};
+    qof_event_deliver (&event, 1, event_data);
+}
+
+void
+qof_event_begin_batch (void)
+{
+    batch_level++;
+}
+
+void
+qof_event_end_batch (void)
+{
+    if (batch_level == 0)
+    {
+        PERR ("batch level underflow");
+        return;
+    }
+
+    if (--batch_level)
+        return;
+
+    /* Events generated while delivering aren't batched, but a handler
+     * could start a batch of its own, so work on a copy. */
+    std::vector<QofEventBatchEntry> events;
+    events.swap (batch_events);
+    batch_entities.clear ();
+    events.erase (std::remove_if (events.begin (), events.end (),
+                                  [](const QofEventBatchEntry& ev)
+                                  { return ev.entity == NULL; }),
+                  events.end ());
+    if (!events.empty ())
+        qof_event_deliver (events.data (), events.size (), NULL);
+}
+
+void
+qof_event_forget_entity (QofInstance *entity)
+{
+    if (batch_entities.empty ())
+        return;
+    batch_take_entity (entity);
+}
+
+void
+qof_event_get_stats (QofEventStats *stats)
+{
+    g_return_if_fail (stats);
+    *stats = event_stats;
+}
+
+void
+qof_event_reset_stats (void)
+{
+    event_stats = QofEventStats {0, 0, 0};
+}
+
 void
 qof_event_force (QofInstance *entity, QofEventId event_id, gpointer event_data)
 {
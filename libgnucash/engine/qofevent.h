@@ -98,6 +98,53 @@ typedef void (*QofEventHandler) (QofInstance *ent,  QofEventId event_type,
  */
 gint qof_event_register_handler (QofEventHandler handler, gpointer handler_data);
 
+/** \brief Register a handler for the events of one type of entity.
+ *
+ * The handler is never invoked for entities of any other type.
+ *
+ * @param entity_type: the type of entity, e.g. GNC_ID_ACCOUNT, or NULL
+ *                     for every type.
+ * @param handler:   handler to register
+ * @param handler_data: data provided when handler is invoked
+ *
+ * @return id identifying handler, for qof_event_unregister_handler
+ */
+gint qof_event_register_typed_handler (QofIdType entity_type,
+                                       QofEventHandler handler,
+                                       gpointer handler_data);
+
+/** One event, as passed to a QofEventBatchHandler. */
+typedef struct
+{
+    QofInstance *entity;
+    QofEventId   event_id;
+} QofEventBatchEntry;
+
+/** \brief Handler invoked with several events at once.
+ *
+ * @param events:   the events, in the order they were first generated.
+ * @param n_events: how many there are.
+ * @param handler_data:   data supplied when handler was registered.
+ */
+typedef void (*QofEventBatchHandler) (const QofEventBatchEntry *events,
+                                      guint n_events, gpointer handler_data);
+
+/** \brief Register a handler that gets the events of a batch together.
+ *
+ * Outside of a batch it's invoked with each event alone. Events that
+ * carry event_data are always delivered alone, and the batch handler
+ * doesn't see their event_data.
+ *
+ * @param entity_type: the type of entity, or NULL for every type.
+ * @param handler:   handler to register
+ * @param handler_data: data provided when handler is invoked
+ *
+ * @return id identifying handler, for qof_event_unregister_handler
+ */
+gint qof_event_register_batch_handler (QofIdType entity_type,
+                                       QofEventBatchHandler handler,
+                                       gpointer handler_data);
+
 /** \brief Unregister an event handler.
  *
  * @param handler_id: the id of the handler to unregister
@@ -139,6 +186,34 @@ void qof_event_suspend (void);
 /** Resume engine event generation. */
 void qof_event_resume (void);
 
+/** \brief Start collecting events instead of delivering them.
+ *
+ *  Until the matching qof_event_end_batch events without event_data
+ *  are queued, and an event generated again for the same entity with
+ *  the same id is dropped. The queue is delivered when the outermost
+ *  batch ends. Events with event_data and QOF_EVENT_DESTROY can't wait;
+ *  they're delivered at once, after whatever was queued for their
+ *  entity. Batches nest.
+ */
+void qof_event_begin_batch (void);
+
+/** End a batch, delivering the queued events if it's the outermost one. */
+void qof_event_end_batch (void);
+
+/** Event counts since startup or the last qof_event_reset_stats. */
+typedef struct
+{
+    guint64 generated;  /**< events generated while not suspended */
+    guint64 coalesced;  /**< events dropped as repeats within a batch */
+    guint64 delivered;  /**< events passed to handlers, once per handler */
+} QofEventStats;
+
+/** Fill in stats with the current event counts. */
+void qof_event_get_stats (QofEventStats *stats);
+
+/** Set the event counts back to zero. */
+void qof_event_reset_stats (void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -34,14 +34,180 @@ extern "C"
 #include "qofid-p.h"
 #include "qofinstance-p.h"
 
+#include <cstdint>
+#include <vector>
+
 static QofLogModule log_module = QOF_MOD_ENGINE;
 
+/* Maps GUIDs to a collection's instances. It's an open-addressing
+ * table with linear probing that keeps a copy of each key beside its
+ * value, so a lookup usually reads a single cache line and no pointers.
+ * GUIDs are random to begin with, so the hash just folds the two
+ * halves together; the multiply only guards against made-up GUIDs, as
+ * in tests and some imports, that differ in a byte or two. Removal
+ * shifts the following entries back rather than leaving tombstones.
+ */
+class GuidMap
+{
+public:
+    QofInstance * lookup (const GncGUID *guid) const noexcept;
+    void insert (const GncGUID *guid, QofInstance *inst);
+    void remove (const GncGUID *guid) noexcept;
+    void reserve (size_t count);
+    void prefetch (const GncGUID *guid) const noexcept;
+    size_t size () const noexcept { return m_size; }
+    std::vector<QofInstance*> values () const;
+
+private:
+    struct Entry
+    {
+        GncGUID       guid;
+        QofInstance * inst;     /* NULL if the slot is free */
+    };
+
+    size_t slot_of (const GncGUID *guid) const noexcept;
+    void rehash (size_t capacity);
+
+    std::vector<Entry> m_entries;   /* empty, or a power of two long */
+    size_t m_size {0};
+};
+
+/* Keep the table at most 7/8 full. */
+static inline bool
+guid_map_too_full (size_t count, size_t capacity)
+{
+    return count * 8 > capacity * 7;
+}
+
+size_t
+GuidMap::slot_of (const GncGUID *guid) const noexcept
+{
+    uint64_t lo, hi;
+    memcpy (&lo, guid->reserved, sizeof (lo));
+    memcpy (&hi, guid->reserved + sizeof (lo), sizeof (hi));
+    uint64_t hash = (lo ^ hi) * UINT64_C(0x9E3779B97F4A7C15);
+    return (hash >> 32) & (m_entries.size () - 1);
+}
+
+QofInstance *
+GuidMap::lookup (const GncGUID *guid) const noexcept
+{
+    if (m_entries.empty ())
+        return nullptr;
+    auto mask = m_entries.size () - 1;
+    for (auto slot = slot_of (guid); ; slot = (slot + 1) & mask)
+    {
+        auto& entry = m_entries[slot];
+        if (!entry.inst)
+            return nullptr;
+        if (guid_equal (&entry.guid, guid))
+            return entry.inst;
+    }
+}
+
+void
+GuidMap::prefetch (const GncGUID *guid) const noexcept
+{
+#ifdef __GNUC__
+    if (!m_entries.empty ())
+        __builtin_prefetch (&m_entries[slot_of (guid)]);
+#endif
+}
+
+void
+GuidMap::insert (const GncGUID *guid, QofInstance *inst)
+{
+    if (m_entries.empty () || guid_map_too_full (m_size + 1, m_entries.size ()))
+        rehash (m_entries.empty () ? 16 : m_entries.size () * 2);
+    auto mask = m_entries.size () - 1;
+    for (auto slot = slot_of (guid); ; slot = (slot + 1) & mask)
+    {
+        auto& entry = m_entries[slot];
+        if (!entry.inst)
+        {
+            entry.guid = *guid;
+            entry.inst = inst;
+            ++m_size;
+            return;
+        }
+        if (guid_equal (&entry.guid, guid))
+        {
+            entry.inst = inst;
+            return;
+        }
+    }
+}
+
+void
+GuidMap::remove (const GncGUID *guid) noexcept
+{
+    if (m_entries.empty ())
+        return;
+    auto mask = m_entries.size () - 1;
+    auto slot = slot_of (guid);
+    for (; ; slot = (slot + 1) & mask)
+    {
+        if (!m_entries[slot].inst)
+            return;
+        if (guid_equal (&m_entries[slot].guid, guid))
+            break;
+    }
+
+    /* Move back any later entry of the run that could have used the
+     * freed slot, then free the slot it left. */
+    auto hole = slot;
+    for (auto next = (hole + 1) & mask; m_entries[next].inst;
+         next = (next + 1) & mask)
+    {
+        auto home = slot_of (&m_entries[next].guid);
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            m_entries[hole] = m_entries[next];
+            hole = next;
+        }
+    }
+    m_entries[hole].inst = nullptr;
+    --m_size;
+}
+
+void
+GuidMap::reserve (size_t count)
+{
+    size_t capacity = m_entries.empty () ? 16 : m_entries.size ();
+    while (guid_map_too_full (count, capacity))
+        capacity *= 2;
+    if (capacity > m_entries.size ())
+        rehash (capacity);
+}
+
+void
+GuidMap::rehash (size_t capacity)
+{
+    std::vector<Entry> old (capacity, Entry {{}, nullptr});
+    std::swap (old, m_entries);
+    m_size = 0;
+    for (auto& entry : old)
+        if (entry.inst)
+            insert (&entry.guid, entry.inst);
+}
+
+std::vector<QofInstance*>
+GuidMap::values () const
+{
+    std::vector<QofInstance*> ret;
+    ret.reserve (m_size);
+    for (auto& entry : m_entries)
+        if (entry.inst)
+            ret.push_back (entry.inst);
+    return ret;
+}
+
 struct QofCollection_s
 {
     QofIdType    e_type;
     gboolean     is_dirty;
 
-    GHashTable * hash_of_entities;
+    GuidMap      entities;
     gpointer     data;       /* place where object class can hang arbitrary data */
 };
 
@@ -51,9 +217,9 @@ QofCollection *
 qof_collection_new (QofIdType type)
 {
     QofCollection *col;
-    col = g_new0(QofCollection, 1);
+    col = new QofCollection;
     col->e_type = static_cast<QofIdType>(CACHE_INSERT (type));
-    col->hash_of_entities = guid_hash_table_new();
+    col->is_dirty = FALSE;
     col->data = NULL;
     return col;
 }
@@ -62,11 +228,9 @@ void
 qof_collection_destroy (QofCollection *col)
 {
     CACHE_REMOVE (col->e_type);
-    g_hash_table_destroy(col->hash_of_entities);
     col->e_type = NULL;
-    col->hash_of_entities = NULL;
     col->data = NULL;   /** XXX there should be a destroy notifier for this */
-    g_free (col);
+    delete col;
 }
 
 /* =============================================================== */
@@ -90,7 +254,7 @@ qof_collection_remove_entity (QofInstance *ent)
     col = qof_instance_get_collection(ent);
     if (!col) return;
     guid = qof_instance_get_guid(ent);
-    g_hash_table_remove (col->hash_of_entities, guid);
+    col->entities.remove (guid);
     qof_instance_set_collection(ent, NULL);
 }
 
@@ -104,7 +268,7 @@ qof_collection_insert_entity (QofCollection *col, QofInstance *ent)
     if (guid_equal(guid, guid_null())) return;
     g_return_if_fail (col->e_type == ent->e_type);
     qof_collection_remove_entity (ent);
-    g_hash_table_insert (col->hash_of_entities, (gpointer)guid, ent);
+    col->entities.insert (guid, ent);
     qof_instance_set_collection(ent, col);
 }
 
@@ -130,7 +294,7 @@ qof_collection_add_entity (QofCollection *coll, QofInstance *ent)
     {
         return FALSE;
     }
-    g_hash_table_insert (coll->hash_of_entities, (gpointer)guid, ent);
+    coll->entities.insert (guid, ent);
     return TRUE;
 }
 
@@ -214,12 +378,36 @@ qof_collection_compare (QofCollection *target, QofCollection *merge)
 QofInstance *
 qof_collection_lookup_entity (const QofCollection *col, const GncGUID * guid)
 {
-    QofInstance *ent;
     g_return_val_if_fail (col, NULL);
     if (guid == NULL) return NULL;
-    ent = static_cast<QofInstance*>(g_hash_table_lookup (col->hash_of_entities,
-							 guid));
-    return ent;
+    return col->entities.lookup (guid);
+}
+
+void
+qof_collection_lookup_entities (const QofCollection *col, const GncGUID *guids,
+                                guint n, QofInstance **results)
+{
+    /* How many lookups to start fetching the slots for ahead of time */
+    const guint ahead = 8;
+
+    g_return_if_fail (col);
+    g_return_if_fail (n == 0 || (guids && results));
+
+    for (guint i = 0; i < n && i < ahead; ++i)
+        col->entities.prefetch (&guids[i]);
+    for (guint i = 0; i < n; ++i)
+    {
+        if (i + ahead < n)
+            col->entities.prefetch (&guids[i + ahead]);
+        results[i] = col->entities.lookup (&guids[i]);
+    }
+}
+
+void
+qof_collection_reserve (QofCollection *col, guint n)
+{
+    g_return_if_fail (col);
+    col->entities.reserve (n);
 }
 
 QofCollection *
@@ -245,10 +433,7 @@ qof_collection_from_glist (QofIdType type, const GList *glist)
 guint
 qof_collection_count (const QofCollection *col)
 {
-    guint c;
-
-    c = g_hash_table_size(col->hash_of_entities);
-    return c;
+    return col->entities.size ();
 }
 
 /* =============================================================== */
@@ -304,40 +489,19 @@ qof_collection_set_data (QofCollection *col, gpointer user_data)
 
 /* =============================================================== */
 
-struct _qofid_iterate
-{
-    QofInstanceForeachCB      fcn;
-    gpointer                data;
-};
-
-static void
-foreach_cb (gpointer item, gpointer arg)
-{
-    struct _qofid_iterate *iter = static_cast<_qofid_iterate*>(arg);
-    QofInstance *ent = static_cast<QofInstance*>(item);
-
-    iter->fcn (ent, iter->data);
-}
-
 void
 qof_collection_foreach (const QofCollection *col, QofInstanceForeachCB cb_func,
                         gpointer user_data)
 {
-    struct _qofid_iterate iter;
-    GList *entries;
-
     g_return_if_fail (col);
     g_return_if_fail (cb_func);
 
-    iter.fcn = cb_func;
-    iter.data = user_data;
-
-    PINFO("Hash Table size of %s before is %d", col->e_type, g_hash_table_size(col->hash_of_entities));
+    PINFO("Hash Table size of %s before is %zu", col->e_type, col->entities.size ());
 
-    entries = g_hash_table_get_values (col->hash_of_entities);
-    g_list_foreach (entries, foreach_cb, &iter);
-    g_list_free (entries);
+    /* Walk a copy, the callback may add or remove entities. */
+    for (auto ent : col->entities.values ())
+        cb_func (ent, user_data);
 
-    PINFO("Hash Table size of %s after is %d", col->e_type, g_hash_table_size(col->hash_of_entities));
+    PINFO("Hash Table size of %s after is %zu", col->e_type, col->entities.size ());
 }
 /* =============================================================== */
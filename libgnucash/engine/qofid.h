@@ -118,7 +118,7 @@ print error message if its bad  */
 
 @param e_type QofIdType
 @param is_dirty gboolean
-@param hash_of_entities GHashTable
+@param entities map from GncGUID to QofInstance
 @param data gpointer, place where object class can hang arbitrary data
 
 */
@@ -142,6 +142,17 @@ QofIdType qof_collection_get_type (const QofCollection *);
 /*@ dependent @*/
 QofInstance * qof_collection_lookup_entity (const QofCollection *, const GncGUID *);
 
+/** Find the entities for n guids at once, putting the entity for
+ *  guids[i], or NULL, in results[i]. Quicker than looking them up one
+ *  at a time when there are many. */
+void qof_collection_lookup_entities (const QofCollection *col,
+                                     const GncGUID *guids, guint n,
+                                     QofInstance **results);
+
+/** Make room for n entities, for when it's known how many are about to
+ *  be added. */
+void qof_collection_reserve (QofCollection *col, guint n);
+
 /** Callback type for qof_collection_foreach */
 typedef void (*QofInstanceForeachCB) (QofInstance *, gpointer user_data);
 
@@ -165,6 +165,12 @@ void qof_instance_get_path_kvp (QofInstance *, GValue *, std::vector<std::string
 
 void qof_instance_set_path_kvp (QofInstance *, GValue const *, std::vector<std::string> const &);
 
+/** Same as qof_instance_get_path_kvp and qof_instance_set_path_kvp but
+ *  for a compiled KvpPath. */
+void qof_instance_get_compiled_path_kvp (QofInstance *, GValue *, KvpPath const &);
+
+void qof_instance_set_compiled_path_kvp (QofInstance *, GValue const *, KvpPath const &);
+
 bool qof_instance_has_path_slot (QofInstance const *, std::vector<std::string> const &);
 
 void qof_instance_slot_path_delete (QofInstance const *, std::vector<std::string> const &);
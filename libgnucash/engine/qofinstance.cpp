@@ -39,6 +39,7 @@ extern "C"
 #include <utility>
 #include "qof.h"
 #include "qofbook-p.h"
+#include "qofevent-p.h"
 #include "qofid-p.h"
 #include "kvp-frame.hpp"
 #include "qofinstance-p.h"
@@ -321,6 +322,7 @@ qof_instance_dispose (GObject *instp)
     priv = GET_PRIVATE(instp);
     if (priv->collection)
         qof_collection_remove_entity(inst);
+    qof_event_forget_entity(inst);
 
     CACHE_REMOVE(inst->e_type);
     inst->e_type = NULL;
@@ -1081,6 +1083,24 @@ void qof_instance_get_path_kvp (QofInstance * inst, GValue * value, std::vector<
     }
 }
 
+void qof_instance_set_compiled_path_kvp (QofInstance * inst, GValue const * value, KvpPath const & path)
+{
+    delete inst->kvp_data->set_compiled_path (path, kvp_value_from_gvalue (value));
+}
+
+void qof_instance_get_compiled_path_kvp (QofInstance * inst, GValue * value, KvpPath const & path)
+{
+    auto temp = gvalue_from_kvp_value (inst->kvp_data->get_compiled_slot (path));
+    if (G_IS_VALUE (temp))
+    {
+        if (G_IS_VALUE (value))
+            g_value_unset (value);
+        g_value_init (value, G_VALUE_TYPE (temp));
+        g_value_copy (temp, value);
+        gnc_gvalue_free (temp);
+    }
+}
+
 void
 qof_instance_get_kvp (QofInstance * inst, GValue * value, unsigned count, ...)
 {
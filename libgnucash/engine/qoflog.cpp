@@ -66,7 +66,9 @@ extern "C"
 #define NUM_CLOCKS 10
 
 static FILE *fout = NULL;
-static gchar* function_buffer = NULL;
+/* Each thread that logs gets its own, so that PERR and friends can be
+ * used off the main thread. */
+static thread_local gchar* function_buffer = NULL;
 static gint qof_log_num_spaces = 0;
 static GLogFunc previous_handler = NULL;
 static gchar* qof_logger_format = NULL;
@@ -58,6 +58,48 @@ QofQueryPredData *qof_query_term_get_pred_data (const QofQueryTerm *queryterm);
 gboolean qof_query_term_is_inverted (const QofQueryTerm *queryterm);
 
 
+/* Query indexes.
+ *
+ * An index lets qof_query_run visit only the objects that might
+ * satisfy one OR'd branch of a query (a list of ANDed terms) instead
+ * of every object of the searched-for type in the book.
+ *
+ * When book is NULL the function only says whether it can serve the
+ * terms: if it can it prepends to *covered the terms every one of its
+ * candidates is guaranteed to satisfy, which qof_query_run then doesn't
+ * check again, and returns TRUE. Otherwise it calls cb once for each
+ * candidate object in book; the candidates must include every object
+ * that satisfies and_terms.
+ */
+typedef gboolean (*QofQueryIndexFunc) (QofBook *book, GList *and_terms,
+                                       GList **covered,
+                                       QofInstanceForeachCB cb,
+                                       gpointer user_data);
+
+/* Register an index for objects of type obj_type. When several indexes
+ * can serve a branch the one registered first is used. name is what
+ * qof_query_get_plan reports for branches served by it. */
+void qof_query_register_index (QofIdTypeConst obj_type, const char *name,
+                               QofQueryIndexFunc func);
+
+/* Live query dependencies.
+ *
+ * A live query re-checks an object of its searched-for type whenever
+ * that object changes. Terms can also reach other objects through
+ * their parameter chains (a split's transaction date, say), so a type
+ * can register a function that, given a changed instance of
+ * related_type, calls cb for every obj_type object the change may have
+ * affected.
+ */
+typedef void (*QofQueryRelatedFunc) (QofInstance *changed,
+                                     QofInstanceForeachCB cb,
+                                     gpointer user_data);
+
+void qof_query_register_related (QofIdTypeConst obj_type,
+                                 QofIdTypeConst related_type,
+                                 QofQueryRelatedFunc func);
+
+
 /* Functions to get and look at QuerySorts */
 
 /* This function returns the primary, secondary, and tertiary sorts.
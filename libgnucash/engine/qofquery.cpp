@@ -35,12 +35,23 @@ extern "C"
 #include "qof.h"
 #include "qof-backend.hpp"
 #include "qofbook-p.h"
+#include "qofevent-p.h"
 #include "qofclass-p.h"
 #include "qofquery-p.h"
 #include "qofquerycore-p.h"
 
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 static QofLogModule log_module = QOF_MOD_QUERY;
 
+/* Don't start a thread for fewer objects than this */
+#define QUERY_MIN_WORKER_OBJECTS 512
+
 struct _QofQueryTerm
 {
     QofQueryParamList *     param_list;
@@ -93,6 +104,9 @@ struct _QofQuery
     /* The maximum number of results to return */
     gint              max_results;
 
+    /* Threads to check the predicates on, see qof_query_set_workers */
+    guint             workers;
+
     /* list of books that will be participating in the query */
     GList *           books;
 
@@ -104,6 +118,19 @@ struct _QofQuery
     gint              changed;
 
     GList *           results;
+
+    /* how the last run found its candidates, see qof_query_get_plan */
+    gchar *           plan;
+};
+
+/* The best max_results matches seen so far, as a heap whose top is
+ * the worst of them. seq numbers the matches in the order they were
+ * found so that ties break the same way the stable sort of the full
+ * list would. */
+struct QofQueryTopK
+{
+    std::vector<std::pair<gpointer, size_t>> heap;
+    size_t            seq;
 };
 
 typedef struct _QofQueryCB
@@ -111,8 +138,43 @@ typedef struct _QofQueryCB
     QofQuery *        query;
     GList *           list;
     gint              count;
+    QofQueryTopK *    top_k;
 } QofQueryCB;
 
+struct QofQueryIndex
+{
+    std::string       obj_type;
+    std::string       name;
+    QofQueryIndexFunc func;
+};
+
+static std::vector<QofQueryIndex> query_indexes;
+
+struct QofQueryRelated
+{
+    std::string       obj_type;
+    std::string       related_type;
+    QofQueryRelatedFunc func;
+};
+
+static std::vector<QofQueryRelated> query_related;
+
+/* One OR'd branch of a query served by an index. */
+struct QofQueryIndexBranch
+{
+    const QofQueryIndex * index;
+    GList *           or_node;      /* the branch's node in q->terms */
+    GList *           covered;      /* terms the index guarantees */
+};
+
+using QofQueryPlan = std::vector<QofQueryIndexBranch>;
+
+typedef struct
+{
+    QofQueryCB *      qcb;
+    const QofQueryIndexBranch * branch;
+} QofQueryIndexCB;
+
 /* initial_term will be owned by the new Query */
 static void query_init (QofQuery *q, QofQueryTerm *initial_term)
 {
@@ -274,6 +336,9 @@ static void free_members (QofQuery *q)
 
     g_list_free(q->results);
     q->results = NULL;
+
+    g_free(q->plan);
+    q->plan = NULL;
 }
 
 static int cmp_func (const QofQuerySort *sort, QofSortFunc default_sort,
@@ -356,60 +421,127 @@ sort_func (const gconstpointer a, const gconstpointer b, const gpointer q)
     }
 }
 
+/* Top-K support: full sort-then-crop keeps the last max_results
+ * objects of the stably sorted list, i.e. the greatest by sort_func
+ * with later matches winning ties. */
+static bool
+top_k_less (const QofQuery *q, const std::pair<gpointer, size_t>& a,
+            const std::pair<gpointer, size_t>& b)
+{
+    int retval = sort_func (a.first, b.first, const_cast<QofQuery*>(q));
+    return retval < 0 || (retval == 0 && a.second < b.second);
+}
+
+static void
+top_k_add (QofQueryCB *qcb, gpointer object)
+{
+    auto top_k = qcb->top_k;
+    auto q = qcb->query;
+    auto greater = [q] (const std::pair<gpointer, size_t>& a,
+                        const std::pair<gpointer, size_t>& b)
+    {
+        return top_k_less (q, b, a);
+    };
+    std::pair<gpointer, size_t> item {object, top_k->seq++};
+
+    if (top_k->heap.size () < static_cast<size_t>(q->max_results))
+    {
+        top_k->heap.push_back (item);
+        std::push_heap (top_k->heap.begin (), top_k->heap.end (), greater);
+    }
+    else if (top_k_less (q, top_k->heap.front (), item))
+    {
+        std::pop_heap (top_k->heap.begin (), top_k->heap.end (), greater);
+        top_k->heap.back () = item;
+        std::push_heap (top_k->heap.begin (), top_k->heap.end (), greater);
+    }
+}
+
+/* Returns the kept objects in sorted order. */
+static GList *
+top_k_to_list (const QofQuery *q, QofQueryTopK *top_k)
+{
+    GList *list = NULL;
+
+    std::sort (top_k->heap.begin (), top_k->heap.end (),
+               [q] (const std::pair<gpointer, size_t>& a,
+                    const std::pair<gpointer, size_t>& b)
+               {
+                   return top_k_less (q, a, b);
+               });
+    for (auto it = top_k->heap.rbegin (); it != top_k->heap.rend (); ++it)
+        list = g_list_prepend (list, it->first);
+    return list;
+}
+
+static void
+query_cb_add (QofQueryCB *qcb, gpointer object)
+{
+    if (qcb->top_k)
+        top_k_add (qcb, object);
+    else
+        qcb->list = g_list_prepend (qcb->list, object);
+    qcb->count++;
+}
+
 /* ==================================================================== */
-/* This is the main workhorse for performing the query.  For each
- * object, it walks over all of the query terms to see if the
- * object passes the seive.
+/* Check object against one OR'd branch of the query, skipping the
+ * terms in skip.
  */
-
 static int
-check_object (const QofQuery *q, gpointer object)
+check_and_terms (const GList *and_terms, const GList *skip, gpointer object)
 {
     const GList     * and_ptr;
-    const GList     * or_ptr;
     const QofQueryTerm * qt;
-    int       and_terms_ok = 1;
 
-    for (or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+    for (and_ptr = and_terms; and_ptr; and_ptr = and_ptr->next)
     {
-        and_terms_ok = 1;
-        for (and_ptr = static_cast<GList*>(or_ptr->data); and_ptr;
-	     and_ptr = static_cast<GList*>(and_ptr->next))
+        qt = (QofQueryTerm *)(and_ptr->data);
+        if (skip && g_list_find ((GList*)skip, qt))
+            continue;
+        if (qt->param_fcns && qt->pred_fcn)
         {
-            qt = (QofQueryTerm *)(and_ptr->data);
-            if (qt->param_fcns && qt->pred_fcn)
-            {
-                const GSList *node;
-                QofParam *param = NULL;
-                gpointer conv_obj = object;
-
-                /* iterate through the conversions */
-                for (node = qt->param_fcns; node; node = node->next)
-                {
-                    param = static_cast<QofParam*>(node->data);
+            const GSList *node;
+            QofParam *param = NULL;
+            gpointer conv_obj = object;
 
-                    /* The last term is the actual parameter getter */
-                    if (!node->next) break;
+            /* iterate through the conversions */
+            for (node = qt->param_fcns; node; node = node->next)
+            {
+                param = static_cast<QofParam*>(node->data);
 
-                    conv_obj = param->param_getfcn (conv_obj, param);
-                }
+                /* The last term is the actual parameter getter */
+                if (!node->next) break;
 
-                if (((qt->pred_fcn)(conv_obj, param, qt->pdata)) == qt->invert)
-                {
-                    and_terms_ok = 0;
-                    break;
-                }
-            }
-            else
-            {
-                /* XXX: Don't know how to do this conversion -- do we care? */
+                conv_obj = param->param_getfcn (conv_obj, param);
             }
+
+            if (((qt->pred_fcn)(conv_obj, param, qt->pdata)) == qt->invert)
+                return 0;
         }
-        if (and_terms_ok)
+        else
         {
-            return 1;
+            /* XXX: Don't know how to do this conversion -- do we care? */
         }
     }
+    return 1;
+}
+
+/* This is the main workhorse for performing the query.  For each
+ * object, it walks over all of the query terms to see if the
+ * object passes the seive.
+ */
+
+static int
+check_object (const QofQuery *q, gpointer object)
+{
+    const GList     * or_ptr;
+
+    for (or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+    {
+        if (check_and_terms (static_cast<GList*>(or_ptr->data), NULL, object))
+            return 1;
+    }
 
     /* If there are no terms, assume a "match any" applies.
      * A query with no terms is still meaningful, since the user
@@ -574,11 +706,150 @@ static void check_item_cb (gpointer object, gpointer user_data)
     if (!object || !ql) return;
 
     if (check_object (ql->query, object))
+        query_cb_add (ql, object);
+    return;
+}
+
+/* A scan is only split across threads if the predicate of every term
+ * is one the core marks as safe to run concurrently, and every getter
+ * on the way to the value was marked thread safe by its object. Many
+ * getters fill in caches (closing transaction, notes, the book's num
+ * source), so an unmarked getter keeps the scan serial. */
+static gboolean
+query_is_thread_safe (const QofQuery *q)
+{
+    for (auto or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+        for (auto and_ptr = static_cast<GList*>(or_ptr->data); and_ptr;
+             and_ptr = and_ptr->next)
+        {
+            auto qt = static_cast<QofQueryTerm*>(and_ptr->data);
+            if (!qt->pdata ||
+                !qof_query_core_predicate_is_thread_safe (qt->pdata->type_name))
+                return FALSE;
+            for (auto node = qt->param_fcns; node; node = node->next)
+                if (!qof_class_parameter_is_thread_safe
+                        (static_cast<const QofParam*>(node->data)))
+                    return FALSE;
+        }
+    return TRUE;
+}
+
+static void collect_item_cb (QofInstance *object, gpointer user_data)
+{
+    auto objects = static_cast<std::vector<gpointer>*>(user_data);
+    if (object)
+        objects->push_back (object);
+}
+
+/* Scan the book with the objects cut into one contiguous run per
+ * worker. Each worker only marks which of its objects match; the
+ * matches are then added in the order the collection gave them, so the
+ * result (and any top-K tie-breaking) is the same as a serial scan. */
+static void
+check_items_parallel (QofQueryCB *qcb, QofBook *book, guint n_workers)
+{
+    std::vector<gpointer> objects;
+
+    qof_object_foreach (qcb->query->search_for, book, collect_item_cb,
+                        &objects);
+    n_workers = std::min<size_t> (n_workers,
+                                  objects.size () / QUERY_MIN_WORKER_OBJECTS);
+
+    std::vector<char> matched (objects.size ());
+    auto worker = [qcb, &objects, &matched] (size_t begin, size_t end)
     {
-        ql->list = g_list_prepend (ql->list, object);
-        ql->count++;
+        for (auto i = begin; i < end; ++i)
+            matched[i] = check_object (qcb->query, objects[i]);
+    };
+
+    auto chunk = n_workers > 1 ? (objects.size () + n_workers - 1) / n_workers
+        : objects.size ();
+    std::vector<std::thread> threads;
+    for (auto begin = chunk; begin < objects.size (); begin += chunk)
+        threads.emplace_back (worker, begin,
+                              std::min (begin + chunk, objects.size ()));
+    worker (0, std::min (chunk, objects.size ()));
+    for (auto& thread : threads)
+        thread.join ();
+
+    for (size_t i = 0; i < objects.size (); ++i)
+        if (matched[i])
+            query_cb_add (qcb, objects[i]);
+}
+
+/* Called for each candidate an index hands us for one branch. The
+ * candidate only has to pass the terms the index didn't cover, but an
+ * object that matches an earlier branch was already taken there. */
+static void check_index_item_cb (QofInstance *object, gpointer user_data)
+{
+    QofQueryIndexCB* icb = static_cast<QofQueryIndexCB*>(user_data);
+    const QofQueryIndexBranch* branch = icb->branch;
+    GList *or_ptr;
+
+    if (!object) return;
+
+    if (!check_and_terms (static_cast<GList*>(branch->or_node->data),
+                          branch->covered, object))
+        return;
+
+    for (or_ptr = icb->qcb->query->terms; or_ptr != branch->or_node;
+         or_ptr = or_ptr->next)
+        if (check_and_terms (static_cast<GList*>(or_ptr->data), NULL, object))
+            return;
+
+    query_cb_add (icb->qcb, object);
+}
+
+/* Find an index for every OR'd branch of the query. If any branch has
+ * none the whole query has to scan, and an empty plan is returned. */
+static QofQueryPlan
+query_plan (QofQuery *q)
+{
+    QofQueryPlan plan;
+
+    for (auto or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+    {
+        auto and_terms = static_cast<GList*>(or_ptr->data);
+        QofQueryIndexBranch branch {nullptr, or_ptr, nullptr};
+
+        for (auto& index : query_indexes)
+        {
+            if (index.obj_type != q->search_for)
+                continue;
+            if ((index.func) (nullptr, and_terms, &branch.covered, nullptr,
+                              nullptr))
+            {
+                branch.index = &index;
+                break;
+            }
+            g_list_free (branch.covered);
+            branch.covered = nullptr;
+        }
+        if (!branch.index)
+        {
+            for (auto& b : plan)
+                g_list_free (b.covered);
+            return {};
+        }
+        plan.push_back (branch);
     }
-    return;
+    return plan;
+}
+
+static gchar *
+query_plan_to_string (const QofQueryPlan& plan)
+{
+    if (plan.empty ())
+        return g_strdup ("scan");
+
+    std::string str;
+    for (auto& branch : plan)
+    {
+        if (!str.empty ())
+            str += " | ";
+        str += branch.index->name;
+    }
+    return g_strdup (str.c_str ());
 }
 
 static int param_list_cmp (const QofQueryParamList *l1, const QofQueryParamList *l2)
@@ -724,6 +995,13 @@ void qof_query_purge_terms (QofQuery *q, QofQueryParamList *param_list)
     }
 }
 
+static gboolean
+query_is_sorted (const QofQuery *q)
+{
+    return (q->primary_sort.comp_fcn || q->primary_sort.obj_cmp ||
+            (q->primary_sort.use_default && q->defaultSort));
+}
+
 static GList * qof_query_run_internal (QofQuery *q,
                                        void(*run_cb)(QofQueryCB*, gpointer),
                                        gpointer cb_arg)
@@ -750,18 +1028,35 @@ static GList * qof_query_run_internal (QofQuery *q,
     if (qof_log_check (log_module, QOF_LOG_DEBUG))
         qof_query_print (q);
 
+    gboolean sorted = query_is_sorted (q);
+
     /* Now run the query over all the objects and save the results */
     {
         QofQueryCB qcb;
+        QofQueryTopK top_k {{}, 0};
 
         memset (&qcb, 0, sizeof (qcb));
         qcb.query = q;
+        /* When only the first few of many sorted matches are wanted
+         * don't collect and sort the lot. */
+        if (sorted && q->max_results > 0)
+            qcb.top_k = &top_k;
 
         /* Run the query callback */
         run_cb(&qcb, cb_arg);
 
-        matching_objects = qcb.list;
         object_count = qcb.count;
+        if (qcb.top_k)
+        {
+            PINFO ("kept %d of %d matching objects", q->max_results,
+                   object_count);
+            q->changed = 0;
+            g_list_free(q->results);
+            q->results = top_k_to_list (q, &top_k);
+            LEAVE (" q=%p", q);
+            return q->results;
+        }
+        matching_objects = qcb.list;
     }
     PINFO ("matching objects=%p count=%d", matching_objects, object_count);
 
@@ -774,8 +1069,7 @@ static GList * qof_query_run_internal (QofQuery *q,
     matching_objects = g_list_reverse(matching_objects);
 
     /* Now sort the matching objects based on the search criteria */
-    if (q->primary_sort.comp_fcn || q->primary_sort.obj_cmp ||
-            (q->primary_sort.use_default && q->defaultSort))
+    if (sorted)
     {
         matching_objects = g_list_sort_with_data(matching_objects, sort_func, q);
     }
@@ -822,6 +1116,17 @@ static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
     (void)cb_arg; /* unused */
     g_return_if_fail(qcb);
 
+    auto plan = query_plan (qcb->query);
+    g_free (qcb->query->plan);
+    qcb->query->plan = query_plan_to_string (plan);
+    PINFO ("query plan: %s", qcb->query->plan);
+
+    auto n_workers = qcb->query->workers;
+    if (n_workers == 0)
+        n_workers = std::max (1u, std::thread::hardware_concurrency ());
+    if (n_workers > 1 && !query_is_thread_safe (qcb->query))
+        n_workers = 1;
+
     for (node = qcb->query->books; node; node = node->next)
     {
         QofBook* book = static_cast<QofBook*>(node->data);
@@ -840,10 +1145,29 @@ static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
             }
         }
 #endif
-        /* And then iterate over all the objects */
-        qof_object_foreach (qcb->query->search_for, book,
-                            (QofInstanceForeachCB) check_item_cb, qcb);
+        /* And then iterate over all the objects, or over the ones the
+         * indexes say can match */
+        if (plan.empty () && n_workers > 1)
+        {
+            check_items_parallel (qcb, book, n_workers);
+            continue;
+        }
+        if (plan.empty ())
+        {
+            qof_object_foreach (qcb->query->search_for, book,
+                                (QofInstanceForeachCB) check_item_cb, qcb);
+            continue;
+        }
+        for (auto& branch : plan)
+        {
+            QofQueryIndexCB icb {qcb, &branch};
+            (branch.index->func) (book, static_cast<GList*>(branch.or_node->data),
+                                  nullptr, check_index_item_cb, &icb);
+        }
     }
+
+    for (auto& branch : plan)
+        g_list_free (branch.covered);
 }
 
 GList * qof_query_run (QofQuery *q)
@@ -886,6 +1210,423 @@ qof_query_last_run (QofQuery *query)
     return query->results;
 }
 
+/* ================================================================ */
+/* Live queries */
+
+struct _QofLiveQuery
+{
+    /* the caller's query, only looked at to see whether it changed */
+    QofQuery *        user_query;
+    /* our own copy of it, which the objects are checked against */
+    QofQuery *        query;
+    /* every matching object, in the query's sort order */
+    std::vector<gpointer> results;
+    std::unordered_set<gpointer> members;
+    /* objects changed since the results were last brought up to date,
+     * in the order they were first seen, and those that went away */
+    std::vector<gpointer> pending;
+    std::unordered_set<gpointer> pending_set;
+    std::unordered_set<gpointer> gone;
+    /* qof_event_get_suspend_serial() when the results were made */
+    guint             suspend_serial;
+    std::vector<gint> handler_ids;
+    /* other types the query reads through that nothing relates back to
+     * the searched-for objects; a change to one has every object
+     * checked again */
+    std::unordered_set<std::string> recheck_types;
+    bool              recheck_all;
+    QofLiveQueryCB    cb;
+    gpointer          user_data;
+};
+
+/* Re-run the caller's query from scratch, keeping every match rather
+ * than only the last max_results. */
+static void
+live_query_rerun (QofLiveQuery *lq)
+{
+    if (lq->query)
+        qof_query_destroy (lq->query);
+    lq->query = qof_query_copy (lq->user_query);
+    lq->query->changed = 1;
+
+    auto max_results = lq->query->max_results;
+    lq->query->max_results = -1;
+    auto list = qof_query_run (lq->query);
+    lq->query->max_results = max_results;
+
+    lq->results.clear ();
+    lq->members.clear ();
+    for (auto node = list; node; node = node->next)
+    {
+        lq->results.push_back (node->data);
+        lq->members.insert (node->data);
+    }
+    lq->pending.clear ();
+    lq->pending_set.clear ();
+    lq->gone.clear ();
+    lq->recheck_all = false;
+    lq->suspend_serial = qof_event_get_suspend_serial ();
+}
+
+/* Whether changes may have been made that no event told us about. */
+static inline gboolean
+live_query_missed_events (const QofLiveQuery *lq)
+{
+    return qof_event_is_suspended () ||
+        lq->suspend_serial != qof_event_get_suspend_serial ();
+}
+
+static void
+live_query_notify (QofLiveQuery *lq, QofLiveQueryChange change,
+                   gpointer object, size_t position)
+{
+    if (lq->cb)
+        (lq->cb) (lq, change, object, position, lq->user_data);
+}
+
+/* Drop an object that is going away; it mustn't be looked at again. */
+static void
+live_query_forget (QofLiveQuery *lq, QofInstance *object)
+{
+    lq->pending_set.erase (object);
+    if (lq->members.count (object))
+        lq->gone.insert (object);
+}
+
+/* Note an object that may have moved into, out of or within the
+ * results, to be checked by live_query_flush. */
+static void
+live_query_update (QofInstance *object, gpointer user_data)
+{
+    auto lq = static_cast<QofLiveQuery*>(user_data);
+
+    if (qof_instance_get_destroying (object))
+    {
+        live_query_forget (lq, object);
+        return;
+    }
+    if (lq->pending_set.insert (object).second)
+        lq->pending.push_back (object);
+}
+
+/* Bring the results up to date with the objects noted since the last
+ * time, in one pass over them. */
+static void
+live_query_flush (QofLiveQuery *lq)
+{
+    if (lq->recheck_all)
+    {
+        lq->recheck_all = false;
+        for (auto node = lq->query->books; node; node = node->next)
+            qof_collection_foreach (qof_book_get_collection (QOF_BOOK (node->data),
+                                                             lq->query->search_for),
+                                    live_query_update, lq);
+    }
+    if (lq->pending_set.empty () && lq->gone.empty ())
+    {
+        lq->pending.clear ();
+        return;
+    }
+
+    auto q = lq->query;
+    auto& results = lq->results;
+    std::vector<gpointer> matched;
+    std::unordered_set<gpointer> leaving (lq->gone);
+    for (auto object : lq->pending)
+    {
+        if (!lq->pending_set.erase (object))
+            continue;
+        if (lq->members.count (object))
+            leaving.insert (object);
+        if (!qof_instance_get_destroying (object) &&
+            g_list_find (q->books, qof_instance_get_book (object)) &&
+            check_object (q, object))
+            matched.push_back (object);
+    }
+    lq->pending.clear ();
+    lq->pending_set.clear ();
+    lq->gone.clear ();
+
+    /* Take out every object that changed, remembering where it was. */
+    std::unordered_map<gpointer, size_t> old_pos;
+    if (!leaving.empty ())
+    {
+        std::vector<gpointer> kept;
+        kept.reserve (results.size ());
+        for (size_t i = 0; i < results.size (); i++)
+        {
+            if (leaving.count (results[i]))
+                old_pos.emplace (results[i], i);
+            else
+                kept.push_back (results[i]);
+        }
+        results.swap (kept);
+        for (auto object : leaving)
+            lq->members.erase (object);
+    }
+
+    /* Put the matches back in their places. */
+    std::unordered_set<gpointer> entering (matched.begin (), matched.end ());
+    if (!matched.empty ())
+    {
+        std::vector<gpointer> merged;
+        merged.reserve (results.size () + matched.size ());
+        if (query_is_sorted (q))
+        {
+            auto less = [q] (gpointer a, gpointer b)
+                { return sort_func (a, b, q) < 0; };
+            std::stable_sort (matched.begin (), matched.end (), less);
+            std::merge (results.begin (), results.end (),
+                        matched.begin (), matched.end (),
+                        std::back_inserter (merged), less);
+        }
+        else
+        {
+            merged = results;
+            merged.insert (merged.end (), matched.begin (), matched.end ());
+        }
+        results.swap (merged);
+        lq->members.insert (matched.begin (), matched.end ());
+    }
+
+    if (!lq->cb)
+        return;
+
+    std::vector<std::pair<size_t, gpointer>> removed;
+    for (auto& [object, pos] : old_pos)
+        if (!entering.count (object))
+            removed.emplace_back (pos, object);
+    std::sort (removed.begin (), removed.end ());
+    for (auto& [pos, object] : removed)
+        live_query_notify (lq, QOF_LIVE_QUERY_REMOVED, object, pos);
+
+    if (entering.empty ())
+        return;
+    for (size_t i = 0; i < results.size (); i++)
+    {
+        auto object = results[i];
+        if (!entering.count (object))
+            continue;
+        auto iter = old_pos.find (object);
+        if (iter == old_pos.end ())
+            live_query_notify (lq, QOF_LIVE_QUERY_ADDED, object, i);
+        else if (iter->second != i)
+            live_query_notify (lq, QOF_LIVE_QUERY_MOVED, object, i);
+    }
+}
+
+static void
+live_query_event_handler (const QofEventBatchEntry *events, guint n_events,
+                          gpointer handler_data)
+{
+    auto lq = static_cast<QofLiveQuery*>(handler_data);
+    auto q = lq->query;
+
+    /* The results will be made again from scratch anyway. */
+    if (live_query_missed_events (lq))
+        return;
+
+    for (guint i = 0; i < n_events; i++)
+    {
+        auto ent = events[i].entity;
+        if (!ent || !(events[i].event_id & (QOF_EVENT_CREATE | QOF_EVENT_MODIFY |
+                                            QOF_EVENT_DESTROY | QOF_EVENT_ADD |
+                                            QOF_EVENT_REMOVE)))
+            continue;
+
+        if (!g_strcmp0 (ent->e_type, q->search_for))
+        {
+            if (events[i].event_id & QOF_EVENT_DESTROY)
+                live_query_forget (lq, ent);
+            else
+                live_query_update (ent, lq);
+            continue;
+        }
+        for (auto& related : query_related)
+            if (related.obj_type == q->search_for &&
+                related.related_type == ent->e_type)
+                (related.func) (ent, live_query_update, lq);
+        if (lq->recheck_types.count (ent->e_type))
+            lq->recheck_all = true;
+    }
+
+    /* Only a callback needs to hear of the changes straight away. */
+    if (lq->cb)
+        live_query_flush (lq);
+}
+
+static bool
+live_query_is_related (QofIdTypeConst obj_type, const std::string& type)
+{
+    for (auto& related : query_related)
+        if (related.obj_type == obj_type && related.related_type == type)
+            return true;
+    return false;
+}
+
+/* The object types the compiled terms and sorts read through that no
+ * related function maps back to the searched-for type. */
+static void
+live_query_find_recheck_types (QofLiveQuery *lq)
+{
+    auto q = lq->query;
+    auto add_types = [lq, q] (GSList *params)
+    {
+        for (auto node = params; node; node = node->next)
+        {
+            auto param = static_cast<const QofParam*>(node->data);
+            if (g_strcmp0 (param->param_type, q->search_for) &&
+                qof_object_lookup (param->param_type) &&
+                !live_query_is_related (q->search_for, param->param_type))
+                lq->recheck_types.insert (param->param_type);
+        }
+    };
+
+    lq->recheck_types.clear ();
+    for (auto or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+        for (auto and_ptr = static_cast<GList*>(or_ptr->data); and_ptr;
+             and_ptr = and_ptr->next)
+            add_types (static_cast<QofQueryTerm*>(and_ptr->data)->param_fcns);
+    add_types (q->primary_sort.param_fcns);
+    add_types (q->secondary_sort.param_fcns);
+    add_types (q->tertiary_sort.param_fcns);
+}
+
+/* Listen for the searched-for type, the types related to it and the
+ * other types the query reads through. Call it after the query has
+ * been run, so its parameters are compiled. */
+static void
+live_query_register_handlers (QofLiveQuery *lq)
+{
+    for (auto id : lq->handler_ids)
+        qof_event_unregister_handler (id);
+    lq->handler_ids.clear ();
+
+    auto search_for = lq->query->search_for;
+    lq->handler_ids.push_back (
+        qof_event_register_batch_handler (search_for, live_query_event_handler,
+                                          lq));
+    for (auto& related : query_related)
+        if (related.obj_type == search_for)
+            lq->handler_ids.push_back (
+                qof_event_register_batch_handler (related.related_type.c_str (),
+                                                  live_query_event_handler, lq));
+    live_query_find_recheck_types (lq);
+    for (auto& type : lq->recheck_types)
+        lq->handler_ids.push_back (
+            qof_event_register_batch_handler (type.c_str (),
+                                              live_query_event_handler, lq));
+}
+
+QofLiveQuery *
+qof_live_query_new (QofQuery *q, QofLiveQueryCB cb, gpointer user_data)
+{
+    g_return_val_if_fail (q && q->search_for && q->books, NULL);
+
+    auto lq = new QofLiveQuery {q, nullptr, {}, {}, {}, {}, {}, 0, {}, {},
+                                false, cb, user_data};
+    live_query_rerun (lq);
+    live_query_register_handlers (lq);
+    return lq;
+}
+
+void
+qof_live_query_destroy (QofLiveQuery *lq)
+{
+    if (!lq) return;
+
+    for (auto id : lq->handler_ids)
+        qof_event_unregister_handler (id);
+    qof_query_destroy (lq->query);
+    delete lq;
+}
+
+void
+qof_live_query_set_query (QofLiveQuery *lq, QofQuery *q)
+{
+    g_return_if_fail (lq && q && q->search_for && q->books);
+
+    lq->user_query = q;
+    live_query_rerun (lq);
+    live_query_register_handlers (lq);
+}
+
+GList *
+qof_live_query_get_results (QofLiveQuery *lq)
+{
+    g_return_val_if_fail (lq, NULL);
+
+    auto q = lq->user_query;
+    auto books = q->books, our_books = lq->query->books;
+    for (; books && our_books; books = books->next, our_books = our_books->next)
+        if (books->data != our_books->data)
+            break;
+    if (books || our_books || !qof_query_equal (q, lq->query))
+    {
+        PINFO ("query %p changed, running it again", q);
+        live_query_rerun (lq);
+        live_query_register_handlers (lq);
+    }
+    else if (live_query_missed_events (lq))
+    {
+        PINFO ("events were suspended, running query %p again", q);
+        live_query_rerun (lq);
+    }
+    else
+        live_query_flush (lq);
+
+    /* Same cropping as qof_query_run, leaving the list where
+     * qof_query_last_run will find it. */
+    auto& results = lq->results;
+    size_t first = 0;
+    if (q->max_results > -1 &&
+        results.size () > static_cast<size_t>(q->max_results))
+        first = results.size () - q->max_results;
+
+    GList *list = NULL;
+    for (auto i = results.size (); i > first; --i)
+        list = g_list_prepend (list, results[i - 1]);
+
+    g_list_free (q->results);
+    q->results = list;
+    return list;
+}
+
+const char *
+qof_query_get_plan (QofQuery *query)
+{
+    if (!query)
+        return NULL;
+
+    return query->plan;
+}
+
+void
+qof_query_register_index (QofIdTypeConst obj_type, const char *name,
+                          QofQueryIndexFunc func)
+{
+    g_return_if_fail (obj_type && name && func);
+
+    for (auto& index : query_indexes)
+        if (index.obj_type == obj_type && index.name == name)
+            return;
+    query_indexes.push_back ({obj_type, name, func});
+}
+
+void
+qof_query_register_related (QofIdTypeConst obj_type,
+                            QofIdTypeConst related_type,
+                            QofQueryRelatedFunc func)
+{
+    g_return_if_fail (obj_type && related_type && func);
+
+    for (auto& related : query_related)
+        if (related.obj_type == obj_type &&
+            related.related_type == related_type && related.func == func)
+            return;
+    query_related.push_back ({obj_type, related_type, func});
+}
+
 void qof_query_clear (QofQuery *query)
 {
     QofQuery *q2 = qof_query_create ();
@@ -903,6 +1644,7 @@ QofQuery * qof_query_create (void)
 {
     QofQuery *qp = g_new0 (QofQuery, 1);
     qp->be_compiled = g_hash_table_new (g_direct_hash, g_direct_equal);
+    qp->workers = 1;
     query_init (qp, NULL);
     return qp;
 }
@@ -1015,6 +1757,7 @@ QofQuery * qof_query_copy (QofQuery *q)
     copy->terms = copy_or_terms (q->terms);
     copy->books = g_list_copy (q->books);
     copy->results = g_list_copy (q->results);
+    copy->plan = g_strdup (q->plan);
 
     copy_sort (&(copy->primary_sort), &(q->primary_sort));
     copy_sort (&(copy->secondary_sort), &(q->secondary_sort));
@@ -1275,6 +2018,12 @@ void qof_query_set_max_results (QofQuery *q, int n)
     q->max_results = n;
 }
 
+void qof_query_set_workers (QofQuery *q, guint n_workers)
+{
+    if (!q) return;
+    q->workers = n_workers;
+}
+
 void qof_query_add_guid_list_match (QofQuery *q, QofQueryParamList *param_list,
                                     GList *guid_list, QofGuidMatch options,
                                     QofQueryOp op)
@@ -1350,6 +2099,8 @@ void qof_query_init (void)
 
 void qof_query_shutdown (void)
 {
+    query_indexes.clear ();
+    query_related.clear ();
     qof_class_shutdown ();
     qof_query_core_shutdown ();
 }
@@ -227,6 +227,17 @@ GList * qof_query_run (QofQuery *query);
  */
 GList * qof_query_last_run (QofQuery *query);
 
+/** Describe how the last qof_query_run() found the objects it checked.
+ *  "scan" means every object of the searched-for type in the book was
+ *  checked. Otherwise the query was answered from indexes, and the
+ *  string holds the name of the index used for each OR'd part of the
+ *  query, separated by " | ".
+ *
+ *  Returns NULL if the query hasn't been run. The string belongs to
+ *  the query and is only valid until it is next run or destroyed.
+ */
+const char * qof_query_get_plan (QofQuery *query);
+
 /** Perform a subquery, return the results.
  *  Instead of running over a book, the subquery runs over the results
  *  of the primary query.
@@ -360,6 +371,20 @@ void qof_query_set_sort_increasing (QofQuery *q, gboolean prim_inc,
  */
 void qof_query_set_max_results (QofQuery *q, int n);
 
+/**
+ * Check the query's terms against the objects on several threads.
+ * 1, the default, checks them on the calling thread and 0 uses one
+ * thread per processor. Only scans are split up, and only when every
+ * term uses a core type predicate that is safe to run concurrently and
+ * reaches its value through parameters marked with
+ * qof_class_set_thread_safe_parameters(); anything else runs on the
+ * calling thread. A getter may only be marked if it reads the object
+ * without filling in any cache on it or on its book, and the objects
+ * must not be changed by another thread while the query runs. The
+ * results are the same, in the same order, as a serial run.
+ */
+void qof_query_set_workers (QofQuery *q, guint n_workers);
+
 /** Compare two queries for equality.
  * Query terms are compared each to each.
  * This is a simplistic
@@ -382,6 +407,60 @@ QofIdType qof_query_get_search_for (const QofQuery *q);
 /** Return the list of books we're using */
 GList * qof_query_get_books (QofQuery *q);
 
+/** @name Live queries
+
+    A live query keeps the results of a query up to date as the objects
+    in its books change, instead of running the whole query again. It
+    listens for engine events on objects of the searched-for type (and
+    on the types registered as related to it), checks only the changed
+    objects against the query, and moves them into or out of the
+    sorted results, reporting each change to its callback. Without a
+    callback the changed objects are only noted, and worked into the
+    results when they are next asked for.
+
+    A change to an object of any other type the query's terms or sorts
+    read through has every object of the searched-for type checked
+    again, since nothing says which of them it affects. If events were
+    suspended since the results were made, they are made again from
+    scratch when next asked for.
+@{ */
+typedef struct _QofLiveQuery QofLiveQuery;
+
+typedef enum
+{
+    QOF_LIVE_QUERY_ADDED,
+    QOF_LIVE_QUERY_REMOVED,
+    QOF_LIVE_QUERY_MOVED,
+} QofLiveQueryChange;
+
+/** Called for each change to a live query's results, once the events
+ *  of a batch have all been worked in. position is the object's new
+ *  index among all of the matches in sort order, or for
+ *  QOF_LIVE_QUERY_REMOVED its index before the batch; removals are
+ *  reported first. max_results is not applied. */
+typedef void (*QofLiveQueryCB) (QofLiveQuery *lq, QofLiveQueryChange change,
+                                gpointer object, guint position,
+                                gpointer user_data);
+
+/** Run q and keep its results up to date from then on. q is not owned
+ *  by the live query but must outlive it, or be replaced with
+ *  qof_live_query_set_query(). cb may be NULL. */
+QofLiveQuery * qof_live_query_new (QofQuery *q, QofLiveQueryCB cb,
+                                   gpointer user_data);
+
+void qof_live_query_destroy (QofLiveQuery *lq);
+
+/** Follow a different query, running it from scratch. */
+void qof_live_query_set_query (QofLiveQuery *lq, QofQuery *q);
+
+/** Return the current results, cropped to max_results, just as
+ *  qof_query_run() would. If the query's terms, sorting or books were
+ *  changed since it was last run, or events were suspended, it is run
+ *  again from scratch, without calling the callback. The list belongs to the query and is also
+ *  what qof_query_last_run() returns. */
+GList * qof_live_query_get_results (QofLiveQuery *lq);
+/** @} */
+
 // @}
 /* @} */
 #ifdef __cplusplus
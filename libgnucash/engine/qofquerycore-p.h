@@ -49,6 +49,10 @@ typedef gint (*QofQueryPredicateFunc) (gpointer object,
 QofQueryPredicateFunc qof_query_core_get_predicate (gchar const *type);
 QofCompareFunc qof_query_core_get_compare (gchar const *type);
 
+/* Whether the type's predicate may be run on several objects at once.
+ * Only the core types registered by qof_query_core_init can be. */
+gboolean qof_query_core_predicate_is_thread_safe (gchar const *type);
+
 /* Compare two predicates */
 gboolean qof_query_core_predicate_equal (const QofQueryPredData *p1, const QofQueryPredData *p2);
 
@@ -96,6 +96,7 @@ static GHashTable *copyTable = NULL;
 static GHashTable *freeTable = NULL;
 static GHashTable *toStringTable = NULL;
 static GHashTable *predEqualTable = NULL;
+static GHashTable *threadSafeTable = NULL;
 
 #define COMPARE_ERROR -3
 #define PREDICATE_ERROR -2
@@ -1622,66 +1623,72 @@ static void init_tables (void)
         QueryPredDataFree      pd_free;
         QueryToString          toString;
         QueryPredicateEqual    pred_equal;
+        /* The predicate only reads its pdata and the value it gets, so
+         * it may run on several objects at once. */
+        gboolean               thread_safe;
     } knownTypes[] =
     {
         {
             QOF_TYPE_STRING, string_match_predicate, string_compare_func,
             string_copy_predicate, string_free_pdata, string_to_string,
-            string_predicate_equal
+            string_predicate_equal, TRUE
         },
         {
             QOF_TYPE_DATE, date_match_predicate, date_compare_func,
             date_copy_predicate, date_free_pdata, date_to_string,
-            date_predicate_equal
+            date_predicate_equal, TRUE
         },
         {
             QOF_TYPE_DEBCRED, numeric_match_predicate, numeric_compare_func,
             numeric_copy_predicate, numeric_free_pdata, debcred_to_string,
-            numeric_predicate_equal
+            numeric_predicate_equal, TRUE
         },
         {
             QOF_TYPE_NUMERIC, numeric_match_predicate, numeric_compare_func,
             numeric_copy_predicate, numeric_free_pdata, numeric_to_string,
-            numeric_predicate_equal
+            numeric_predicate_equal, TRUE
         },
         {
             QOF_TYPE_GUID, guid_match_predicate, NULL,
             guid_copy_predicate, guid_free_pdata, NULL,
-            guid_predicate_equal
+            guid_predicate_equal, TRUE
         },
         {
             QOF_TYPE_INT32, int32_match_predicate, int32_compare_func,
             int32_copy_predicate, int32_free_pdata, int32_to_string,
-            int32_predicate_equal
+            int32_predicate_equal, TRUE
         },
         {
             QOF_TYPE_INT64, int64_match_predicate, int64_compare_func,
             int64_copy_predicate, int64_free_pdata, int64_to_string,
-            int64_predicate_equal
+            int64_predicate_equal, TRUE
         },
         {
             QOF_TYPE_DOUBLE, double_match_predicate, double_compare_func,
             double_copy_predicate, double_free_pdata, double_to_string,
-            double_predicate_equal
+            double_predicate_equal, TRUE
         },
         {
             QOF_TYPE_BOOLEAN, boolean_match_predicate, boolean_compare_func,
             boolean_copy_predicate, boolean_free_pdata, boolean_to_string,
-            boolean_predicate_equal
+            boolean_predicate_equal, TRUE
         },
         {
             QOF_TYPE_CHAR, char_match_predicate, char_compare_func,
             char_copy_predicate, char_free_pdata, char_to_string,
-            char_predicate_equal
+            char_predicate_equal, TRUE
         },
+        /* The collect and choice getters may build the lists they hand
+         * back, so leave those to a single thread. */
         {
             QOF_TYPE_COLLECT, collect_match_predicate, collect_compare_func,
             collect_copy_predicate, collect_free_pdata, NULL,
-            collect_predicate_equal
+            collect_predicate_equal, FALSE
         },
         {
             QOF_TYPE_CHOICE, choice_match_predicate, NULL,
-            choice_copy_predicate, choice_free_pdata, NULL, choice_predicate_equal
+            choice_copy_predicate, choice_free_pdata, NULL, choice_predicate_equal,
+            FALSE
         },
     };
 
@@ -1695,6 +1702,9 @@ static void init_tables (void)
                                         knownTypes[i].pd_free,
                                         knownTypes[i].toString,
                                         knownTypes[i].pred_equal);
+        if (knownTypes[i].thread_safe)
+            g_hash_table_insert (threadSafeTable, (char *)knownTypes[i].name,
+                                 GINT_TO_POINTER (TRUE));
     }
 }
 
@@ -1730,6 +1740,7 @@ void qof_query_core_init (void)
     freeTable = g_hash_table_new (g_str_hash, g_str_equal);
     toStringTable = g_hash_table_new (g_str_hash, g_str_equal);
     predEqualTable = g_hash_table_new (g_str_hash, g_str_equal);
+    threadSafeTable = g_hash_table_new (g_str_hash, g_str_equal);
 
     init_tables ();
 }
@@ -1745,6 +1756,7 @@ void qof_query_core_shutdown (void)
     g_hash_table_destroy (freeTable);
     g_hash_table_destroy (toStringTable);
     g_hash_table_destroy (predEqualTable);
+    g_hash_table_destroy (threadSafeTable);
 }
 
 QofQueryPredicateFunc
@@ -1754,6 +1766,13 @@ qof_query_core_get_predicate (QofType type)
     return reinterpret_cast<QofQueryPredicateFunc>(g_hash_table_lookup (predTable, type));
 }
 
+gboolean
+qof_query_core_predicate_is_thread_safe (QofType type)
+{
+    g_return_val_if_fail (type, FALSE);
+    return GPOINTER_TO_INT (g_hash_table_lookup (threadSafeTable, type));
+}
+
 QofCompareFunc
 qof_query_core_get_compare (QofType type)
 {
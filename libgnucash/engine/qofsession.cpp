@@ -432,7 +432,18 @@ QofSessionImpl::get_uri () const noexcept
 bool
 QofSessionImpl::is_saving () const noexcept
 {
-    return m_saving;
+    return m_saving || (m_backend && m_backend->save_in_progress ());
+}
+
+void
+QofSessionImpl::wait_for_save () noexcept
+{
+    if (!m_backend) return;
+    m_backend->wait_for_save ();
+    auto err = m_backend->get_error ();
+    auto msg = m_backend->get_message ();
+    if (err != ERR_BACKEND_NO_ERR)
+        push_error (err, msg);
 }
 
 /* Manipulators (save, load, etc.) -------------------------*/
@@ -647,6 +658,13 @@ qof_session_save_in_progress(const QofSession *session)
     return session->is_saving ();
 }
 
+void
+qof_session_wait_for_save (QofSession *session)
+{
+    if (!session) return;
+    session->wait_for_save ();
+}
+
 void
 qof_session_end (QofSession *session)
 {
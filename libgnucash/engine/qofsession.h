@@ -249,6 +249,18 @@ const char * qof_session_get_url (const QofSession *session);
 /* gboolean qof_session_not_saved(const QofSession *session); <- unimplemented */
 gboolean qof_session_save_in_progress(const QofSession *session);
 
+/**
+ * The qof_session_wait_for_save() routine waits until a save that the
+ *    backend is writing out in the background is complete.  A backend may
+ *    return from qof_session_save() as soon as it has a consistent copy of
+ *    the book; if writing that copy out fails, the error is available
+ *    from qof_session_get_error() afterwards.  qof_session_save_in_progress()
+ *    only looks, so call this once it returns FALSE to learn how the save
+ *    went.  A qof_session_save() started before that finishes the earlier
+ *    save first and writes the book again if it failed.
+ */
+void qof_session_wait_for_save (QofSession *session);
+
 /**
  * Returns the qof session's backend.
  */
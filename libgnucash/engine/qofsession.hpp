@@ -50,6 +50,8 @@ struct QofSessionImpl
     void save (QofPercentageFunc) noexcept;
     void safe_save (QofPercentageFunc) noexcept;
     bool save_in_progress () const noexcept;
+    /** Wait for a save the backend is finishing in the background. */
+    void wait_for_save () noexcept;
     bool export_session (QofSessionImpl & real_session, QofPercentageFunc) noexcept;
 
     bool events_pending () const noexcept;
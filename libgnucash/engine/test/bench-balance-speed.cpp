@@ -0,0 +1,161 @@
+/********************************************************************
+ * bench-balance-speed.cpp: Time gnc_numeric_add_fixed.             *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+/* Walks an account's splits adding up the balance, the cleared and the
+ * reconciled balance the way xaccAccountRecomputeBalance does, once with
+ * gnc_numeric_add_fixed and once with the general gnc_numeric_add, and
+ * reports how long each took.
+ */
+#include <glib.h>
+
+#include <chrono>
+#include <cstdio>
+
+extern "C"
+{
+#include <config.h>
+#include "qof.h"
+#include "cashobjects.h"
+#include "Account.h"
+#include "Transaction.h"
+#include "TransLog.h"
+#include "gnc-commodity.h"
+#include "test-stuff.h"
+#include "test-engine-stuff.h"
+}
+#include "Account.hpp"
+
+#define NUM_SPLITS 20000
+#define NUM_REPS 20
+
+using Clock = std::chrono::steady_clock;
+
+static Account*
+make_account (QofBook *book, gnc_commodity *comm)
+{
+    auto acc = xaccMallocAccount (book);
+    xaccAccountBeginEdit (acc);
+    xaccAccountSetCommodity (acc, comm);
+
+    for (int i = 0; i < NUM_SPLITS; i++)
+    {
+        auto trans = xaccMallocTransaction (book);
+        auto split = xaccMallocSplit (book);
+        auto amount = gnc_numeric_create (get_random_gint64 () % 1000000, 100);
+
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, comm);
+        xaccTransSetDatePostedSecsNormalized (trans, 86400 * (i + 1));
+        xaccSplitSetParent (split, trans);
+        xaccSplitSetAccount (split, acc);
+        xaccSplitSetAmount (split, amount);
+        xaccSplitSetValue (split, amount);
+        if (i % 3)
+            xaccSplitSetReconcile (split, CREC);
+        xaccTransCommitEdit (trans);
+    }
+    xaccAccountCommitEdit (acc);
+    return acc;
+}
+
+struct Balances
+{
+    gnc_numeric bal = gnc_numeric_zero ();
+    gnc_numeric clr_bal = gnc_numeric_zero ();
+    gnc_numeric rec_bal = gnc_numeric_zero ();
+};
+
+static gnc_numeric
+general_add (gnc_numeric a, gnc_numeric b)
+{
+    return gnc_numeric_add (a, b, GNC_DENOM_AUTO,
+                            GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
+}
+
+template <gnc_numeric (*add) (gnc_numeric, gnc_numeric)> static Balances
+walk (Account *acc)
+{
+    Balances b;
+
+    for (auto split : xaccAccountGetSplits (acc))
+    {
+        auto amt = xaccSplitGetAmount (split);
+        auto rec = xaccSplitGetReconcile (split);
+        b.bal = add (b.bal, amt);
+        if (rec != NREC)
+            b.clr_bal = add (b.clr_bal, amt);
+        if (rec == YREC || rec == FREC)
+            b.rec_bal = add (b.rec_bal, amt);
+    }
+    return b;
+}
+
+static void
+run_test (void)
+{
+    auto book = qof_book_new ();
+    auto comm = gnc_commodity_new (book, "US Dollar", "CURRENCY", "USD",
+                                   "840", 100);
+    auto acc = make_account (book, comm);
+    Balances general, fixed;
+
+    auto start = Clock::now ();
+    for (int i = 0; i < NUM_REPS; i++)
+        general = walk<general_add> (acc);
+    std::chrono::duration<double, std::milli> general_time = Clock::now () - start;
+
+    start = Clock::now ();
+    for (int i = 0; i < NUM_REPS; i++)
+        fixed = walk<gnc_numeric_add_fixed> (acc);
+    std::chrono::duration<double, std::milli> fixed_time = Clock::now () - start;
+
+    do_test (gnc_numeric_eq (general.bal, fixed.bal) &&
+             gnc_numeric_eq (general.clr_bal, fixed.clr_bal) &&
+             gnc_numeric_eq (general.rec_bal, fixed.rec_bal),
+             "gnc_numeric_add_fixed matches gnc_numeric_add");
+    do_test (gnc_numeric_eq (fixed.bal, xaccAccountGetBalance (acc)),
+             "the walk matches the account balance");
+
+    printf ("%d x %d splits: gnc_numeric_add %.1f ms, "
+            "gnc_numeric_add_fixed %.1f ms (%.1fx)\n",
+            NUM_REPS, NUM_SPLITS, general_time.count (), fixed_time.count (),
+            fixed_time.count () > 0 ?
+            general_time.count () / fixed_time.count () : 0.0);
+
+    xaccAccountBeginEdit (acc);
+    xaccAccountDestroy (acc);
+    qof_book_destroy (book);
+}
+
+int
+main (int argc, char **argv)
+{
+    qof_init ();
+    if (cashobjects_register ())
+    {
+        xaccLogDisable ();
+        run_test ();
+        print_test_results ();
+    }
+    qof_close ();
+    return get_rv ();
+}
@@ -0,0 +1,140 @@
+/********************************************************************
+ * bench-bulk-load-arena.cpp: Measure loading a book with and       *
+ * without the bulk-load arena.                                     *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+/* Loads a generated book of random transactions, each with random KVP
+ * data, the way the backends do, first with the KVP objects allocated
+ * one by one and then from the book's arena. It reports the load time
+ * and how much the heap and the resident set grew. The second load can
+ * reuse memory the first one freed, so its RSS growth is understated;
+ * compare the heap figures.
+ */
+#include <glib.h>
+
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+extern "C"
+{
+#include <config.h>
+#include "qof.h"
+#include "cashobjects.h"
+#include "Account.h"
+#include "TransLog.h"
+#include "test-stuff.h"
+#include "test-engine-stuff.h"
+}
+#include "qof-arena.hpp"
+
+#define NUM_TRANSACTIONS 20000
+
+using Clock = std::chrono::steady_clock;
+
+/* Bytes allocated from the heap, or 0 if that can't be found out. */
+static size_t
+heap_in_use (void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    auto info = mallinfo2 ();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+/* The resident set size in bytes, or 0 if that can't be found out. */
+static size_t
+resident_set (void)
+{
+    size_t pages = 0, resident = 0;
+    auto statm = fopen ("/proc/self/statm", "r");
+    if (!statm)
+        return 0;
+    if (fscanf (statm, "%zu %zu", &pages, &resident) != 2)
+        resident = 0;
+    fclose (statm);
+    return resident * sysconf (_SC_PAGESIZE);
+}
+
+static void
+load_book (gboolean use_arena)
+{
+    const char *how = use_arena ? "arena" : "heap";
+    auto book = qof_book_new ();
+
+    qof_book_set_use_bulk_load_arena (use_arena);
+    auto heap_before = heap_in_use ();
+    auto rss_before = resident_set ();
+    auto start = Clock::now ();
+    /* A backend starts loading into an empty book. */
+    gnc_book_begin_bulk_load (book);
+    get_random_account_tree (book);
+    get_random_pricedb (book);
+    add_random_transactions_to_book (book, NUM_TRANSACTIONS);
+    gnc_book_end_bulk_load (book);
+    std::chrono::duration<double, std::milli> elapsed = Clock::now () - start;
+    auto heap = heap_in_use () - heap_before;
+    auto rss = resident_set () - rss_before;
+
+    auto trans = qof_book_get_collection (book, GNC_ID_TRANS);
+    do_test (qof_collection_count (trans) == NUM_TRANSACTIONS,
+             "every transaction was loaded");
+    auto arena = static_cast<QofArena*>(book->arena);
+    if (use_arena)
+        do_test (arena && arena->used () > 0, "KVP data came from the arena");
+    else
+        do_test (arena == NULL, "no arena without use_arena");
+
+    /* Later bulk loads, like an import, use the heap. */
+    auto used = arena ? arena->used () : 0;
+    gnc_book_begin_bulk_load (book);
+    add_random_transactions_to_book (book, 100);
+    gnc_book_end_bulk_load (book);
+    do_test (book->arena == arena && (!arena || arena->used () == used),
+             "a second bulk load doesn't use the arena");
+
+    printf ("%d transactions from the %s: %.1f ms, heap +%zu KiB, "
+            "RSS +%zu KiB\n", NUM_TRANSACTIONS, how, elapsed.count (),
+            heap / 1024, rss / 1024);
+
+    qof_book_destroy (book);
+}
+
+int
+main (int argc, char **argv)
+{
+    qof_init ();
+    auto use_arena = qof_book_get_use_bulk_load_arena ();
+    if (cashobjects_register ())
+    {
+        xaccLogDisable ();
+        load_book (FALSE);
+        load_book (TRUE);
+        print_test_results ();
+    }
+    qof_book_set_use_bulk_load_arena (use_arena);
+    qof_close ();
+    return get_rv ();
+}
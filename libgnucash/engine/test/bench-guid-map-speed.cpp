@@ -0,0 +1,121 @@
+/********************************************************************
+ * bench-guid-map-speed.cpp: Time looking up collection entities.   *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+/* Compares looking GUIDs up in a GHashTable keyed with
+ * guid_hash_table_new, which is what QofCollection used to keep its
+ * entities in, with qof_collection_lookup_entity and the batch
+ * qof_collection_lookup_entities. A quarter of the GUIDs looked up
+ * aren't in the collection.
+ */
+#include <glib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+extern "C"
+{
+#include <config.h>
+#include "qof.h"
+#include "test-stuff.h"
+}
+
+#define NUM_INSTANCES 200000
+#define NUM_REPS 10
+#define TEST_ID_TYPE "TestGuidMap"
+
+using Clock = std::chrono::steady_clock;
+
+static void
+run_test (void)
+{
+    auto book = qof_book_new ();
+    auto col = qof_book_get_collection (book, TEST_ID_TYPE);
+    auto table = guid_hash_table_new ();
+    std::vector<QofInstance*> instances;
+    std::vector<GncGUID> guids;
+
+    qof_collection_reserve (col, NUM_INSTANCES);
+    for (int i = 0; i < NUM_INSTANCES; i++)
+    {
+        auto inst = static_cast<QofInstance*>(g_object_new (QOF_TYPE_INSTANCE,
+                                                            nullptr));
+        qof_instance_init_data (inst, TEST_ID_TYPE, book);
+        auto guid = qof_instance_get_guid (inst);
+        g_hash_table_insert (table, (gpointer)guid, inst);
+        instances.push_back (inst);
+        guids.push_back (*guid);
+        if (i % 3 == 0)
+            guids.push_back (guid_new_return ());
+    }
+    std::shuffle (guids.begin (), guids.end (), std::mt19937 (NUM_INSTANCES));
+
+    std::vector<QofInstance*> expected (guids.size ());
+    auto start = Clock::now ();
+    for (int rep = 0; rep < NUM_REPS; rep++)
+        for (size_t i = 0; i < guids.size (); i++)
+            expected[i] = static_cast<QofInstance*>(g_hash_table_lookup (table,
+                                                                         &guids[i]));
+    std::chrono::duration<double, std::milli> hash = Clock::now () - start;
+
+    std::vector<QofInstance*> single (guids.size ());
+    start = Clock::now ();
+    for (int rep = 0; rep < NUM_REPS; rep++)
+        for (size_t i = 0; i < guids.size (); i++)
+            single[i] = qof_collection_lookup_entity (col, &guids[i]);
+    std::chrono::duration<double, std::milli> one = Clock::now () - start;
+
+    std::vector<QofInstance*> batch (guids.size ());
+    start = Clock::now ();
+    for (int rep = 0; rep < NUM_REPS; rep++)
+        qof_collection_lookup_entities (col, guids.data (), guids.size (),
+                                        batch.data ());
+    std::chrono::duration<double, std::milli> many = Clock::now () - start;
+
+    do_test (qof_collection_count (col) == NUM_INSTANCES,
+             "collection holds every instance");
+    do_test (single == expected, "lookup_entity matches the hash table");
+    do_test (batch == expected, "lookup_entities matches the hash table");
+
+    printf ("%d x %zu lookups: GHashTable %.1f ms, "
+            "qof_collection_lookup_entity %.1f ms (%.1fx), "
+            "qof_collection_lookup_entities %.1f ms (%.1fx)\n",
+            NUM_REPS, guids.size (), hash.count (),
+            one.count (), one.count () > 0 ? hash.count () / one.count () : 0.0,
+            many.count (), many.count () > 0 ? hash.count () / many.count () : 0.0);
+
+    g_hash_table_destroy (table);
+    for (auto inst : instances)
+        g_object_unref (inst);
+    qof_book_destroy (book);
+}
+
+int
+main (int argc, char **argv)
+{
+    qof_init ();
+    run_test ();
+    print_test_results ();
+    qof_close ();
+    return get_rv ();
+}
@@ -0,0 +1,151 @@
+/********************************************************************
+ * bench-split-layout.cpp: Report how Split's hot fields are laid   *
+ * out and what a balance walk over a generated book costs.         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+/* Prints the size of a Split and how many bytes and cache lines the
+ * fields a balance walk touches span, then times recomputing every
+ * account's balances in a generated book. Where the kernel lets us, it
+ * counts cache misses during the walk too. utest-Split checks that
+ * the hot fields stay together.
+ */
+#include <glib.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+extern "C"
+{
+#include <config.h>
+#include "qof.h"
+#include "cashobjects.h"
+#include "Account.h"
+#include "TransLog.h"
+#include "test-engine-stuff.h"
+}
+#include "SplitP.h"
+
+#define NUM_TRANSACTIONS 20000
+#define NUM_REPS 20
+#define CACHE_LINE 64
+
+using Clock = std::chrono::steady_clock;
+
+/* The fields xaccAccountRecomputeBalance reads and writes. */
+static const size_t hot_begin = offsetof (Split, acc);
+static const size_t hot_end = offsetof (Split, reconciled_balance) +
+    sizeof (gnc_numeric);
+
+static void
+report_layout (void)
+{
+    auto span = hot_end - hot_begin;
+    printf ("sizeof (Split) %zu bytes; hot fields span %zu bytes, "
+            "%zu to %zu cache lines\n", sizeof (Split), span,
+            (span + CACHE_LINE - 1) / CACHE_LINE,
+            (span + 2 * CACHE_LINE - 2) / CACHE_LINE);
+}
+
+#ifdef __linux__
+static int
+open_miss_counter (void)
+{
+    perf_event_attr attr {};
+    attr.size = sizeof (attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return syscall (SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+static void
+walk_book (void)
+{
+    auto book = get_random_book ();
+    add_random_transactions_to_book (book, NUM_TRANSACTIONS);
+    auto accounts = gnc_account_get_descendants (gnc_book_get_root_account (book));
+    auto n_splits = qof_collection_count (qof_book_get_collection (book,
+                                                                  GNC_ID_SPLIT));
+    long long misses = -1;
+
+#ifdef __linux__
+    int counter = open_miss_counter ();
+    if (counter >= 0)
+    {
+        ioctl (counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl (counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+    auto start = Clock::now ();
+    for (int i = 0; i < NUM_REPS; i++)
+        for (auto node = accounts; node; node = node->next)
+        {
+            auto acc = static_cast<Account*>(node->data);
+            gnc_account_set_balance_dirty (acc);
+            xaccAccountRecomputeBalance (acc);
+        }
+    std::chrono::duration<double, std::milli> elapsed = Clock::now () - start;
+#ifdef __linux__
+    if (counter >= 0)
+    {
+        ioctl (counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read (counter, &misses, sizeof (misses)) != sizeof (misses))
+            misses = -1;
+        close (counter);
+    }
+#endif
+
+    if (misses >= 0)
+        printf ("%d balance walks over %u splits: %.1f ms, "
+                "%.2f cache misses per split\n", NUM_REPS, n_splits,
+                elapsed.count (),
+                n_splits ? (double)misses / NUM_REPS / n_splits : 0.0);
+    else
+        printf ("%d balance walks over %u splits: %.1f ms, "
+                "cache misses not available\n", NUM_REPS, n_splits,
+                elapsed.count ());
+
+    g_list_free (accounts);
+    qof_book_destroy (book);
+}
+
+int
+main (int argc, char **argv)
+{
+    qof_init ();
+    if (cashobjects_register ())
+    {
+        xaccLogDisable ();
+        report_layout ();
+        walk_book ();
+    }
+    qof_close ();
+    return 0;
+}
@@ -371,6 +371,56 @@ TEST_F(ImapBayesTest, ConvertBayesData)
     EXPECT_TRUE(qof_instance_get_dirty_flag(QOF_INSTANCE(t_bank_account)));
 }
 
+/* The token index built by the first lookup must follow later changes. */
+TEST_F(ImapBayesTest, FindAccountBayesAfterChanges)
+{
+    gnc_account_imap_add_account_bayes(t_imap, t_list1, t_expense_account1);
+    auto account = gnc_account_imap_find_account_bayes(t_imap, t_list1);
+    EXPECT_EQ(t_expense_account1, account);
+    account = gnc_account_imap_find_account_bayes(t_imap, t_list2);
+    EXPECT_EQ(nullptr, account);
+
+    for (int i = 0; i < 4; ++i)
+        gnc_account_imap_add_account_bayes(t_imap, t_list1, t_expense_account2);
+    gnc_account_imap_add_account_bayes(t_imap, t_list2, t_expense_account1);
+    account = gnc_account_imap_find_account_bayes(t_imap, t_list1);
+    EXPECT_EQ(t_expense_account2, account);
+    account = gnc_account_imap_find_account_bayes(t_imap, t_list2);
+    EXPECT_EQ(t_expense_account1, account);
+
+    gnc_account_delete_all_bayes_maps(t_bank_account);
+    account = gnc_account_imap_find_account_bayes(t_imap, t_list1);
+    EXPECT_EQ(nullptr, account);
+}
+
+/* Writes to the import map that don't go through the import map
+ * functions must not leave the token index stale either. */
+TEST_F(ImapBayesTest, FindAccountBayesAfterDirectWrites)
+{
+    gnc_account_imap_add_account_bayes(t_imap, t_list1, t_expense_account1);
+    auto account = gnc_account_imap_find_account_bayes(t_imap, t_list1);
+    EXPECT_EQ(t_expense_account1, account);
+
+    auto acct2_guid = guid_to_string (xaccAccountGetGUID(t_expense_account2));
+    GValue value = G_VALUE_INIT;
+    g_value_init (&value, G_TYPE_INT64);
+    g_value_set_int64 (&value, 100);
+    for (auto token : {foo, bar})
+        qof_instance_set_path_kvp (QOF_INSTANCE (t_bank_account), &value,
+                                   {std::string{IMAP_FRAME_BAYES} + "/" + token + "/" + acct2_guid});
+    g_value_unset (&value);
+    g_free (acct2_guid);
+    account = gnc_account_imap_find_account_bayes(t_imap, t_list1);
+    EXPECT_EQ(t_expense_account2, account);
+
+    /* Copying the frame over from an account without a map, as undo
+     * does, empties it. */
+    qof_instance_copy_kvp (QOF_INSTANCE (t_bank_account),
+                           QOF_INSTANCE (t_sav_account));
+    account = gnc_account_imap_find_account_bayes(t_imap, t_list1);
+    EXPECT_EQ(nullptr, account);
+}
+
 /* Tests the import map's handling of KVP delimiters */
 TEST_F (ImapBayesTest, import_map_with_delimiters)
 {
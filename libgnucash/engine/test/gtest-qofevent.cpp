@@ -28,6 +28,7 @@
 #include "../qofevent.h"
 #include "../qofevent-p.h"
 #include <gtest/gtest.h>
+#include <vector>
 
 static void
 easy_handler (QofInstance *ent,  QofEventId event_type,
@@ -135,3 +136,87 @@ TEST (qofevent, compound_events)
     qof_event_unregister_handler (id5);
 }
 
+
+static void
+count_handler (QofInstance *ent,  QofEventId event_type,
+               gpointer handler_data, gpointer event_data)
+{
+    int *data = static_cast<int*>(handler_data);
+    *data = *data + 1;
+}
+
+static void
+batch_handler (const QofEventBatchEntry *events, guint n_events,
+               gpointer handler_data)
+{
+    auto batches = static_cast<std::vector<std::vector<QofEventBatchEntry>>*>(handler_data);
+    batches->emplace_back (events, events + n_events);
+}
+
+TEST (qofevent, batch_events)
+{
+    QofInstance account, trans;  // only e_type is looked at
+    account.e_type = "Account";
+    trans.e_type = "Trans";
+    int all = 0, accounts = 0;
+    std::vector<std::vector<QofEventBatchEntry>> batches;
+    QofEventStats stats;
+
+    int id1 = qof_event_register_handler (count_handler, &all);
+    int id2 = qof_event_register_typed_handler ("Account", count_handler,
+                                                &accounts);
+    int id3 = qof_event_register_batch_handler (NULL, batch_handler, &batches);
+    qof_event_reset_stats ();
+
+    // outside a batch every handler that wants an event gets it at once.
+    qof_event_gen (&trans, QOF_EVENT_MODIFY, NULL);
+    EXPECT_EQ (all, 1);
+    EXPECT_EQ (accounts, 0);
+    ASSERT_EQ (batches.size (), 1u);
+    EXPECT_EQ (batches[0].size (), 1u);
+    batches.clear ();
+
+    // repeated events in a batch are delivered once, when the batch ends.
+    qof_event_begin_batch ();
+    qof_event_begin_batch ();
+    for (int i = 0; i < 10; i++)
+    {
+        qof_event_gen (&account, QOF_EVENT_MODIFY, NULL);
+        qof_event_gen (&trans, QOF_EVENT_MODIFY, NULL);
+    }
+    qof_event_gen (&account, QOF_EVENT_ADD, NULL);
+    qof_event_end_batch ();
+    EXPECT_EQ (all, 1);
+    EXPECT_TRUE (batches.empty ());
+    qof_event_end_batch ();
+    EXPECT_EQ (all, 4);
+    EXPECT_EQ (accounts, 2);
+    ASSERT_EQ (batches.size (), 1u);
+    ASSERT_EQ (batches[0].size (), 3u);
+    EXPECT_EQ (batches[0][0].entity, &account);
+    EXPECT_EQ (batches[0][0].event_id, QOF_EVENT_MODIFY);
+    EXPECT_EQ (batches[0][1].entity, &trans);
+    EXPECT_EQ (batches[0][2].event_id, QOF_EVENT_ADD);
+    batches.clear ();
+
+    // an event with data goes at once, after what was queued for its entity.
+    qof_event_begin_batch ();
+    qof_event_gen (&account, QOF_EVENT_MODIFY, NULL);
+    qof_event_gen (&trans, QOF_EVENT_MODIFY, NULL);
+    qof_event_gen (&account, QOF_EVENT_REMOVE, GINT_TO_POINTER(1));
+    ASSERT_EQ (batches.size (), 2u);
+    EXPECT_EQ (batches[0][0].event_id, QOF_EVENT_MODIFY);
+    EXPECT_EQ (batches[1][0].event_id, QOF_EVENT_REMOVE);
+    qof_event_forget_entity (&trans);
+    qof_event_end_batch ();
+    EXPECT_EQ (batches.size (), 2u);
+
+    qof_event_get_stats (&stats);
+    EXPECT_EQ (stats.generated, 25u);
+    EXPECT_EQ (stats.coalesced, 18u);
+    EXPECT_EQ (stats.delivered, 16u);
+
+    qof_event_unregister_handler (id3);
+    qof_event_unregister_handler (id2);
+    qof_event_unregister_handler (id1);
+}
@@ -27,6 +27,7 @@
  */
 #include <guid.hpp>
 #include <glib.h>
+#include <vector>
 
 extern "C"
 {
@@ -89,6 +90,55 @@ run_test (void)
     qof_session_destroy(sess);
 }
 
+/* Looks up entities one at a time and in a batch after some have been
+ * taken out of the collection again. */
+static void
+test_lookup_entities (void)
+{
+    const int n_ent = 1000;
+    auto book = qof_book_new ();
+    auto col = qof_book_get_collection (book, "asdf");
+    std::vector<QofInstance*> instances;
+    std::vector<GncGUID> guids;
+    std::vector<QofInstance*> expected;
+
+    qof_collection_reserve (col, n_ent);
+    for (int i = 0; i < n_ent; i++)
+    {
+        auto ent = static_cast<QofInstance*>(g_object_new (QOF_TYPE_INSTANCE,
+                                                           NULL));
+        qof_instance_init_data (ent, "asdf", book);
+        instances.push_back (ent);
+        guids.push_back (*qof_instance_get_guid (ent));
+        expected.push_back (ent);
+        if (i % 3 == 0)
+        {
+            guids.push_back (guid_new_return ());
+            expected.push_back (NULL);
+        }
+    }
+    for (size_t i = 0; i < guids.size (); i += 5)
+    {
+        if (!expected[i]) continue;
+        qof_collection_remove_entity (expected[i]);
+        expected[i] = NULL;
+    }
+
+    std::vector<QofInstance*> single;
+    for (auto& guid : guids)
+        single.push_back (qof_collection_lookup_entity (col, &guid));
+    std::vector<QofInstance*> batch (guids.size ());
+    qof_collection_lookup_entities (col, guids.data (), guids.size (),
+                                    batch.data ());
+
+    do_test (single == expected, "lookup_entity finds what's left");
+    do_test (batch == expected, "lookup_entities finds what's left");
+
+    for (auto ent : instances)
+        g_object_unref (ent);
+    qof_book_destroy (book);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -97,6 +147,7 @@ main (int argc, char **argv)
     {
         test_null_guid();
         run_test ();
+        test_lookup_entities ();
         print_test_results();
     }
     qof_close();
@@ -27,6 +27,7 @@
 #include "../kvp-frame.hpp"
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <thread>
 
 class KvpFrameTest : public ::testing::Test
 {
@@ -181,6 +182,54 @@ TEST_F (KvpFrameTest, GetSlotPath)
     EXPECT_EQ (v1, t_root.get_slot(path3a));
 }
 
+TEST_F (KvpFrameTest, CompiledPath)
+{
+    KvpPath first {"top/first"};
+    KvpPath deep {"top/second/twenty/twenty-first"};
+    KvpPath missing {"top/fourth"};
+    auto v1 = new KvpValueImpl {15.0};
+    auto v2 = new KvpValueImpl {INT64_C(52)};
+
+    EXPECT_EQ (t_int_val, t_root.get_compiled_slot (first));
+    EXPECT_EQ (nullptr, t_root.get_compiled_slot (missing));
+    EXPECT_EQ (nullptr, t_root.set_compiled_path (deep, v1));
+    EXPECT_EQ (v1, t_root.get_slot ({"top", "second", "twenty", "twenty-first"}));
+    EXPECT_EQ (v1, t_root.set_compiled_path (deep, v2));
+    EXPECT_EQ (v2, t_root.get_compiled_slot (deep));
+    EXPECT_EQ (v2, t_root.set_compiled_path (deep, nullptr));
+    EXPECT_EQ (nullptr, t_root.get_compiled_slot (deep));
+    delete v1;
+    delete v2;
+
+    /* Frames too big to scan are bisected. */
+    for (auto key : {"k", "j", "i", "h", "g", "f", "e", "d", "c", "b", "a"})
+        t_root.set ({key}, new KvpValue {INT64_C(1)});
+    auto keys = t_root.get_keys ();
+    EXPECT_TRUE (std::is_sorted (keys.begin (), keys.end ()));
+    EXPECT_NE (nullptr, t_root.get_compiled_slot (KvpPath {"f"}));
+    EXPECT_NE (nullptr, t_root.get_compiled_slot (KvpPath {Path {"top", "third"}}));
+    EXPECT_EQ (nullptr, t_root.get_compiled_slot (KvpPath {"ff"}));
+}
+
+/* A shared path is looked up from several threads at once, like the
+ * static ones in Account.cpp from the parallel query workers. */
+TEST_F (KvpFrameTest, CompiledPathThreads)
+{
+    KvpPath shared {"top/first"};
+    std::vector<std::thread> threads;
+    std::vector<char const *> firsts (8);
+    for (size_t i = 0; i < firsts.size (); i++)
+        threads.emplace_back ([&shared, &firsts, i] ()
+                              { firsts[i] = shared.atoms ().front (); });
+    for (auto& thread : threads)
+        thread.join ();
+    EXPECT_TRUE (std::all_of (firsts.begin (), firsts.end (),
+                              [&firsts] (char const * atom)
+                              { return atom == firsts.front (); }));
+    EXPECT_EQ (2u, shared.atoms ().size ());
+    EXPECT_EQ (t_int_val, t_root.get_compiled_slot (shared));
+}
+
 TEST_F (KvpFrameTest, Empty)
 {
     KvpFrameImpl f1, f2;
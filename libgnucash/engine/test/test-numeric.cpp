@@ -664,6 +664,59 @@ check_add_subtract_overflow (void)
 
 /* ======================================================= */
 
+/* gnc_numeric_add_fixed and gnc_numeric_sub_fixed take a 64-bit shortcut
+ * for operands with the same denominator; it must agree exactly with the
+ * general routines, including when the shortcut has to be abandoned. */
+static void
+check_add_subtract_fixed (void)
+{
+    int i;
+    gnc_numeric a, b;
+
+    for (i = 0; i < 100 * NREPS; i++)
+    {
+        gint64 deno = powten (rand () % 7);
+        a = gnc_numeric_create (get_random_gint64 () / 2, deno);
+        b = gnc_numeric_create (get_random_gint64 () / 2, deno);
+
+        check_binary_op (gnc_numeric_add (a, b, GNC_DENOM_AUTO,
+                                          GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER),
+                         gnc_numeric_add_fixed (a, b), a, b,
+                         "expected %s got %s = %s + %s for add_fixed");
+        check_binary_op (gnc_numeric_sub (a, b, GNC_DENOM_AUTO,
+                                          GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER),
+                         gnc_numeric_sub_fixed (a, b), a, b,
+                         "expected %s got %s = %s - %s for sub_fixed");
+    }
+
+    /* Overflowing the 64-bit sum falls back to the general code. */
+    a = gnc_numeric_create (G_MAXINT64 - 1, 100);
+    b = gnc_numeric_create (2, 100);
+    check_binary_op (gnc_numeric_add (a, b, GNC_DENOM_AUTO,
+                                      GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER),
+                     gnc_numeric_add_fixed (a, b), a, b,
+                     "expected %s got %s = %s + %s for overflowing add_fixed");
+    a = gnc_numeric_create (G_MININT64 + 1, 100);
+    check_binary_op (gnc_numeric_sub (a, b, GNC_DENOM_AUTO,
+                                      GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER),
+                     gnc_numeric_sub_fixed (a, b), a, b,
+                     "expected %s got %s = %s - %s for overflowing sub_fixed");
+
+    /* Different denominators take the general path. */
+    a = gnc_numeric_create (1, 3);
+    b = gnc_numeric_create (1, 4);
+    check_binary_op (gnc_numeric_add (a, b, GNC_DENOM_AUTO,
+                                      GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER),
+                     gnc_numeric_add_fixed (a, b), a, b,
+                     "expected %s got %s = %s + %s for mixed add_fixed");
+    check_binary_op (gnc_numeric_sub (a, b, GNC_DENOM_AUTO,
+                                      GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER),
+                     gnc_numeric_sub_fixed (a, b), a, b,
+                     "expected %s got %s = %s - %s for mixed sub_fixed");
+}
+
+/* ======================================================= */
+
 
 static void
 check_mult_div (void)
@@ -898,6 +951,7 @@ run_test (void)
     check_neg();
     check_add_subtract();
     check_add_subtract_overflow ();
+    check_add_subtract_fixed ();
     check_mult_div ();
 }
 
@@ -77,8 +77,93 @@ test_qof_string_cache( void )
     g_assert(str1_1 != str1_4);
 }
 
+static void
+test_qof_string_cache_stats( void )
+{
+    QofStringCacheStats before, stats;
+    const gchar* str = "stats string";
+    const gsize size = strlen(str) + 1;
+
+    qof_string_cache_get_stats(&before);
+    qof_string_cache_insert(str);
+    qof_string_cache_insert(str);
+    qof_string_cache_insert(str);
+    qof_string_cache_get_stats(&stats);
+    g_assert_cmpuint(stats.unique_strings, ==, before.unique_strings + 1);
+    g_assert_cmpuint(stats.bytes, ==, before.bytes + size);
+    g_assert_cmpuint(stats.bytes_saved, ==, before.bytes_saved + 2 * size);
+
+    qof_string_cache_remove(str);
+    qof_string_cache_remove(str);
+    qof_string_cache_remove(str);
+    qof_string_cache_get_stats(&stats);
+    g_assert_cmpuint(stats.unique_strings, ==, before.unique_strings);
+    g_assert_cmpuint(stats.bytes, ==, before.bytes);
+    g_assert_cmpuint(stats.bytes_saved, ==, before.bytes_saved);
+}
+
+#define NUM_THREADS 4
+#define NUM_STRINGS 50
+#define NUM_ITERATIONS 10000
+
+static gpointer
+string_cache_thread( gpointer data )
+{
+    gint i;
+    for (i = 0; i < NUM_ITERATIONS; i++)
+    {
+        gchar *str = g_strdup_printf("thread string %d", i % NUM_STRINGS);
+        const gchar *cached = qof_string_cache_insert(str);
+        g_assert_cmpstr(cached, ==, str);
+        if (i % 3 != 0)
+            qof_string_cache_remove(cached);
+        g_free(str);
+    }
+    return NULL;
+}
+
+static void
+test_qof_string_cache_threads( void )
+{
+    /* Each thread keeps a third of its references, so every string ends
+     * up shared and has to come out with the right count. */
+    GThread *threads[NUM_THREADS];
+    QofStringCacheStats before, stats;
+    gint i, j;
+
+    qof_string_cache_get_stats(&before);
+    for (i = 0; i < NUM_THREADS; i++)
+        threads[i] = g_thread_new("string-cache", string_cache_thread, NULL);
+    for (i = 0; i < NUM_THREADS; i++)
+        g_thread_join(threads[i]);
+
+    qof_string_cache_get_stats(&stats);
+    g_assert_cmpuint(stats.unique_strings, ==, before.unique_strings + NUM_STRINGS);
+
+    for (i = 0; i < NUM_STRINGS; i++)
+    {
+        gchar *str = g_strdup_printf("thread string %d", i);
+        const gchar *cached = qof_string_cache_insert(str);
+        /* the one just taken, and the ones the threads kept */
+        qof_string_cache_remove(cached);
+        for (j = i; j < NUM_ITERATIONS; j += NUM_STRINGS)
+            if (j % 3 == 0)
+            {
+                gint t;
+                for (t = 0; t < NUM_THREADS; t++)
+                    qof_string_cache_remove(cached);
+            }
+        g_free(str);
+    }
+    qof_string_cache_get_stats(&stats);
+    g_assert_cmpuint(stats.unique_strings, ==, before.unique_strings);
+    g_assert_cmpuint(stats.bytes_saved, ==, before.bytes_saved);
+}
+
 void
 test_suite_qof_string_cache ( void )
 {
     GNC_TEST_ADD_FUNC( suitename, "string-cache", test_qof_string_cache);
+    GNC_TEST_ADD_FUNC( suitename, "string-cache stats", test_qof_string_cache_stats);
+    GNC_TEST_ADD_FUNC( suitename, "string-cache threads", test_qof_string_cache_threads);
 }
@@ -720,6 +720,41 @@ test_book_shutting_down( Fixture *fixture, gconstpointer pData )
     g_assert( qof_book_shutting_down( fixture->book ) == FALSE );
 }
 
+static void
+test_book_bulk_load_arena( Fixture *fixture, gconstpointer pData )
+{
+    gboolean use_arena = qof_book_get_use_bulk_load_arena();
+    gpointer arena;
+
+    g_test_message( "Testing bulk load without an arena" );
+    qof_book_set_use_bulk_load_arena( FALSE );
+    qof_book_begin_bulk_load( fixture->book );
+    g_assert( qof_book_is_bulk_loading( fixture->book ) );
+    g_assert( fixture->book->arena == NULL );
+    g_assert( qof_book_end_bulk_load( fixture->book ) );
+    g_assert( !qof_book_is_bulk_loading( fixture->book ) );
+
+    g_test_message( "Testing the first bulk load into an empty book" );
+    qof_book_set_use_bulk_load_arena( TRUE );
+    qof_book_begin_bulk_load( fixture->book );
+    qof_book_begin_bulk_load( fixture->book );
+    arena = fixture->book->arena;
+    g_assert( arena != NULL );
+    qof_book_set_string_option( fixture->book, "Test Option", "from the arena" );
+    g_assert( !qof_book_end_bulk_load( fixture->book ) );
+    g_assert( qof_book_is_bulk_loading( fixture->book ) );
+    g_assert( qof_book_end_bulk_load( fixture->book ) );
+    g_assert_cmpstr( qof_book_get_string_option( fixture->book, "Test Option" ),
+                     ==, "from the arena" );
+
+    g_test_message( "Testing that a later bulk load keeps the same arena" );
+    qof_book_begin_bulk_load( fixture->book );
+    g_assert( fixture->book->arena == arena );
+    g_assert( qof_book_end_bulk_load( fixture->book ) );
+
+    qof_book_set_use_bulk_load_arena( use_arena );
+}
+
 static void
 test_book_set_get_data( Fixture *fixture, gconstpointer pData )
 {
@@ -971,6 +1006,7 @@ test_suite_qofbook ( void )
     GNC_TEST_ADD( suitename, "session dirty time", Fixture, NULL, setup, test_book_get_session_dirty_time, teardown );
     GNC_TEST_ADD( suitename, "set dirty callback", Fixture, NULL, setup, test_book_set_dirty_cb, teardown );
     GNC_TEST_ADD( suitename, "shutting down", Fixture, NULL, setup, test_book_shutting_down, teardown );
+    GNC_TEST_ADD( suitename, "bulk load arena", Fixture, NULL, setup, test_book_bulk_load_arena, teardown );
     GNC_TEST_ADD( suitename, "set get data", Fixture, NULL, setup, test_book_set_get_data, teardown );
     GNC_TEST_ADD( suitename, "get collection", Fixture, NULL, setup, test_book_get_collection, teardown );
     GNC_TEST_ADD( suitename, "features", Fixture, NULL, setup, test_book_features, teardown );
@@ -34,6 +34,8 @@ static QofBook * exported_book {nullptr};
 static bool safe_sync_called {false};
 static bool sync_called {false};
 static bool load_error {true};
+static bool background_save {false};
+static QofBackendError background_save_error {ERR_BACKEND_NO_ERR};
 static bool hook_called {false};
 static bool data_loaded {false};
 
@@ -50,6 +52,8 @@ public:
     void sync(QofBook*);
     void safe_sync(QofBook*);
     void export_coa(QofBook*);
+    bool save_in_progress() const { return background_save; }
+    void wait_for_save();
 };
 
 static void
@@ -82,6 +86,14 @@ void QofSessionMockBackend::export_coa(QofBook * book)
     exported_book = book;
 }
 
+void QofSessionMockBackend::wait_for_save ()
+{
+    if (!background_save)
+        return;
+    background_save = false;
+    set_error (background_save_error);
+}
+
 static QofBackend*
 test_backend_factory ()
 {
@@ -228,6 +240,24 @@ TEST (QofSessionTest, safe_save)
     safe_sync_called = false;
 }
 
+TEST (QofSessionTest, wait_for_save)
+{
+    qof_backend_register_provider (get_provider ());
+    QofSession s(qof_book_new());
+    s.begin ("book1", SESSION_NORMAL_OPEN);
+    background_save = true;
+    background_save_error = ERR_FILEIO_WRITE_ERROR;
+    EXPECT_TRUE (s.is_saving ());
+    s.wait_for_save ();
+    EXPECT_FALSE (s.is_saving ());
+    EXPECT_EQ (s.get_error (), ERR_FILEIO_WRITE_ERROR);
+    s.clear_error ();
+    s.wait_for_save ();
+    EXPECT_EQ (s.get_error (), ERR_BACKEND_NO_ERR);
+    qof_backend_unregister_all_providers ();
+    background_save_error = ERR_BACKEND_NO_ERR;
+}
+
 TEST (QofSessionTest, export_session)
 {
     qof_backend_register_provider (get_provider ());
@@ -27,6 +27,7 @@ extern "C"
 #include <config.h>
 #include "qof.h"
 #include "cashobjects.h"
+#include "Query.h"
 #include "Transaction.h"
 #include "TransLog.h"
 #include "gnc-engine.h"
@@ -68,6 +69,323 @@ test_trans_query (Transaction *trans, gpointer data)
     return 0;
 }
 
+/* A register-style query must be answered from the account's splits
+ * and give the same splits a scan would. */
+static void
+test_account_date_query (Account *acc, QofBook *book)
+{
+    GList *splits = xaccAccountGetSplitList (acc);
+    GList *expected = NULL, *node;
+    guint len = g_list_length (splits);
+    time64 start, end;
+    QofQuery *q, *q2;
+
+    if (len == 0)
+        return;
+
+    start = xaccTransGetDate (xaccSplitGetParent (GNC_SPLIT (g_list_nth_data (splits, len / 4))));
+    end = xaccTransGetDate (xaccSplitGetParent (GNC_SPLIT (g_list_nth_data (splits, 3 * len / 4))));
+    for (node = splits; node; node = node->next)
+    {
+        time64 t = xaccTransGetDate (xaccSplitGetParent (GNC_SPLIT (node->data)));
+        if (t >= start && t <= end)
+            expected = g_list_prepend (expected, node->data);
+    }
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddSingleAccountMatch (q, acc, QOF_QUERY_AND);
+    xaccQueryAddDateMatchTT (q, TRUE, start, TRUE, end, QOF_QUERY_AND);
+
+    auto result = qof_query_run (q);
+    do_test (!g_strcmp0 (qof_query_get_plan (q), "split-account"),
+             "account and date query uses the account index");
+    do_test (g_list_length (result) == g_list_length (expected),
+             "account and date query finds the right number of splits");
+    for (node = expected; node; node = node->next)
+        if (!g_list_find (result, node->data))
+            break;
+    do_test (node == NULL, "account and date query finds the right splits");
+
+    /* An OR'd part no index can serve means a scan. */
+    q2 = qof_query_create_for (GNC_ID_SPLIT);
+    xaccQueryAddDescriptionMatch (q2, "x", TRUE, FALSE, QOF_COMPARE_CONTAINS,
+                                  QOF_QUERY_AND);
+    qof_query_merge_in_place (q, q2, QOF_QUERY_OR);
+    qof_query_run (q);
+    do_test (!g_strcmp0 (qof_query_get_plan (q), "scan"),
+             "unindexable OR term makes the query scan");
+
+    qof_query_destroy (q2);
+    qof_query_destroy (q);
+    g_list_free (expected);
+}
+
+/* Keeping only the best max_results matches while scanning must give
+ * exactly the tail of the fully sorted list, ties included. */
+static void
+test_max_results (QofBook *book, QofQueryParamList *sort_params)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    GList *all, *node, *tail;
+    gint n;
+
+    qof_query_set_book (q, book);
+    if (sort_params)
+        qof_query_set_sort_order (q, sort_params, NULL, NULL);
+    all = g_list_copy (qof_query_run (q));
+    n = g_list_length (all);
+
+    for (gint k = 1; k <= n + 1; k += 1 + n / 5)
+    {
+        qof_query_set_max_results (q, k);
+        node = qof_query_run (q);
+        tail = g_list_nth (all, k < n ? n - k : 0);
+        while (node && tail && node->data == tail->data)
+        {
+            node = node->next;
+            tail = tail->next;
+        }
+        do_test (!node && !tail, "max results keeps the last of the sorted matches");
+    }
+
+    g_list_free (all);
+    qof_query_destroy (q);
+}
+
+/* Splitting the scan across threads must not change the result or its
+ * order, with or without max_results. */
+static void
+test_parallel_query (QofBook *book)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    const gint max_results[] = {-1, 100};
+    GList *serial, *node, *node2;
+
+    qof_query_set_book (q, book);
+    xaccQueryAddValueMatch (q, gnc_numeric_zero (), QOF_NUMERIC_MATCH_ANY,
+                            QOF_COMPARE_GT, QOF_QUERY_AND);
+    xaccQueryAddClearedMatch (q, (cleared_match_t)(CLEARED_NO | CLEARED_CLEARED),
+                              QOF_QUERY_OR);
+
+    for (auto max : max_results)
+    {
+        qof_query_set_max_results (q, max);
+        qof_query_set_workers (q, 1);
+        serial = g_list_copy (qof_query_run (q));
+        qof_query_set_workers (q, 4);
+        node = qof_query_run (q);
+        for (node2 = serial; node && node2; node = node->next, node2 = node2->next)
+            if (node->data != node2->data)
+                break;
+        do_test (serial && !node && !node2,
+                 "parallel query matches the serial one");
+        g_list_free (serial);
+    }
+
+    qof_query_destroy (q);
+}
+
+/* Getters that fill in caches must keep the scan on one thread; the
+ * query still gives the same answer when asked for workers. */
+static void
+test_thread_safe_params (QofBook *book)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    GList *serial, *node, *node2;
+
+    do_test (qof_class_parameter_is_thread_safe
+             (qof_class_get_parameter (GNC_ID_SPLIT, SPLIT_VALUE)),
+             "split value is thread safe");
+    do_test (!qof_class_parameter_is_thread_safe
+             (qof_class_get_parameter (GNC_ID_TRANS, TRANS_IS_CLOSING)),
+             "closing transaction flag is not thread safe");
+    do_test (!qof_class_parameter_is_thread_safe
+             (qof_class_get_parameter (GNC_ID_TRANS, TRANS_NOTES)),
+             "transaction notes are not thread safe");
+
+    qof_query_set_book (q, book);
+    qof_query_add_term (q, qof_query_build_param_list (SPLIT_TRANS,
+                                                       TRANS_IS_CLOSING,
+                                                       NULL),
+                        qof_query_boolean_predicate (QOF_COMPARE_EQUAL, FALSE),
+                        QOF_QUERY_AND);
+    serial = g_list_copy (qof_query_run (q));
+    qof_query_set_workers (q, 4);
+    node = qof_query_run (q);
+    for (node2 = serial; node && node2; node = node->next, node2 = node2->next)
+        if (node->data != node2->data)
+            break;
+    do_test (serial && !node && !node2,
+             "query on a caching getter matches with workers set");
+    g_list_free (serial);
+    qof_query_destroy (q);
+}
+
+struct LiveQueryCounts
+{
+    gint added;
+    gint removed;
+    gint moved;
+};
+
+static void
+live_query_cb (QofLiveQuery *lq, QofLiveQueryChange change, gpointer object,
+               guint position, gpointer user_data)
+{
+    auto counts = static_cast<LiveQueryCounts*>(user_data);
+    switch (change)
+    {
+    case QOF_LIVE_QUERY_ADDED:
+        counts->added++;
+        break;
+    case QOF_LIVE_QUERY_REMOVED:
+        counts->removed++;
+        break;
+    case QOF_LIVE_QUERY_MOVED:
+        counts->moved++;
+        break;
+    }
+}
+
+static gboolean
+live_query_matches_run (QofLiveQuery *lq, QofQuery *q)
+{
+    QofQuery *q2 = qof_query_copy (q);
+    GList *expected = qof_query_run (q2);
+    GList *node = qof_live_query_get_results (lq);
+
+    for (; node && expected; node = node->next, expected = expected->next)
+        if (node->data != expected->data)
+            break;
+    qof_query_destroy (q2);
+    return !node && !expected;
+}
+
+static void
+collect_instance (QofInstance *inst, gpointer data)
+{
+    auto list = static_cast<GList**>(data);
+    *list = g_list_prepend (*list, inst);
+}
+
+/* A live query must follow edits to the splits and to their
+ * transactions to the same results a fresh run gives. */
+static void
+test_live_query (QofBook *book)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    LiveQueryCounts counts {0, 0, 0};
+    GList *transactions = NULL, *node;
+    gint i = 0;
+
+    qof_query_set_book (q, book);
+    xaccQueryAddValueMatch (q, gnc_numeric_zero (), QOF_NUMERIC_MATCH_ANY,
+                            QOF_COMPARE_GT, QOF_QUERY_AND);
+    qof_query_set_max_results (q, 50);
+
+    auto lq = qof_live_query_new (q, live_query_cb, &counts);
+    do_test (live_query_matches_run (lq, q), "new live query matches a run");
+
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_TRANS),
+                            collect_instance, &transactions);
+
+    /* Move some transactions in time and turn others around. */
+    for (node = transactions; node && i < 20; node = node->next, i++)
+    {
+        auto trans = GNC_TRANSACTION (node->data);
+        xaccTransBeginEdit (trans);
+        if (i % 2)
+            xaccTransSetDatePostedSecsNormalized (trans,
+                                                  xaccTransGetDate (trans) + 86400 * 400);
+        else
+            for (auto snode = xaccTransGetSplitList (trans); snode;
+                 snode = snode->next)
+            {
+                auto split = GNC_SPLIT (snode->data);
+                xaccSplitSetAmount (split, gnc_numeric_neg (xaccSplitGetAmount (split)));
+                xaccSplitSetValue (split, gnc_numeric_neg (xaccSplitGetValue (split)));
+            }
+        xaccTransCommitEdit (trans);
+    }
+    do_test (live_query_matches_run (lq, q), "live query follows edits");
+    do_test (counts.added && counts.removed && counts.moved,
+             "live query reports the changes");
+
+    /* Nothing tells the live query about these. */
+    qof_event_suspend ();
+    for (node = transactions, i = 0; node && i < 10; node = node->next, i++)
+    {
+        auto trans = GNC_TRANSACTION (node->data);
+        xaccTransBeginEdit (trans);
+        xaccTransSetDatePostedSecsNormalized (trans,
+                                              xaccTransGetDate (trans) - 86400 * 800);
+        xaccTransCommitEdit (trans);
+    }
+    qof_event_resume ();
+    do_test (live_query_matches_run (lq, q),
+             "live query follows edits made while events were suspended");
+
+    auto trans = GNC_TRANSACTION (transactions->data);
+    xaccTransBeginEdit (trans);
+    xaccTransDestroy (trans);
+    xaccTransCommitEdit (trans);
+    do_test (live_query_matches_run (lq, q), "live query follows a deletion");
+
+    xaccQueryAddClearedMatch (q, CLEARED_NO, QOF_QUERY_AND);
+    do_test (live_query_matches_run (lq, q), "live query follows its query");
+
+    qof_live_query_destroy (lq);
+    qof_query_destroy (q);
+    g_list_free (transactions);
+}
+
+/* Renaming an account moves its splits in a live query sorted by
+ * account name, and in and out of one matching on the name. */
+static void
+test_live_query_accounts (QofBook *book)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    LiveQueryCounts counts {0, 0, 0};
+    auto root = gnc_book_get_root_account (book);
+    auto accounts = gnc_account_get_descendants (root);
+    gint i = 0;
+
+    qof_query_set_book (q, book);
+    qof_query_set_sort_order (q, qof_query_build_param_list (SPLIT_ACCOUNT,
+                                                             ACCOUNT_NAME_,
+                                                             NULL),
+                              NULL, NULL);
+    qof_query_add_term (q, qof_query_build_param_list (SPLIT_ACCOUNT,
+                                                       ACCOUNT_CODE_, NULL),
+                        qof_query_string_predicate (QOF_COMPARE_NEQ, "X",
+                                                    QOF_STRING_MATCH_NORMAL,
+                                                    FALSE),
+                        QOF_QUERY_AND);
+
+    auto lq = qof_live_query_new (q, live_query_cb, &counts);
+    do_test (live_query_matches_run (lq, q),
+             "new live query on account names matches a run");
+
+    for (auto node = accounts; node && i < 6; node = node->next, i++)
+    {
+        auto acc = GNC_ACCOUNT (node->data);
+        auto name = g_strdup_printf ("%c renamed %d", i % 2 ? 'A' : 'z', i);
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetName (acc, name);
+        if (i % 3 == 0)
+            xaccAccountSetCode (acc, "X");
+        xaccAccountCommitEdit (acc);
+        g_free (name);
+    }
+    do_test (live_query_matches_run (lq, q),
+             "live query follows account renames");
+
+    qof_live_query_destroy (lq);
+    qof_query_destroy (q);
+    g_list_free (accounts);
+}
+
 static void
 run_test (void)
 {
@@ -83,6 +401,22 @@ run_test (void)
 
     xaccAccountTreeForEachTransaction (root, test_trans_query, book);
 
+    auto accounts = gnc_account_get_descendants (root);
+    for (auto node = accounts; node; node = node->next)
+        test_account_date_query (GNC_ACCOUNT (node->data), book);
+    g_list_free (accounts);
+
+    test_max_results (book, NULL);
+    /* Few distinct values, so lots of ties. */
+    test_max_results (book, qof_query_build_param_list (SPLIT_RECONCILE, NULL));
+
+    /* Enough splits for the scan to be worth splitting up. */
+    add_random_transactions_to_book (book, 1000);
+    test_parallel_query (book);
+    test_thread_safe_params (book);
+    test_live_query (book);
+    test_live_query_accounts (book);
+
     qof_session_end (session);
 }
 
@@ -43,6 +43,7 @@ static const gchar *suitename = "/engine/Account";
 void test_suite_account (void);
 }
 
+#include <algorithm>
 #include <qofinstance-p.h>
 #include <kvp-frame.hpp>
 
@@ -895,7 +896,7 @@ test_xaccFreeAccount (Fixture *fixture, gconstpointer pData)
     /* Check that we've got children, lots, and splits to remove */
     g_assert (p_priv->children != NULL);
     g_assert (p_priv->lots != NULL);
-    g_assert (p_priv->splits != NULL);
+    g_assert (!p_priv->splits.empty());
     g_assert (p_priv->parent != NULL);
     g_assert (p_priv->commodity != NULL);
     g_assert_cmpint (check1->hits, ==, 0);
@@ -1010,7 +1011,7 @@ test_xaccAccountCommitEdit (Fixture *fixture, gconstpointer pData)
     /* Check that we've got children, lots, and splits to remove */
     g_assert (p_priv->children != NULL);
     g_assert (p_priv->lots != NULL);
-    g_assert (p_priv->splits != NULL);
+    g_assert (!p_priv->splits.empty());
     g_assert (p_priv->parent != NULL);
     g_assert (p_priv->commodity != NULL);
     g_assert_cmpint (check1->hits, ==, 0);
@@ -1026,7 +1027,7 @@ test_xaccAccountCommitEdit (Fixture *fixture, gconstpointer pData)
     test_signal_assert_hits (sig2, 0);
     g_assert (p_priv->children != NULL);
     g_assert (p_priv->lots != NULL);
-    g_assert (p_priv->splits != NULL);
+    g_assert (!p_priv->splits.empty());
     g_assert (p_priv->parent != NULL);
     g_assert (p_priv->commodity != NULL);
     g_assert_cmpint (check1->hits, ==, 0);
@@ -1350,6 +1351,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     Split *split2 = xaccMallocSplit (book);
     Split *split3 = xaccMallocSplit (book);
     TestSignal sig1, sig2, sig3;
+    GList *list;
     AccountPrivate *priv = fixture->func->get_private (fixture->acct);
     auto msg1 = ": assertion 'GNC_IS_ACCOUNT(acc)' failed";
     auto msg2 = ": assertion 'GNC_IS_SPLIT(s)' failed";
@@ -1370,19 +1372,19 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
 
     /* Check that the call fails with invalid account and split (throws) */
     g_assert (!gnc_account_insert_split (NULL, split1));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 0);
+    g_assert_cmpuint (priv->splits.size(), == , 0);
     g_assert (!priv->sort_dirty);
     g_assert (!priv->balance_dirty);
     test_signal_assert_hits (sig1, 0);
     test_signal_assert_hits (sig2, 0);
     g_assert (!gnc_account_insert_split (fixture->acct, NULL));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 0);
+    g_assert_cmpuint (priv->splits.size(), == , 0);
     g_assert (!priv->sort_dirty);
     g_assert (!priv->balance_dirty);
     test_signal_assert_hits (sig1, 0);
     test_signal_assert_hits (sig2, 0);
     /* g_assert (!gnc_account_insert_split (fixture->acct, (Split*)priv)); */
-    /* g_assert_cmpuint (g_list_length (priv->splits), == , 0); */
+    /* g_assert_cmpuint (priv->splits.size(), == , 0); */
     /* g_assert (!priv->sort_dirty); */
     /* g_assert (!priv->balance_dirty); */
     /* test_signal_assert_hits (sig1, 0); */
@@ -1395,7 +1397,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
 
     /* Check that it works the first time */
     g_assert (gnc_account_insert_split (fixture->acct, split1));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 1);
+    g_assert_cmpuint (priv->splits.size(), == , 1);
     g_assert (!priv->sort_dirty);
     g_assert (priv->balance_dirty);
     test_signal_assert_hits (sig1, 1);
@@ -1407,7 +1409,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     sig3 = test_signal_new (&fixture->acct->inst, GNC_EVENT_ITEM_ADDED, split2);
     /* Now add a second split to the account and check that sort_dirty isn't set. We have to bump the editlevel to force this. */
     g_assert (gnc_account_insert_split (fixture->acct, split2));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 2);
+    g_assert_cmpuint (priv->splits.size(), == , 2);
     g_assert (!priv->sort_dirty);
     g_assert (priv->balance_dirty);
     test_signal_assert_hits (sig1, 2);
@@ -1418,7 +1420,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     qof_instance_increase_editlevel (fixture->acct);
     g_assert (gnc_account_insert_split (fixture->acct, split3));
     qof_instance_decrease_editlevel (fixture->acct);
-    g_assert_cmpuint (g_list_length (priv->splits), == , 3);
+    g_assert_cmpuint (priv->splits.size(), == , 3);
     g_assert (priv->sort_dirty);
     g_assert (priv->balance_dirty);
     test_signal_assert_hits (sig1, 3);
@@ -1429,7 +1431,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     sig3 = test_signal_new (&fixture->acct->inst, GNC_EVENT_ITEM_REMOVED,
                             split3);
     g_assert (gnc_account_remove_split (fixture->acct, split3));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 2);
+    g_assert_cmpuint (priv->splits.size(), == , 2);
     g_assert (priv->sort_dirty);
     g_assert (!priv->balance_dirty);
     test_signal_assert_hits (sig1, 4);
@@ -1437,11 +1439,35 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     /* And do it again to make sure that it fails when the split has
      * already been removed */
     g_assert (!gnc_account_remove_split (fixture->acct, split3));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 2);
+    g_assert_cmpuint (priv->splits.size(), == , 2);
     g_assert (priv->sort_dirty);
     g_assert (!priv->balance_dirty);
     test_signal_assert_hits (sig1, 4);
     test_signal_assert_hits (sig3, 1);
+    /* The GList handed out by xaccAccountGetSplitList follows the
+     * split vector through later removals */
+    list = xaccAccountGetSplitList (fixture->acct);
+    g_assert_cmpuint (g_list_length (list), == , 2);
+    g_assert (g_list_nth_data (list, 0) == priv->splits[0]);
+    g_assert (g_list_nth_data (list, 1) == priv->splits[1]);
+    g_assert (gnc_account_remove_split (fixture->acct, split2));
+    list = xaccAccountGetSplitList (fixture->acct);
+    g_assert_cmpuint (g_list_length (list), == , 1);
+    g_assert (list->data == split1);
+    g_assert_cmpuint (xaccAccountGetSplitsSize (fixture->acct), == , 1);
+
+    /* Inserting a split into another account takes it out of this one,
+     * and out of the list */
+    auto other = xaccMallocAccount (book);
+    g_assert (gnc_account_insert_split (other, split1));
+    g_assert_cmpuint (xaccAccountGetSplitsSize (fixture->acct), == , 0);
+    g_assert (xaccAccountGetSplitList (fixture->acct) == NULL);
+    g_assert_cmpuint (xaccAccountGetSplitsSize (other), == , 1);
+    g_assert (gnc_account_insert_split (fixture->acct, split1));
+    g_assert_cmpuint (xaccAccountGetSplitsSize (other), == , 0);
+    g_assert (xaccAccountGetSplitList (fixture->acct)->data == split1);
+    xaccAccountBeginEdit (other);
+    xaccAccountDestroy (other);
 
     /* Clean up the handlers */
     test_signal_free (sig3);
@@ -1588,7 +1614,7 @@ test_xaccAccountRecomputeBalance (Fixture *fixture, gconstpointer pData)
     }
     g_assert (gnc_numeric_zero_p (priv->starting_balance));
     g_assert (gnc_numeric_zero_p (priv->balance));
-    priv->balance_dirty = TRUE;
+    gnc_account_set_balance_dirty (fixture->acct);
     xaccAccountRecomputeBalance (fixture->acct);
     g_assert (gnc_numeric_zero_p (priv->starting_balance));
     g_assert (gnc_numeric_eq (priv->balance, bal));
@@ -1597,6 +1623,149 @@ test_xaccAccountRecomputeBalance (Fixture *fixture, gconstpointer pData)
     g_assert (!priv->balance_dirty);
 }
 
+/* Changing one split in the middle of the register must leave every
+ * running balance identical to what a full recompute produces.
+ */
+static void
+test_xaccAccountRecomputeBalance_incremental (Fixture *fixture, gconstpointer pData)
+{
+    AccountPrivate *priv = fixture->func->get_private (fixture->acct);
+    const SplitsVec& splits = xaccAccountGetSplits (fixture->acct);
+    std::vector<gnc_numeric> bals;
+    size_t mid;
+    Split *split;
+
+    gnc_account_set_balance_dirty (fixture->acct);
+    xaccAccountRecomputeBalance (fixture->acct);
+    g_assert_cmpuint (splits.size (), >, 2);
+    mid = splits.size () / 2;
+    split = splits[mid];
+
+    xaccTransBeginEdit (xaccSplitGetParent (split));
+    xaccSplitSetAmount (split,
+                        gnc_numeric_add_fixed (xaccSplitGetAmount (split),
+                                               gnc_numeric_create (100, 1)));
+    g_assert (priv->balance_dirty);
+    g_assert_cmpuint (priv->balance_dirty_from, ==, mid);
+    xaccTransCommitEdit (xaccSplitGetParent (split));
+    xaccAccountRecomputeBalance (fixture->acct);
+    g_assert (!priv->balance_dirty);
+    g_assert_cmpuint (priv->balance_dirty_from, ==, SIZE_MAX);
+    for (auto s : splits)
+        bals.push_back (xaccSplitGetBalance (s));
+
+    gnc_account_set_balance_dirty (fixture->acct);
+    g_assert_cmpuint (priv->balance_dirty_from, ==, 0);
+    xaccAccountRecomputeBalance (fixture->acct);
+    for (size_t i = 0; i < splits.size (); ++i)
+        g_assert (gnc_numeric_equal (bals[i], xaccSplitGetBalance (splits[i])));
+    g_assert (gnc_numeric_equal (bals.back (), priv->balance));
+}
+
+/* gnc_book_begin_bulk_load, gnc_book_end_bulk_load
+ * Changes made during a bulk load leave the account dirty until the
+ * outermost bulk load ends, which then brings it up to date.
+ */
+static void
+test_gnc_book_bulk_load (Fixture *fixture, gconstpointer pData)
+{
+    AccountPrivate *priv = fixture->func->get_private (fixture->acct);
+    QofBook *book = gnc_account_get_book (fixture->acct);
+    const SplitsVec& splits = xaccAccountGetSplits (fixture->acct);
+    gnc_numeric bal, added = gnc_numeric_create (100, 1);
+    Split *split;
+
+    gnc_account_set_balance_dirty (fixture->acct);
+    xaccAccountRecomputeBalance (fixture->acct);
+    bal = priv->balance;
+    g_assert_cmpuint (splits.size (), >, 2);
+    split = splits[splits.size () / 2];
+
+    gnc_book_begin_bulk_load (book);
+    gnc_book_begin_bulk_load (book);
+    g_assert (qof_book_is_bulk_loading (book));
+    xaccTransBeginEdit (xaccSplitGetParent (split));
+    xaccSplitSetAmount (split,
+                        gnc_numeric_add_fixed (xaccSplitGetAmount (split),
+                                               added));
+    xaccTransCommitEdit (xaccSplitGetParent (split));
+    g_assert (priv->balance_dirty);
+    g_assert (gnc_numeric_equal (priv->balance, bal));
+
+    gnc_book_end_bulk_load (book);
+    g_assert (qof_book_is_bulk_loading (book));
+    g_assert (priv->balance_dirty);
+
+    gnc_book_end_bulk_load (book);
+    g_assert (!qof_book_is_bulk_loading (book));
+    g_assert (!priv->balance_dirty);
+    g_assert (!priv->sort_dirty);
+    g_assert (gnc_numeric_equal (priv->balance,
+                                 gnc_numeric_add_fixed (bal, added)));
+    g_assert (std::is_sorted (splits.begin (), splits.end (),
+                              [] (const Split *a, const Split *b) {
+                                  return xaccSplitOrder (a, b) < 0;
+                              }));
+}
+
+/* gnc_book_set_bulk_load_workers
+ * Ending a bulk load on several threads sorts and balances the accounts
+ * just as ending it on one does.
+ */
+static void
+test_gnc_book_bulk_load_workers (Fixture *fixture, gconstpointer pData)
+{
+    QofBook *book = gnc_account_get_book (fixture->acct);
+    GList *accounts = gnc_account_get_descendants (gnc_book_get_root_account (book));
+    std::vector<SplitsVec> serial_splits;
+    std::vector<gnc_numeric> serial_balances;
+    guint old_workers = gnc_book_get_bulk_load_workers ();
+
+    for (guint workers : {1u, 4u})
+    {
+        std::vector<SplitsVec> splits;
+        std::vector<gnc_numeric> balances;
+
+        /* Leave the splits the way a load might: out of order and with
+         * no balances. */
+        gnc_book_begin_bulk_load (book);
+        for (GList *node = accounts; node; node = node->next)
+        {
+            Account *acc = GNC_ACCOUNT (node->data);
+            SplitsVec& acc_splits = fixture->func->get_private (acc)->splits;
+            std::reverse (acc_splits.begin (), acc_splits.end ());
+            gnc_account_set_sort_dirty (acc);
+            gnc_account_set_balance_dirty (acc);
+        }
+        gnc_book_set_bulk_load_workers (workers);
+        gnc_book_end_bulk_load (book);
+
+        for (GList *node = accounts; node; node = node->next)
+        {
+            Account *acc = GNC_ACCOUNT (node->data);
+            splits.push_back (xaccAccountGetSplits (acc));
+            for (auto split : splits.back ())
+                balances.push_back (xaccSplitGetBalance (split));
+            balances.push_back (xaccAccountGetBalance (acc));
+            balances.push_back (xaccAccountGetClearedBalance (acc));
+            balances.push_back (xaccAccountGetReconciledBalance (acc));
+        }
+        if (workers == 1)
+        {
+            serial_splits = splits;
+            serial_balances = balances;
+            continue;
+        }
+        g_assert (splits == serial_splits);
+        g_assert_cmpuint (balances.size (), ==, serial_balances.size ());
+        for (size_t i = 0; i < balances.size (); ++i)
+            g_assert (gnc_numeric_equal (balances[i], serial_balances[i]));
+    }
+
+    gnc_book_set_bulk_load_workers (old_workers);
+    g_list_free (accounts);
+}
+
 /* xaccAccountOrder
 int
 xaccAccountOrder (const Account *aa, const Account *ab)// C: 11 in 3 */
@@ -2218,6 +2387,62 @@ test_xaccAccountGetBalanceAsOfDate (Fixture *fixture, gconstpointer pData)
     dval = gnc_numeric_to_double (val);
     g_assert_cmpfloat (dval, == , dbal);
 }
+/* xaccAccountGetReconciledBalanceAsOfDate
+gnc_numeric
+xaccAccountGetReconciledBalanceAsOfDate (Account *acc, time64 date)*/
+static void
+set_date_reconciled (Split *split, time64 date)
+{
+    auto txn = xaccSplitGetParent (split);
+    xaccTransBeginEdit (txn);
+    xaccSplitSetDateReconciledSecs (split, date);
+    /* xaccTransCommitEdit () does a bunch of scrubbing that we don't need */
+    qof_commit_edit (QOF_INSTANCE (txn));
+}
+
+static void
+test_xaccAccountGetReconciledBalanceAsOfDate (Fixture *fixture, gconstpointer pData)
+{
+    const time64 day = 24 * 3600;
+    auto now = gnc_time (NULL);
+    Split *salt = NULL, *pork = NULL;
+    gnc_numeric val;
+
+    for (auto split : xaccAccountGetSplits (fixture->acct))
+    {
+        if (g_strcmp0 (xaccSplitGetMemo (split), "salt_meh") == 0)
+            salt = split;
+        else if (g_strcmp0 (xaccSplitGetMemo (split), "pork_meh") == 0)
+            pork = split;
+    }
+    g_assert (salt != NULL && pork != NULL);
+    set_date_reconciled (salt, now - 2 * day);
+    set_date_reconciled (pork, now + 3 * day);
+    xaccAccountRecomputeBalance (fixture->acct);
+
+    val = xaccAccountGetReconciledBalanceAsOfDate (fixture->acct, now - 5 * day);
+    g_assert (gnc_numeric_zero_p (val));
+    val = xaccAccountGetReconciledBalanceAsOfDate (fixture->acct, now - 2 * day);
+    g_assert (gnc_numeric_equal (val, gnc_numeric_create (31415, 100)));
+    val = xaccAccountGetReconciledBalanceAsOfDate (fixture->acct, now);
+    g_assert (gnc_numeric_equal (val, gnc_numeric_create (31415, 100)));
+    val = xaccAccountGetReconciledBalanceAsOfDate (fixture->acct, now + 4 * day);
+    g_assert (gnc_numeric_equal (val, gnc_numeric_create (31415 - 23746, 100)));
+
+    /* Moving a reconcile date doesn't change any balance, but must still
+     * move the split in the date index */
+    set_date_reconciled (salt, now + day);
+    val = xaccAccountGetReconciledBalanceAsOfDate (fixture->acct, now);
+    g_assert (gnc_numeric_zero_p (val));
+    set_date_reconciled (salt, now - 2 * day);
+
+    /* Unreconciling a split must not leave it in the date index */
+    xaccTransBeginEdit (xaccSplitGetParent (pork));
+    xaccSplitSetReconcile (pork, NREC);
+    qof_commit_edit (QOF_INSTANCE (xaccSplitGetParent (pork)));
+    val = xaccAccountGetReconciledBalanceAsOfDate (fixture->acct, now + 4 * day);
+    g_assert (gnc_numeric_equal (val, gnc_numeric_create (31415, 100)));
+}
 /* xaccAccountGetPresentBalance
 gnc_numeric
 xaccAccountGetPresentBalance (const Account *acc)// C: 4 in 2 */
@@ -2828,6 +3053,9 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "gnc account insert & remove split", Fixture, NULL, setup, test_gnc_account_insert_remove_split,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccount Insert and Remove Lot", Fixture, &good_data, setup, test_xaccAccountInsertRemoveLot,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountRecomputeBalance", Fixture, &some_data, setup, test_xaccAccountRecomputeBalance,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountRecomputeBalance incremental", Fixture, &some_data, setup, test_xaccAccountRecomputeBalance_incremental,  teardown );
+    GNC_TEST_ADD (suitename, "gnc_book bulk load", Fixture, &some_data, setup, test_gnc_book_bulk_load,  teardown );
+    GNC_TEST_ADD (suitename, "gnc_book bulk load workers", Fixture, &some_data, setup, test_gnc_book_bulk_load_workers,  teardown );
     GNC_TEST_ADD_FUNC (suitename, "xaccAccountOrder", test_xaccAccountOrder );
     GNC_TEST_ADD (suitename, "qofAccountSetParent", Fixture, &some_data, setup, test_qofAccountSetParent,  teardown );
     GNC_TEST_ADD (suitename, "gnc account append/remove child", Fixture, NULL, setup, test_gnc_account_append_remove_child,  teardown );
@@ -2847,6 +3075,7 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "gnc account get full name", Fixture, &good_data, setup, test_gnc_account_get_full_name,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetProjectedMinimumBalance", Fixture, &some_data, setup, test_xaccAccountGetProjectedMinimumBalance,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetBalanceAsOfDate", Fixture, &some_data, setup, test_xaccAccountGetBalanceAsOfDate,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountGetReconciledBalanceAsOfDate", Fixture, &some_data, setup, test_xaccAccountGetReconciledBalanceAsOfDate,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetPresentBalance", Fixture, &some_data, setup, test_xaccAccountGetPresentBalance,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountFindOpenLots", Fixture, &complex_data, setup, test_xaccAccountFindOpenLots,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountForEachLot", Fixture, &complex_data, setup, test_xaccAccountForEachLot,  teardown );
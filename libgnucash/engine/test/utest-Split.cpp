@@ -45,6 +45,7 @@ static const gchar *suitename = "/engine/Split";
 void test_suite_split ( void );
 }
 
+#include <cstddef>
 #include <qofinstance-p.h>
 #include <kvp-frame.hpp>
 
@@ -146,6 +147,36 @@ test_gnc_split_init ()
 
     g_object_unref (split);
 }
+/* Split layout
+ * The fields xaccAccountRecomputeBalance reads and writes are kept
+ * together at the start of the Split, ahead of the rarely used ones.
+ */
+static void
+test_split_layout ()
+{
+    const size_t hot_begin = offsetof (Split, acc);
+    const size_t hot_end = offsetof (Split, reconciled_balance) +
+        sizeof (gnc_numeric);
+    const size_t hot[] = {offsetof (Split, acc), offsetof (Split, parent),
+                          offsetof (Split, amount), offsetof (Split, value),
+                          offsetof (Split, reconciled),
+                          offsetof (Split, balance),
+                          offsetof (Split, noclosing_balance),
+                          offsetof (Split, cleared_balance),
+                          offsetof (Split, reconciled_balance)};
+    const size_t cold[] = {offsetof (Split, lot), offsetof (Split, gains_split),
+                           offsetof (Split, memo), offsetof (Split, action),
+                           offsetof (Split, split_type),
+                           offsetof (Split, date_reconciled),
+                           offsetof (Split, orig_acc),
+                           offsetof (Split, orig_parent)};
+
+    for (auto h : hot)
+        g_assert (h >= hot_begin && h < hot_end);
+    for (auto c : cold)
+        g_assert (c < hot_begin || c >= hot_end);
+}
+
 /* gnc_split_dispose
 static void
 gnc_split_dispose(GObject *splitp)*/
@@ -1901,6 +1932,7 @@ test_suite_split (void)
 {
 
     GNC_TEST_ADD_FUNC (suitename, "gnc split init", test_gnc_split_init);
+    GNC_TEST_ADD_FUNC (suitename, "split layout", test_split_layout);
     GNC_TEST_ADD_FUNC (suitename, "gnc split dispose", test_gnc_split_dispose);
     GNC_TEST_ADD_FUNC (suitename, "gnc split set & get property", test_gnc_split_set_get_property);
     GNC_TEST_ADD (suitename, "xaccMallocSplit", Fixture, NULL, setup, test_xaccMallocSplit, teardown);
@@ -720,6 +720,38 @@ test_gnc_pricedb_get_num_prices (PriceDBFixture *fixture, gconstpointer pData)
     int num = gnc_pricedb_get_num_prices(fixture->pricedb);
     g_assert_cmpint(num, ==, 42);
 }
+
+static void
+test_gnc_pricedb_nth_price (PriceDBFixture *fixture, gconstpointer pData)
+{
+    GNCPriceDB *db = fixture->pricedb;
+    QofBook *book = qof_instance_get_book(QOF_INSTANCE(db));
+    QofBook *book2 = qof_book_new();
+    GNCPriceDB *db2 = gnc_pricedb_get_db(book2);
+    gnc_commodity *usd = fixture->com->usd;
+    int num = gnc_pricedb_num_prices(db, usd);
+    GNCPrice *price;
+    int i;
+
+    g_assert_cmpint(num, >, 0);
+    for (i = 0; i < num; i++)
+        g_assert(gnc_price_get_commodity(gnc_pricedb_nth_price(db, usd, i))
+                 == usd);
+    g_assert(gnc_pricedb_nth_price(db, usd, num) == NULL);
+    /* Each db has its own view. */
+    g_assert(gnc_pricedb_nth_price(db2, usd, 0) == NULL);
+    g_assert(gnc_pricedb_nth_price(db, usd, 0) != NULL);
+
+    price = construct_price(book, usd, fixture->com->gbp,
+                            gnc_dmy2time64(1, 1, 2020), PRICE_SOURCE_FQ,
+                            gnc_numeric_create(3, 4));
+    gnc_pricedb_add_price(db, price);
+    g_assert(gnc_pricedb_nth_price(db, usd, num) != NULL);
+    g_assert(gnc_pricedb_nth_price(db, usd, num + 1) == NULL);
+    gnc_pricedb_remove_price(db, price);
+    g_assert(gnc_pricedb_nth_price(db, usd, num) == NULL);
+    qof_book_destroy(book2);
+}
 /* pricedb_equal_foreach_pricelist
 static void
 pricedb_equal_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)// Local: 0:1:0
@@ -1193,6 +1225,74 @@ test_gnc_pricedb_lookup_nearest_before_t64 (PriceDBFixture *fixture, gconstpoint
     g_assert_cmpstr(GET_CUR_NAME(price), ==, "USD");
 
 }
+
+/* Lookups must see one time-ordered series across both quote directions
+ * no matter in which order the prices were added. */
+#define NUM_SERIES_PRICES 40
+static void
+test_gnc_pricedb_lookup_interleaved (PriceDBFixture *fixture, gconstpointer pData)
+{
+    GNCPriceDB *db = fixture->pricedb;
+    QofBook *book = qof_instance_get_book(QOF_INSTANCE(db));
+    gnc_commodity *bgn = fixture->com->bgn, *dkk = fixture->com->dkk;
+    time64 base = gnc_dmy2time64(1, 1, 2015) + 3600;
+    const time64 day = 86400;
+    GNCPrice *price;
+    PriceList *prices, *node;
+    int i, count;
+
+    /* Even days quote BGN in DKK, odd days DKK in BGN; 7 is coprime to the
+     * number of prices so they arrive out of order. */
+    for (i = 0; i < NUM_SERIES_PRICES; i++)
+    {
+        int d = (i * 7) % NUM_SERIES_PRICES;
+        gboolean even = (d % 2 == 0);
+        gnc_pricedb_add_price(db, construct_price(book, even ? bgn : dkk,
+                                                  even ? dkk : bgn,
+                                                  base + d * day,
+                                                  PRICE_SOURCE_FQ,
+                                                  gnc_numeric_create(d + 1, 1)));
+    }
+
+    prices = gnc_pricedb_get_prices(db, bgn, dkk);
+    for (node = prices, count = 0; node; node = node->next, count++)
+        if (node->next)
+            g_assert_cmpint(gnc_price_get_time64(node->data), >,
+                            gnc_price_get_time64(node->next->data));
+    g_assert_cmpint(count, ==, NUM_SERIES_PRICES / 2);
+    gnc_price_list_destroy(prices);
+
+    price = gnc_pricedb_lookup_latest(db, bgn, dkk);
+    g_assert_cmpint(gnc_price_get_time64(price), ==,
+                    base + (NUM_SERIES_PRICES - 1) * day);
+    gnc_price_unref(price);
+
+    g_assert(gnc_pricedb_lookup_nearest_before_t64(db, dkk, bgn,
+                                                   base - 1) == NULL);
+    for (i = 0; i < NUM_SERIES_PRICES; i++)
+    {
+        time64 t = base + i * day;
+
+        price = gnc_pricedb_lookup_at_time64(db, dkk, bgn, t);
+        g_assert_cmpint(gnc_price_get_time64(price), ==, t);
+        gnc_price_unref(price);
+        g_assert(gnc_pricedb_lookup_at_time64(db, dkk, bgn, t + 1) == NULL);
+
+        price = gnc_pricedb_lookup_nearest_before_t64(db, bgn, dkk, t + day - 1);
+        g_assert_cmpint(gnc_price_get_time64(price), ==, t);
+        gnc_price_unref(price);
+
+        price = gnc_pricedb_lookup_nearest_in_time64(db, bgn, dkk,
+                                                     t + day / 2 - 1);
+        g_assert_cmpint(gnc_price_get_time64(price), ==, t);
+        gnc_price_unref(price);
+
+        price = gnc_pricedb_lookup_nearest_in_time64(db, bgn, dkk,
+                                                     t - day / 2 + 1);
+        g_assert_cmpint(gnc_price_get_time64(price), ==, t);
+        gnc_price_unref(price);
+    }
+}
 /* direct_balance_conversion
 static gnc_numeric
 direct_balance_conversion (GNCPriceDB *db, gnc_numeric bal,// Local: 2:0:0
@@ -1427,6 +1527,59 @@ test_gnc_pricedb_get_nearest_price (PriceDBFixture *fixture, gconstpointer pData
     g_assert_cmpint(result.denom, ==, 1331);
 }
 
+static void
+test_gnc_pricedb_conversion_cache (PriceDBFixture *fixture, gconstpointer pData)
+{
+    GNCPriceDB *db = fixture->pricedb;
+    QofBook *book = qof_instance_get_book(QOF_INSTANCE(db));
+    time64 t = gnc_dmy2time64(15, 8, 2011);
+    guint64 hits, misses;
+    gnc_numeric result;
+    GNCPrice *price;
+
+    gnc_pricedb_get_conversion_cache_stats (db, &hits, &misses);
+    g_assert_cmpuint(hits, ==, 0);
+    g_assert_cmpuint(misses, ==, 0);
+
+    result = gnc_pricedb_get_nearest_price (db, fixture->com->gbp,
+                                            fixture->com->dkk, t);
+    g_assert_cmpint(result.num, ==, 84450223707);
+    g_assert_cmpint(result.denom, ==, 10000000000);
+    result = gnc_pricedb_get_nearest_price (db, fixture->com->gbp,
+                                            fixture->com->dkk, t);
+    g_assert_cmpint(result.num, ==, 84450223707);
+    g_assert_cmpint(result.denom, ==, 10000000000);
+    gnc_pricedb_get_conversion_cache_stats (db, &hits, &misses);
+    g_assert_cmpuint(hits, ==, 1);
+    g_assert_cmpuint(misses, ==, 1);
+
+    /* A direct price replaces the derived rate... */
+    price = construct_price(book, fixture->com->gbp, fixture->com->dkk, t,
+                            PRICE_SOURCE_USER_PRICE, gnc_numeric_create(8, 1));
+    gnc_pricedb_add_price(db, price);
+    result = gnc_pricedb_get_nearest_price (db, fixture->com->gbp,
+                                            fixture->com->dkk, t);
+    g_assert_cmpint(result.num, ==, 8);
+    g_assert_cmpint(result.denom, ==, 1);
+
+    /* ...and so does changing it... */
+    gnc_price_set_value(price, gnc_numeric_create(9, 1));
+    result = gnc_pricedb_get_nearest_price (db, fixture->com->gbp,
+                                            fixture->com->dkk, t);
+    g_assert_cmpint(result.num, ==, 9);
+    g_assert_cmpint(result.denom, ==, 1);
+
+    /* ...and removing it brings the old one back. */
+    gnc_pricedb_remove_price(db, price);
+    result = gnc_pricedb_get_nearest_price (db, fixture->com->gbp,
+                                            fixture->com->dkk, t);
+    g_assert_cmpint(result.num, ==, 84450223707);
+    g_assert_cmpint(result.denom, ==, 10000000000);
+    gnc_pricedb_get_conversion_cache_stats (db, &hits, &misses);
+    g_assert_cmpuint(hits, ==, 1);
+    g_assert_cmpuint(misses, ==, 4);
+}
+
 static void
 test_gnc_pricedb_get_nearest_before_price (PriceDBFixture *fixture, gconstpointer pData)
 {
@@ -1688,6 +1841,7 @@ GNC_TEST_ADD (suitename, "gnc price list equal", PriceDBFixture, NULL, setup, te
 // GNC_TEST_ADD (suitename, "gnc pricedb get db", Fixture, NULL, setup, test_gnc_pricedb_get_db, teardown);
 // GNC_TEST_ADD (suitename, "num prices helper", Fixture, NULL, setup, test_num_prices_helper, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb get num prices", PriceDBFixture, NULL, setup, test_gnc_pricedb_get_num_prices, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb nth price", PriceDBFixture, NULL, setup, test_gnc_pricedb_nth_price, teardown);
 // GNC_TEST_ADD (suitename, "pricedb equal foreach pricelist", Fixture, NULL, setup, test_pricedb_equal_foreach_pricelist, teardown);
 // GNC_TEST_ADD (suitename, "pricedb equal foreach currencies hash", Fixture, NULL, setup, test_pricedb_equal_foreach_currencies_hash, teardown);
 // GNC_TEST_ADD (suitename, "insert or replace price", Fixture, NULL, setup, test_insert_or_replace_price, teardown);
@@ -1718,6 +1872,7 @@ GNC_TEST_ADD (suitename, "gnc price list equal", PriceDBFixture, NULL, setup, te
 // GNC_TEST_ADD (suitename, "lookup nearest in time", Fixture, NULL, setup, test_lookup_nearest_in_time, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb lookup nearest in time", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_nearest_in_time64, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb lookup nearest before in time", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_nearest_before_t64, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb lookup interleaved", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_interleaved, teardown);
 // GNC_TEST_ADD (suitename, "direct balance conversion", Fixture, NULL, setup, test_direct_balance_conversion, teardown);
 // GNC_TEST_ADD (suitename, "extract common prices", Fixture, NULL, setup, test_extract_common_prices, teardown);
 // GNC_TEST_ADD (suitename, "convert balance", Fixture, NULL, setup, test_convert_balance, teardown);
@@ -1727,6 +1882,7 @@ GNC_TEST_ADD (suitename, "gnc price list equal", PriceDBFixture, NULL, setup, te
     GNC_TEST_ADD (suitename, "gnc pricedb convert balance nearest before price", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balance_nearest_before_price_t64, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb get latest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_get_latest_price, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb get nearest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_get_nearest_price, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb conversion cache", PriceDBFixture, NULL, setup, test_gnc_pricedb_conversion_cache, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb get nearest before price", PriceDBFixture, NULL, setup, test_gnc_pricedb_get_nearest_before_price, teardown);
 // GNC_TEST_ADD (suitename, "pricedb foreach pricelist", Fixture, NULL, setup, test_pricedb_foreach_pricelist, teardown);
 // GNC_TEST_ADD (suitename, "pricedb foreach currencies hash", Fixture, NULL, setup, test_pricedb_foreach_currencies_hash, teardown);